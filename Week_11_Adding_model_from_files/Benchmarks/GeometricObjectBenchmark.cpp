@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "GeometricObject.h"
+#include "LegacyGeometricObject.h"
+
+// Generating primitives with the generators that were replaced, which push back every vertex and
+// index into vectors that start empty and find one sine and cosine at a time, against the forms
+// of the Compute functions that write into a buffer that is allocated once and reused.  The
+// argument is the tessellation.  A sphere cannot be finer than 180 with 16-bit indices.
+
+namespace
+{
+	template<typename Generate> void GenerateIntoNewVectors(benchmark::State& state, size_t vertexCount, Generate generate)
+	{
+		for (auto _ : state)
+		{
+			vector<ObjectVertexStruct> vertices;
+			vector<uint32_t> indices;
+			generate(vertices, indices);
+			benchmark::DoNotOptimize(vertices.data());
+			benchmark::DoNotOptimize(indices.data());
+		}
+		state.SetItemsProcessed(state.iterations() * vertexCount);
+	}
+
+	template<typename Generate> void GenerateIntoBuffer(benchmark::State& state, const GeometryCounts& counts, Generate generate)
+	{
+		vector<ObjectVertexStruct> vertices(counts.VertexCount);
+		vector<uint32_t> indices(counts.IndexCount);
+		for (auto _ : state)
+		{
+			generate(vertices.data(), indices.data());
+			benchmark::DoNotOptimize(vertices.data());
+			benchmark::DoNotOptimize(indices.data());
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * counts.VertexCount);
+	}
+}
+
+static void BM_SphereLegacy(benchmark::State& state)
+{
+	size_t tessellation = static_cast<size_t>(state.range(0));
+	GenerateIntoNewVectors(state, GetSphereCounts(tessellation).VertexCount,
+						   [=](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { LegacyGeometricObject::ComputeSphere(vertices, indices, 1.0f, tessellation); });
+}
+BENCHMARK(BM_SphereLegacy)->Arg(16)->Arg(64)->Arg(180);
+
+static void BM_SphereBuffer(benchmark::State& state)
+{
+	size_t tessellation = static_cast<size_t>(state.range(0));
+	GenerateIntoBuffer(state, GetSphereCounts(tessellation), [=](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeSphere(vertices, indices, 1.0f, tessellation); });
+}
+BENCHMARK(BM_SphereBuffer)->Arg(16)->Arg(64)->Arg(180);
+
+static void BM_CylinderLegacy(benchmark::State& state)
+{
+	size_t tessellation = static_cast<size_t>(state.range(0));
+	GenerateIntoNewVectors(state, GetCylinderCounts(tessellation).VertexCount,
+						   [=](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { LegacyGeometricObject::ComputeCylinder(vertices, indices, 2.0f, 1.0f, tessellation); });
+}
+BENCHMARK(BM_CylinderLegacy)->Arg(256)->Arg(1024)->Arg(4096);
+
+static void BM_CylinderBuffer(benchmark::State& state)
+{
+	size_t tessellation = static_cast<size_t>(state.range(0));
+	GenerateIntoBuffer(state, GetCylinderCounts(tessellation), [=](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeCylinder(vertices, indices, 2.0f, 1.0f, tessellation); });
+}
+BENCHMARK(BM_CylinderBuffer)->Arg(256)->Arg(1024)->Arg(4096);
+
+static void BM_ConeLegacy(benchmark::State& state)
+{
+	size_t tessellation = static_cast<size_t>(state.range(0));
+	GenerateIntoNewVectors(state, GetConeCounts(tessellation).VertexCount,
+						   [=](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { LegacyGeometricObject::ComputeCone(vertices, indices, 1.0f, 2.0f, tessellation); });
+}
+BENCHMARK(BM_ConeLegacy)->Arg(256)->Arg(1024)->Arg(4096);
+
+static void BM_ConeBuffer(benchmark::State& state)
+{
+	size_t tessellation = static_cast<size_t>(state.range(0));
+	GenerateIntoBuffer(state, GetConeCounts(tessellation), [=](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeCone(vertices, indices, 1.0f, 2.0f, tessellation); });
+}
+BENCHMARK(BM_ConeBuffer)->Arg(256)->Arg(1024)->Arg(4096);
+
+static void BM_BoxLegacy(benchmark::State& state)
+{
+	GenerateIntoNewVectors(state, GetBoxCounts().VertexCount,
+						   [](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { LegacyGeometricObject::ComputeBox(vertices, indices, Vector3(1.0f, 2.0f, 3.0f)); });
+}
+BENCHMARK(BM_BoxLegacy);
+
+static void BM_BoxBuffer(benchmark::State& state)
+{
+	GenerateIntoBuffer(state, GetBoxCounts(), [](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeBox(vertices, indices, Vector3(1.0f, 2.0f, 3.0f)); });
+}
+BENCHMARK(BM_BoxBuffer);
@@ -0,0 +1,160 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "MeshOptimiser.h"
+
+// The optimiser stages on large meshes.  The mesh is a grid with the argument as the number of
+// quads along each side, so 1024 is about two million triangles.  The triangles are shuffled
+// and every triangle has its own copy of its vertices, as a mesh exported without an index
+// buffer would, so that every stage has work to do.  The ACMR counters are for the shuffled
+// and optimised indices.
+
+namespace
+{
+	struct BenchmarkVertex
+	{
+		float				Position[3];
+		float				Normal[3];
+		float				TexCoord[2];
+	};
+
+	void BuildGrid(size_t quadsPerSide, vector<BenchmarkVertex>& vertices, vector<uint32_t>& indices)
+	{
+		size_t triangleCount = quadsPerSide * quadsPerSide * 2;
+		vector<uint32_t> corners(triangleCount * 3);
+		size_t verticesPerSide = quadsPerSide + 1;
+		for (size_t y = 0; y < quadsPerSide; y++)
+		{
+			for (size_t x = 0; x < quadsPerSide; x++)
+			{
+				uint32_t corner = static_cast<uint32_t>(y * verticesPerSide + x);
+				uint32_t quad[6] = { corner, corner + static_cast<uint32_t>(verticesPerSide), corner + 1,
+									 corner + 1, corner + static_cast<uint32_t>(verticesPerSide), corner + static_cast<uint32_t>(verticesPerSide) + 1 };
+				copy(quad, quad + 6, corners.begin() + (y * quadsPerSide + x) * 6);
+			}
+		}
+		// Shuffle the triangles
+		uint64_t random = 12345;
+		for (size_t i = triangleCount - 1; i > 0; i--)
+		{
+			random = random * 6364136223846793005ull + 1442695040888963407ull;
+			size_t j = static_cast<size_t>(random >> 33) % (i + 1);
+			swap_ranges(corners.begin() + i * 3, corners.begin() + i * 3 + 3, corners.begin() + j * 3);
+		}
+		vertices.resize(corners.size());
+		indices.resize(corners.size());
+		for (size_t i = 0; i < corners.size(); i++)
+		{
+			float x = static_cast<float>(corners[i] % verticesPerSide);
+			float y = static_cast<float>(corners[i] / verticesPerSide);
+			vertices[i] = { { x, y, 0.0f }, { 0.0f, 0.0f, -1.0f }, { x / quadsPerSide, y / quadsPerSide } };
+			indices[i] = static_cast<uint32_t>(i);
+		}
+	}
+
+	// The welded grid, which is the input to the later stages
+	void BuildWeldedGrid(size_t quadsPerSide, vector<BenchmarkVertex>& vertices, vector<uint32_t>& indices)
+	{
+		BuildGrid(quadsPerSide, vertices, indices);
+		vertices.resize(WeldVertices(vertices.data(), vertices.size(), sizeof(BenchmarkVertex), indices));
+	}
+}
+
+static void BM_WeldVertices(benchmark::State& state)
+{
+	vector<BenchmarkVertex> sourceVertices;
+	vector<uint32_t> sourceIndices;
+	BuildGrid(static_cast<size_t>(state.range(0)), sourceVertices, sourceIndices);
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		vector<BenchmarkVertex> vertices = sourceVertices;
+		vector<uint32_t> indices = sourceIndices;
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(WeldVertices(vertices.data(), vertices.size(), sizeof(BenchmarkVertex), indices));
+	}
+	state.SetItemsProcessed(state.iterations() * sourceIndices.size() / 3);
+}
+BENCHMARK(BM_WeldVertices)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+static void BM_OptimiseVertexCache(benchmark::State& state)
+{
+	vector<BenchmarkVertex> vertices;
+	vector<uint32_t> sourceIndices;
+	BuildWeldedGrid(static_cast<size_t>(state.range(0)), vertices, sourceIndices);
+	vector<uint32_t> indices;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		indices = sourceIndices;
+		state.ResumeTiming();
+		OptimiseVertexCache(indices, vertices.size());
+	}
+	state.SetItemsProcessed(state.iterations() * sourceIndices.size() / 3);
+	state.counters["ACMRBefore"] = AnalyseVertexCache(sourceIndices, vertices.size()).ACMR;
+	state.counters["ACMRAfter"] = AnalyseVertexCache(indices, vertices.size()).ACMR;
+}
+BENCHMARK(BM_OptimiseVertexCache)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+static void BM_OptimiseOverdraw(benchmark::State& state)
+{
+	vector<BenchmarkVertex> vertices;
+	vector<uint32_t> sourceIndices;
+	BuildWeldedGrid(static_cast<size_t>(state.range(0)), vertices, sourceIndices);
+	OptimiseVertexCache(sourceIndices, vertices.size());
+	vector<uint32_t> indices;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		indices = sourceIndices;
+		state.ResumeTiming();
+		OptimiseOverdraw(indices, vertices.data(), vertices.size(), sizeof(BenchmarkVertex), DefaultMeshOptimiserOptions().OverdrawThreshold);
+	}
+	state.SetItemsProcessed(state.iterations() * sourceIndices.size() / 3);
+	state.counters["ACMRBefore"] = AnalyseVertexCache(sourceIndices, vertices.size()).ACMR;
+	state.counters["ACMRAfter"] = AnalyseVertexCache(indices, vertices.size()).ACMR;
+}
+BENCHMARK(BM_OptimiseOverdraw)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+static void BM_OptimiseVertexFetch(benchmark::State& state)
+{
+	vector<BenchmarkVertex> sourceVertices;
+	vector<uint32_t> sourceIndices;
+	BuildWeldedGrid(static_cast<size_t>(state.range(0)), sourceVertices, sourceIndices);
+	OptimiseVertexCache(sourceIndices, sourceVertices.size());
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		vector<BenchmarkVertex> vertices = sourceVertices;
+		vector<uint32_t> indices = sourceIndices;
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(OptimiseVertexFetch(vertices.data(), vertices.size(), sizeof(BenchmarkVertex), indices));
+	}
+	state.SetItemsProcessed(state.iterations() * sourceIndices.size() / 3);
+}
+BENCHMARK(BM_OptimiseVertexFetch)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+// Everything that is run when a model is imported
+static void BM_OptimiseMesh(benchmark::State& state)
+{
+	vector<BenchmarkVertex> sourceVertices;
+	vector<uint32_t> sourceIndices;
+	BuildGrid(static_cast<size_t>(state.range(0)), sourceVertices, sourceIndices);
+	MeshOptimiserOptions options = DefaultMeshOptimiserOptions();
+	options.OptimiseOverdraw = true;
+	MeshOptimiserReport report = {};
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		vector<BenchmarkVertex> vertices = sourceVertices;
+		vector<uint32_t> indices = sourceIndices;
+		state.ResumeTiming();
+		OptimiseMesh(vertices, indices, options, &report);
+	}
+	state.SetItemsProcessed(state.iterations() * sourceIndices.size() / 3);
+	state.counters["ACMRBefore"] = report.Before.ACMR;
+	state.counters["ACMRAfter"] = report.After.ACMR;
+	state.counters["VerticesAfter"] = static_cast<double>(report.VertexCountAfter);
+}
+BENCHMARK(BM_OptimiseMesh)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+#include "RecordingRenderDevice.h"
+#include "RenderQueue.h"
+
+// The CPU cost of a frame: submitting, sorting and executing a queue of packets through the
+// state cache into a recording device that only keeps its statistics.  The packets use a few
+// shaders and materials, and a quarter of them can be instanced.
+
+namespace
+{
+	const int ShaderCount = 4;
+	const int MaterialCount = 32;
+	int Shaders[ShaderCount];
+	int Materials[MaterialCount];
+	int InputLayout;
+	int InstancedVertexShader;
+	int VertexBuffer;
+	int IndexBuffer;
+
+	void BuildScene(size_t packetCount, vector<DrawPacket>& packets, vector<ObjectConstants>& objectConstants)
+	{
+		packets.resize(packetCount);
+		objectConstants.resize(packetCount);
+		for (size_t i = 0; i < packetCount; i++)
+		{
+			DrawPacket& packet = packets[i];
+			packet = {};
+			packet.VertexShader = &Shaders[i % ShaderCount];
+			packet.PixelShader = &Shaders[(i / ShaderCount) % ShaderCount];
+			packet.InputLayout = &InputLayout;
+			packet.VertexBuffer = &VertexBuffer;
+			packet.VertexStride = 32;
+			packet.IndexBuffer = &IndexBuffer;
+			packet.IndexSize = 2;
+			packet.IndexCount = 36;
+			packet.StartIndex = static_cast<unsigned int>((i % 7) * 36);
+			packet.MaterialConstantBuffer = &Materials[(i * 7) % MaterialCount];
+			if (i % 4 == 0)
+			{
+				packet.InstancedVertexShader = &InstancedVertexShader;
+				packet.InstancedInputLayout = &InputLayout;
+			}
+			objectConstants[i] = {};
+			objectConstants[i].World = Matrix::CreateTranslation(0.0f, 0.0f, static_cast<float>((i * 37) % 1000));
+		}
+	}
+}
+
+static void BM_RenderQueueFrame(benchmark::State& state)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	device->SetRecording(false);
+	StateCache stateCache(device);
+	RenderQueue queue(device);
+	vector<DrawPacket> packets;
+	vector<ObjectConstants> objectConstants;
+	BuildScene(static_cast<size_t>(state.range(0)), packets, objectConstants);
+
+	FrameConstants frameConstants = {};
+	for (auto _ : state)
+	{
+		device->Clear();
+		queue.Begin(frameConstants, Matrix(), 1.0f, 1000.0f);
+		for (size_t i = 0; i < packets.size(); i++)
+		{
+			queue.Submit(OpaquePass, packets[i], objectConstants[i]);
+		}
+		queue.Sort();
+		queue.Execute(&stateCache);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.counters["DrawCalls"] = static_cast<double>(queue.GetStatistics().DrawCalls);
+	state.counters["DeviceCalls"] = static_cast<double>(queue.GetStatistics().StateChanges + queue.GetStatistics().DrawCalls);
+}
+BENCHMARK(BM_RenderQueueFrame)->Arg(1000)->Arg(10000)->Arg(100000);
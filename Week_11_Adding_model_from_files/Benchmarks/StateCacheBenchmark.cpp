@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "RecordingRenderDevice.h"
+#include "StateCache.h"
+
+// The cost of the state calls for a stream of draws into a recording device that only keeps its
+// statistics, with and without the state cache in front of it.  Each draw sets its full state,
+// as the render queue does, using a few shaders, materials and meshes, so most calls are
+// redundant.  The argument is the number of draws.
+
+namespace
+{
+	const int ShaderCount = 4;
+	const int MaterialCount = 16;
+	const int MeshCount = 8;
+	int Shaders[ShaderCount];
+	int InputLayout;
+	int Materials[MaterialCount];
+	int VertexBuffers[MeshCount];
+	int IndexBuffers[MeshCount];
+
+	template<typename Target> void SetStateAndDraw(Target& target, size_t i)
+	{
+		// Draws with the same shader come together, as they would once sorted
+		size_t shader = (i * ShaderCount) / 1000 % ShaderCount;
+		target.SetVertexShader(&Shaders[shader]);
+		target.SetPixelShader(&Shaders[shader]);
+		target.SetInputLayout(&InputLayout);
+		target.SetPrimitiveTopology(RenderTriangleList);
+		target.SetVertexBuffer(&VertexBuffers[(i / 4) % MeshCount], 32);
+		target.SetIndexBuffer(&IndexBuffers[(i / 4) % MeshCount], 2);
+		target.SetPixelConstantBuffer(1, &Materials[(i / 16) % MaterialCount]);
+		target.DrawIndexed(36, 0, 0);
+	}
+
+	// Makes the same calls directly on the device, so the cost of the filter can be compared
+	struct DirectTarget
+	{
+		RecordingRenderDevice& Device;
+
+		void SetVertexShader(RenderVertexShader vertexShader) { Device.SetVertexShader(vertexShader); }
+		void SetPixelShader(RenderPixelShader pixelShader) { Device.SetPixelShader(pixelShader); }
+		void SetInputLayout(RenderInputLayout inputLayout) { Device.SetInputLayout(inputLayout); }
+		void SetPrimitiveTopology(RenderTopology topology) { Device.SetPrimitiveTopology(topology); }
+		void SetVertexBuffer(RenderBuffer vertexBuffer, unsigned int stride) { Device.SetVertexBuffer(0, vertexBuffer, stride); }
+		void SetIndexBuffer(RenderBuffer indexBuffer, unsigned int indexSize) { Device.SetIndexBuffer(indexBuffer, indexSize); }
+		void SetPixelConstantBuffer(unsigned int slot, RenderBuffer constantBuffer) { Device.SetPixelConstantBuffer(slot, constantBuffer); }
+		void DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex) { Device.DrawIndexed(indexCount, startIndex, baseVertex); }
+	};
+}
+
+static void BM_StateCacheDraws(benchmark::State& state)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	device->SetRecording(false);
+	StateCache stateCache(device);
+	size_t drawCount = static_cast<size_t>(state.range(0));
+	for (auto _ : state)
+	{
+		device->Clear();
+		stateCache.Invalidate();
+		for (size_t i = 0; i < drawCount; i++)
+		{
+			SetStateAndDraw(stateCache, i);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * drawCount);
+	state.counters["StateCalls"] = static_cast<double>(stateCache.GetFilter().GetIssuedCount()) / static_cast<double>(state.iterations());
+	state.counters["Elided"] = static_cast<double>(stateCache.GetFilter().GetElidedCount()) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_StateCacheDraws)->Arg(1000)->Arg(100000);
+
+static void BM_UnfilteredDraws(benchmark::State& state)
+{
+	RecordingRenderDevice device;
+	device.SetRecording(false);
+	DirectTarget target = { device };
+	size_t drawCount = static_cast<size_t>(state.range(0));
+	for (auto _ : state)
+	{
+		device.Clear();
+		for (size_t i = 0; i < drawCount; i++)
+		{
+			SetStateAndDraw(target, i);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * drawCount);
+}
+BENCHMARK(BM_UnfilteredDraws)->Arg(1000)->Arg(100000);
@@ -0,0 +1,113 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TextureDecoder.h"
+#include "WorkerPool.h"
+
+// Decoding the bitmaps used by the project from memory, so that the file system is not timed.
+// BM_DecodeImage decodes one at a time; the argument picks the bitmap.  BM_DecodeBatch decodes a
+// batch of 48, sixteen of each, across worker pools of increasing size, as DecodeTextures does
+// when a model is loaded.  Its argument is the number of threads doing the work, which is the
+// workers plus the calling thread.
+
+namespace
+{
+	const char * const BitmapNames[] = { "woodbox.bmp", "bihull.bmp", "wings.bmp" };
+	const size_t BitmapCount = sizeof(BitmapNames) / sizeof(BitmapNames[0]);
+
+	const vector<vector<uint8_t>>& GetBitmaps()
+	{
+		static vector<vector<uint8_t>> bitmaps;
+		if (bitmaps.empty())
+		{
+			for (const char * name : BitmapNames)
+			{
+				ifstream file(string(SOURCE_DIRECTORY) + "/" + name, ios::binary);
+				bitmaps.emplace_back(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+			}
+		}
+		return bitmaps;
+	}
+
+	void ThreadCounts(benchmark::internal::Benchmark * benchmark)
+	{
+		unsigned int maximum = max(thread::hardware_concurrency(), 1u);
+		for (unsigned int threadCount = 1; threadCount <= maximum; threadCount *= 2)
+		{
+			benchmark->Arg(threadCount);
+		}
+		if ((maximum & (maximum - 1)) != 0)
+		{
+			benchmark->Arg(maximum);
+		}
+	}
+}
+
+static void BM_DecodeImage(benchmark::State& state)
+{
+	const vector<uint8_t>& bitmap = GetBitmaps()[static_cast<size_t>(state.range(0))];
+	state.SetLabel(BitmapNames[state.range(0)]);
+	DecodedTexture texture;
+	for (auto _ : state)
+	{
+		if (!DecodeImage(bitmap.data(), bitmap.size(), texture))
+		{
+			state.SkipWithError("The bitmap could not be decoded");
+			break;
+		}
+		benchmark::DoNotOptimize(texture.Pixels.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * texture.Pixels.size());
+}
+BENCHMARK(BM_DecodeImage)->DenseRange(0, BitmapCount - 1);
+
+static void BM_DecodeBatch(benchmark::State& state)
+{
+	unsigned int threadCount = static_cast<unsigned int>(state.range(0));
+	unique_ptr<WorkerPool> workerPool;
+	if (threadCount > 1)
+	{
+		workerPool = make_unique<WorkerPool>(threadCount - 1);
+	}
+	const vector<vector<uint8_t>>& bitmaps = GetBitmaps();
+	const size_t batchSize = BitmapCount * 16;
+	vector<DecodedTexture> textures(batchSize);
+	vector<char> decoded(batchSize);
+	auto decode = [&](size_t i)
+		{
+			const vector<uint8_t>& bitmap = bitmaps[i % BitmapCount];
+			decoded[i] = DecodeImage(bitmap.data(), bitmap.size(), textures[i]);
+		};
+	for (auto _ : state)
+	{
+		// Each texture starts empty, as it does when a model is loaded
+		for (DecodedTexture& texture : textures)
+		{
+			vector<uint8_t>().swap(texture.Pixels);
+		}
+		if (workerPool)
+		{
+			workerPool->ParallelFor(batchSize, decode);
+		}
+		else
+		{
+			for (size_t i = 0; i < batchSize; i++)
+			{
+				decode(i);
+			}
+		}
+		benchmark::ClobberMemory();
+	}
+	if (count(decoded.begin(), decoded.end(), 0) != 0)
+	{
+		state.SkipWithError("A bitmap could not be decoded");
+	}
+	state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_DecodeBatch)->Apply(ThreadCounts)->UseRealTime();
@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "TransformStore.h"
+#include "WorkerPool.h"
+
+// Updating every world transformation of a 100k node scene, serially and with worker pools of
+// increasing size, to show how the update scales with the number of cores.  The argument is the
+// number of threads doing the work, which is the workers plus the calling thread.
+
+static void BuildScene(TransformStore& store, size_t nodeCount, vector<TransformHandle>& handles)
+{
+	uint32_t random = 12345;
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		random = random * 1664525 + 1013904223;
+		TransformHandle handle = store.Allocate();
+		size_t groupStart = i - i % 1000;
+		if (i != groupStart)
+		{
+			store.SetParent(handle, handles[groupStart + random % (i - groupStart)]);
+		}
+		store.SetLocalTransform(handle, Matrix::CreateRotationY(static_cast<float>(random % 628) / 100.0f) * Matrix::CreateTranslation(1.0f, 1.0f, 0.5f));
+		handles.push_back(handle);
+	}
+	store.Update();
+}
+
+static void BM_TransformStoreUpdate(benchmark::State& state)
+{
+	const size_t nodeCount = 100000;
+	unsigned int threadCount = static_cast<unsigned int>(state.range(0));
+	unique_ptr<WorkerPool> workerPool;
+	if (threadCount > 1)
+	{
+		workerPool = make_unique<WorkerPool>(threadCount - 1);
+	}
+	TransformStore store;
+	vector<TransformHandle> handles;
+	BuildScene(store, nodeCount, handles);
+
+	// Alternate between two transformations of the first node of each tree so that every
+	// node is dirty on every iteration
+	Matrix moves[2] = { Matrix::CreateTranslation(0.0f, 1.0f, 0.0f), Matrix::CreateTranslation(0.0f, 2.0f, 0.0f) };
+	size_t iteration = 0;
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < nodeCount; i += 1000)
+		{
+			store.SetLocalTransform(handles[i], moves[iteration & 1]);
+		}
+		store.Update(workerPool.get());
+		iteration++;
+	}
+	state.SetItemsProcessed(state.iterations() * nodeCount);
+}
+
+static void ThreadCounts(benchmark::internal::Benchmark * benchmark)
+{
+	unsigned int maximum = max(thread::hardware_concurrency(), 1u);
+	for (unsigned int threadCount = 1; threadCount <= maximum; threadCount *= 2)
+	{
+		benchmark->Arg(threadCount);
+	}
+	if ((maximum & (maximum - 1)) != 0)
+	{
+		benchmark->Arg(maximum);
+	}
+}
+BENCHMARK(BM_TransformStoreUpdate)->Apply(ThreadCounts)->UseRealTime();
@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "GeometricObject.h"
+#include "WorkerPool.h"
+
+// Generating the normals of a bumpy grid of 1024 x 1024 quads, which is two million triangles,
+// serially and with worker pools of increasing size.  The argument is the number of threads doing
+// the work, which is the workers plus the calling thread.  BM_AverageNormals is the scalar
+// averaging that CubeNode used to do, for comparison.
+
+namespace
+{
+	const size_t QuadsAcross = 1024;
+
+	void BuildTerrain(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices)
+	{
+		uint32_t random = 12345;
+		const size_t verticesAcross = QuadsAcross + 1;
+		vertices.resize(verticesAcross * verticesAcross);
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			random = random * 1664525 + 1013904223;
+			vertices[i].Position = Vector3(static_cast<float>(i % verticesAcross), static_cast<float>(random % 1000) / 250.0f, static_cast<float>(i / verticesAcross));
+		}
+		indices.clear();
+		indices.reserve(QuadsAcross * QuadsAcross * 6);
+		for (size_t z = 0; z < QuadsAcross; z++)
+		{
+			for (size_t x = 0; x < QuadsAcross; x++)
+			{
+				const uint32_t corner = static_cast<uint32_t>(z * verticesAcross + x);
+				const uint32_t across = static_cast<uint32_t>(verticesAcross);
+				indices.insert(indices.end(), { corner, corner + across, corner + 1, corner + 1, corner + across, corner + across + 1 });
+			}
+		}
+	}
+
+	void GenerateNormals(benchmark::State& state, NormalWeighting weighting, bool generateTangents)
+	{
+		unsigned int threadCount = static_cast<unsigned int>(state.range(0));
+		unique_ptr<WorkerPool> workerPool;
+		if (threadCount > 1)
+		{
+			workerPool = make_unique<WorkerPool>(threadCount - 1);
+		}
+		vector<ObjectVertexStruct> vertices;
+		vector<uint32_t> indices;
+		BuildTerrain(vertices, indices);
+		// The positions stand in for texture coordinates when tangents are generated
+		const VertexNormalLayout layout = { sizeof(ObjectVertexStruct), offsetof(ObjectVertexStruct, Normal), 0 };
+		vector<Vector4> tangents(generateTangents ? vertices.size() : 0);
+		for (auto _ : state)
+		{
+			GenerateVertexNormals(vertices.data(), vertices.size(), layout, indices.data(), indices.size(), weighting,
+								  generateTangents ? tangents.data() : nullptr, workerPool.get());
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * (indices.size() / 3));
+	}
+
+	void ThreadCounts(benchmark::internal::Benchmark * benchmark)
+	{
+		unsigned int maximum = max(thread::hardware_concurrency(), 1u);
+		for (unsigned int threadCount = 1; threadCount <= maximum; threadCount *= 2)
+		{
+			benchmark->Arg(threadCount);
+		}
+		if ((maximum & (maximum - 1)) != 0)
+		{
+			benchmark->Arg(maximum);
+		}
+	}
+}
+
+static void BM_AverageNormals(benchmark::State& state)
+{
+	vector<ObjectVertexStruct> vertices;
+	vector<uint32_t> indices;
+	BuildTerrain(vertices, indices);
+	vector<int> contributingCounts(vertices.size());
+	for (auto _ : state)
+	{
+		for (ObjectVertexStruct& vertex : vertices)
+		{
+			vertex.Normal = Vector3(0.0f, 0.0f, 0.0f);
+		}
+		fill(contributingCounts.begin(), contributingCounts.end(), 0);
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const Vector3 u = vertices[indices[i + 1]].Position - vertices[indices[i]].Position;
+			const Vector3 v = vertices[indices[i + 2]].Position - vertices[indices[i]].Position;
+			const Vector3 polygonNormal = u.Cross(v);
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				vertices[indices[i + corner]].Normal += polygonNormal;
+				contributingCounts[indices[i + corner]]++;
+			}
+		}
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			if (contributingCounts[i] > 0)
+			{
+				vertices[i].Normal /= static_cast<float>(contributingCounts[i]);
+				vertices[i].Normal.Normalize();
+			}
+		}
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * (indices.size() / 3));
+}
+BENCHMARK(BM_AverageNormals)->UseRealTime();
+
+static void BM_AreaWeightedNormals(benchmark::State& state)
+{
+	GenerateNormals(state, NormalWeightingArea, false);
+}
+BENCHMARK(BM_AreaWeightedNormals)->Apply(ThreadCounts)->UseRealTime();
+
+static void BM_AngleWeightedNormals(benchmark::State& state)
+{
+	GenerateNormals(state, NormalWeightingAngle, false);
+}
+BENCHMARK(BM_AngleWeightedNormals)->Apply(ThreadCounts)->UseRealTime();
+
+static void BM_NormalsAndTangents(benchmark::State& state)
+{
+	GenerateNormals(state, NormalWeightingArea, true);
+}
+BENCHMARK(BM_NormalsAndTangents)->Apply(ThreadCounts)->UseRealTime();
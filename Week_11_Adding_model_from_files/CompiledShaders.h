@@ -0,0 +1,39 @@
+#pragma once
+#include "DirectXCore.h"
+
+// The bytecode of every shader entry point, compiled by the CompileShaders target in
+// DirectX_Base.vcxproj.  Each CompiledShader item in the project produces a header in the
+// CompiledShaders directory holding an array named g_<item name>.
+//
+// When adding an entry point to a shader, add it to the CompiledShader items in the project
+// and to the table below.
+
+#include "CompiledShaders\shader_VS.h"
+#include "CompiledShaders\shader_VSInstanced.h"
+#include "CompiledShaders\shader_VSQuantised.h"
+#include "CompiledShaders\shader_PS.h"
+#include "CompiledShaders\TextureShader_VS.h"
+#include "CompiledShaders\TextureShader_VSInstanced.h"
+#include "CompiledShaders\TextureShader_VSQuantised.h"
+#include "CompiledShaders\TextureShader_PS.h"
+
+struct CompiledShader
+{
+	const wchar_t *		FileName;
+	const char *		EntryPoint;
+	const char *		Profile;
+	const BYTE *		ByteCode;
+	size_t				ByteCodeSize;
+};
+
+static const CompiledShader CompiledShaders[] =
+{
+	{ L"shader.hlsl",			"VS",			"vs_5_0", g_shader_VS,					sizeof(g_shader_VS) },
+	{ L"shader.hlsl",			"VSInstanced",	"vs_5_0", g_shader_VSInstanced,			sizeof(g_shader_VSInstanced) },
+	{ L"shader.hlsl",			"VSQuantised",	"vs_5_0", g_shader_VSQuantised,			sizeof(g_shader_VSQuantised) },
+	{ L"shader.hlsl",			"PS",			"ps_5_0", g_shader_PS,					sizeof(g_shader_PS) },
+	{ L"TextureShader.hlsl",	"VS",			"vs_5_0", g_TextureShader_VS,			sizeof(g_TextureShader_VS) },
+	{ L"TextureShader.hlsl",	"VSInstanced",	"vs_5_0", g_TextureShader_VSInstanced,	sizeof(g_TextureShader_VSInstanced) },
+	{ L"TextureShader.hlsl",	"VSQuantised",	"vs_5_0", g_TextureShader_VSQuantised,	sizeof(g_TextureShader_VSQuantised) },
+	{ L"TextureShader.hlsl",	"PS",			"ps_5_0", g_TextureShader_PS,			sizeof(g_TextureShader_PS) },
+};
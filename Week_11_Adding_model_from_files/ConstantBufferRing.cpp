@@ -0,0 +1,106 @@
+#include "ConstantBufferRing.h"
+
+ConstantBufferRing::ConstantBufferRing(shared_ptr<RenderDevice> device, size_t capacity) :
+	_allocator(capacity, SliceSize)
+{
+	_device = device;
+	_buffer = nullptr;
+	_mappedSize = 0;
+	_nextFenceValue = 1;
+	CreateBuffer(capacity);
+}
+
+ConstantBufferRing::~ConstantBufferRing()
+{
+	_device->ReleaseBuffer(_buffer);
+	for (const Fence& fence : _pendingFences)
+	{
+		_device->ReleaseFence(fence.Handle);
+	}
+	for (RenderFence fence : _freeFences)
+	{
+		_device->ReleaseFence(fence);
+	}
+}
+
+uint8_t * ConstantBufferRing::Map(size_t sliceCount, unsigned int& firstConstant)
+{
+	RetireCompletedFrames();
+
+	size_t size = sliceCount * SliceSize;
+	RingAllocation allocation;
+	if (!_allocator.Allocate(size, allocation))
+	{
+		// More slices than the whole buffer holds.  Grow to the next power of two.
+		size_t capacity = _allocator.GetCapacity() * 2;
+		while (capacity < size)
+		{
+			capacity *= 2;
+		}
+		CreateBuffer(capacity);
+		_allocator.Allocate(size, allocation);
+	}
+
+	RenderMapMode mapMode = RenderMapNoOverwrite;
+	if (allocation.MapMode == RingMapDiscard || _discardNextMap)
+	{
+		mapMode = RenderMapDiscard;
+		_discardNextMap = false;
+	}
+	uint8_t * mappedBuffer = static_cast<uint8_t *>(_device->MapBuffer(_buffer, mapMode));
+	_mappedSize = size;
+	firstConstant = static_cast<unsigned int>(allocation.Offset / 16);
+	return mappedBuffer + allocation.Offset;
+}
+
+void ConstantBufferRing::Unmap()
+{
+	_device->UnmapBuffer(_buffer, _mappedSize);
+	_mappedSize = 0;
+}
+
+void ConstantBufferRing::EndFrame()
+{
+	Fence fence;
+	fence.Value = _nextFenceValue++;
+	if (_freeFences.empty())
+	{
+		fence.Handle = _device->CreateFence();
+	}
+	else
+	{
+		fence.Handle = _freeFences.back();
+		_freeFences.pop_back();
+	}
+	_device->SignalFence(fence.Handle);
+	_pendingFences.push_back(fence);
+	_allocator.EndFrame(fence.Value);
+}
+
+void ConstantBufferRing::CreateBuffer(size_t capacity)
+{
+	RenderBufferDesc bufferDesc = { capacity, RenderConstantBufferBinding, RenderBufferDynamic };
+	// Create the new buffer before releasing the old one so that the state cache
+	// cannot mistake it for the buffer that is currently bound
+	RenderBuffer buffer = _device->CreateBuffer(bufferDesc, nullptr);
+	if (_buffer != nullptr)
+	{
+		_device->ReleaseBuffer(_buffer);
+	}
+	_buffer = buffer;
+	_allocator = RingAllocator(capacity, SliceSize);
+	_discardNextMap = true;
+}
+
+void ConstantBufferRing::RetireCompletedFrames()
+{
+	// Fences complete in the order they were signalled, so stop at the first one that has not
+	uint64_t completedFence = 0;
+	while (!_pendingFences.empty() && _device->IsFenceComplete(_pendingFences.front().Handle))
+	{
+		completedFence = _pendingFences.front().Value;
+		_freeFences.push_back(_pendingFences.front().Handle);
+		_pendingFences.pop_front();
+	}
+	_allocator.Retire(completedFence);
+}
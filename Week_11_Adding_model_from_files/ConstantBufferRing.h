@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "RenderDevice.h"
+#include "RingAllocator.h"
+
+using namespace std;
+
+// One large dynamic constant buffer that is shared by every draw in a frame.  Each draw gets its
+// own 256 byte slice, which is bound at an offset into the buffer.  The slices for a frame are
+// written with a single map.  Normally the buffer is mapped with no-overwrite, since
+// RingAllocator knows which parts the GPU has finished with.  A fence signalled at the end of
+// each frame tells it when that happens.
+//
+// Binding at an offset needs Direct3D 11.1, so check RenderDevice::SupportsConstantBufferOffsets
+// before creating one.
+
+class ConstantBufferRing
+{
+public:
+	// Constant buffer offsets must be a multiple of 16 constants of 16 bytes each
+	static const unsigned int		SliceSize = 256;
+	static const unsigned int		SliceConstantCount = SliceSize / 16;
+
+	ConstantBufferRing(shared_ptr<RenderDevice> device, size_t capacity);
+	~ConstantBufferRing();
+
+	// The buffer and fences belong to the device, so the ring cannot be copied
+	ConstantBufferRing(const ConstantBufferRing&) = delete;
+	ConstantBufferRing& operator=(const ConstantBufferRing&) = delete;
+
+	// Allocates and maps the given number of consecutive slices.  The first slice starts at the
+	// returned pointer, and firstConstant is set to its offset in constants for binding.  If the
+	// slices do not fit in the buffer, a larger buffer is created.
+	uint8_t *						Map(size_t sliceCount, unsigned int& firstConstant);
+	void							Unmap();
+
+	// Closes the frame, so that the slices allocated in it can be reused once the GPU has
+	// finished with them
+	void							EndFrame();
+
+	inline RenderBuffer				GetBuffer() const { return _buffer; }
+	inline const RingAllocator&		GetAllocator() const { return _allocator; }
+
+private:
+	shared_ptr<RenderDevice>		_device;
+	RenderBuffer					_buffer;
+	RingAllocator					_allocator;
+	// Bytes written since the last map
+	size_t							_mappedSize;
+	// A newly created buffer has to be mapped with discard the first time
+	bool							_discardNextMap;
+
+	struct Fence
+	{
+		uint64_t					Value;
+		RenderFence					Handle;
+	};
+	uint64_t						_nextFenceValue;
+	deque<Fence>					_pendingFences;
+	vector<RenderFence>				_freeFences;
+
+	void							CreateBuffer(size_t capacity);
+	void							RetireCompletedFrames();
+};
@@ -1,46 +1,46 @@
-#pragma once
-#include "SceneNode.h"
-#include "DirectXFramework.h"
-
-
-class CubeNode : public SceneNode
-{
-	
-
-public:
-	CubeNode(wstring name) : CubeNode(name, Vector4(0.25f, 0.25f, 0.25f, 1.0f)) {};
-	CubeNode(wstring name, Vector4 ambientColour) : SceneNode(name) { _ambientColour = ambientColour; }
-	
-	bool Initialise();
-	void Render();
-
-
-private:
-
-	ComPtr<ID3D11Device>			_device;
-	ComPtr<ID3D11DeviceContext>		_deviceContext;
-
-	ComPtr<ID3D11Buffer>			_vertexBuffer;
-	ComPtr<ID3D11Buffer>			_indexBuffer;
-
-	ComPtr<ID3DBlob>				_vertexShaderByteCode = nullptr;
-	ComPtr<ID3DBlob>				_pixelShaderByteCode = nullptr;
-	ComPtr<ID3D11VertexShader>		_vertexShader;
-	ComPtr<ID3D11PixelShader>		_pixelShader;
-	ComPtr<ID3D11InputLayout>		_layout;
-	ComPtr<ID3D11Buffer>			_constantBuffer;
-
-
-	Vector4							_ambientColour;
-		
-	
-	void BuildGeometryBuffers();
-	void BuildShaders();
-	void BuildVertexLayout();
-	void BuildConstantBuffer();
-	void GenerateVertexNormals();
-
-
-	
-};
-
+#pragma once
+#include "SceneNode.h"
+#include "DirectXFramework.h"
+
+
+class CubeNode : public SceneNode
+{
+	
+
+public:
+	CubeNode(wstring name) : CubeNode(name, Vector4(0.25f, 0.25f, 0.25f, 1.0f)) {};
+	CubeNode(wstring name, Vector4 ambientColour) : SceneNode(name) { _ambientColour = ambientColour; }
+	
+	bool Initialise();
+	void Render();
+	void Shutdown();
+
+
+private:
+
+	ComPtr<ID3D11Device>			_device;
+	ComPtr<ID3D11DeviceContext>		_deviceContext;
+
+	shared_ptr<Mesh>				_mesh;
+
+	// The shader library hands every cube the same shaders and layouts, and the resource
+	// manager the same material.  Together with the shared mesh, this lets the render queue
+	// draw cubes instanced.
+	ComPtr<ID3D11VertexShader>		_vertexShader;
+	ComPtr<ID3D11VertexShader>		_instancedVertexShader;
+	ComPtr<ID3D11PixelShader>		_pixelShader;
+	ComPtr<ID3D11InputLayout>		_layout;
+	ComPtr<ID3D11InputLayout>		_instancedLayout;
+	shared_ptr<Material>			_material;
+
+
+	Vector4							_ambientColour;
+		
+	
+	void BuildShaders();
+	void BuildVertexLayout();
+
+
+	
+};
+
@@ -0,0 +1,195 @@
+#include "D3D11RenderDevice.h"
+#include <cassert>
+
+// The object constants of each instance are read from vertex buffer slot 1, one element per instance
+const D3D11_INPUT_ELEMENT_DESC InstanceDataDescription[5] =
+{
+	{ "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+	{ "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+	{ "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+	{ "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+	{ "AMBIENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+};
+
+static const D3D11_PRIMITIVE_TOPOLOGY Topologies[] =
+{
+	D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST,
+	D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP,
+	D3D11_PRIMITIVE_TOPOLOGY_LINELIST,
+	D3D11_PRIMITIVE_TOPOLOGY_POINTLIST
+};
+
+static const UINT BindFlags[] =
+{
+	D3D11_BIND_VERTEX_BUFFER,
+	D3D11_BIND_INDEX_BUFFER,
+	D3D11_BIND_CONSTANT_BUFFER
+};
+
+D3D11RenderDevice::D3D11RenderDevice(ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> deviceContext)
+{
+	_device = device;
+	_deviceContext = deviceContext;
+	_deviceContext.As(&_deviceContext1);
+
+	// Binding constant buffers at an offset needs Direct3D 11.1, and mapping them with
+	// no-overwrite needs driver support as well
+	_constantBufferOffsets = false;
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+	if (_deviceContext1 && SUCCEEDED(_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+	{
+		_constantBufferOffsets = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+	}
+}
+
+RenderBuffer D3D11RenderDevice::CreateBuffer(const RenderBufferDesc& desc, const void * initialData)
+{
+	D3D11_BUFFER_DESC bufferDescriptor = { 0 };
+	bufferDescriptor.ByteWidth = static_cast<UINT>(desc.Size);
+	bufferDescriptor.BindFlags = BindFlags[desc.Binding];
+	if (desc.Usage == RenderBufferDynamic)
+	{
+		bufferDescriptor.Usage = D3D11_USAGE_DYNAMIC;
+		bufferDescriptor.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	}
+	else
+	{
+		bufferDescriptor.Usage = D3D11_USAGE_DEFAULT;
+	}
+	D3D11_SUBRESOURCE_DATA initialisationData = { initialData, 0, 0 };
+	ComPtr<ID3D11Buffer> buffer;
+	ThrowIfFailed(_device->CreateBuffer(&bufferDescriptor, initialData ? &initialisationData : nullptr, buffer.GetAddressOf()));
+	// The reference is handed over to the caller along with the handle
+	return buffer.Detach();
+}
+
+void D3D11RenderDevice::ReleaseBuffer(RenderBuffer buffer)
+{
+	if (buffer != nullptr)
+	{
+		static_cast<ID3D11Buffer *>(buffer)->Release();
+	}
+}
+
+void D3D11RenderDevice::UpdateBuffer(RenderBuffer buffer, const void * data, size_t size)
+{
+	// UpdateSubresource without a box reads the whole buffer from data, and a constant buffer
+	// cannot be given a box on feature level 11.0, so only whole updates are allowed
+#ifndef NDEBUG
+	D3D11_BUFFER_DESC bufferDescriptor;
+	static_cast<ID3D11Buffer *>(buffer)->GetDesc(&bufferDescriptor);
+	assert(size == bufferDescriptor.ByteWidth);
+#else
+	(void)size;
+#endif
+	_deviceContext->UpdateSubresource(static_cast<ID3D11Buffer *>(buffer), 0, 0, data, 0, 0);
+}
+
+void * D3D11RenderDevice::MapBuffer(RenderBuffer buffer, RenderMapMode mode)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedBuffer;
+	ThrowIfFailed(_deviceContext->Map(static_cast<ID3D11Buffer *>(buffer), 0, mode == RenderMapNoOverwrite ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer));
+	return mappedBuffer.pData;
+}
+
+void D3D11RenderDevice::UnmapBuffer(RenderBuffer buffer, size_t bytesWritten)
+{
+	_deviceContext->Unmap(static_cast<ID3D11Buffer *>(buffer), 0);
+}
+
+RenderFence D3D11RenderDevice::CreateFence()
+{
+	D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_EVENT, 0 };
+	ComPtr<ID3D11Query> query;
+	ThrowIfFailed(_device->CreateQuery(&queryDesc, query.GetAddressOf()));
+	return query.Detach();
+}
+
+void D3D11RenderDevice::ReleaseFence(RenderFence fence)
+{
+	if (fence != nullptr)
+	{
+		static_cast<ID3D11Query *>(fence)->Release();
+	}
+}
+
+void D3D11RenderDevice::SignalFence(RenderFence fence)
+{
+	_deviceContext->End(static_cast<ID3D11Query *>(fence));
+}
+
+bool D3D11RenderDevice::IsFenceComplete(RenderFence fence)
+{
+	return _deviceContext->GetData(static_cast<ID3D11Query *>(fence), nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+}
+
+void D3D11RenderDevice::SetVertexShader(RenderVertexShader vertexShader)
+{
+	_deviceContext->VSSetShader(static_cast<ID3D11VertexShader *>(vertexShader), 0, 0);
+}
+
+void D3D11RenderDevice::SetPixelShader(RenderPixelShader pixelShader)
+{
+	_deviceContext->PSSetShader(static_cast<ID3D11PixelShader *>(pixelShader), 0, 0);
+}
+
+void D3D11RenderDevice::SetInputLayout(RenderInputLayout inputLayout)
+{
+	_deviceContext->IASetInputLayout(static_cast<ID3D11InputLayout *>(inputLayout));
+}
+
+void D3D11RenderDevice::SetPrimitiveTopology(RenderTopology topology)
+{
+	_deviceContext->IASetPrimitiveTopology(Topologies[topology]);
+}
+
+void D3D11RenderDevice::SetRasteriserState(RenderRasteriserState rasteriserState)
+{
+	_deviceContext->RSSetState(static_cast<ID3D11RasterizerState *>(rasteriserState));
+}
+
+void D3D11RenderDevice::SetVertexBuffer(unsigned int slot, RenderBuffer vertexBuffer, unsigned int stride)
+{
+	ID3D11Buffer * buffer = static_cast<ID3D11Buffer *>(vertexBuffer);
+	UINT offset = 0;
+	_deviceContext->IASetVertexBuffers(slot, 1, &buffer, &stride, &offset);
+}
+
+void D3D11RenderDevice::SetIndexBuffer(RenderBuffer indexBuffer, unsigned int indexSize)
+{
+	_deviceContext->IASetIndexBuffer(static_cast<ID3D11Buffer *>(indexBuffer), indexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
+}
+
+void D3D11RenderDevice::SetVertexConstantBuffer(unsigned int slot, RenderBuffer constantBuffer)
+{
+	ID3D11Buffer * buffer = static_cast<ID3D11Buffer *>(constantBuffer);
+	_deviceContext->VSSetConstantBuffers(slot, 1, &buffer);
+}
+
+void D3D11RenderDevice::SetVertexConstantBufferRange(unsigned int slot, RenderBuffer constantBuffer, unsigned int firstConstant, unsigned int constantCount)
+{
+	ID3D11Buffer * buffer = static_cast<ID3D11Buffer *>(constantBuffer);
+	_deviceContext1->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+}
+
+void D3D11RenderDevice::SetPixelConstantBuffer(unsigned int slot, RenderBuffer constantBuffer)
+{
+	ID3D11Buffer * buffer = static_cast<ID3D11Buffer *>(constantBuffer);
+	_deviceContext->PSSetConstantBuffers(slot, 1, &buffer);
+}
+
+void D3D11RenderDevice::SetPixelShaderResource(unsigned int slot, RenderShaderResource shaderResource)
+{
+	ID3D11ShaderResourceView * view = static_cast<ID3D11ShaderResourceView *>(shaderResource);
+	_deviceContext->PSSetShaderResources(slot, 1, &view);
+}
+
+void D3D11RenderDevice::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+	_deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void D3D11RenderDevice::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance)
+{
+	_deviceContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "core.h"
+#include "DirectXCore.h"
+#include "RenderDevice.h"
+
+// The instanced vertex shaders (VSInstanced in shader.hlsl and TextureShader.hlsl) read the
+// ObjectConstants of each instance from the second vertex stream, which the render queue fills.
+// These input elements describe it, and are appended to the per-vertex elements when creating
+// the input layout for an instanced vertex shader.
+extern const D3D11_INPUT_ELEMENT_DESC InstanceDataDescription[5];
+
+// Passes the calls on to a Direct3D 11 device and its immediate context.  The handles are the
+// Direct3D interface pointers.  Buffers and fences created here hold one reference, which is
+// released by ReleaseBuffer and ReleaseFence.
+
+class D3D11RenderDevice : public RenderDevice
+{
+public:
+	D3D11RenderDevice(ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> deviceContext);
+
+	RenderBuffer				CreateBuffer(const RenderBufferDesc& desc, const void * initialData);
+	void						ReleaseBuffer(RenderBuffer buffer);
+	void						UpdateBuffer(RenderBuffer buffer, const void * data, size_t size);
+	void *						MapBuffer(RenderBuffer buffer, RenderMapMode mode);
+	void						UnmapBuffer(RenderBuffer buffer, size_t bytesWritten);
+
+	inline bool					SupportsConstantBufferOffsets() const { return _constantBufferOffsets; }
+
+	RenderFence					CreateFence();
+	void						ReleaseFence(RenderFence fence);
+	void						SignalFence(RenderFence fence);
+	bool						IsFenceComplete(RenderFence fence);
+
+	void						SetVertexShader(RenderVertexShader vertexShader);
+	void						SetPixelShader(RenderPixelShader pixelShader);
+	void						SetInputLayout(RenderInputLayout inputLayout);
+	void						SetPrimitiveTopology(RenderTopology topology);
+	void						SetRasteriserState(RenderRasteriserState rasteriserState);
+	void						SetVertexBuffer(unsigned int slot, RenderBuffer vertexBuffer, unsigned int stride);
+	void						SetIndexBuffer(RenderBuffer indexBuffer, unsigned int indexSize);
+	void						SetVertexConstantBuffer(unsigned int slot, RenderBuffer constantBuffer);
+	void						SetVertexConstantBufferRange(unsigned int slot, RenderBuffer constantBuffer, unsigned int firstConstant, unsigned int constantCount);
+	void						SetPixelConstantBuffer(unsigned int slot, RenderBuffer constantBuffer);
+	void						SetPixelShaderResource(unsigned int slot, RenderShaderResource shaderResource);
+
+	void						DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex);
+	void						DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance);
+
+private:
+	ComPtr<ID3D11Device>		_device;
+	ComPtr<ID3D11DeviceContext>	_deviceContext;
+	// Null if the runtime does not support Direct3D 11.1
+	ComPtr<ID3D11DeviceContext1>	_deviceContext1;
+	bool						_constantBufferOffsets;
+};
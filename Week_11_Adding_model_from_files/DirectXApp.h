@@ -1,16 +1,24 @@
-#pragma once
-#include "DirectXFramework.h"
-
-class DirectXApp : public DirectXFramework
-{
-public:
-	void CreateSceneGraph();
-	void UpdateSceneGraph();
-	float _rotationAngle;
-	float _yOffset;
-	bool _isGoingUp;
-	float shoulderOffsetX;
-	float shoulderOffsetY;
-	float shoulderOffsetZ;
-
-};
+#pragma once
+#include "DirectXFramework.h"
+
+class DirectXApp : public DirectXFramework
+{
+public:
+	void CreateSceneGraph();
+	void UpdateSceneGraph();
+	float _rotationAngle;
+	float _yOffset;
+	bool _isGoingUp;
+	float shoulderOffsetX;
+	float shoulderOffsetY;
+	float shoulderOffsetZ;
+
+private:
+	// Handles to the nodes that are animated, looked up once when the scene graph is created
+	SceneNodeHandle _leftShoulderHandle;
+	SceneNodeHandle _leftArmHandle;
+	SceneNodeHandle _rightShoulderHandle;
+	SceneNodeHandle _rightArmHandle;
+	SceneNodeHandle _teapotHandle;
+
+};
@@ -1,14 +1,14 @@
-#pragma once
-#include <d3d11.h>
-#include <d3dcompiler.h>
-#include <DirectXMath.h>
-#include "SimpleMath.h"
-#include <DirectXColors.h>
-#include <wrl.h>
-
-using namespace DirectX;
-
-using namespace SimpleMath;
-
-using Microsoft::WRL::ComPtr;
-
+#pragma once
+#include <d3d11_1.h>
+#include <d3dcompiler.h>
+#include <DirectXMath.h>
+#include "SimpleMath.h"
+#include <DirectXColors.h>
+#include <wrl.h>
+
+using namespace DirectX;
+
+using namespace SimpleMath;
+
+using Microsoft::WRL::ComPtr;
+
@@ -1,264 +1,307 @@
-#include "DirectXFramework.h"
-
-// DirectX libraries that are needed
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "d3dcompiler.lib")
-
-DirectXFramework * _dxFramework = nullptr;
-
-DirectXFramework::DirectXFramework() : DirectXFramework(800, 600)
-{
-}
-
-DirectXFramework::DirectXFramework(unsigned int width, unsigned int height) : Framework(width, height)
-{
-	_dxFramework = this;
-
-	// Set default background colour
-	_backgroundColour[0] = 0.0f;
-	_backgroundColour[1] = 0.0f;
-	_backgroundColour[2] = 0.0f;
-	_backgroundColour[3] = 0.0f;
-
-	// Initialise vectors used to create camera.  We will move these
-	// to a separate Camera class later
-	
-
-	_eyePosition = Vector3(0.0f, 40.0f, -110.0f);
-	_focalPointPosition = Vector3(0.0f, 20.0f, 0.0f);
-	_upVector = Vector3(0.0f, 1.0f, 0.0f);
-
-
-	_directionalLightVector = Vector4(-1.0f, -1.0f, 1.0f, 0.0f);
-	_directionalLightColour = Vector4(1, 1, 1, 1);
-
-	_secondDirectionalLightVector = Vector4(1.0f, -1.0f, 1.0f, 0.0f);
-	_secondDirectionalLightColour = Vector4(0.40f, 0.40f, 0.40f, 0.0f);
-
-}
-
-void DirectXFramework::SetCameraPosition(Vector3 cameraPosition)
-{
-	_eyePosition = cameraPosition;
-	_viewTransformation = XMMatrixLookAtLH(_eyePosition, _focalPointPosition, _upVector);
-}
-
-void DirectXFramework::SetCameraFocalPoint(Vector3 cameraFocalPoint)
-{
-	_focalPointPosition = cameraFocalPoint;
-	_viewTransformation = XMMatrixLookAtLH(_eyePosition, _focalPointPosition, _upVector);
-}
-
-void DirectXFramework::SetCameraUpVector(Vector3 cameraUpVector)
-{
-	_upVector = cameraUpVector;
-	_viewTransformation = XMMatrixLookAtLH(_eyePosition, _focalPointPosition, _upVector);
-}
-
-DirectXFramework * DirectXFramework::GetDXFramework()
-{
-	return _dxFramework;
-}
-
-const Matrix& DirectXFramework::GetViewTransformation() const
-{
-	return _viewTransformation;
-}
-
-const Matrix& DirectXFramework::GetProjectionTransformation() const
-{
-	return _projectionTransformation;
-}
-
-void DirectXFramework::SetBackgroundColour(Vector4 backgroundColour)
-{
-	_backgroundColour[0] = backgroundColour.x;
-	_backgroundColour[1] = backgroundColour.y;
-	_backgroundColour[2] = backgroundColour.z;
-	_backgroundColour[3] = backgroundColour.w;
-}
-
-void DirectXFramework::CreateSceneGraph()
-{
-}
-
-void DirectXFramework::UpdateSceneGraph()
-{
-}
-
-bool DirectXFramework::Initialise()
-{
-	// The call to CoInitializeEx is needed if we are using
-	// textures since the WIC library used requires it, so we
-	// take care of initialising it here
-	if FAILED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED))
-	{
-		return false;
-	}
-	if (!GetDeviceAndSwapChain())
-	{
-		return false;
-	}
-	OnResize(SIZE_RESTORED);
-
-	_sceneGraph = make_shared<SceneGraph>();
-	_resourceManager = make_shared<ResourceManager>();
-	CreateSceneGraph();
-	return _sceneGraph->Initialise();
-}
-
-void DirectXFramework::Shutdown()
-{
-	// Required because we called CoInitialize above
-	_sceneGraph->Shutdown();
-	_resourceManager->ReleaseMesh(L"airplane.x");
-	CoUninitialize();
-}
-
-void DirectXFramework::Update()
-{
-	// Do any updates to the scene graph nodes
-	UpdateSceneGraph();
-	// Now apply any updates that have been made to world transformations
-	// to all the nodes
-	Matrix identity;
-	_sceneGraph->Update(identity);
-}
-
-void DirectXFramework::Render()
-{
-	// Clear the render target and the depth stencil view
-	_deviceContext->ClearRenderTargetView(_renderTargetView.Get(), _backgroundColour);
-	_deviceContext->ClearDepthStencilView(_depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	// Now recurse through the scene graph, rendering each object
-	_sceneGraph->Render();
-	// Now display the scene
-	ThrowIfFailed(_swapChain->Present(0, 0));
-}
-
-void DirectXFramework::OnResize(WPARAM wParam)
-{
-	if (wParam == SIZE_MINIMIZED)
-	{
-		return;
-	}
-
-	// Update view and projection matrices to allow for the window size change
-	_viewTransformation = XMMatrixLookAtLH(_eyePosition, _focalPointPosition, _upVector);
-	_projectionTransformation = XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)GetWindowWidth() / GetWindowHeight(), 1.0f, 10000.0f);
-		
-
-	// This will free any existing render and depth views (which
-	// would be the case if the window was being resized)
-	_renderTargetView = nullptr;
-	_depthStencilView = nullptr;
-	_depthStencilBuffer = nullptr;
-
-	ThrowIfFailed(_swapChain->ResizeBuffers(1, GetWindowWidth(), GetWindowHeight(), DXGI_FORMAT_R8G8B8A8_UNORM, 0));
-
-	// Create a drawing surface for DirectX to render to
-	ComPtr<ID3D11Texture2D> backBuffer;
-	ThrowIfFailed(_swapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer)));
-	ThrowIfFailed(_device->CreateRenderTargetView(backBuffer.Get(), NULL, _renderTargetView.GetAddressOf()));
-	
-	// The depth buffer is used by DirectX to ensure
-	// that pixels of closer objects are drawn over pixels of more
-	// distant objects.
-
-	// First, we need to create a texture (bitmap) for the depth buffer
-	D3D11_TEXTURE2D_DESC depthBufferTexture = { 0 };
-	depthBufferTexture.Width = GetWindowWidth();
-	depthBufferTexture.Height = GetWindowHeight();
-	depthBufferTexture.ArraySize = 1;
-	depthBufferTexture.MipLevels = 1;
-	depthBufferTexture.SampleDesc.Count = 4;
-	depthBufferTexture.Format = DXGI_FORMAT_D32_FLOAT;
-	depthBufferTexture.Usage = D3D11_USAGE_DEFAULT;
-	depthBufferTexture.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-
-	// Create the depth buffer.  
-	ComPtr<ID3D11Texture2D> depthBuffer;
-	ThrowIfFailed(_device->CreateTexture2D(&depthBufferTexture, NULL, depthBuffer.GetAddressOf()));
-	ThrowIfFailed(_device->CreateDepthStencilView(depthBuffer.Get(), 0, _depthStencilView.GetAddressOf()));
-
-	// Bind the render target view buffer and the depth stencil view buffer to the output-merger stage
-	// of the pipeline. 
-	_deviceContext->OMSetRenderTargets(1, _renderTargetView.GetAddressOf(), _depthStencilView.Get());
-
-	// Specify a viewport of the required size
-	D3D11_VIEWPORT viewPort = { 0 };
-	viewPort.Width = static_cast<float>(GetWindowWidth());
-	viewPort.Height = static_cast<float>(GetWindowHeight());
-	viewPort.MinDepth = 0.0f;
-	viewPort.MaxDepth = 1.0f;
-	viewPort.TopLeftX = 0;
-	viewPort.TopLeftY = 0;
-	_deviceContext->RSSetViewports(1, &viewPort);
-}
-
-bool DirectXFramework::GetDeviceAndSwapChain()
-{
-	UINT createDeviceFlags = 0;
-
-	// We are going to only accept a hardware driver or a WARP
-	// driver
-	D3D_DRIVER_TYPE driverTypes[] =
-	{
-		D3D_DRIVER_TYPE_HARDWARE,
-		D3D_DRIVER_TYPE_WARP
-	};
-	unsigned int totalDriverTypes = ARRAYSIZE(driverTypes);
-
-	D3D_FEATURE_LEVEL featureLevels[] =
-	{
-		D3D_FEATURE_LEVEL_11_0
-	};
-	unsigned int totalFeatureLevels = ARRAYSIZE(featureLevels);
-
-	DXGI_SWAP_CHAIN_DESC swapChainDesc = { 0 };
-	swapChainDesc.BufferCount = 1;
-	swapChainDesc.BufferDesc.Width = GetWindowWidth();
-	swapChainDesc.BufferDesc.Height = GetWindowHeight();
-	swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	// Set the refresh rate to 0 and let DXGI determine the best option (refer to DXGI best practices)
-	swapChainDesc.BufferDesc.RefreshRate.Numerator = 0;
-	swapChainDesc.BufferDesc.RefreshRate.Denominator = 0;
-	swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	swapChainDesc.OutputWindow = GetHWnd();
-	// Start out windowed
-	swapChainDesc.Windowed = true;
-	// Enable multi-sampling to give smoother lines (set to 1 if performance becomes an issue)
-	swapChainDesc.SampleDesc.Count = 4;
-	swapChainDesc.SampleDesc.Quality = 0;
-
-	// Loop through the driver types to determine which one is available to us
-	D3D_DRIVER_TYPE driverType = D3D_DRIVER_TYPE_UNKNOWN;
-
-	for (unsigned int driver = 0; driver < totalDriverTypes && driverType == D3D_DRIVER_TYPE_UNKNOWN; driver++)
-	{
-		if (SUCCEEDED(D3D11CreateDeviceAndSwapChain(0,
-			driverTypes[driver],
-			0,
-			createDeviceFlags,
-			featureLevels,
-			totalFeatureLevels,
-			D3D11_SDK_VERSION,
-			&swapChainDesc,
-			_swapChain.GetAddressOf(),
-			_device.GetAddressOf(),
-			0,
-			_deviceContext.GetAddressOf()
-		)))
-
-		{
-			driverType = driverTypes[driver];
-		}
-	}
-	if (driverType == D3D_DRIVER_TYPE_UNKNOWN)
-	{
-		// Unable to find a suitable device driver
-		return false;
-	}
-	return true;
-}
-
+#include "DirectXFramework.h"
+
+// DirectX libraries that are needed
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+
+DirectXFramework * _dxFramework = nullptr;
+
+const float NearClippingPlane = 1.0f;
+const float FarClippingPlane = 10000.0f;
+// The screen-space error, in pixels, allowed for a level of detail at a quality bias of 1
+const float LodPixelError = 1.0f;
+
+DirectXFramework::DirectXFramework() : DirectXFramework(800, 600)
+{
+}
+
+DirectXFramework::DirectXFramework(unsigned int width, unsigned int height) : Framework(width, height)
+{
+	_dxFramework = this;
+
+	// Scene nodes allocate their transforms from the store when they are
+	// constructed, so it must exist before any nodes are created
+	_transformStore = make_shared<TransformStore>();
+	_sceneNodeRegistry = make_shared<SceneNodeRegistry>();
+	_workerPool = make_shared<WorkerPool>();
+	_parallelUpdate = true;
+	_lodQualityBias = 1.0f;
+
+	// Set default background colour
+	_backgroundColour[0] = 0.0f;
+	_backgroundColour[1] = 0.0f;
+	_backgroundColour[2] = 0.0f;
+	_backgroundColour[3] = 0.0f;
+
+	// Initialise vectors used to create camera.  We will move these
+	// to a separate Camera class later
+	
+
+	_eyePosition = Vector3(0.0f, 40.0f, -110.0f);
+	_focalPointPosition = Vector3(0.0f, 20.0f, 0.0f);
+	_upVector = Vector3(0.0f, 1.0f, 0.0f);
+
+
+	_directionalLightVector = Vector4(-1.0f, -1.0f, 1.0f, 0.0f);
+	_directionalLightColour = Vector4(Colors::Linen);
+
+	_secondDirectionalLightVector = Vector4(1.0f, -1.0f, 1.0f, 0.0f);
+	_secondDirectionalLightColour = Vector4(0.40f, 0.40f, 0.40f, 0.0f);
+
+}
+
+void DirectXFramework::SetCameraPosition(Vector3 cameraPosition)
+{
+	_eyePosition = cameraPosition;
+	_viewTransformation = XMMatrixLookAtLH(_eyePosition, _focalPointPosition, _upVector);
+}
+
+void DirectXFramework::SetCameraFocalPoint(Vector3 cameraFocalPoint)
+{
+	_focalPointPosition = cameraFocalPoint;
+	_viewTransformation = XMMatrixLookAtLH(_eyePosition, _focalPointPosition, _upVector);
+}
+
+void DirectXFramework::SetCameraUpVector(Vector3 cameraUpVector)
+{
+	_upVector = cameraUpVector;
+	_viewTransformation = XMMatrixLookAtLH(_eyePosition, _focalPointPosition, _upVector);
+}
+
+DirectXFramework * DirectXFramework::GetDXFramework()
+{
+	return _dxFramework;
+}
+
+const Matrix& DirectXFramework::GetViewTransformation() const
+{
+	return _viewTransformation;
+}
+
+const Matrix& DirectXFramework::GetProjectionTransformation() const
+{
+	return _projectionTransformation;
+}
+
+float DirectXFramework::GetAllowedLodError(float distance)
+{
+	// _22 of the projection is the cotangent of half the vertical field of view, so this is how
+	// many pixels a unit at a distance of one covers
+	float pixelsPerUnit = 0.5f * GetWindowHeight() * _projectionTransformation._22;
+	if (pixelsPerUnit <= 0.0f)
+	{
+		return 0.0f;
+	}
+	return LodPixelError * _lodQualityBias * distance / pixelsPerUnit;
+}
+
+void DirectXFramework::SetBackgroundColour(Vector4 backgroundColour)
+{
+	_backgroundColour[0] = backgroundColour.x;
+	_backgroundColour[1] = backgroundColour.y;
+	_backgroundColour[2] = backgroundColour.z;
+	_backgroundColour[3] = backgroundColour.w;
+}
+
+void DirectXFramework::CreateSceneGraph()
+{
+}
+
+void DirectXFramework::UpdateSceneGraph()
+{
+}
+
+bool DirectXFramework::Initialise()
+{
+	// The call to CoInitializeEx is needed if we are using
+	// textures since the WIC library used requires it, so we
+	// take care of initialising it here
+	if FAILED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED))
+	{
+		return false;
+	}
+	if (!GetDeviceAndSwapChain())
+	{
+		return false;
+	}
+	OnResize(SIZE_RESTORED);
+	_renderDevice = make_shared<D3D11RenderDevice>(_device, _deviceContext);
+	_stateCache = make_shared<StateCache>(_renderDevice);
+	_renderQueue = make_shared<RenderQueue>(_renderDevice);
+
+	_sceneGraph = make_shared<SceneGraph>();
+	_resourceManager = make_shared<ResourceManager>();
+	CreateSceneGraph();
+	return _sceneGraph->Initialise();
+}
+
+void DirectXFramework::Shutdown()
+{
+	// Required because we called CoInitialize above
+	_sceneGraph->Shutdown();
+	_resourceManager->ReleaseMesh(L"airplane.x");
+	CoUninitialize();
+}
+
+void DirectXFramework::Update()
+{
+	// Finish off any models that have been loading in the background
+	_resourceManager->Update();
+	// Do any updates to the scene graph nodes
+	UpdateSceneGraph();
+	// Now apply any updates that have been made to world transformations
+	// to all the nodes
+	_transformStore->Update(_parallelUpdate ? _workerPool.get() : nullptr);
+}
+
+void DirectXFramework::Render()
+{
+	// Clear the render target and the depth stencil view
+	_deviceContext->ClearRenderTargetView(_renderTargetView.Get(), _backgroundColour);
+	_deviceContext->ClearDepthStencilView(_depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	// Extract the view frustum so that objects that cannot be seen are culled
+	_viewFrustum.Extract(_viewTransformation * _projectionTransformation);
+	_cullingStatistics.VisibleCount = 0;
+	_cullingStatistics.CulledCount = 0;
+	// The camera and lighting are the same for everything drawn this frame
+	FrameConstants frameConstants;
+	frameConstants.ViewProjection = _viewTransformation * _projectionTransformation;
+	frameConstants.DirectionalLightColour = _directionalLightColour;
+	frameConstants.DirectionalLightVector = _directionalLightVector;
+	frameConstants.CameraPosition = Vector4(_eyePosition.x, _eyePosition.y, _eyePosition.z, 1.0f);
+	// Now recurse through the scene graph.  Each object adds its draw packets to the
+	// render queue, which is then sorted to minimise state changes and drawn
+	_renderQueue->Begin(frameConstants, _viewTransformation, NearClippingPlane, FarClippingPlane);
+	_sceneGraph->Render();
+	_renderQueue->Sort();
+	_renderQueue->Execute(_stateCache.get());
+	// Now display the scene
+	ThrowIfFailed(_swapChain->Present(0, 0));
+}
+
+void DirectXFramework::OnResize(WPARAM wParam)
+{
+	if (wParam == SIZE_MINIMIZED)
+	{
+		return;
+	}
+
+	// Update view and projection matrices to allow for the window size change
+	_viewTransformation = XMMatrixLookAtLH(_eyePosition, _focalPointPosition, _upVector);
+	_projectionTransformation = XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)GetWindowWidth() / GetWindowHeight(), NearClippingPlane, FarClippingPlane);
+		
+
+	// This will free any existing render and depth views (which
+	// would be the case if the window was being resized)
+	_renderTargetView = nullptr;
+	_depthStencilView = nullptr;
+	_depthStencilBuffer = nullptr;
+
+	ThrowIfFailed(_swapChain->ResizeBuffers(1, GetWindowWidth(), GetWindowHeight(), DXGI_FORMAT_R8G8B8A8_UNORM, 0));
+
+	// Create a drawing surface for DirectX to render to
+	ComPtr<ID3D11Texture2D> backBuffer;
+	ThrowIfFailed(_swapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer)));
+	ThrowIfFailed(_device->CreateRenderTargetView(backBuffer.Get(), NULL, _renderTargetView.GetAddressOf()));
+	
+	// The depth buffer is used by DirectX to ensure
+	// that pixels of closer objects are drawn over pixels of more
+	// distant objects.
+
+	// First, we need to create a texture (bitmap) for the depth buffer
+	D3D11_TEXTURE2D_DESC depthBufferTexture = { 0 };
+	depthBufferTexture.Width = GetWindowWidth();
+	depthBufferTexture.Height = GetWindowHeight();
+	depthBufferTexture.ArraySize = 1;
+	depthBufferTexture.MipLevels = 1;
+	depthBufferTexture.SampleDesc.Count = 4;
+	depthBufferTexture.Format = DXGI_FORMAT_D32_FLOAT;
+	depthBufferTexture.Usage = D3D11_USAGE_DEFAULT;
+	depthBufferTexture.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+
+	// Create the depth buffer.  
+	ComPtr<ID3D11Texture2D> depthBuffer;
+	ThrowIfFailed(_device->CreateTexture2D(&depthBufferTexture, NULL, depthBuffer.GetAddressOf()));
+	ThrowIfFailed(_device->CreateDepthStencilView(depthBuffer.Get(), 0, _depthStencilView.GetAddressOf()));
+
+	// Bind the render target view buffer and the depth stencil view buffer to the output-merger stage
+	// of the pipeline. 
+	_deviceContext->OMSetRenderTargets(1, _renderTargetView.GetAddressOf(), _depthStencilView.Get());
+
+	// Specify a viewport of the required size
+	D3D11_VIEWPORT viewPort = { 0 };
+	viewPort.Width = static_cast<float>(GetWindowWidth());
+	viewPort.Height = static_cast<float>(GetWindowHeight());
+	viewPort.MinDepth = 0.0f;
+	viewPort.MaxDepth = 1.0f;
+	viewPort.TopLeftX = 0;
+	viewPort.TopLeftY = 0;
+	_deviceContext->RSSetViewports(1, &viewPort);
+}
+
+bool DirectXFramework::GetDeviceAndSwapChain()
+{
+	UINT createDeviceFlags = 0;
+
+	// We are going to only accept a hardware driver or a WARP
+	// driver
+	D3D_DRIVER_TYPE driverTypes[] =
+	{
+		D3D_DRIVER_TYPE_HARDWARE,
+		D3D_DRIVER_TYPE_WARP
+	};
+	unsigned int totalDriverTypes = ARRAYSIZE(driverTypes);
+
+	D3D_FEATURE_LEVEL featureLevels[] =
+	{
+		D3D_FEATURE_LEVEL_11_0
+	};
+	unsigned int totalFeatureLevels = ARRAYSIZE(featureLevels);
+
+	DXGI_SWAP_CHAIN_DESC swapChainDesc = { 0 };
+	swapChainDesc.BufferCount = 1;
+	swapChainDesc.BufferDesc.Width = GetWindowWidth();
+	swapChainDesc.BufferDesc.Height = GetWindowHeight();
+	swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	// Set the refresh rate to 0 and let DXGI determine the best option (refer to DXGI best practices)
+	swapChainDesc.BufferDesc.RefreshRate.Numerator = 0;
+	swapChainDesc.BufferDesc.RefreshRate.Denominator = 0;
+	swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+	swapChainDesc.OutputWindow = GetHWnd();
+	// Start out windowed
+	swapChainDesc.Windowed = true;
+	// Enable multi-sampling to give smoother lines (set to 1 if performance becomes an issue)
+	swapChainDesc.SampleDesc.Count = 4;
+	swapChainDesc.SampleDesc.Quality = 0;
+
+	// Loop through the driver types to determine which one is available to us
+	D3D_DRIVER_TYPE driverType = D3D_DRIVER_TYPE_UNKNOWN;
+
+	for (unsigned int driver = 0; driver < totalDriverTypes && driverType == D3D_DRIVER_TYPE_UNKNOWN; driver++)
+	{
+		if (SUCCEEDED(D3D11CreateDeviceAndSwapChain(0,
+			driverTypes[driver],
+			0,
+			createDeviceFlags,
+			featureLevels,
+			totalFeatureLevels,
+			D3D11_SDK_VERSION,
+			&swapChainDesc,
+			_swapChain.GetAddressOf(),
+			_device.GetAddressOf(),
+			0,
+			_deviceContext.GetAddressOf()
+		)))
+
+		{
+			driverType = driverTypes[driver];
+		}
+	}
+	if (driverType == D3D_DRIVER_TYPE_UNKNOWN)
+	{
+		// Unable to find a suitable device driver
+		return false;
+	}
+	return true;
+}
+
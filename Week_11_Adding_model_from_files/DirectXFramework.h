@@ -1,77 +1,114 @@
-#pragma once
-#include <vector>
-#include "Framework.h"
-#include "DirectXCore.h"
-#include "SceneGraph.h"
-#include "ResourceManager.h"
-
-class DirectXFramework : public Framework
-{
-public:
-	DirectXFramework();
-	DirectXFramework(unsigned int width, unsigned int height);
-
-	virtual void CreateSceneGraph();
-	virtual void UpdateSceneGraph();
-
-	bool Initialise();
-	void Update();
-	void Render();
-	void OnResize(WPARAM wParam);
-	void Shutdown();
-
-	static DirectXFramework *			GetDXFramework();
-
-	inline SceneGraphPointer			GetSceneGraph() { return _sceneGraph; }
-	inline shared_ptr<ResourceManager>	GetResourceManager() { return _resourceManager; }
-	inline ComPtr<ID3D11Device>			GetDevice() { return _device; }
-	inline ComPtr<ID3D11DeviceContext>	GetDeviceContext() { return _deviceContext; }
-	inline Vector3						GetEyePosition() { return _eyePosition; }
-
-	inline Vector4						GetLightDirection() { return _directionalLightVector; }
-	inline Vector4						GetLightColour() { return _directionalLightColour; }
-	inline Vector4						GetSecondLightDirection() { return _secondDirectionalLightVector; }
-	inline Vector4						GetSecondLightColour() { return _secondDirectionalLightColour; }
-
-
-	void SetCameraPosition(Vector3 cameraPosition);
-	void SetCameraFocalPoint(Vector3 cameraFocalPoint);
-	void SetCameraUpVector(Vector3 cameraUpVector);
-
-	const Matrix&						GetViewTransformation() const;
-	const Matrix&						GetProjectionTransformation() const;
-
-	void								SetBackgroundColour(Vector4 backgroundColour);
-
-private:
-	ComPtr<ID3D11Device>				_device;
-	ComPtr<ID3D11DeviceContext>			_deviceContext;
-	ComPtr<IDXGISwapChain>				_swapChain;
-	ComPtr<ID3D11Texture2D>				_depthStencilBuffer;
-	ComPtr<ID3D11RenderTargetView>		_renderTargetView;
-	ComPtr<ID3D11DepthStencilView>		_depthStencilView;
-
-	D3D11_VIEWPORT						_screenViewport{ 0 };
-
-	Vector3								_eyePosition;
-	Vector3								_focalPointPosition;
-	Vector3								_upVector;
-
-	Vector4								_directionalLightVector;
-	Vector4								_secondDirectionalLightVector;
-	Vector4								_directionalLightColour;
-	Vector4								_secondDirectionalLightColour;
-
-
-	Matrix								_viewTransformation;
-	Matrix								_projectionTransformation;
-
-	SceneGraphPointer					_sceneGraph;
-	shared_ptr<ResourceManager>			_resourceManager;
-
-
-	float							    _backgroundColour[4];
-
-	bool GetDeviceAndSwapChain();
-};
-
+#pragma once
+#include <vector>
+#include "Framework.h"
+#include "DirectXCore.h"
+#include "TransformStore.h"
+#include "SceneGraph.h"
+#include "ResourceManager.h"
+#include "ViewFrustum.h"
+#include "D3D11RenderDevice.h"
+#include "RenderQueue.h"
+
+class DirectXFramework : public Framework
+{
+public:
+	DirectXFramework();
+	DirectXFramework(unsigned int width, unsigned int height);
+
+	virtual void CreateSceneGraph();
+	virtual void UpdateSceneGraph();
+
+	bool Initialise();
+	void Update();
+	void Render();
+	void OnResize(WPARAM wParam);
+	void Shutdown();
+
+	static DirectXFramework *			GetDXFramework();
+
+	inline SceneGraphPointer			GetSceneGraph() { return _sceneGraph; }
+	inline shared_ptr<TransformStore>	GetTransformStore() { return _transformStore; }
+	inline shared_ptr<SceneNodeRegistry> GetSceneNodeRegistry() { return _sceneNodeRegistry; }
+	inline shared_ptr<WorkerPool>		GetWorkerPool() { return _workerPool; }
+
+	// When enabled, the world transformations are updated across the worker pool
+	inline void							SetParallelUpdate(bool parallelUpdate) { _parallelUpdate = parallelUpdate; }
+	inline shared_ptr<RenderDevice>		GetRenderDevice() { return _renderDevice; }
+	inline shared_ptr<RenderQueue>		GetRenderQueue() { return _renderQueue; }
+	inline shared_ptr<StateCache>		GetStateCache() { return _stateCache; }
+	inline shared_ptr<ResourceManager>	GetResourceManager() { return _resourceManager; }
+	inline ComPtr<ID3D11Device>			GetDevice() { return _device; }
+	inline ComPtr<ID3D11DeviceContext>	GetDeviceContext() { return _deviceContext; }
+	inline Vector3						GetEyePosition() { return _eyePosition; }
+
+	inline Vector4						GetLightDirection() { return _directionalLightVector; }
+	inline Vector4						GetLightColour() { return _directionalLightColour; }
+	inline Vector4						GetSecondLightDirection() { return _secondDirectionalLightVector; }
+	inline Vector4						GetSecondLightColour() { return _secondDirectionalLightColour; }
+
+
+	void SetCameraPosition(Vector3 cameraPosition);
+	void SetCameraFocalPoint(Vector3 cameraFocalPoint);
+	void SetCameraUpVector(Vector3 cameraUpVector);
+
+	const Matrix&						GetViewTransformation() const;
+	const Matrix&						GetProjectionTransformation() const;
+
+	inline const ViewFrustum&			GetViewFrustum() const { return _viewFrustum; }
+	inline CullingStatistics&			GetCullingStatistics() { return _cullingStatistics; }
+
+	void								SetBackgroundColour(Vector4 backgroundColour);
+
+	// Levels of detail are chosen so that their error covers about a pixel on screen, times the
+	// quality bias.  A bias above 1 switches to simpler levels sooner and 0 always draws meshes
+	// in full.
+	inline void							SetLodQualityBias(float lodQualityBias) { _lodQualityBias = lodQualityBias; }
+	inline float						GetLodQualityBias() const { return _lodQualityBias; }
+	// The largest error, in world units, that may be drawn at the given distance from the eye
+	float								GetAllowedLodError(float distance);
+
+private:
+	ComPtr<ID3D11Device>				_device;
+	ComPtr<ID3D11DeviceContext>			_deviceContext;
+	ComPtr<IDXGISwapChain>				_swapChain;
+	// The per-frame drawing goes through this rather than the device context
+	shared_ptr<RenderDevice>			_renderDevice;
+	shared_ptr<StateCache>				_stateCache;
+	ComPtr<ID3D11Texture2D>				_depthStencilBuffer;
+	ComPtr<ID3D11RenderTargetView>		_renderTargetView;
+	ComPtr<ID3D11DepthStencilView>		_depthStencilView;
+
+	D3D11_VIEWPORT						_screenViewport{ 0 };
+
+	Vector3								_eyePosition;
+	Vector3								_focalPointPosition;
+	Vector3								_upVector;
+
+	Vector4								_directionalLightVector;
+	Vector4								_secondDirectionalLightVector;
+	Vector4								_directionalLightColour;
+	Vector4								_secondDirectionalLightColour;
+
+
+	Matrix								_viewTransformation;
+	Matrix								_projectionTransformation;
+	ViewFrustum							_viewFrustum;
+	CullingStatistics					_cullingStatistics{ 0 };
+
+	// The transform store and node registry must outlive the scene graph since
+	// nodes release their entries in them when they are destroyed
+	shared_ptr<TransformStore>			_transformStore;
+	shared_ptr<SceneNodeRegistry>		_sceneNodeRegistry;
+	shared_ptr<WorkerPool>				_workerPool;
+	bool								_parallelUpdate;
+	shared_ptr<RenderQueue>				_renderQueue;
+	SceneGraphPointer					_sceneGraph;
+	shared_ptr<ResourceManager>			_resourceManager;
+
+
+	float							    _backgroundColour[4];
+	float								_lodQualityBias;
+
+	bool GetDeviceAndSwapChain();
+};
+
@@ -1,359 +1,813 @@
-// --------------------------------------------------------------------------------------
-// File: GeometricObject.cpp
-//
-// Adapted from files in the Microsoft DirectX Toolkit to use the SimpleMath library
-// and simplify the usage.  
-// 
-// Normals are always returned set to (0, 0, 0) since it is expected that the normals 
-// will be calculated.
-// 
-// Parts copyright (c) Microsoft Corporation.
-// Licensed under the MIT License.
-//
-//--------------------------------------------------------------------------------------
-
-#include "pch.h"
-#include "GeometricObject.h"
-#include "teapot.h"
-
-inline void CheckIndexOverflow(size_t value)
-{
-    // Use >=, not > comparison, because some D3D level 9_x hardware does not support 0xFFFF index values.
-    if (value >= USHRT_MAX)
-        throw std::out_of_range("Index value out of range: cannot tesselate primitive so finely");
-}
-
-inline void IndexPushBack(vector<UINT>& indices, size_t value)
-{
-    CheckIndexOverflow(value);
-    indices.push_back(static_cast<unsigned int>(value));
-}
-
-
-// Helper for flipping winding of geometric primitives for LH vs. RH coords
-inline void ReverseWinding(vector<UINT>& indices, vector<ObjectVertexStruct>& vertices)
-{
-    assert((indices.size() % 3) == 0);
-    for (auto it = indices.begin(); it != indices.end(); it += 3)
-    {
-        std::swap(*it, *(it + 2));
-    }
-}
-
-//--------------------------------------------------------------------------------------
-// Cube (or Box)
-//--------------------------------------------------------------------------------------
-
-void ComputeBox(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, const Vector3& size)
-{
-    vertices.clear();
-    indices.clear();
-
-    // A box has six faces, each one pointing in a different direction.
-    constexpr int FaceCount = 6;
-
-    static const XMVECTORF32 faceNormals[FaceCount] =
-    {
-        { { {  0,  0,  1, 0 } } },
-        { { {  0,  0, -1, 0 } } },
-        { { {  1,  0,  0, 0 } } },
-        { { { -1,  0,  0, 0 } } },
-        { { {  0,  1,  0, 0 } } },
-        { { {  0, -1,  0, 0 } } },
-    };
-
-    XMVECTOR tsize = XMLoadFloat3(&size);
-    tsize = XMVectorDivide(tsize, g_XMTwo);
-
-    // Create each face in turn.
-    for (int i = 0; i < FaceCount; i++)
-    {
-        const XMVECTOR normal = faceNormals[i];
-
-        // Get two vectors perpendicular both to the face normal and to each other.
-        const XMVECTOR basis = (i >= 4) ? g_XMIdentityR2 : g_XMIdentityR1;
-
-        const XMVECTOR side1 = XMVector3Cross(normal, basis);
-        const XMVECTOR side2 = XMVector3Cross(normal, side1);
-
-        // Six indices (two triangles) per face.
-        const size_t vbase = vertices.size();
-        IndexPushBack(indices, vbase + 2);
-        IndexPushBack(indices, vbase + 1);
-        IndexPushBack(indices, vbase + 0);
-
-        IndexPushBack(indices, vbase + 3);
-        IndexPushBack(indices, vbase + 2);
-        IndexPushBack(indices, vbase + 0);
-
-        // Four vertices per face.
-        // (normal - side1 - side2) * tsize // normal // t0
-        ObjectVertexStruct vertex;
-        vertex.Position = XMVectorMultiply(XMVectorSubtract(XMVectorSubtract(normal, side1), side2), tsize);
-        vertex.Normal = Vector3(0, 0, 0);
-        vertices.push_back(vertex);
-
-        // (normal - side1 + side2) * tsize // normal // t1
-        vertex.Position = XMVectorMultiply(XMVectorAdd(XMVectorSubtract(normal, side1), side2), tsize);
-        vertices.push_back(vertex);
-
-        // (normal + side1 + side2) * tsize // normal // t2
-        vertex.Position = XMVectorMultiply(XMVectorAdd(normal, XMVectorAdd(side1, side2)), tsize);
-        vertices.push_back(vertex);
-
-        // (normal + side1 - side2) * tsize // normal // t3
-        vertex.Position = XMVectorMultiply(XMVectorSubtract(XMVectorAdd(normal, side1), side2), tsize);
-        vertices.push_back(vertex);
-    }
-}
-    
-
-//--------------------------------------------------------------------------------------
-// Sphere
-//--------------------------------------------------------------------------------------
-void ComputeSphere(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, float diameter, size_t tessellation)
-{
-    vertices.clear();
-    indices.clear();
-
-    if (tessellation < 3)
-        throw std::invalid_argument("tesselation parameter must be at least 3");
-
-    const size_t verticalSegments = tessellation;
-    const size_t horizontalSegments = tessellation * 2;
-
-    const float radius = diameter / 2;
-
-    // Create rings of vertices at progressively higher latitudes.
-    for (size_t i = 0; i <= verticalSegments; i++)
-    {
-        const float v = 1 - float(i) / float(verticalSegments);
-
-        const float latitude = (float(i) * XM_PI / float(verticalSegments)) - XM_PIDIV2;
-        float dy, dxz;
-
-        XMScalarSinCos(&dy, &dxz, latitude);
-
-        // Create a single ring of vertices at this latitude.
-        for (size_t j = 0; j <= horizontalSegments; j++)
-        {
-            const float u = float(j) / float(horizontalSegments);
-
-            const float longitude = float(j) * XM_2PI / float(horizontalSegments);
-            float dx, dz;
-
-            XMScalarSinCos(&dx, &dz, longitude);
-
-            dx *= dxz;
-            dz *= dxz;
-
-            ObjectVertexStruct vertex;
-            vertex.Position = Vector3(dx * radius, dy * radius, dz * radius);
-            vertex.Normal = Vector3(0, 0, 0);
-            vertices.push_back(vertex);
-        }
-    }
-
-    // Fill the index buffer with triangles joining each pair of latitude rings.
-    const size_t stride = horizontalSegments + 1;
-
-    for (size_t i = 0; i < verticalSegments; i++)
-    {
-        for (size_t j = 0; j <= horizontalSegments; j++)
-        {
-            const size_t nextI = i + 1;
-            const size_t nextJ = (j + 1) % stride;
-
-            IndexPushBack(indices, i * stride + nextJ);
-            IndexPushBack(indices, nextI * stride + j);
-            IndexPushBack(indices, i * stride + j);
-
-            IndexPushBack(indices, nextI * stride + nextJ);
-            IndexPushBack(indices, nextI * stride + j);
-            IndexPushBack(indices, i * stride + nextJ);
-        }
-    }
-}
-
-//--------------------------------------------------------------------------------------
-// Cylinder / Cone
-//--------------------------------------------------------------------------------------
-
-// Helper computes a point on a unit circle, aligned to the x/z plane and centered on the origin.
-inline XMVECTOR GetCircleVector(size_t i, size_t tessellation) noexcept
-{
-    const float angle = float(i) * XM_2PI / float(tessellation);
-    float dx, dz;
-
-    XMScalarSinCos(&dx, &dz, angle);
-
-    const XMVECTORF32 v = { { { dx, 0, dz, 0 } } };
-    return v;
-}
-
-inline XMVECTOR GetCircleTangent(size_t i, size_t tessellation) noexcept
-{
-    const float angle = (float(i) * XM_2PI / float(tessellation)) + XM_PIDIV2;
-    float dx, dz;
-
-    XMScalarSinCos(&dx, &dz, angle);
-
-    const XMVECTORF32 v = { { { dx, 0, dz, 0 } } };
-    return v;
-}
-
-// Helper creates a triangle fan to close the end of a cylinder / cone
-void CreateCylinderCap(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, size_t tessellation, float height, float radius, bool isTop)
-{
-    // Create cap indices.
-    for (size_t i = 0; i < tessellation - 2; i++)
-    {
-        size_t i1 = (i + 1) % tessellation;
-        size_t i2 = (i + 2) % tessellation;
-
-        if (isTop)
-        {
-            std::swap(i1, i2);
-        }
-
-        const size_t vbase = vertices.size();
-        IndexPushBack(indices, vbase + i2);
-        IndexPushBack(indices, vbase + i1);
-        IndexPushBack(indices, vbase);
-    }
-
-    // Which end of the cylinder is this?
-    XMVECTOR normal = g_XMIdentityR1;
-
-    if (!isTop)
-    {
-        normal = XMVectorNegate(normal);
-    }
-
-    // Create cap vertices.
-    for (size_t i = 0; i < tessellation; i++)
-    {
-        const XMVECTOR circleVector = GetCircleVector(i, tessellation);
-
-        const XMVECTOR position = XMVectorAdd(XMVectorScale(circleVector, radius), XMVectorScale(normal, height));
-
-        ObjectVertexStruct vertex;
-        vertex.Position = position;
-        vertex.Normal = Vector3(0, 0, 0);
-        vertices.push_back(vertex);
-    }
-}
-
-void ComputeCylinder(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, float height, float diameter, size_t tessellation)
-{
-    vertices.clear();
-    indices.clear();
-
-    if (tessellation < 3)
-        throw std::invalid_argument("tesselation parameter must be at least 3");
-
-    height /= 2;
-
-    const XMVECTOR topOffset = XMVectorScale(g_XMIdentityR1, height);
-
-    const float radius = diameter / 2;
-    const size_t stride = tessellation + 1;
-
-    // Create a ring of triangles around the outside of the cylinder.
-    for (size_t i = 0; i <= tessellation; i++)
-    {
-        const XMVECTOR normal = GetCircleVector(i, tessellation);
-
-        const XMVECTOR sideOffset = XMVectorScale(normal, radius);
-
-        const float u = float(i) / float(tessellation);
-
-        ObjectVertexStruct vertex;
-        vertex.Position = XMVectorAdd(sideOffset, topOffset);
-        vertex.Normal = Vector3(0, 0, 0);
-        vertices.push_back(vertex);
-        vertex.Position = XMVectorSubtract(sideOffset, topOffset);
-        vertices.push_back(vertex);
-
-        IndexPushBack(indices, i * 2 + 1);
-        IndexPushBack(indices, (i * 2 + 2) % (stride * 2));
-        IndexPushBack(indices, i * 2);
-
-        IndexPushBack(indices, (i * 2 + 3) % (stride * 2));
-        IndexPushBack(indices, (i * 2 + 2) % (stride * 2));
-        IndexPushBack(indices, i * 2 + 1);
-    }
-
-    // Create flat triangle fan caps to seal the top and bottom.
-    CreateCylinderCap(vertices, indices, tessellation, height, radius, true);
-    CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
-}
-
-void ComputeCone(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, float diameter, float height, size_t tessellation)
-{
-    vertices.clear();
-    indices.clear();
-
-    if (tessellation < 3)
-        throw std::invalid_argument("tesselation parameter must be at least 3");
-
-    height /= 2;
-
-    const XMVECTOR topOffset = XMVectorScale(g_XMIdentityR1, height);
-
-    const float radius = diameter / 2;
-    const size_t stride = tessellation + 1;
-
-    // Create a ring of triangles around the outside of the cone.
-    for (size_t i = 0; i <= tessellation; i++)
-    {
-        const XMVECTOR circlevec = GetCircleVector(i, tessellation);
-
-        const XMVECTOR sideOffset = XMVectorScale(circlevec, radius);
-
-        const float u = float(i) / float(tessellation);
-
-        const XMVECTOR pt = XMVectorSubtract(sideOffset, topOffset);
-
-        XMVECTOR normal = XMVector3Cross(
-            GetCircleTangent(i, tessellation),
-            XMVectorSubtract(topOffset, pt));
-        normal = XMVector3Normalize(normal);
-
-        // Duplicate the top vertex for distinct normals
-        ObjectVertexStruct vertex;
-        vertex.Position = topOffset;
-        vertex.Normal = Vector3(0, 0, 0);
-        vertices.push_back(vertex);
-        vertex.Position = pt;
-        vertices.push_back(vertex);
-
-        IndexPushBack(indices, (i * 2 + 1) % (stride * 2));
-        IndexPushBack(indices, (i * 2 + 3) % (stride * 2));
-        IndexPushBack(indices, i * 2);
-    }
-
-    // Create flat triangle fan caps to seal the bottom.
-    CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
-}
-
-void ComputeTeapot(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, float size)
-{
-    vertices.clear();
-    indices.clear();
-
-    ObjectVertexStruct vertex;
-    vertex.Normal = Vector3(0, 0, 0);
-
-    for (int i = 0; i < ARRAYSIZE(teapotVertexFloats); i += 3)
-    {
-        vertex.Position.x = teapotVertexFloats[i] * size;
-        vertex.Position.y = teapotVertexFloats[i + 1] * size;
-        vertex.Position.z = teapotVertexFloats[i + 2] * size;
-        vertices.push_back(vertex);
-    }
-    for (int i = 0; i < ARRAYSIZE(teapotIndices); i++)
-    {
-        indices.push_back(teapotIndices[i]);
-    }
-}
+// --------------------------------------------------------------------------------------
+// File: GeometricObject.cpp
+//
+// Adapted from files in the Microsoft DirectX Toolkit to use the SimpleMath library
+// and simplify the usage.  
+// 
+// Normals are returned set to (0, 0, 0) since it is expected that the normals 
+// will be calculated, except for the teapot, whose normals come from its patches.
+// 
+// Parts copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+//--------------------------------------------------------------------------------------
+
+#include "GeometricObject.h"
+#include "teapot.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <stdexcept>
+
+inline void CheckIndexOverflow(size_t value)
+{
+    // Use >=, not > comparison, because some D3D level 9_x hardware does not support 0xFFFF index values.
+    if (value >= USHRT_MAX)
+        throw std::out_of_range("Index value out of range: cannot tesselate primitive so finely");
+}
+
+// Throws if the vertices of a primitive cannot all be indexed.  The largest index is always the
+// last vertex, so this is checked once rather than for every index.
+inline void CheckVertexCount(size_t vertexCount)
+{
+    CheckIndexOverflow(vertexCount - 1);
+}
+
+inline void CheckTessellation(size_t tessellation)
+{
+    if (tessellation < 3)
+        throw std::invalid_argument("tesselation parameter must be at least 3");
+}
+
+// Writes the points of a unit circle in the x/z plane into the positions of count vertices, every
+// stride vertices apart.  Point i is at an angle of i * 2 pi / tessellation, and the sines and
+// cosines are computed four points at a time.
+static void WriteUnitCircle(ObjectVertexStruct * vertices, size_t stride, size_t count, size_t tessellation)
+{
+    const XMVECTOR laneOffsets = XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+    const float step = XM_2PI / float(tessellation);
+    for (size_t i = 0; i < count; i += 4)
+    {
+        const XMVECTOR angles = XMVectorScale(XMVectorAdd(XMVectorReplicate(float(i)), laneOffsets), step);
+        XMVECTOR sines, cosines;
+        XMVectorSinCos(&sines, &cosines, angles);
+
+        XMFLOAT4A dx, dz;
+        XMStoreFloat4A(&dx, sines);
+        XMStoreFloat4A(&dz, cosines);
+        const float * xs = &dx.x;
+        const float * zs = &dz.x;
+        const size_t lanes = std::min<size_t>(count - i, 4);
+        for (size_t k = 0; k < lanes; k++)
+        {
+            vertices[(i + k) * stride].Position = Vector3(xs[k], 0, zs[k]);
+        }
+    }
+}
+
+// Sets the positions of count vertices to the unit circle read from the source vertices, scaled and
+// offset.  The source and destination can be the same vertices.
+static void TransformRing(const ObjectVertexStruct * source, size_t sourceStride, ObjectVertexStruct * destination, size_t destinationStride,
+                          size_t count, FXMVECTOR scale, FXMVECTOR offset)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const XMVECTOR circleVector = XMLoadFloat3(&source[i * sourceStride].Position);
+        ObjectVertexStruct& vertex = destination[i * destinationStride];
+        XMStoreFloat3(&vertex.Position, XMVectorMultiplyAdd(circleVector, scale, offset));
+        vertex.Normal = Vector3(0, 0, 0);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Cube (or Box)
+//--------------------------------------------------------------------------------------
+
+GeometryCounts GetBoxCounts()
+{
+    return { 24, 36 };
+}
+
+void ComputeBox(ObjectVertexStruct * vertices, uint32_t * indices, const Vector3& size)
+{
+    // A box has six faces, each one pointing in a different direction.
+    constexpr int FaceCount = 6;
+
+    static const XMVECTORF32 faceNormals[FaceCount] =
+    {
+        { { {  0,  0,  1, 0 } } },
+        { { {  0,  0, -1, 0 } } },
+        { { {  1,  0,  0, 0 } } },
+        { { { -1,  0,  0, 0 } } },
+        { { {  0,  1,  0, 0 } } },
+        { { {  0, -1,  0, 0 } } },
+    };
+
+    XMVECTOR tsize = XMLoadFloat3(&size);
+    tsize = XMVectorDivide(tsize, g_XMTwo);
+
+    // Create each face in turn.
+    for (int i = 0; i < FaceCount; i++)
+    {
+        const XMVECTOR normal = faceNormals[i];
+
+        // Get two vectors perpendicular both to the face normal and to each other.
+        const XMVECTOR basis = (i >= 4) ? g_XMIdentityR2 : g_XMIdentityR1;
+
+        const XMVECTOR side1 = XMVector3Cross(normal, basis);
+        const XMVECTOR side2 = XMVector3Cross(normal, side1);
+
+        // Six indices (two triangles) per face.
+        const uint32_t vbase = static_cast<uint32_t>(i * 4);
+        *indices++ = vbase + 2;
+        *indices++ = vbase + 1;
+        *indices++ = vbase + 0;
+
+        *indices++ = vbase + 3;
+        *indices++ = vbase + 2;
+        *indices++ = vbase + 0;
+
+        // Four vertices per face.
+        // (normal - side1 - side2) * tsize // normal // t0
+        XMStoreFloat3(&vertices[0].Position, XMVectorMultiply(XMVectorSubtract(XMVectorSubtract(normal, side1), side2), tsize));
+
+        // (normal - side1 + side2) * tsize // normal // t1
+        XMStoreFloat3(&vertices[1].Position, XMVectorMultiply(XMVectorAdd(XMVectorSubtract(normal, side1), side2), tsize));
+
+        // (normal + side1 + side2) * tsize // normal // t2
+        XMStoreFloat3(&vertices[2].Position, XMVectorMultiply(XMVectorAdd(normal, XMVectorAdd(side1, side2)), tsize));
+
+        // (normal + side1 - side2) * tsize // normal // t3
+        XMStoreFloat3(&vertices[3].Position, XMVectorMultiply(XMVectorSubtract(XMVectorAdd(normal, side1), side2), tsize));
+
+        for (int j = 0; j < 4; j++)
+        {
+            vertices[j].Normal = Vector3(0, 0, 0);
+        }
+        vertices += 4;
+    }
+}
+
+void ComputeBox(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, const Vector3& size)
+{
+    const GeometryCounts counts = GetBoxCounts();
+    vertices.resize(counts.VertexCount);
+    indices.resize(counts.IndexCount);
+    ComputeBox(vertices.data(), indices.data(), size);
+}
+    
+
+//--------------------------------------------------------------------------------------
+// Sphere
+//--------------------------------------------------------------------------------------
+
+GeometryCounts GetSphereCounts(size_t tessellation)
+{
+    CheckTessellation(tessellation);
+    const size_t verticalSegments = tessellation;
+    const size_t horizontalSegments = tessellation * 2;
+    return { (verticalSegments + 1) * (horizontalSegments + 1), verticalSegments * (horizontalSegments + 1) * 6 };
+}
+
+void ComputeSphere(ObjectVertexStruct * vertices, uint32_t * indices, float diameter, size_t tessellation)
+{
+    CheckVertexCount(GetSphereCounts(tessellation).VertexCount);
+
+    const size_t verticalSegments = tessellation;
+    const size_t horizontalSegments = tessellation * 2;
+    const size_t stride = horizontalSegments + 1;
+
+    const float radius = diameter / 2;
+
+    // Every ring is the same circle, scaled and moved up to its latitude.  The circle is computed
+    // once into the first ring, which is the last to be overwritten.
+    WriteUnitCircle(vertices, 1, stride, horizontalSegments);
+
+    // Create rings of vertices at progressively higher latitudes.
+    for (size_t ring = 1; ring <= verticalSegments + 1; ring++)
+    {
+        const size_t i = ring % (verticalSegments + 1);
+
+        const float latitude = (float(i) * XM_PI / float(verticalSegments)) - XM_PIDIV2;
+        float dy, dxz;
+
+        XMScalarSinCos(&dy, &dxz, latitude);
+
+        TransformRing(vertices, 1, vertices + i * stride, 1, stride,
+                      XMVectorReplicate(dxz * radius), XMVectorSet(0, dy * radius, 0, 0));
+    }
+
+    // Fill the index buffer with triangles joining each pair of latitude rings.
+    for (size_t i = 0; i < verticalSegments; i++)
+    {
+        for (size_t j = 0; j <= horizontalSegments; j++)
+        {
+            const size_t nextI = i + 1;
+            const size_t nextJ = (j + 1) % stride;
+
+            *indices++ = static_cast<uint32_t>(i * stride + nextJ);
+            *indices++ = static_cast<uint32_t>(nextI * stride + j);
+            *indices++ = static_cast<uint32_t>(i * stride + j);
+
+            *indices++ = static_cast<uint32_t>(nextI * stride + nextJ);
+            *indices++ = static_cast<uint32_t>(nextI * stride + j);
+            *indices++ = static_cast<uint32_t>(i * stride + nextJ);
+        }
+    }
+}
+
+void ComputeSphere(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float diameter, size_t tessellation)
+{
+    const GeometryCounts counts = GetSphereCounts(tessellation);
+    vertices.resize(counts.VertexCount);
+    indices.resize(counts.IndexCount);
+    ComputeSphere(vertices.data(), indices.data(), diameter, tessellation);
+}
+
+//--------------------------------------------------------------------------------------
+// Cylinder / Cone
+//--------------------------------------------------------------------------------------
+
+// Helper creates the indices of a triangle fan to close the end of a cylinder / cone.  Returns
+// the position after the last index written.
+static uint32_t * CreateCylinderCapIndices(uint32_t * indices, size_t vbase, size_t tessellation, bool isTop)
+{
+    for (size_t i = 0; i < tessellation - 2; i++)
+    {
+        size_t i1 = (i + 1) % tessellation;
+        size_t i2 = (i + 2) % tessellation;
+
+        if (isTop)
+        {
+            std::swap(i1, i2);
+        }
+
+        *indices++ = static_cast<uint32_t>(vbase + i2);
+        *indices++ = static_cast<uint32_t>(vbase + i1);
+        *indices++ = static_cast<uint32_t>(vbase);
+    }
+    return indices;
+}
+
+GeometryCounts GetCylinderCounts(size_t tessellation)
+{
+    CheckTessellation(tessellation);
+    // Two vertices for each of the tessellation + 1 points around the side, and a fan for each cap
+    return { (tessellation + 1) * 2 + tessellation * 2, (tessellation + 1) * 6 + (tessellation - 2) * 6 };
+}
+
+void ComputeCylinder(ObjectVertexStruct * vertices, uint32_t * indices, float height, float diameter, size_t tessellation)
+{
+    CheckVertexCount(GetCylinderCounts(tessellation).VertexCount);
+
+    height /= 2;
+
+    const XMVECTOR topOffset = XMVectorScale(g_XMIdentityR1, height);
+    const XMVECTOR bottomOffset = XMVectorNegate(topOffset);
+    const XMVECTOR radius = XMVectorReplicate(diameter / 2);
+    const size_t stride = tessellation + 1;
+    ObjectVertexStruct * topCap = vertices + stride * 2;
+    ObjectVertexStruct * bottomCap = topCap + tessellation;
+
+    // The circle is computed once into the top vertices of the side.  The caps and the bottom
+    // vertices of the side are made from it before the top vertices are moved into place.
+    WriteUnitCircle(vertices, 2, stride, tessellation);
+    TransformRing(vertices, 2, topCap, 1, tessellation, radius, topOffset);
+    TransformRing(vertices, 2, bottomCap, 1, tessellation, radius, bottomOffset);
+    TransformRing(vertices, 2, vertices + 1, 2, stride, radius, bottomOffset);
+    TransformRing(vertices, 2, vertices, 2, stride, radius, topOffset);
+
+    // Create a ring of triangles around the outside of the cylinder.
+    for (size_t i = 0; i <= tessellation; i++)
+    {
+        *indices++ = static_cast<uint32_t>(i * 2 + 1);
+        *indices++ = static_cast<uint32_t>((i * 2 + 2) % (stride * 2));
+        *indices++ = static_cast<uint32_t>(i * 2);
+
+        *indices++ = static_cast<uint32_t>((i * 2 + 3) % (stride * 2));
+        *indices++ = static_cast<uint32_t>((i * 2 + 2) % (stride * 2));
+        *indices++ = static_cast<uint32_t>(i * 2 + 1);
+    }
+
+    // Create flat triangle fan caps to seal the top and bottom.
+    indices = CreateCylinderCapIndices(indices, stride * 2, tessellation, true);
+    CreateCylinderCapIndices(indices, stride * 2 + tessellation, tessellation, false);
+}
+
+void ComputeCylinder(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float height, float diameter, size_t tessellation)
+{
+    const GeometryCounts counts = GetCylinderCounts(tessellation);
+    vertices.resize(counts.VertexCount);
+    indices.resize(counts.IndexCount);
+    ComputeCylinder(vertices.data(), indices.data(), height, diameter, tessellation);
+}
+
+GeometryCounts GetConeCounts(size_t tessellation)
+{
+    CheckTessellation(tessellation);
+    // The top vertex is duplicated for each of the tessellation + 1 points around the side
+    return { (tessellation + 1) * 2 + tessellation, (tessellation + 1) * 3 + (tessellation - 2) * 3 };
+}
+
+void ComputeCone(ObjectVertexStruct * vertices, uint32_t * indices, float diameter, float height, size_t tessellation)
+{
+    CheckVertexCount(GetConeCounts(tessellation).VertexCount);
+
+    height /= 2;
+
+    const XMVECTOR topOffset = XMVectorScale(g_XMIdentityR1, height);
+    const XMVECTOR bottomOffset = XMVectorNegate(topOffset);
+    const XMVECTOR radius = XMVectorReplicate(diameter / 2);
+    const size_t stride = tessellation + 1;
+    ObjectVertexStruct * bottomCap = vertices + stride * 2;
+
+    // The circle is computed once into the bottom vertices of the side, and the cap is made from
+    // it before they are moved into place.
+    WriteUnitCircle(vertices + 1, 2, stride, tessellation);
+    TransformRing(vertices + 1, 2, bottomCap, 1, tessellation, radius, bottomOffset);
+    TransformRing(vertices + 1, 2, vertices + 1, 2, stride, radius, bottomOffset);
+
+    // Create a ring of triangles around the outside of the cone.
+    for (size_t i = 0; i <= tessellation; i++)
+    {
+        // Duplicate the top vertex for distinct normals
+        XMStoreFloat3(&vertices[i * 2].Position, topOffset);
+        vertices[i * 2].Normal = Vector3(0, 0, 0);
+
+        *indices++ = static_cast<uint32_t>((i * 2 + 1) % (stride * 2));
+        *indices++ = static_cast<uint32_t>((i * 2 + 3) % (stride * 2));
+        *indices++ = static_cast<uint32_t>(i * 2);
+    }
+
+    // Create flat triangle fan caps to seal the bottom.
+    CreateCylinderCapIndices(indices, stride * 2, tessellation, false);
+}
+
+void ComputeCone(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float diameter, float height, size_t tessellation)
+{
+    const GeometryCounts counts = GetConeCounts(tessellation);
+    vertices.resize(counts.VertexCount);
+    indices.resize(counts.IndexCount);
+    ComputeCone(vertices.data(), indices.data(), diameter, height, tessellation);
+}
+
+//--------------------------------------------------------------------------------------
+// Teapot
+//--------------------------------------------------------------------------------------
+
+// The teapot is moved from the origin of the control points to this point and scaled by half, which
+// is where and how big the teapot made from the old fixed table of vertices was
+static const XMVECTORF32 TeapotOrigin = { { { 0.042254f, 1.738644f, 0, 0 } } };
+constexpr float TeapotScale = 0.5f;
+
+// The mirrors applied to the quadrant patches.  The half patches only use the first and last.
+static const XMVECTORF32 TeapotMirrors[4] =
+{
+    { { {  1, 1,  1, 0 } } },
+    { { { -1, 1,  1, 0 } } },
+    { { { -1, 1, -1, 0 } } },
+    { { {  1, 1, -1, 0 } } },
+};
+
+// The Bernstein polynomials of a cubic Bezier curve at t, and their derivatives
+inline XMVECTOR CubicBasis(float t)
+{
+    const float s = 1 - t;
+    return XMVectorSet(s * s * s, 3 * t * s * s, 3 * t * t * s, t * t * t);
+}
+
+inline XMVECTOR CubicBasisDerivative(float t)
+{
+    const float s = 1 - t;
+    return XMVectorSet(-3 * s * s, 3 * s * s - 6 * t * s, 6 * t * s - 3 * t * t, 3 * t * t);
+}
+
+// The sum of four points weighted by the components of the basis
+inline XMVECTOR WeightPoints(const XMVECTOR * points, FXMVECTOR basis)
+{
+    XMVECTOR result = XMVectorMultiply(points[0], XMVectorSplatX(basis));
+    result = XMVectorMultiplyAdd(points[1], XMVectorSplatY(basis), result);
+    result = XMVectorMultiplyAdd(points[2], XMVectorSplatZ(basis), result);
+    return XMVectorMultiplyAdd(points[3], XMVectorSplatW(basis), result);
+}
+
+// Reduces the patch to a Bezier curve in v at the given u, along with the curve of the derivatives
+// in u.  The control points are held as columns, so columns[j][i] is control point i * 4 + j.
+static void EvaluatePatchRow(const XMVECTOR columns[4][4], float u, XMVECTOR curve[4], XMVECTOR tangentCurve[4])
+{
+    const XMVECTOR basis = CubicBasis(u);
+    const XMVECTOR basisDerivative = CubicBasisDerivative(u);
+    for (int j = 0; j < 4; j++)
+    {
+        curve[j] = WeightPoints(columns[j], basis);
+        tangentCurve[j] = WeightPoints(columns[j], basisDerivative);
+    }
+}
+
+// The normal is the cross product of the derivatives in u and v
+static XMVECTOR EvaluatePatchNormal(const XMVECTOR curve[4], const XMVECTOR tangentCurve[4], float v)
+{
+    const XMVECTOR tangentU = WeightPoints(tangentCurve, CubicBasis(v));
+    const XMVECTOR tangentV = WeightPoints(curve, CubicBasisDerivative(v));
+    return XMVector3Cross(tangentU, tangentV);
+}
+
+size_t GetTeapotPatchCount()
+{
+    size_t patchCount = 0;
+    for (const TeapotPatch& patch : TeapotPatches)
+    {
+        patchCount += patch.MirrorZ ? 2 : 4;
+    }
+    return patchCount;
+}
+
+GeometryCounts GetTeapotCounts(size_t tessellation)
+{
+    if (tessellation < 1)
+        throw std::invalid_argument("tesselation parameter must be at least 1");
+
+    const size_t patchCount = GetTeapotPatchCount();
+    return { patchCount * (tessellation + 1) * (tessellation + 1), patchCount * tessellation * tessellation * 6 };
+}
+
+void ComputeTeapotPatch(ObjectVertexStruct * vertices, uint32_t * indices, float size, size_t tessellation, size_t patchIndex)
+{
+    CheckVertexCount(GetTeapotCounts(tessellation).VertexCount);
+
+    // Find which patch this is and how it is mirrored
+    const TeapotPatch * patch = TeapotPatches;
+    size_t mirror = patchIndex;
+    while (mirror >= (patch->MirrorZ ? 2u : 4u))
+    {
+        mirror -= patch->MirrorZ ? 2 : 4;
+        patch++;
+    }
+    if (patch->MirrorZ && mirror == 1)
+    {
+        mirror = 3;
+    }
+    const XMVECTOR mirrorVector = TeapotMirrors[mirror];
+
+    // Mirroring in one axis turns the patch inside out, so the triangles and normals are reversed
+    const bool reverse = (mirror == 1 || mirror == 3);
+
+    XMVECTOR columns[4][4];
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            const float * point = patch->ControlPoints[i * 4 + j];
+            columns[j][i] = XMVectorMultiply(XMVectorSet(point[0], point[1], point[2], 0), mirrorVector);
+        }
+    }
+
+    const size_t stride = tessellation + 1;
+    vertices += patchIndex * stride * stride;
+    indices += patchIndex * tessellation * tessellation * 6;
+    const XMVECTOR scale = XMVectorReplicate(TeapotScale * size);
+    const XMVECTOR offset = XMVectorNegate(XMVectorMultiply(TeapotOrigin, scale));
+
+    for (size_t r = 0; r <= tessellation; r++)
+    {
+        const float u = float(r) / float(tessellation);
+        XMVECTOR curve[4];
+        XMVECTOR tangentCurve[4];
+        EvaluatePatchRow(columns, u, curve, tangentCurve);
+
+        for (size_t c = 0; c <= tessellation; c++)
+        {
+            const float v = float(c) / float(tessellation);
+            const XMVECTOR position = WeightPoints(curve, CubicBasis(v));
+            XMVECTOR normal = EvaluatePatchNormal(curve, tangentCurve, v);
+
+            // Where an edge of the patch has collapsed to a point (the top of the lid and the
+            // middle of the bottom), one of the derivatives is zero.  The normal is taken from a
+            // point just inside the patch instead.
+            if (XMVectorGetX(XMVector3LengthSq(normal)) < 1e-12f)
+            {
+                const float nudgedU = u + (0.5f - u) * 1e-3f;
+                const float nudgedV = v + (0.5f - v) * 1e-3f;
+                XMVECTOR nudgedCurve[4];
+                XMVECTOR nudgedTangentCurve[4];
+                EvaluatePatchRow(columns, nudgedU, nudgedCurve, nudgedTangentCurve);
+                normal = EvaluatePatchNormal(nudgedCurve, nudgedTangentCurve, nudgedV);
+            }
+            normal = XMVector3Normalize(reverse ? XMVectorNegate(normal) : normal);
+
+            ObjectVertexStruct& vertex = vertices[r * stride + c];
+            XMStoreFloat3(&vertex.Position, XMVectorMultiplyAdd(position, scale, offset));
+            XMStoreFloat3(&vertex.Normal, normal);
+        }
+    }
+
+    const uint32_t vbase = static_cast<uint32_t>(patchIndex * stride * stride);
+    for (size_t r = 0; r < tessellation; r++)
+    {
+        for (size_t c = 0; c < tessellation; c++)
+        {
+            const uint32_t i0 = vbase + static_cast<uint32_t>(r * stride + c);
+            const uint32_t i1 = i0 + static_cast<uint32_t>(stride);
+            const uint32_t i2 = i1 + 1;
+            const uint32_t i3 = i0 + 1;
+            const uint32_t quad[6] = { i0, i1, i2, i2, i3, i0 };
+            for (int k = 0; k < 6; k += 3)
+            {
+                *indices++ = quad[k + (reverse ? 2 : 0)];
+                *indices++ = quad[k + 1];
+                *indices++ = quad[k + (reverse ? 0 : 2)];
+            }
+        }
+    }
+}
+
+void ComputeTeapot(ObjectVertexStruct * vertices, uint32_t * indices, float size, size_t tessellation)
+{
+    const size_t patchCount = GetTeapotPatchCount();
+    for (size_t patch = 0; patch < patchCount; patch++)
+    {
+        ComputeTeapotPatch(vertices, indices, size, tessellation, patch);
+    }
+}
+
+void ComputeTeapot(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float size, size_t tessellation)
+{
+    const GeometryCounts counts = GetTeapotCounts(tessellation);
+    vertices.resize(counts.VertexCount);
+    indices.resize(counts.IndexCount);
+    ComputeTeapot(vertices.data(), indices.data(), size, tessellation);
+}
+
+void ComputeBoundingBox(const vector<ObjectVertexStruct>& vertices, BoundingBox& bounds)
+{
+    if (vertices.empty())
+    {
+        bounds = BoundingBox();
+        return;
+    }
+    BoundingBox::CreateFromPoints(bounds, vertices.size(), &vertices[0].Position, sizeof(ObjectVertexStruct));
+}
+
+//--------------------------------------------------------------------------------------
+// Vertex normals
+//--------------------------------------------------------------------------------------
+
+// Triangles and vertices are handed to the workers in blocks of this many, so that each task
+// is worth the cost of scheduling it
+constexpr size_t NormalBlockSize = 16384;
+
+static void ForEachNormalBlock(size_t count, WorkerPool * workerPool, const function<void(size_t, size_t)>& body)
+{
+    const size_t blockCount = (count + NormalBlockSize - 1) / NormalBlockSize;
+    if (workerPool == nullptr || blockCount < 2)
+    {
+        body(0, count);
+        return;
+    }
+    workerPool->ParallelFor(blockCount, [&](size_t block)
+        {
+            const size_t first = block * NormalBlockSize;
+            body(first, std::min(first + NormalBlockSize, count));
+        });
+}
+
+// What one triangle adds to each of its corners is the normal, tangent and bitangent multiplied
+// by the weight of that corner.  With area weighting, the normal is the cross product of two
+// edges, whose length is twice the area, and the weights are 1.  The tangents are scaled to
+// match.  With angle weighting, they are all unit vectors and the weights are the angles.
+
+struct TriangleFrame
+{
+    XMVECTOR        Normal;
+    XMVECTOR        Tangent;
+    XMVECTOR        Bitangent;
+    XMFLOAT3        Weights;
+};
+
+class NormalSource
+{
+public:
+    NormalSource(uint8_t * vertices, const VertexNormalLayout& layout, const uint32_t * indices, NormalWeighting weighting, bool generateTangents) :
+        _vertices(vertices), _layout(layout), _indices(indices), _weighting(weighting), _generateTangents(generateTangents)
+    {
+    }
+
+    inline XMVECTOR GetPosition(uint32_t index) const
+    {
+        return XMLoadFloat3(reinterpret_cast<const XMFLOAT3 *>(_vertices + index * _layout.Stride));
+    }
+
+    inline XMVECTOR GetTexCoord(uint32_t index) const
+    {
+        return XMLoadFloat2(reinterpret_cast<const XMFLOAT2 *>(_vertices + index * _layout.Stride + _layout.TexCoordOffset));
+    }
+
+    TriangleFrame Evaluate(size_t face) const
+    {
+        const uint32_t * corners = _indices + face * 3;
+        const XMVECTOR p0 = GetPosition(corners[0]);
+        const XMVECTOR edge1 = XMVectorSubtract(GetPosition(corners[1]), p0);
+        const XMVECTOR edge2 = XMVectorSubtract(GetPosition(corners[2]), p0);
+
+        TriangleFrame frame;
+        frame.Normal = XMVector3Cross(edge1, edge2);
+        frame.Weights = XMFLOAT3(1.0f, 1.0f, 1.0f);
+        XMVECTOR tangentScale = g_XMOne;
+        if (_weighting == NormalWeightingAngle)
+        {
+            // The angles at all three corners are found together from the cosines between the
+            // unit edges
+            const XMVECTOR a = XMVector3Normalize(edge1);
+            const XMVECTOR b = XMVector3Normalize(edge2);
+            const XMVECTOR c = XMVector3Normalize(XMVectorSubtract(edge2, edge1));
+            XMVECTOR cosines = XMVectorSet(XMVectorGetX(XMVector3Dot(a, b)),
+                                           -XMVectorGetX(XMVector3Dot(a, c)),
+                                           XMVectorGetX(XMVector3Dot(b, c)),
+                                           0);
+            cosines = XMVectorClamp(cosines, g_XMNegativeOne, g_XMOne);
+            XMStoreFloat3(&frame.Weights, XMVectorACos(cosines));
+            frame.Normal = XMVector3Normalize(frame.Normal);
+        }
+        else if (_generateTangents)
+        {
+            tangentScale = XMVector3Length(frame.Normal);
+        }
+
+        frame.Tangent = XMVectorZero();
+        frame.Bitangent = XMVectorZero();
+        if (_generateTangents)
+        {
+            // The directions in which U and V increase across the triangle.  A triangle whose
+            // texture coordinates do not cover any area has none.
+            const XMVECTOR uv0 = GetTexCoord(corners[0]);
+            XMFLOAT2 uv1;
+            XMFLOAT2 uv2;
+            XMStoreFloat2(&uv1, XMVectorSubtract(GetTexCoord(corners[1]), uv0));
+            XMStoreFloat2(&uv2, XMVectorSubtract(GetTexCoord(corners[2]), uv0));
+            const float determinant = uv1.x * uv2.y - uv2.x * uv1.y;
+            if (fabsf(determinant) > 1e-20f)
+            {
+                const XMVECTOR tangent = XMVectorSubtract(XMVectorScale(edge1, uv2.y), XMVectorScale(edge2, uv1.y));
+                const XMVECTOR bitangent = XMVectorSubtract(XMVectorScale(edge2, uv1.x), XMVectorScale(edge1, uv2.x));
+                const XMVECTOR scale = XMVectorScale(tangentScale, determinant < 0.0f ? -1.0f : 1.0f);
+                frame.Tangent = XMVectorMultiply(XMVector3Normalize(tangent), scale);
+                frame.Bitangent = XMVectorMultiply(XMVector3Normalize(bitangent), scale);
+            }
+        }
+        return frame;
+    }
+
+    // Turns the sums of the corners that share a vertex into its normal and tangent
+    void Finish(size_t vertex, FXMVECTOR normalSum, FXMVECTOR tangentSum, FXMVECTOR bitangentSum, Vector4 * tangents) const
+    {
+        const XMVECTOR normal = XMVector3Normalize(normalSum);
+        XMStoreFloat3(reinterpret_cast<XMFLOAT3 *>(_vertices + vertex * _layout.Stride + _layout.NormalOffset), normal);
+        if (tangents == nullptr)
+        {
+            return;
+        }
+        // The tangent is made perpendicular to the normal.  If there is nothing left, any
+        // perpendicular direction will do.
+        XMVECTOR tangent = XMVectorSubtract(tangentSum, XMVectorMultiply(normal, XMVector3Dot(normal, tangentSum)));
+        if (XMVectorGetX(XMVector3LengthSq(tangent)) < 1e-12f)
+        {
+            const XMVECTOR axis = fabsf(XMVectorGetX(normal)) < 0.9f ? g_XMIdentityR0 : g_XMIdentityR1;
+            tangent = XMVector3Cross(normal, axis);
+        }
+        tangent = XMVector3Normalize(tangent);
+        const float handedness = XMVectorGetX(XMVector3Dot(XMVector3Cross(normal, tangent), bitangentSum)) < 0.0f ? -1.0f : 1.0f;
+        XMStoreFloat4(&tangents[vertex], XMVectorSetW(tangent, handedness));
+    }
+
+private:
+    uint8_t *               _vertices;
+    VertexNormalLayout      _layout;
+    const uint32_t *            _indices;
+    NormalWeighting         _weighting;
+    bool                    _generateTangents;
+};
+
+inline float GetWeight(const XMFLOAT3& weights, size_t corner)
+{
+    return corner == 0 ? weights.x : (corner == 1 ? weights.y : weights.z);
+}
+
+void ComputeVertexNormals(vector<ObjectVertexStruct>& vertices, const vector<uint32_t>& indices, WorkerPool * workerPool)
+{
+    const VertexNormalLayout layout = { sizeof(ObjectVertexStruct), offsetof(ObjectVertexStruct, Normal), 0 };
+    GenerateVertexNormals(vertices.data(), vertices.size(), layout, indices.data(), indices.size(), NormalWeightingArea, nullptr, workerPool);
+}
+
+void GenerateVertexNormals(void * vertices, size_t vertexCount, const VertexNormalLayout& layout, const uint32_t * indices, size_t indexCount, NormalWeighting weighting, Vector4 * tangents, WorkerPool * workerPool)
+{
+    const NormalSource source(static_cast<uint8_t *>(vertices), layout, indices, weighting, tangents != nullptr);
+    const size_t faceCount = indexCount / 3;
+    const bool parallel = workerPool != nullptr && workerPool->GetThreadCount() > 0 && faceCount > NormalBlockSize;
+
+    if (!parallel)
+    {
+        // On one thread, each triangle is simply added to its corners as it is found
+        vector<XMFLOAT3> normalSums(vertexCount, XMFLOAT3(0.0f, 0.0f, 0.0f));
+        vector<XMFLOAT3> tangentSums(tangents ? vertexCount : 0, XMFLOAT3(0.0f, 0.0f, 0.0f));
+        vector<XMFLOAT3> bitangentSums(tangents ? vertexCount : 0, XMFLOAT3(0.0f, 0.0f, 0.0f));
+        vector<bool> used(vertexCount, false);
+        for (size_t face = 0; face < faceCount; face++)
+        {
+            const TriangleFrame frame = source.Evaluate(face);
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                const uint32_t index = indices[face * 3 + corner];
+                const XMVECTOR weight = XMVectorReplicate(GetWeight(frame.Weights, corner));
+                XMStoreFloat3(&normalSums[index], XMVectorMultiplyAdd(frame.Normal, weight, XMLoadFloat3(&normalSums[index])));
+                if (tangents)
+                {
+                    XMStoreFloat3(&tangentSums[index], XMVectorMultiplyAdd(frame.Tangent, weight, XMLoadFloat3(&tangentSums[index])));
+                    XMStoreFloat3(&bitangentSums[index], XMVectorMultiplyAdd(frame.Bitangent, weight, XMLoadFloat3(&bitangentSums[index])));
+                }
+                used[index] = true;
+            }
+        }
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            if (used[i])
+            {
+                source.Finish(i, XMLoadFloat3(&normalSums[i]),
+                              tangents ? XMLoadFloat3(&tangentSums[i]) : XMVectorZero(),
+                              tangents ? XMLoadFloat3(&bitangentSums[i]) : XMVectorZero(),
+                              tangents);
+            }
+        }
+        return;
+    }
+
+    // Across the workers, adding to the corners as above would have threads writing to the same
+    // vertices.  Instead, the first pass stores what each triangle adds and the second pass
+    // visits each vertex and gathers from the triangles that use it, so each vertex is only ever
+    // written by one thread.  The corners are gathered in the order of the triangles, so the
+    // sums are exactly the same as on one thread.
+    vector<XMFLOAT3> faceNormals(faceCount);
+    vector<XMFLOAT3> faceWeights(weighting == NormalWeightingAngle ? faceCount : 0);
+    vector<XMFLOAT3> faceTangents(tangents ? faceCount : 0);
+    vector<XMFLOAT3> faceBitangents(tangents ? faceCount : 0);
+    ForEachNormalBlock(faceCount, workerPool, [&](size_t firstFace, size_t lastFace)
+        {
+            for (size_t face = firstFace; face < lastFace; face++)
+            {
+                const TriangleFrame frame = source.Evaluate(face);
+                XMStoreFloat3(&faceNormals[face], frame.Normal);
+                if (weighting == NormalWeightingAngle)
+                {
+                    faceWeights[face] = frame.Weights;
+                }
+                if (tangents)
+                {
+                    XMStoreFloat3(&faceTangents[face], frame.Tangent);
+                    XMStoreFloat3(&faceBitangents[face], frame.Bitangent);
+                }
+            }
+        });
+
+    // The corners that use each vertex, in order
+    vector<uint32_t> cornerStarts(vertexCount + 1, 0);
+    for (size_t corner = 0; corner < faceCount * 3; corner++)
+    {
+        cornerStarts[indices[corner] + 1]++;
+    }
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        cornerStarts[i + 1] += cornerStarts[i];
+    }
+    vector<uint32_t> vertexCorners(faceCount * 3);
+    vector<uint32_t> nextCorner(cornerStarts.begin(), cornerStarts.end() - 1);
+    for (size_t corner = 0; corner < faceCount * 3; corner++)
+    {
+        vertexCorners[nextCorner[indices[corner]]++] = static_cast<uint32_t>(corner);
+    }
+
+    ForEachNormalBlock(vertexCount, workerPool, [&](size_t firstVertex, size_t lastVertex)
+        {
+            for (size_t i = firstVertex; i < lastVertex; i++)
+            {
+                if (cornerStarts[i] == cornerStarts[i + 1])
+                {
+                    continue;
+                }
+                XMVECTOR normalSum = XMVectorZero();
+                XMVECTOR tangentSum = XMVectorZero();
+                XMVECTOR bitangentSum = XMVectorZero();
+                for (uint32_t j = cornerStarts[i]; j < cornerStarts[i + 1]; j++)
+                {
+                    const size_t face = vertexCorners[j] / 3;
+                    const XMVECTOR weight = XMVectorReplicate(weighting == NormalWeightingAngle ? GetWeight(faceWeights[face], vertexCorners[j] % 3) : 1.0f);
+                    normalSum = XMVectorMultiplyAdd(XMLoadFloat3(&faceNormals[face]), weight, normalSum);
+                    if (tangents)
+                    {
+                        tangentSum = XMVectorMultiplyAdd(XMLoadFloat3(&faceTangents[face]), weight, tangentSum);
+                        bitangentSum = XMVectorMultiplyAdd(XMLoadFloat3(&faceBitangents[face]), weight, bitangentSum);
+                    }
+                }
+                source.Finish(i, normalSum, tangentSum, bitangentSum, tangents);
+            }
+        });
+}
@@ -1,130 +1,249 @@
-#pragma once
-//--------------------------------------------------------------------------------------
-// File: GeometricObject.h
-//
-// Adapted from files in the Microsoft DirectX Toolkit to use the SimpleMath library
-// and simplify the usage.  
-// 
-// Normals are always returned set to (0, 0, 0) since it is expected that the normals 
-// will be calculated.
-// 
-// Parts copyright (c) Microsoft Corporation.
-// Licensed under the MIT License.
-//
-//--------------------------------------------------------------------------------------
-
-#include "SimpleMath.h"
-#include <vector>
-
-using namespace std;
-using namespace DirectX;
-using namespace SimpleMath;
-
-// Structure of a single vertex for all vertices generated by these functions.  This must match the
-// structure of the input vertex in the shader
-
-struct ObjectVertexStruct
-{
-    Vector3		Position;
-    Vector3		Normal;
-};
-
-//--------------------------------------------------------------------------------------------------------
-// ComputeBox
-//
-// Input Parameters:
-//
-// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the box.
-// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the box.
-// size             : A reference to a Vector3 containing the size of the box requested in the X, Y and Z dimensions.
-//
-// Output Parameters:
-//
-// vertices         : This contains the vertices for the box.
-// indices          : This contains the indices for the box
-//
-//--------------------------------------------------------------------------------------------------------
-
-
-void ComputeBox(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, const Vector3& size);
-
-//--------------------------------------------------------------------------------------------------------
-// ComputeSphere
-//
-// Input Parameters:
-//
-// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the sphere.
-// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the sphere.
-// diameter         : The required diameter of the sphere
-// tesselation      : The number of polygons that make up the diameter of the sphere.  Higher numbers give a smoother effect,
-//                    but, of course, result in many more vertices.  Must be more than 3.
-//
-// Output Parameters:
-//
-// vertices         : This contains the vertices for the sphere.
-// indices          : This contains the indices for the sphere.
-//
-//--------------------------------------------------------------------------------------------------------
-
-void ComputeSphere(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, float diameter, size_t tessellation);
-
-//--------------------------------------------------------------------------------------------------------
-// ComputeCylinder
-//
-// Input Parameters:
-//
-// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the cylinder.
-// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the cylinder.
-// height           : The required height of the cylinder
-// diameter         : The required diameter of the cylinder
-// tesselation      : Defines the smoothness of the cylinder.  Higher numbers give a smoother effect,
-//                    but, of course, result in many more vertices.  Must be more than 3.
-//
-// Output Parameters:
-//
-// vertices         : This contains the vertices for the cylinder.
-// indices          : This contains the indices for the cylinder.
-//
-//--------------------------------------------------------------------------------------------------------
-
-void ComputeCylinder(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, float height, float diameter, size_t tessellation);
-
-//--------------------------------------------------------------------------------------------------------
-// ComputeCone
-//
-// Input Parameters:
-//
-// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the cone.
-// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the cone.
-// diameter         : The required diameter of the base of the cone
-// height           : The required height of the cone
-// tesselation      : Defines the smoothness of the cone.  Higher numbers give a smoother effect,
-//                    but, of course, result in many more vertices.  Must be more than 3.
-//
-// Output Parameters:
-//
-// vertices         : This contains the vertices for the cone.
-// indices          : This contains the indices for the cone.
-//
-//--------------------------------------------------------------------------------------------------------
-
-void ComputeCone(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, float diameter, float height, size_t tessellation);
-
-//--------------------------------------------------------------------------------------------------------
-// ComputeTeapot.  Generate the model of a teapot.
-//
-// Input Parameters:
-//
-// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the teapot.
-// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the teapot.
-// size             : The size of the teapot in all dimensions.
-//
-// Output Parameters:
-//
-// vertices         : This contains the vertices for the teapot.
-// indices          : This contains the indices for the teapot.
-//
-//--------------------------------------------------------------------------------------------------------
-
-void ComputeTeapot(vector<ObjectVertexStruct>& vertices, vector<UINT>& indices, float size);
-
+#pragma once
+//--------------------------------------------------------------------------------------
+// File: GeometricObject.h
+//
+// Adapted from files in the Microsoft DirectX Toolkit to use the SimpleMath library
+// and simplify the usage.  
+// 
+// Normals are returned set to (0, 0, 0) since it is expected that the normals 
+// will be calculated, except for the teapot, whose normals come from its patches.
+// 
+// Parts copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+//--------------------------------------------------------------------------------------
+
+#include "SimpleMath.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+using namespace DirectX;
+using namespace SimpleMath;
+
+// Structure of a single vertex for all vertices generated by these functions.  This must match the
+// structure of the input vertex in the shader
+
+struct ObjectVertexStruct
+{
+    Vector3		Position;
+    Vector3		Normal;
+};
+
+// The number of vertices and indices a primitive is made of.  Each of the Compute functions below for
+// a box, sphere, cylinder, cone and teapot has a form that writes into memory provided by the caller, which must
+// have room for exactly these counts, so that geometry can be generated without any allocation.  The
+// forms that take vectors resize them to these counts, so a vector that is reused is only allocated once.
+
+struct GeometryCounts
+{
+    size_t      VertexCount;
+    size_t      IndexCount;
+};
+
+GeometryCounts GetBoxCounts();
+GeometryCounts GetSphereCounts(size_t tessellation);
+GeometryCounts GetCylinderCounts(size_t tessellation);
+GeometryCounts GetConeCounts(size_t tessellation);
+GeometryCounts GetTeapotCounts(size_t tessellation);
+
+// The teapot is made of Bezier patches, each of which is tessellated into its own grid of vertices.
+// This is the number of patches, counting each mirrored copy of a patch separately.
+size_t GetTeapotPatchCount();
+
+// The tessellation that gives the same number of triangles as the old fixed teapot model
+const size_t DefaultTeapotTessellation = 6;
+
+//--------------------------------------------------------------------------------------------------------
+// ComputeBox
+//
+// Input Parameters:
+//
+// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the box.
+// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the box.
+// size             : A reference to a Vector3 containing the size of the box requested in the X, Y and Z dimensions.
+//
+// Output Parameters:
+//
+// vertices         : This contains the vertices for the box.
+// indices          : This contains the indices for the box
+//
+//--------------------------------------------------------------------------------------------------------
+
+
+void ComputeBox(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, const Vector3& size);
+void ComputeBox(ObjectVertexStruct * vertices, uint32_t * indices, const Vector3& size);
+
+//--------------------------------------------------------------------------------------------------------
+// ComputeSphere
+//
+// Input Parameters:
+//
+// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the sphere.
+// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the sphere.
+// diameter         : The required diameter of the sphere
+// tesselation      : The number of polygons that make up the diameter of the sphere.  Higher numbers give a smoother effect,
+//                    but, of course, result in many more vertices.  Must be more than 3.
+//
+// Output Parameters:
+//
+// vertices         : This contains the vertices for the sphere.
+// indices          : This contains the indices for the sphere.
+//
+//--------------------------------------------------------------------------------------------------------
+
+void ComputeSphere(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float diameter, size_t tessellation);
+void ComputeSphere(ObjectVertexStruct * vertices, uint32_t * indices, float diameter, size_t tessellation);
+
+//--------------------------------------------------------------------------------------------------------
+// ComputeCylinder
+//
+// Input Parameters:
+//
+// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the cylinder.
+// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the cylinder.
+// height           : The required height of the cylinder
+// diameter         : The required diameter of the cylinder
+// tesselation      : Defines the smoothness of the cylinder.  Higher numbers give a smoother effect,
+//                    but, of course, result in many more vertices.  Must be more than 3.
+//
+// Output Parameters:
+//
+// vertices         : This contains the vertices for the cylinder.
+// indices          : This contains the indices for the cylinder.
+//
+//--------------------------------------------------------------------------------------------------------
+
+void ComputeCylinder(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float height, float diameter, size_t tessellation);
+void ComputeCylinder(ObjectVertexStruct * vertices, uint32_t * indices, float height, float diameter, size_t tessellation);
+
+//--------------------------------------------------------------------------------------------------------
+// ComputeCone
+//
+// Input Parameters:
+//
+// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the cone.
+// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the cone.
+// diameter         : The required diameter of the base of the cone
+// height           : The required height of the cone
+// tesselation      : Defines the smoothness of the cone.  Higher numbers give a smoother effect,
+//                    but, of course, result in many more vertices.  Must be more than 3.
+//
+// Output Parameters:
+//
+// vertices         : This contains the vertices for the cone.
+// indices          : This contains the indices for the cone.
+//
+//--------------------------------------------------------------------------------------------------------
+
+void ComputeCone(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float diameter, float height, size_t tessellation);
+void ComputeCone(ObjectVertexStruct * vertices, uint32_t * indices, float diameter, float height, size_t tessellation);
+
+//--------------------------------------------------------------------------------------------------------
+// ComputeTeapot.  Generate the model of a teapot by tessellating the Bezier patches of the Utah teapot.
+//
+// Input Parameters:
+//
+// vertices         : A reference to a vector of ObjectVertexStruct structures.  This will be populated with the vertices for the teapot.
+// indices          : A reference to a vector of unsigned ints.  This will be populated with the indices for the teapot.
+// size             : The size of the teapot in all dimensions.
+// tesselation      : The number of rows and columns of quads that each patch is divided into.  Must be at least 1.
+//
+// Output Parameters:
+//
+// vertices         : This contains the vertices for the teapot, with their normals.
+// indices          : This contains the indices for the teapot.
+//
+// The vertices along the edges of the patches are not shared, so each patch can be generated on its own by
+// ComputeTeapotPatch.  Each patch writes to its own part of the memory, patch * (tessellation + 1)^2 vertices
+// and patch * tessellation^2 * 6 indices from the start, so the patches can be generated on different threads.
+//--------------------------------------------------------------------------------------------------------
+
+void ComputeTeapot(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float size, size_t tessellation = DefaultTeapotTessellation);
+void ComputeTeapot(ObjectVertexStruct * vertices, uint32_t * indices, float size, size_t tessellation = DefaultTeapotTessellation);
+void ComputeTeapotPatch(ObjectVertexStruct * vertices, uint32_t * indices, float size, size_t tessellation, size_t patch);
+
+//--------------------------------------------------------------------------------------------------------
+// ComputeBoundingBox.  Calculate the axis-aligned box that encloses a set of vertices.
+//
+// Input Parameters:
+//
+// vertices         : A reference to a vector of ObjectVertexStruct structures, as generated by one of the functions above.
+//
+// Output Parameters:
+//
+// bounds           : This contains the bounding box of the vertices.
+//
+//--------------------------------------------------------------------------------------------------------
+
+void ComputeBoundingBox(const vector<ObjectVertexStruct>& vertices, BoundingBox& bounds);
+
+//--------------------------------------------------------------------------------------------------------
+// ComputeVertexNormals.  Calculate smooth vertex normals for the output of one of the functions above by
+// averaging the normals of the polygons that share each vertex, weighted by their areas.
+//
+// Input Parameters:
+//
+// vertices         : A reference to a vector of ObjectVertexStruct structures.
+// indices          : A reference to a vector of unsigned ints containing the indices of the polygons.
+// workerPool       : Optional.  Large meshes are split across the workers.
+//
+// Output Parameters:
+//
+// vertices         : The normal of each vertex has been set.
+//
+//--------------------------------------------------------------------------------------------------------
+
+class WorkerPool;
+
+void ComputeVertexNormals(vector<ObjectVertexStruct>& vertices, const vector<uint32_t>& indices, WorkerPool * workerPool = nullptr);
+
+// How much each triangle contributes to the normals of its corners
+
+enum NormalWeighting
+{
+    // In proportion to the area of the triangle.  This is what ComputeVertexNormals does.
+    NormalWeightingArea,
+    // In proportion to the angle of the triangle at the corner, so that the normals do not depend on
+    // how a surface has been divided into triangles
+    NormalWeightingAngle
+};
+
+// Where GenerateVertexNormals finds the parts of a vertex.  The position is always three floats at the
+// start of the vertex.
+
+struct VertexNormalLayout
+{
+    size_t      Stride;
+    size_t      NormalOffset;
+    // Two floats.  Only read when tangents are generated.
+    size_t      TexCoordOffset;
+};
+
+//--------------------------------------------------------------------------------------------------------
+// GenerateVertexNormals.  Calculate smooth vertex normals, and optionally tangents, for any indexed triangle list.
+//
+// Input Parameters:
+//
+// vertices         : A pointer to the first vertex.  The normals are written into the vertices.
+// vertexCount      : The number of vertices.
+// layout           : The size of each vertex and where the normal and texture coordinates are within it.
+// indices          : A pointer to the indices of the triangles.
+// indexCount       : The number of indices.
+// weighting        : How much each triangle contributes to the normals of its corners.
+// tangents         : Optional.  An array of vertexCount Vector4s to receive the tangents, which follow the U direction
+//                    of the texture coordinates.  W is 1 or -1, the sign of the bitangent as cross(normal, tangent) * W.
+// workerPool       : Optional.  Large meshes are split across the workers.
+//
+// Output Parameters:
+//
+// vertices         : The normal of each vertex used by a triangle has been set.  Other vertices are not changed.
+// tangents         : The tangent of each vertex used by a triangle has been set.
+//
+// The work is done in two passes.  The first finds the normal (and tangent) of each triangle and the weight of each of
+// its corners.  The second visits each vertex in turn and adds up the corners that use it, from a table built between
+// the passes.  No two threads write to the same vertex, so no locking is needed and the result does not depend on the
+// number of threads.
+//--------------------------------------------------------------------------------------------------------
+
+void GenerateVertexNormals(void * vertices, size_t vertexCount, const VertexNormalLayout& layout, const uint32_t * indices, size_t indexCount, NormalWeighting weighting, Vector4 * tangents = nullptr, WorkerPool * workerPool = nullptr);
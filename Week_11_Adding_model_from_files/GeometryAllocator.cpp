@@ -0,0 +1,181 @@
+#include "GeometryAllocator.h"
+#include <algorithm>
+
+GeometryAllocator::GeometryAllocator(size_t capacity, size_t alignment, size_t maximumCapacity)
+{
+	_alignment = alignment;
+	_capacity = capacity / alignment * alignment;
+	_maximumCapacity = max(maximumCapacity / alignment * alignment, _capacity);
+	_used = 0;
+	_blockCount = 0;
+	if (_capacity > 0)
+	{
+		_freeRanges[0] = _capacity;
+	}
+}
+
+GeometryBlockId GeometryAllocator::Allocate(size_t size)
+{
+	size_t alignedSize = (size + _alignment - 1) / _alignment * _alignment;
+	if (alignedSize == 0)
+	{
+		return InvalidGeometryBlock;
+	}
+
+	// Best fit, taking the lowest offset when several ranges are the same size
+	map<size_t, size_t>::iterator best = _freeRanges.end();
+	for (map<size_t, size_t>::iterator it = _freeRanges.begin(); it != _freeRanges.end(); ++it)
+	{
+		if (it->second >= alignedSize && (best == _freeRanges.end() || it->second < best->second))
+		{
+			best = it;
+			if (it->second == alignedSize)
+			{
+				break;
+			}
+		}
+	}
+	if (best == _freeRanges.end())
+	{
+		if (!Grow(alignedSize))
+		{
+			return InvalidGeometryBlock;
+		}
+		// After growing, the last free range is always large enough
+		best = prev(_freeRanges.end());
+	}
+
+	size_t offset = best->first;
+	size_t remaining = best->second - alignedSize;
+	_freeRanges.erase(best);
+	if (remaining > 0)
+	{
+		_freeRanges[offset + alignedSize] = remaining;
+	}
+
+	GeometryBlockId id;
+	if (_freeIds.empty())
+	{
+		id = static_cast<GeometryBlockId>(_blocks.size());
+		_blocks.push_back(BlockEntry());
+	}
+	else
+	{
+		id = _freeIds.back();
+		_freeIds.pop_back();
+	}
+	_blocks[id].Block.Offset = offset;
+	_blocks[id].Block.Size = alignedSize;
+	_blocks[id].InUse = true;
+	_used += alignedSize;
+	_blockCount++;
+	return id;
+}
+
+void GeometryAllocator::Free(GeometryBlockId id)
+{
+	if (id >= _blocks.size() || !_blocks[id].InUse)
+	{
+		return;
+	}
+	BlockEntry& entry = _blocks[id];
+	entry.InUse = false;
+	_used -= entry.Block.Size;
+	_blockCount--;
+	_freeIds.push_back(id);
+	AddFreeRange(entry.Block.Offset, entry.Block.Size);
+}
+
+void GeometryAllocator::Defragment(vector<GeometryMove>& moves)
+{
+	moves.clear();
+	for (GeometryBlockId id = 0; id < _blocks.size(); id++)
+	{
+		if (_blocks[id].InUse)
+		{
+			GeometryMove move;
+			move.Id = id;
+			move.From = _blocks[id].Block.Offset;
+			move.Size = _blocks[id].Block.Size;
+			moves.push_back(move);
+		}
+	}
+	// Keep the blocks in the order they were in, which keeps the data of a mesh together
+	sort(moves.begin(), moves.end(), [](const GeometryMove& a, const GeometryMove& b) { return a.From < b.From; });
+	size_t offset = 0;
+	for (GeometryMove& move : moves)
+	{
+		move.To = offset;
+		_blocks[move.Id].Block.Offset = offset;
+		offset += move.Size;
+	}
+	_freeRanges.clear();
+	if (offset < _capacity)
+	{
+		_freeRanges[offset] = _capacity - offset;
+	}
+}
+
+size_t GeometryAllocator::GetLargestFreeRange() const
+{
+	size_t largest = 0;
+	for (const pair<const size_t, size_t>& range : _freeRanges)
+	{
+		largest = max(largest, range.second);
+	}
+	return largest;
+}
+
+float GeometryAllocator::GetFragmentation() const
+{
+	size_t free = _capacity - _used;
+	if (free == 0)
+	{
+		return 0.0f;
+	}
+	return 1.0f - static_cast<float>(GetLargestFreeRange()) / static_cast<float>(free);
+}
+
+bool GeometryAllocator::Grow(size_t size)
+{
+	// A free range at the end of the buffer counts towards the block
+	size_t tailFree = 0;
+	if (!_freeRanges.empty())
+	{
+		map<size_t, size_t>::const_iterator last = prev(_freeRanges.end());
+		if (last->first + last->second == _capacity)
+		{
+			tailFree = last->second;
+		}
+	}
+	size_t needed = _capacity + size - tailFree;
+	if (needed > _maximumCapacity)
+	{
+		return false;
+	}
+	size_t newCapacity = min(max(_capacity * 2, needed), _maximumCapacity);
+	AddFreeRange(_capacity, newCapacity - _capacity);
+	_capacity = newCapacity;
+	return true;
+}
+
+void GeometryAllocator::AddFreeRange(size_t offset, size_t size)
+{
+	// Merge with the free ranges either side
+	map<size_t, size_t>::iterator next = _freeRanges.lower_bound(offset);
+	if (next != _freeRanges.end() && offset + size == next->first)
+	{
+		size += next->second;
+		next = _freeRanges.erase(next);
+	}
+	if (next != _freeRanges.begin())
+	{
+		map<size_t, size_t>::iterator previous = prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			previous->second += size;
+			return;
+		}
+	}
+	_freeRanges[offset] = size;
+}
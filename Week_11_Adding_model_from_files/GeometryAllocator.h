@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+// Keeps track of which parts of a large buffer are in use, so that the geometry of many
+// sub-meshes can share one vertex buffer and one index buffer (see GeometryArena).  Blocks are
+// identified by an id rather than by their offset, because defragmenting moves them.
+//
+//	Allocation	Best fit from a list of free ranges sorted by offset.  Freed blocks are merged
+//				with the free ranges either side of them.
+//	Growth		If no free range is large enough, the capacity grows to at least double, or
+//				more if the block needs it, up to the maximum capacity.  Existing blocks do not
+//				move, so the owner only has to copy the old contents into a larger buffer.
+//	Defragment	Packs every block down to the start of the buffer in offset order, leaving one
+//				free range at the end.
+//
+// This only does the bookkeeping and has no dependencies on Direct3D, so it can be driven with
+// a plain block of memory standing in for the buffer.
+
+typedef uint32_t GeometryBlockId;
+const GeometryBlockId InvalidGeometryBlock = 0xFFFFFFFF;
+
+struct GeometryBlock
+{
+	size_t					Offset;
+	size_t					Size;
+};
+
+// Where a block was and where it goes after defragmenting
+struct GeometryMove
+{
+	GeometryBlockId			Id;
+	size_t					From;
+	size_t					To;
+	size_t					Size;
+};
+
+class GeometryAllocator
+{
+public:
+	// The capacity and maximum capacity are rounded down to the alignment
+	GeometryAllocator(size_t capacity, size_t alignment, size_t maximumCapacity);
+
+	// Allocates at least the given number of bytes, rounded up to the alignment, growing the
+	// capacity if necessary.  Returns InvalidGeometryBlock if the block does not fit even at the
+	// maximum capacity, in which case nothing is changed.
+	GeometryBlockId			Allocate(size_t size);
+	void					Free(GeometryBlockId id);
+
+	// Moves every block down to close the gaps between them.  The moves are listed for every
+	// block in the new order, including those that stay where they are, so that the contents
+	// can be copied into a new buffer of the same capacity.
+	void					Defragment(vector<GeometryMove>& moves);
+
+	inline const GeometryBlock&	GetBlock(GeometryBlockId id) const { return _blocks[id].Block; }
+	inline size_t			GetCapacity() const { return _capacity; }
+	inline size_t			GetAlignment() const { return _alignment; }
+	inline size_t			GetUsed() const { return _used; }
+	inline size_t			GetBlockCount() const { return _blockCount; }
+	inline size_t			GetFreeRangeCount() const { return _freeRanges.size(); }
+	size_t					GetLargestFreeRange() const;
+	// The fraction of the free space that is not in the largest free range.  0 means that all
+	// of the free space is in one piece.
+	float					GetFragmentation() const;
+
+private:
+	struct BlockEntry
+	{
+		GeometryBlock		Block;
+		bool				InUse;
+	};
+
+	size_t					_capacity;
+	size_t					_alignment;
+	size_t					_maximumCapacity;
+	size_t					_used;
+	size_t					_blockCount;
+	// Offset to size
+	map<size_t, size_t>		_freeRanges;
+	// Indexed by id.  Ids of freed blocks are reused.
+	vector<BlockEntry>		_blocks;
+	vector<GeometryBlockId>	_freeIds;
+
+	bool					Grow(size_t size);
+	void					AddFreeRange(size_t offset, size_t size);
+};
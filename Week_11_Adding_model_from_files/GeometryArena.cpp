@@ -0,0 +1,123 @@
+#include "GeometryArena.h"
+
+GeometryArena::GeometryArena(ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> deviceContext, UINT vertexStride) :
+	_vertexAllocator(InitialGeometryArenaVertexSize, vertexStride, MaximumGeometryArenaSize),
+	_indexAllocator(InitialGeometryArenaIndexSize, sizeof(UINT), MaximumGeometryArenaSize)
+{
+	_device = device;
+	_deviceContext = deviceContext;
+	_vertexStride = vertexStride;
+	ResizeBuffer(_vertexBuffer, D3D11_BIND_VERTEX_BUFFER, _vertexAllocator.GetCapacity());
+	ResizeBuffer(_indexBuffer, D3D11_BIND_INDEX_BUFFER, _indexAllocator.GetCapacity());
+}
+
+bool GeometryArena::Add(const void * vertices, size_t vertexCount, const void * indices, size_t indexCount, size_t indexSize, GeometryBlockId& vertexBlock, GeometryBlockId& indexBlock)
+{
+	vertexBlock = _vertexAllocator.Allocate(_vertexStride * vertexCount);
+	indexBlock = _indexAllocator.Allocate(indexSize * indexCount);
+	// Either allocator may have grown even if the other failed, so the buffers are brought up
+	// to size first
+	ResizeBuffer(_vertexBuffer, D3D11_BIND_VERTEX_BUFFER, _vertexAllocator.GetCapacity());
+	ResizeBuffer(_indexBuffer, D3D11_BIND_INDEX_BUFFER, _indexAllocator.GetCapacity());
+	if (vertexBlock == InvalidGeometryBlock || indexBlock == InvalidGeometryBlock)
+	{
+		Remove(vertexBlock, indexBlock);
+		vertexBlock = InvalidGeometryBlock;
+		indexBlock = InvalidGeometryBlock;
+		return false;
+	}
+	Upload(_vertexBuffer.Get(), _vertexAllocator.GetBlock(vertexBlock).Offset, vertices, _vertexStride * vertexCount);
+	Upload(_indexBuffer.Get(), _indexAllocator.GetBlock(indexBlock).Offset, indices, indexSize * indexCount);
+	return true;
+}
+
+bool GeometryArena::AddIndices(const void * indices, size_t indexCount, size_t indexSize, GeometryBlockId& indexBlock)
+{
+	indexBlock = _indexAllocator.Allocate(indexSize * indexCount);
+	ResizeBuffer(_indexBuffer, D3D11_BIND_INDEX_BUFFER, _indexAllocator.GetCapacity());
+	if (indexBlock == InvalidGeometryBlock)
+	{
+		return false;
+	}
+	Upload(_indexBuffer.Get(), _indexAllocator.GetBlock(indexBlock).Offset, indices, indexSize * indexCount);
+	return true;
+}
+
+void GeometryArena::Remove(GeometryBlockId vertexBlock, GeometryBlockId indexBlock)
+{
+	if (vertexBlock != InvalidGeometryBlock)
+	{
+		_vertexAllocator.Free(vertexBlock);
+	}
+	if (indexBlock != InvalidGeometryBlock)
+	{
+		_indexAllocator.Free(indexBlock);
+	}
+}
+
+void GeometryArena::Compact(float fragmentationThreshold)
+{
+	if (_vertexAllocator.GetFragmentation() > fragmentationThreshold)
+	{
+		CompactBuffer(_vertexBuffer, D3D11_BIND_VERTEX_BUFFER, _vertexAllocator);
+	}
+	if (_indexAllocator.GetFragmentation() > fragmentationThreshold)
+	{
+		CompactBuffer(_indexBuffer, D3D11_BIND_INDEX_BUFFER, _indexAllocator);
+	}
+}
+
+bool GeometryArena::ResizeBuffer(ComPtr<ID3D11Buffer>& buffer, UINT bindFlags, size_t capacity)
+{
+	size_t oldCapacity = 0;
+	if (buffer)
+	{
+		D3D11_BUFFER_DESC oldDescriptor;
+		buffer->GetDesc(&oldDescriptor);
+		oldCapacity = oldDescriptor.ByteWidth;
+		if (oldCapacity == capacity)
+		{
+			return false;
+		}
+	}
+	// Default usage rather than immutable, so that blocks can be written with UpdateSubresource
+	D3D11_BUFFER_DESC bufferDescriptor = { 0 };
+	bufferDescriptor.Usage = D3D11_USAGE_DEFAULT;
+	bufferDescriptor.ByteWidth = static_cast<UINT>(capacity);
+	bufferDescriptor.BindFlags = bindFlags;
+	ComPtr<ID3D11Buffer> newBuffer;
+	ThrowIfFailed(_device->CreateBuffer(&bufferDescriptor, nullptr, newBuffer.GetAddressOf()));
+	if (oldCapacity > 0)
+	{
+		// Growing does not move any blocks, so the old contents are copied as they are
+		D3D11_BOX box = { 0, 0, 0, static_cast<UINT>(oldCapacity), 1, 1 };
+		_deviceContext->CopySubresourceRegion(newBuffer.Get(), 0, 0, 0, 0, buffer.Get(), 0, &box);
+	}
+	buffer = newBuffer;
+	return true;
+}
+
+void GeometryArena::CompactBuffer(ComPtr<ID3D11Buffer>& buffer, UINT bindFlags, GeometryAllocator& allocator)
+{
+	// A region cannot be copied within the same buffer, so the blocks go into a new one
+	vector<GeometryMove> moves;
+	allocator.Defragment(moves);
+	D3D11_BUFFER_DESC bufferDescriptor = { 0 };
+	bufferDescriptor.Usage = D3D11_USAGE_DEFAULT;
+	bufferDescriptor.ByteWidth = static_cast<UINT>(allocator.GetCapacity());
+	bufferDescriptor.BindFlags = bindFlags;
+	ComPtr<ID3D11Buffer> newBuffer;
+	ThrowIfFailed(_device->CreateBuffer(&bufferDescriptor, nullptr, newBuffer.GetAddressOf()));
+	for (const GeometryMove& move : moves)
+	{
+		D3D11_BOX box = { static_cast<UINT>(move.From), 0, 0, static_cast<UINT>(move.From + move.Size), 1, 1 };
+		_deviceContext->CopySubresourceRegion(newBuffer.Get(), 0, static_cast<UINT>(move.To), 0, 0, buffer.Get(), 0, &box);
+	}
+	buffer = newBuffer;
+}
+
+void GeometryArena::Upload(ID3D11Buffer * buffer, size_t offset, const void * data, size_t size)
+{
+	D3D11_BOX box = { static_cast<UINT>(offset), 0, 0, static_cast<UINT>(offset + size), 1, 1 };
+	_deviceContext->UpdateSubresource(buffer, 0, &box, data, 0, 0);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "core.h"
+#include "DirectXCore.h"
+#include "GeometryAllocator.h"
+
+// One vertex buffer and one index buffer shared by the geometry of many sub-meshes.  Each
+// sub-mesh records the blocks it was given and is drawn with a base vertex and start index, so
+// drawing several sub-meshes or meshes from the same arena does not rebind any buffers.
+//
+// Every vertex in an arena has the same stride, so that block offsets are whole vertices.
+// Index blocks can hold 16 or 32-bit indices.  The buffers are replaced when the arena grows
+// or is defragmented, so the buffers and offsets must be asked for every frame rather than
+// kept.  Both happen outside rendering (when meshes are created and in ResourceManager::Update).
+
+// The buffers start at this size and grow as geometry is added
+const size_t InitialGeometryArenaVertexSize = 1024 * 1024;
+const size_t InitialGeometryArenaIndexSize = 256 * 1024;
+// The largest buffer every Direct3D 11 device has to support
+const size_t MaximumGeometryArenaSize = D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * 1024 * 1024;
+
+class GeometryArena
+{
+public:
+	GeometryArena(ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> deviceContext, UINT vertexStride);
+
+	// Copies the geometry into the arena, growing it if necessary.  Returns false if it does not
+	// fit, in which case nothing is allocated.
+	bool								Add(const void * vertices, size_t vertexCount, const void * indices, size_t indexCount, size_t indexSize, GeometryBlockId& vertexBlock, GeometryBlockId& indexBlock);
+	// Adds indices that refer to vertices already in the arena, such as the levels of detail of
+	// a sub-mesh
+	bool								AddIndices(const void * indices, size_t indexCount, size_t indexSize, GeometryBlockId& indexBlock);
+	// Either block can be InvalidGeometryBlock
+	void								Remove(GeometryBlockId vertexBlock, GeometryBlockId indexBlock);
+
+	// Packs the blocks together if more than the given fraction of the free space is outside
+	// the largest free range
+	void								Compact(float fragmentationThreshold);
+
+	inline ComPtr<ID3D11Buffer>			GetVertexBuffer() const { return _vertexBuffer; }
+	inline ComPtr<ID3D11Buffer>			GetIndexBuffer() const { return _indexBuffer; }
+	inline UINT							GetVertexStride() const { return _vertexStride; }
+	inline INT							GetBaseVertex(GeometryBlockId vertexBlock) const { return static_cast<INT>(_vertexAllocator.GetBlock(vertexBlock).Offset / _vertexStride); }
+	inline UINT							GetStartIndex(GeometryBlockId indexBlock, size_t indexSize) const { return static_cast<UINT>(_indexAllocator.GetBlock(indexBlock).Offset / indexSize); }
+	inline const GeometryAllocator&		GetVertexAllocator() const { return _vertexAllocator; }
+	inline const GeometryAllocator&		GetIndexAllocator() const { return _indexAllocator; }
+
+private:
+	ComPtr<ID3D11Device>				_device;
+	ComPtr<ID3D11DeviceContext>			_deviceContext;
+	UINT								_vertexStride;
+	GeometryAllocator					_vertexAllocator;
+	GeometryAllocator					_indexAllocator;
+	ComPtr<ID3D11Buffer>				_vertexBuffer;
+	ComPtr<ID3D11Buffer>				_indexBuffer;
+
+	// Makes the buffer match the capacity of the allocator, keeping its contents
+	bool								ResizeBuffer(ComPtr<ID3D11Buffer>& buffer, UINT bindFlags, size_t capacity);
+	void								CompactBuffer(ComPtr<ID3D11Buffer>& buffer, UINT bindFlags, GeometryAllocator& allocator);
+	void								Upload(ID3D11Buffer * buffer, size_t offset, const void * data, size_t size);
+};
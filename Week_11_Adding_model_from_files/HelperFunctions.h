@@ -1,13 +1,17 @@
-#pragma once
-
-// Various helper functions
-
-using namespace std;
-
-inline void ThrowIfFailed(HRESULT hr)
-{
-	if (FAILED(hr))
-	{
-		throw exception();
-	}
-}
+#pragma once
+
+// Various helper functions
+
+using namespace std;
+
+inline void ThrowIfFailed(HRESULT hr)
+{
+	if (FAILED(hr))
+	{
+		throw exception();
+	}
+}
+
+// Conversions between UTF-8 and wide strings (defined in ResourceManager.cpp)
+wstring s2ws(const std::string& str);
+string ws2s(const std::wstring& wstr);
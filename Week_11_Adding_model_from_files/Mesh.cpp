@@ -1,65 +1,111 @@
-#include "Mesh.h"
-
-// Material methods
-
-Material::Material(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, ComPtr<ID3D11ShaderResourceView> texture)
-{
-	_materialName = materialName;
-	_diffuseColour = diffuseColour;
-	_specularColour = specularColour;
-	_shininess = shininess;
-	_opacity = opacity;
-    _texture = texture;
-}
-
-Material::~Material(void)
-{
-}
-
-// SubMesh methods
-
-SubMesh::SubMesh(ComPtr<ID3D11Buffer> vertexBuffer,
-				ComPtr<ID3D11Buffer> indexBuffer,
-				size_t vertexCount,
-				size_t indexCount,
-				shared_ptr<Material> material,
-				bool hasNormals,
-				bool hasTexCoords)
-{			
-	_vertexBuffer = vertexBuffer;
-	_indexBuffer = indexBuffer;
-	_vertexCount = vertexCount;
-	_indexCount = indexCount;
-	_material = material;
-	_hasNormals = hasNormals;
-	_hasTexCoords = hasTexCoords;
-}
-
-SubMesh::~SubMesh(void)
-{
-}
-
-// Mesh methods
-
-size_t Mesh::GetSubMeshCount()
-{
-	return _subMeshList.size();
-}
-
-shared_ptr<SubMesh> Mesh::GetSubMesh(unsigned int i)
-{
-	if (i >= 0 && i < _subMeshList.size())
-	{
-		return _subMeshList[i];
-	}
-	else
-	{
-		return nullptr;
-	}
-}
-
-void Mesh::AddSubMesh(shared_ptr<SubMesh> subMesh)
-{
-	_subMeshList.push_back(subMesh);
-}
-
+#include "Mesh.h"
+
+// Material methods
+
+Material::Material(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, ComPtr<ID3D11ShaderResourceView> texture, ComPtr<ID3D11Buffer> constantBuffer)
+{
+	_materialName = materialName;
+	_diffuseColour = diffuseColour;
+	_specularColour = specularColour;
+	_shininess = shininess;
+	_opacity = opacity;
+    _texture = texture;
+	_constantBuffer = constantBuffer;
+}
+
+Material::~Material(void)
+{
+}
+
+// SubMesh methods
+
+SubMesh::SubMesh(const SubMeshGeometry& geometry,
+				size_t vertexCount,
+				size_t indexCount,
+				DXGI_FORMAT indexFormat,
+				shared_ptr<Material> material,
+				bool hasNormals,
+				bool hasTexCoords,
+				const BoundingBox& bounds,
+				ComPtr<ID3D11Buffer> meshConstantBuffer)
+{			
+	_geometry = geometry;
+	_vertexCount = vertexCount;
+	_indexCount = indexCount;
+	_indexFormat = indexFormat;
+	_material = material;
+	_hasNormals = hasNormals;
+	_hasTexCoords = hasTexCoords;
+	_bounds = bounds;
+	_meshConstantBuffer = meshConstantBuffer;
+}
+
+SubMesh::~SubMesh(void)
+{
+	// Give the blocks back to the arena
+	if (_geometry.Arena)
+	{
+		_geometry.Arena->Remove(_geometry.VertexBlock, _geometry.IndexBlock);
+		for (const SubMeshLod& lod : _lods)
+		{
+			_geometry.Arena->Remove(InvalidGeometryBlock, lod.IndexBlock);
+		}
+	}
+}
+
+bool SubMesh::AddLod(const void * indices, size_t indexCount, float error)
+{
+	SubMeshLod lod;
+	if (!_geometry.Arena || !_geometry.Arena->AddIndices(indices, indexCount, GetIndexFormatSize(_indexFormat), lod.IndexBlock))
+	{
+		return false;
+	}
+	lod.IndexCount = indexCount;
+	lod.Error = error;
+	_lods.push_back(lod);
+	return true;
+}
+
+size_t SubMesh::SelectLod(float allowedError)
+{
+	// The errors only grow down the chain
+	size_t lod = 0;
+	while (lod < _lods.size() && _lods[lod].Error <= allowedError)
+	{
+		lod++;
+	}
+	return lod;
+}
+
+// Mesh methods
+
+size_t Mesh::GetSubMeshCount()
+{
+	return _subMeshList.size();
+}
+
+shared_ptr<SubMesh> Mesh::GetSubMesh(unsigned int i)
+{
+	if (i >= 0 && i < _subMeshList.size())
+	{
+		return _subMeshList[i];
+	}
+	else
+	{
+		return nullptr;
+	}
+}
+
+void Mesh::AddSubMesh(shared_ptr<SubMesh> subMesh)
+{
+	if (_subMeshList.empty())
+	{
+		_bounds = subMesh->GetBounds();
+	}
+	else
+	{
+		BoundingBox::CreateMerged(_bounds, _bounds, subMesh->GetBounds());
+	}
+	_subMeshList.push_back(subMesh);
+}
+
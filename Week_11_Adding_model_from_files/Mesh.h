@@ -1,90 +1,170 @@
-#pragma once
-#include "core.h"
-#include "DirectXCore.h"
-#include <vector>
-#include <memory>
-#include "SimpleMath.h"
-
-using namespace DirectX::SimpleMath;
-
-struct Vertex
-{
-	Vector3 Position;
-	Vector3 Normal;
-	Vector2 TexCoord;
-};
-
-
-// Core material class.  Ideally, this should be extended to include more material attributes that can be
-// recovered from Assimp, but this handles the basics.
-
-class Material
-{
-public:
-	Material(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, ComPtr<ID3D11ShaderResourceView> texture );
-	~Material();
-
-	inline wstring							GetMaterialName() { return _materialName;  }
-	inline Vector4							GetDiffuseColour() { return _diffuseColour; }
-	inline Vector4							GetSpecularColour() { return _specularColour; }
-	inline float							GetShininess() { return _shininess; }
-	inline float							GetOpacity() { return _opacity; }
-	inline ComPtr<ID3D11ShaderResourceView>	GetTexture() { return _texture; }
-
-private:
-	wstring									_materialName;
-	Vector4									_diffuseColour;
-	Vector4									_specularColour;
-	float									_shininess;
-	float									_opacity;
-    ComPtr<ID3D11ShaderResourceView>		_texture;
-};
-
-// Basic SubMesh class.  A Mesh consists of one or more sub-meshes.  The submesh provides everything that is needed to
-// draw the sub-mesh.
-
-class SubMesh
-{
-public:
-	SubMesh(ComPtr<ID3D11Buffer> vertexBuffer,
-		ComPtr<ID3D11Buffer> indexBuffer,
-		size_t vertexCount,
-		size_t indexCount,
-		shared_ptr<Material> material,
-		bool hasNormals,
-		bool hasTexCoords);
-		
-	~SubMesh();
-
-	inline ComPtr<ID3D11Buffer>			GetVertexBuffer() { return _vertexBuffer; }
-	inline ComPtr<ID3D11Buffer>			GetIndexBuffer() { return _indexBuffer; }
-	inline shared_ptr<Material>			GetMaterial() { return _material; }
-	inline size_t						GetVertexCount() { return _vertexCount; }
-	inline size_t						GetIndexCount() { return _indexCount; }
-	inline bool							HasNormals() { return _hasNormals; }
-	inline bool							HasTexCoords() { return _hasTexCoords; }
-
-private:
-   	ComPtr<ID3D11Buffer>				_vertexBuffer;
-	ComPtr<ID3D11Buffer>				_indexBuffer;
-	shared_ptr<Material>				_material;
-	size_t								_vertexCount;
-	size_t								_indexCount;
-	bool								_hasNormals;
-	bool								_hasTexCoords;
-};
-
-// Core mesh class
-
-class Mesh
-{
-public:
-	size_t								GetSubMeshCount();
-	shared_ptr<SubMesh>					GetSubMesh(unsigned int i);
-	void								AddSubMesh(shared_ptr<SubMesh> subMesh);
-
-private:
-	vector<shared_ptr<SubMesh>> 		_subMeshList;
-};
-
-
+#pragma once
+#include "core.h"
+#include "DirectXCore.h"
+#include <vector>
+#include <memory>
+#include "SimpleMath.h"
+#include "VertexQuantiser.h"
+#include "GeometryArena.h"
+
+using namespace DirectX::SimpleMath;
+
+struct Vertex
+{
+	Vector3 Position;
+	Vector3 Normal;
+	Vector2 TexCoord;
+};
+
+// Meshes with few enough vertices use 16-bit indices, which halves the size of the index buffer
+inline DXGI_FORMAT ChooseIndexFormat(size_t vertexCount)
+{
+	return vertexCount <= 0x10000 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+}
+
+inline size_t GetIndexFormatSize(DXGI_FORMAT indexFormat)
+{
+	return indexFormat == DXGI_FORMAT_R16_UINT ? sizeof(uint16_t) : sizeof(UINT);
+}
+
+// The indices must all be less than 0x10000
+inline void CopyIndicesTo16Bit(const UINT * indices, size_t indexCount, uint16_t * indices16)
+{
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		indices16[i] = static_cast<uint16_t>(indices[i]);
+	}
+}
+
+
+// Core material class.  Ideally, this should be extended to include more material attributes that can be
+// recovered from Assimp, but this handles the basics.
+
+class Material
+{
+public:
+	Material(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, ComPtr<ID3D11ShaderResourceView> texture, ComPtr<ID3D11Buffer> constantBuffer);
+	~Material();
+
+	inline wstring							GetMaterialName() { return _materialName;  }
+	inline Vector4							GetDiffuseColour() { return _diffuseColour; }
+	inline Vector4							GetSpecularColour() { return _specularColour; }
+	inline float							GetShininess() { return _shininess; }
+	inline float							GetOpacity() { return _opacity; }
+	inline ComPtr<ID3D11ShaderResourceView>	GetTexture() { return _texture; }
+	// Immutable buffer holding the MaterialConstants for this material
+	inline ComPtr<ID3D11Buffer>				GetConstantBuffer() { return _constantBuffer; }
+
+private:
+	wstring									_materialName;
+	Vector4									_diffuseColour;
+	Vector4									_specularColour;
+	float									_shininess;
+	float									_opacity;
+    ComPtr<ID3D11ShaderResourceView>		_texture;
+	ComPtr<ID3D11Buffer>					_constantBuffer;
+};
+
+// Where the vertices and indices of a sub-mesh are.  Sub-meshes normally have blocks in a shared
+// GeometryArena, but can have buffers of their own.
+struct SubMeshGeometry
+{
+	shared_ptr<GeometryArena>			Arena;
+	GeometryBlockId						VertexBlock;
+	GeometryBlockId						IndexBlock;
+	// Only used if there is no arena
+	ComPtr<ID3D11Buffer>				VertexBuffer;
+	ComPtr<ID3D11Buffer>				IndexBuffer;
+};
+
+// A simplified level of detail of a sub-mesh (see MeshSimplifier.h).  It has only indices,
+// which refer to the vertices of the full sub-mesh.
+struct SubMeshLod
+{
+	GeometryBlockId						IndexBlock;
+	size_t								IndexCount;
+	// Distance from the full sub-mesh, in model units
+	float								Error;
+};
+
+// Basic SubMesh class.  A Mesh consists of one or more sub-meshes.  The submesh provides everything that is needed to
+// draw the sub-mesh.
+
+class SubMesh
+{
+public:
+	SubMesh(const SubMeshGeometry& geometry,
+		size_t vertexCount,
+		size_t indexCount,
+		DXGI_FORMAT indexFormat,
+		shared_ptr<Material> material,
+		bool hasNormals,
+		bool hasTexCoords,
+		const BoundingBox& bounds,
+		ComPtr<ID3D11Buffer> meshConstantBuffer = nullptr);
+		
+	~SubMesh();
+
+	// The buffers of an arena change when it grows or is compacted, so these and the offsets
+	// below must be asked for each time the sub-mesh is drawn
+	inline ComPtr<ID3D11Buffer>			GetVertexBuffer() { return _geometry.Arena ? _geometry.Arena->GetVertexBuffer() : _geometry.VertexBuffer; }
+	inline ComPtr<ID3D11Buffer>			GetIndexBuffer() { return _geometry.Arena ? _geometry.Arena->GetIndexBuffer() : _geometry.IndexBuffer; }
+	// The offsets to pass to DrawIndexed
+	inline INT							GetBaseVertex() { return _geometry.Arena ? _geometry.Arena->GetBaseVertex(_geometry.VertexBlock) : 0; }
+	inline UINT							GetStartIndex() { return _geometry.Arena ? _geometry.Arena->GetStartIndex(_geometry.IndexBlock, GetIndexFormatSize(_indexFormat)) : 0; }
+
+	// Adds the next level of detail.  Levels must be added from the most detailed down, and can
+	// only be added to sub-meshes in an arena.  Returns false if the level was not added.
+	bool								AddLod(const void * indices, size_t indexCount, float error);
+	// The number of levels after the full sub-mesh, which is level 0
+	inline size_t						GetLodCount() { return _lods.size(); }
+	// The least detailed level whose error is no more than allowedError
+	size_t								SelectLod(float allowedError);
+	inline size_t						GetIndexCount(size_t lod) { return lod == 0 ? _indexCount : _lods[lod - 1].IndexCount; }
+	inline UINT							GetStartIndex(size_t lod) { return lod == 0 ? GetStartIndex() : _geometry.Arena->GetStartIndex(_lods[lod - 1].IndexBlock, GetIndexFormatSize(_indexFormat)); }
+	inline shared_ptr<Material>			GetMaterial() { return _material; }
+	inline size_t						GetVertexCount() { return _vertexCount; }
+	inline size_t						GetIndexCount() { return _indexCount; }
+	// DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT
+	inline DXGI_FORMAT					GetIndexFormat() { return _indexFormat; }
+	inline UINT							GetIndexSize() { return static_cast<UINT>(GetIndexFormatSize(_indexFormat)); }
+	inline bool							HasNormals() { return _hasNormals; }
+	inline bool							HasTexCoords() { return _hasTexCoords; }
+	inline const BoundingBox&			GetBounds() { return _bounds; }
+	// Sub-meshes with a mesh constant buffer hold QuantisedVertex rather than Vertex and must
+	// be drawn with the VSQuantised shaders, with the buffer bound to MeshConstantsRegister
+	inline bool							IsQuantised() { return _meshConstantBuffer != nullptr; }
+	inline ComPtr<ID3D11Buffer>			GetMeshConstantBuffer() { return _meshConstantBuffer; }
+	inline UINT							GetVertexStride() { return IsQuantised() ? sizeof(QuantisedVertex) : sizeof(Vertex); }
+
+private:
+	SubMeshGeometry						_geometry;
+	shared_ptr<Material>				_material;
+	size_t								_vertexCount;
+	size_t								_indexCount;
+	DXGI_FORMAT							_indexFormat;
+	bool								_hasNormals;
+	bool								_hasTexCoords;
+	BoundingBox							_bounds;
+	ComPtr<ID3D11Buffer>				_meshConstantBuffer;
+	vector<SubMeshLod>					_lods;
+};
+
+// Core mesh class
+
+class Mesh
+{
+public:
+	size_t								GetSubMeshCount();
+	shared_ptr<SubMesh>					GetSubMesh(unsigned int i);
+	void								AddSubMesh(shared_ptr<SubMesh> subMesh);
+
+	// Bounding box enclosing all of the sub-meshes
+	inline const BoundingBox&			GetBounds() { return _bounds; }
+
+private:
+	vector<shared_ptr<SubMesh>> 		_subMeshList;
+	BoundingBox							_bounds;
+};
+
+
@@ -0,0 +1,359 @@
+#include "MeshCache.h"
+#include <fstream>
+
+static size_t AlignOffset(size_t offset)
+{
+	return (offset + 15) & ~static_cast<size_t>(15);
+}
+
+static MeshCacheBounds MakeCacheBounds(const BoundingBox& boundingBox)
+{
+	MeshCacheBounds bounds;
+	bounds.Centre[0] = boundingBox.Center.x;
+	bounds.Centre[1] = boundingBox.Center.y;
+	bounds.Centre[2] = boundingBox.Center.z;
+	bounds.Extents[0] = boundingBox.Extents.x;
+	bounds.Extents[1] = boundingBox.Extents.y;
+	bounds.Extents[2] = boundingBox.Extents.z;
+	return bounds;
+}
+
+static BoundingBox GetVertexBounds(const vector<Vertex>& vertices)
+{
+	BoundingBox bounds;
+	if (!vertices.empty())
+	{
+		BoundingBox::CreateFromPoints(bounds, vertices.size(), &vertices[0].Position, sizeof(Vertex));
+	}
+	return bounds;
+}
+
+// Returns true if the block of the given size at the offset lies inside the data
+static bool BlockInside(uint64_t offset, uint64_t size, size_t dataSize)
+{
+	return offset <= dataSize && size <= dataSize - offset;
+}
+
+static void CopyIndices(const vector<UINT>& indices, size_t indexSize, BYTE * destination)
+{
+	if (indexSize == sizeof(uint16_t))
+	{
+		CopyIndicesTo16Bit(indices.data(), indices.size(), reinterpret_cast<uint16_t *>(destination));
+	}
+	else
+	{
+		memcpy(destination, indices.data(), sizeof(UINT) * indices.size());
+	}
+}
+
+bool QuantiseImportedSubMesh(ImportedSubMesh& subMesh, const QuantisationError& tolerance)
+{
+	// Quantised across the same bounds that BuildMeshCache stores for the sub-mesh, which are
+	// what the mesh constants are made from when it is loaded
+	MeshCacheBounds bounds = MakeCacheBounds(GetVertexBounds(subMesh.Vertices));
+	vector<QuantisedVertex> quantisedVertices(subMesh.Vertices.size());
+	QuantisationError error;
+	QuantiseVertices(subMesh.Vertices.data(), subMesh.Vertices.size(), sizeof(Vertex), MakeQuantisationBounds(bounds.Centre, bounds.Extents), quantisedVertices.data(), error);
+	if (!IsWithinTolerance(error, tolerance))
+	{
+		return false;
+	}
+	subMesh.QuantisedVertices.swap(quantisedVertices);
+	return true;
+}
+
+void BuildMeshCache(const vector<ImportedMaterial>& materials, const vector<ImportedSubMesh>& subMeshes, const MeshSourceStamp& source, vector<BYTE>& data)
+{
+	// Work out where everything goes first so that the data only needs to be allocated once
+	size_t subMeshTableOffset = AlignOffset(sizeof(MeshCacheHeader));
+	size_t offset = AlignOffset(subMeshTableOffset + sizeof(MeshCacheSubMesh) * subMeshes.size());
+	vector<size_t> lodTableOffsets(subMeshes.size());
+	for (size_t i = 0; i < subMeshes.size(); i++)
+	{
+		lodTableOffsets[i] = offset;
+		offset += sizeof(MeshCacheLod) * subMeshes[i].Lods.size();
+	}
+	size_t materialTableOffset = AlignOffset(offset);
+	offset = materialTableOffset + sizeof(MeshCacheMaterial) * materials.size();
+	vector<size_t> textureNameOffsets(materials.size());
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		textureNameOffsets[i] = offset;
+		offset += materials[i].TextureName.size();
+	}
+	vector<size_t> vertexOffsets(subMeshes.size());
+	for (size_t i = 0; i < subMeshes.size(); i++)
+	{
+		offset = AlignOffset(offset);
+		vertexOffsets[i] = offset;
+		offset += subMeshes[i].QuantisedVertices.empty() ? sizeof(Vertex) * subMeshes[i].Vertices.size() : sizeof(QuantisedVertex) * subMeshes[i].QuantisedVertices.size();
+	}
+	vector<size_t> indexOffsets(subMeshes.size());
+	vector<size_t> indexSizes(subMeshes.size());
+	for (size_t i = 0; i < subMeshes.size(); i++)
+	{
+		offset = AlignOffset(offset);
+		indexOffsets[i] = offset;
+		indexSizes[i] = GetIndexFormatSize(ChooseIndexFormat(subMeshes[i].Vertices.size()));
+		offset += indexSizes[i] * subMeshes[i].Indices.size();
+	}
+	vector<vector<size_t>> lodIndexOffsets(subMeshes.size());
+	for (size_t i = 0; i < subMeshes.size(); i++)
+	{
+		for (const MeshLod& lod : subMeshes[i].Lods)
+		{
+			offset = AlignOffset(offset);
+			lodIndexOffsets[i].push_back(offset);
+			offset += indexSizes[i] * lod.Indices.size();
+		}
+	}
+	data.assign(AlignOffset(offset), 0);
+
+	MeshCacheHeader * header = reinterpret_cast<MeshCacheHeader *>(data.data());
+	header->Magic = MeshCacheMagic;
+	header->Version = MeshCacheVersion;
+	header->VertexStride = sizeof(Vertex);
+	header->Source = source;
+	header->FileSize = data.size();
+	header->SubMeshCount = static_cast<uint32_t>(subMeshes.size());
+	header->MaterialCount = static_cast<uint32_t>(materials.size());
+	header->SubMeshTableOffset = subMeshTableOffset;
+	header->MaterialTableOffset = materialTableOffset;
+
+	MeshCacheMaterial * cacheMaterials = reinterpret_cast<MeshCacheMaterial *>(data.data() + materialTableOffset);
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		const ImportedMaterial& material = materials[i];
+		MeshCacheMaterial& cacheMaterial = cacheMaterials[i];
+		memcpy(cacheMaterial.DiffuseColour, &material.DiffuseColour, sizeof(cacheMaterial.DiffuseColour));
+		memcpy(cacheMaterial.SpecularColour, &material.SpecularColour, sizeof(cacheMaterial.SpecularColour));
+		cacheMaterial.Shininess = material.Shininess;
+		cacheMaterial.Opacity = material.Opacity;
+		cacheMaterial.TextureNameOffset = textureNameOffsets[i];
+		cacheMaterial.TextureNameLength = static_cast<uint32_t>(material.TextureName.size());
+		memcpy(data.data() + textureNameOffsets[i], material.TextureName.data(), material.TextureName.size());
+	}
+
+	MeshCacheSubMesh * cacheSubMeshes = reinterpret_cast<MeshCacheSubMesh *>(data.data() + subMeshTableOffset);
+	BoundingBox meshBounds;
+	for (size_t i = 0; i < subMeshes.size(); i++)
+	{
+		const ImportedSubMesh& subMesh = subMeshes[i];
+		MeshCacheSubMesh& cacheSubMesh = cacheSubMeshes[i];
+		cacheSubMesh.VertexOffset = vertexOffsets[i];
+		cacheSubMesh.IndexOffset = indexOffsets[i];
+		cacheSubMesh.VertexCount = static_cast<uint32_t>(subMesh.Vertices.size());
+		cacheSubMesh.IndexCount = static_cast<uint32_t>(subMesh.Indices.size());
+		cacheSubMesh.MaterialIndex = subMesh.MaterialIndex;
+		cacheSubMesh.Flags = (subMesh.HasNormals ? MeshCacheHasNormals : 0) | (subMesh.HasTexCoords ? MeshCacheHasTexCoords : 0) |
+							 (indexSizes[i] == sizeof(uint16_t) ? MeshCache16BitIndices : 0) |
+							 (subMesh.QuantisedVertices.empty() ? 0 : MeshCacheQuantisedVertices);
+		BoundingBox bounds = GetVertexBounds(subMesh.Vertices);
+		cacheSubMesh.Bounds = MakeCacheBounds(bounds);
+		if (i == 0)
+		{
+			meshBounds = bounds;
+		}
+		else
+		{
+			BoundingBox::CreateMerged(meshBounds, meshBounds, bounds);
+		}
+		if (subMesh.QuantisedVertices.empty())
+		{
+			memcpy(data.data() + vertexOffsets[i], subMesh.Vertices.data(), sizeof(Vertex) * subMesh.Vertices.size());
+		}
+		else
+		{
+			memcpy(data.data() + vertexOffsets[i], subMesh.QuantisedVertices.data(), sizeof(QuantisedVertex) * subMesh.QuantisedVertices.size());
+		}
+		CopyIndices(subMesh.Indices, indexSizes[i], data.data() + indexOffsets[i]);
+
+		cacheSubMesh.LodTableOffset = lodTableOffsets[i];
+		cacheSubMesh.LodCount = static_cast<uint32_t>(subMesh.Lods.size());
+		MeshCacheLod * cacheLods = reinterpret_cast<MeshCacheLod *>(data.data() + lodTableOffsets[i]);
+		for (size_t l = 0; l < subMesh.Lods.size(); l++)
+		{
+			cacheLods[l].IndexOffset = lodIndexOffsets[i][l];
+			cacheLods[l].IndexCount = static_cast<uint32_t>(subMesh.Lods[l].Indices.size());
+			cacheLods[l].Error = subMesh.Lods[l].Error;
+			CopyIndices(subMesh.Lods[l].Indices, indexSizes[i], data.data() + lodIndexOffsets[i][l]);
+		}
+	}
+	header->Bounds = MakeCacheBounds(meshBounds);
+}
+
+bool WriteMeshCache(const wstring& fileName, const vector<BYTE>& data)
+{
+	wstring temporaryFileName = fileName + L".tmp";
+	{
+		ofstream file(temporaryFileName, ios::binary | ios::trunc);
+		if (!file)
+		{
+			return false;
+		}
+		file.write(reinterpret_cast<const char *>(data.data()), data.size());
+		if (!file)
+		{
+			return false;
+		}
+	}
+	return MoveFileExW(temporaryFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+bool GetMeshSourceStamp(const wstring& fileName, MeshSourceStamp& source)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExW(fileName.c_str(), GetFileExInfoStandard, &attributes))
+	{
+		return false;
+	}
+	source.Size = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+	source.WriteTime = (static_cast<uint64_t>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+// MeshCacheView methods
+
+MeshCacheView::MeshCacheView()
+{
+	_data = nullptr;
+	_header = nullptr;
+	_subMeshes = nullptr;
+	_materials = nullptr;
+}
+
+bool MeshCacheView::Open(const BYTE * data, size_t size, const MeshSourceStamp& source)
+{
+	if (data == nullptr || size < sizeof(MeshCacheHeader))
+	{
+		return false;
+	}
+	const MeshCacheHeader * header = reinterpret_cast<const MeshCacheHeader *>(data);
+	if (header->Magic != MeshCacheMagic ||
+		header->Version != MeshCacheVersion ||
+		header->VertexStride != sizeof(Vertex) ||
+		header->FileSize != size ||
+		header->Source.Size != source.Size ||
+		header->Source.WriteTime != source.WriteTime)
+	{
+		return false;
+	}
+	if (header->SubMeshCount == 0 ||
+		!BlockInside(header->SubMeshTableOffset, sizeof(MeshCacheSubMesh) * static_cast<uint64_t>(header->SubMeshCount), size) ||
+		!BlockInside(header->MaterialTableOffset, sizeof(MeshCacheMaterial) * static_cast<uint64_t>(header->MaterialCount), size))
+	{
+		return false;
+	}
+	const MeshCacheSubMesh * subMeshes = reinterpret_cast<const MeshCacheSubMesh *>(data + header->SubMeshTableOffset);
+	const MeshCacheMaterial * materials = reinterpret_cast<const MeshCacheMaterial *>(data + header->MaterialTableOffset);
+	for (uint32_t i = 0; i < header->SubMeshCount; i++)
+	{
+		const MeshCacheSubMesh& subMesh = subMeshes[i];
+		if (subMesh.VertexCount == 0 ||
+			subMesh.IndexCount == 0 ||
+			!BlockInside(subMesh.VertexOffset, GetVertexStride(subMesh) * static_cast<uint64_t>(subMesh.VertexCount), size) ||
+			!BlockInside(subMesh.IndexOffset, GetIndexSize(subMesh) * static_cast<uint64_t>(subMesh.IndexCount), size) ||
+			(subMesh.MaterialIndex != MeshCacheNoMaterial && subMesh.MaterialIndex >= header->MaterialCount) ||
+			!BlockInside(subMesh.LodTableOffset, sizeof(MeshCacheLod) * static_cast<uint64_t>(subMesh.LodCount), size))
+		{
+			return false;
+		}
+		const MeshCacheLod * lods = reinterpret_cast<const MeshCacheLod *>(data + subMesh.LodTableOffset);
+		for (uint32_t l = 0; l < subMesh.LodCount; l++)
+		{
+			if (lods[l].IndexCount == 0 ||
+				!BlockInside(lods[l].IndexOffset, GetIndexSize(subMesh) * static_cast<uint64_t>(lods[l].IndexCount), size))
+			{
+				return false;
+			}
+		}
+	}
+	for (uint32_t i = 0; i < header->MaterialCount; i++)
+	{
+		if (!BlockInside(materials[i].TextureNameOffset, materials[i].TextureNameLength, size))
+		{
+			return false;
+		}
+	}
+	_data = data;
+	_header = header;
+	_subMeshes = subMeshes;
+	_materials = materials;
+	return true;
+}
+
+string MeshCacheView::GetTextureName(const MeshCacheMaterial& material) const
+{
+	return string(reinterpret_cast<const char *>(_data + material.TextureNameOffset), material.TextureNameLength);
+}
+
+BoundingBox MeshCacheView::GetBoundingBox(const MeshCacheBounds& bounds)
+{
+	return BoundingBox(XMFLOAT3(bounds.Centre[0], bounds.Centre[1], bounds.Centre[2]),
+					   XMFLOAT3(bounds.Extents[0], bounds.Extents[1], bounds.Extents[2]));
+}
+
+// MappedFile methods
+
+MappedFile::MappedFile()
+{
+	_file = INVALID_HANDLE_VALUE;
+	_mapping = nullptr;
+	_data = nullptr;
+	_size = 0;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const wstring& fileName)
+{
+	Close();
+	_file = CreateFileW(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (_file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(_file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	_mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+	_data = static_cast<const BYTE *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+	_size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (_data != nullptr)
+	{
+		UnmapViewOfFile(_data);
+		_data = nullptr;
+	}
+	if (_mapping != nullptr)
+	{
+		CloseHandle(_mapping);
+		_mapping = nullptr;
+	}
+	if (_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(_file);
+		_file = INVALID_HANDLE_VALUE;
+	}
+	_size = 0;
+}
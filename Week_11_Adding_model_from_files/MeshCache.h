@@ -0,0 +1,192 @@
+#pragma once
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Binary cache of models imported by Assimp.  The first time a model is loaded, the vertices,
+// indices, materials and bounds that ResourceManager builds from the Assimp scene are written to
+// a file in the MeshCache directory.  Later loads map that file into memory and pass the vertex
+// and index blocks straight to CreateBuffer, without running the importer at all.
+//
+// A cache file is laid out as follows, with every block starting on a 16 byte boundary:
+//
+//		MeshCacheHeader
+//		MeshCacheSubMesh[SubMeshCount]
+//		MeshCacheLod[LodCount] for each sub-mesh
+//		MeshCacheMaterial[MaterialCount]
+//		Texture names (UTF-8, not terminated)
+//		Vertex blocks (Vertex or QuantisedVertex[VertexCount] for each sub-mesh)
+//		Index blocks (uint16_t or UINT[IndexCount] for each sub-mesh)
+//		LOD index blocks (uint16_t or UINT[IndexCount] for each level of each sub-mesh)
+//
+// The header records the size and modification time of the model file, so a cache is rebuilt
+// when the model changes.  Increase MeshCacheVersion whenever the layout, the Vertex structure
+// or the way models are imported changes.
+
+const uint32_t MeshCacheMagic = 0x4853454D;		// "MESH"
+const uint32_t MeshCacheVersion = 5;
+
+// Identifies the version of the model file that a cache was built from
+struct MeshSourceStamp
+{
+	uint64_t				Size;
+	uint64_t				WriteTime;
+};
+
+struct MeshCacheBounds
+{
+	float					Centre[3];
+	float					Extents[3];
+};
+
+struct MeshCacheHeader
+{
+	uint32_t				Magic;
+	uint32_t				Version;
+	uint32_t				VertexStride;
+	uint32_t				SubMeshCount;
+	uint32_t				MaterialCount;
+	uint32_t				Padding0;
+	MeshSourceStamp			Source;
+	uint64_t				FileSize;
+	uint64_t				SubMeshTableOffset;
+	uint64_t				MaterialTableOffset;
+	MeshCacheBounds			Bounds;
+	uint32_t				Padding[2];
+};
+
+const uint32_t MeshCacheHasNormals = 1;
+const uint32_t MeshCacheHasTexCoords = 2;
+// The indices are 16-bit rather than 32-bit (see ChooseIndexFormat)
+const uint32_t MeshCache16BitIndices = 4;
+// The vertices are QuantisedVertex, quantised across the bounds of the sub-mesh
+const uint32_t MeshCacheQuantisedVertices = 8;
+// Used as the material index of a sub-mesh that has no material
+const uint32_t MeshCacheNoMaterial = 0xFFFFFFFF;
+
+struct MeshCacheSubMesh
+{
+	uint64_t				VertexOffset;
+	uint64_t				IndexOffset;
+	uint32_t				VertexCount;
+	uint32_t				IndexCount;
+	uint32_t				MaterialIndex;
+	uint32_t				Flags;
+	MeshCacheBounds			Bounds;
+	uint64_t				LodTableOffset;
+	uint32_t				LodCount;
+	uint32_t				Padding;
+};
+
+// A simplified level of detail of a sub-mesh (see MeshSimplifier.h).  The indices refer to the
+// vertices of the sub-mesh and are the same size as its own.
+struct MeshCacheLod
+{
+	uint64_t				IndexOffset;
+	uint32_t				IndexCount;
+	// Distance from the full sub-mesh, in model units
+	float					Error;
+};
+
+struct MeshCacheMaterial
+{
+	float					DiffuseColour[4];
+	float					SpecularColour[4];
+	float					Shininess;
+	float					Opacity;
+	// Offset of the texture file name from the start of the file.  The length is 0 if the
+	// material has no texture.
+	uint64_t				TextureNameOffset;
+	uint32_t				TextureNameLength;
+	uint32_t				Padding;
+};
+
+// The data that ResourceManager pulls out of an Assimp scene, used to build a cache file
+struct ImportedMaterial
+{
+	Vector4					DiffuseColour;
+	Vector4					SpecularColour;
+	float					Shininess;
+	float					Opacity;
+	string					TextureName;
+};
+
+struct ImportedSubMesh
+{
+	vector<Vertex>			Vertices;
+	vector<UINT>			Indices;
+	// If this is not empty, it is stored instead of Vertices (see QuantiseImportedSubMesh)
+	vector<QuantisedVertex>	QuantisedVertices;
+	// Simplified levels of detail, from the most detailed down
+	vector<MeshLod>			Lods;
+	uint32_t				MaterialIndex;
+	bool					HasNormals;
+	bool					HasTexCoords;
+};
+
+// Quantises the vertices across their bounds if the error is within the tolerance, so that the
+// sub-mesh is stored in the quantised format.  Returns true if it was quantised.
+bool QuantiseImportedSubMesh(ImportedSubMesh& subMesh, const QuantisationError& tolerance);
+
+// Lays out the imported model in the cache format
+void BuildMeshCache(const vector<ImportedMaterial>& materials, const vector<ImportedSubMesh>& subMeshes, const MeshSourceStamp& source, vector<BYTE>& data);
+
+// Writes the cache to a temporary file and then renames it, so that a partly written file is
+// never picked up.  Returns false if the file could not be written.
+bool WriteMeshCache(const wstring& fileName, const vector<BYTE>& data);
+
+// Gets the size and modification time of a model file.  Returns false if it does not exist.
+bool GetMeshSourceStamp(const wstring& fileName, MeshSourceStamp& source);
+
+// Read-only access to cache data, either mapped from a file or built in memory.  Open checks
+// that every table and block lies inside the data before anything is read from it.
+class MeshCacheView
+{
+public:
+	MeshCacheView();
+
+	bool						Open(const BYTE * data, size_t size, const MeshSourceStamp& source);
+
+	inline const MeshCacheHeader&	GetHeader() const { return *_header; }
+	inline const MeshCacheSubMesh&	GetSubMesh(size_t i) const { return _subMeshes[i]; }
+	inline const MeshCacheMaterial&	GetMaterial(size_t i) const { return _materials[i]; }
+	inline const MeshCacheLod&	GetLod(const MeshCacheSubMesh& subMesh, size_t i) const { return reinterpret_cast<const MeshCacheLod *>(_data + subMesh.LodTableOffset)[i]; }
+	inline const void *			GetVertices(const MeshCacheSubMesh& subMesh) const { return _data + subMesh.VertexOffset; }
+	static inline size_t		GetVertexStride(const MeshCacheSubMesh& subMesh) { return (subMesh.Flags & MeshCacheQuantisedVertices) != 0 ? sizeof(QuantisedVertex) : sizeof(Vertex); }
+	inline const void *			GetIndices(const MeshCacheSubMesh& subMesh) const { return _data + subMesh.IndexOffset; }
+	inline const void *			GetIndices(const MeshCacheLod& lod) const { return _data + lod.IndexOffset; }
+	static inline size_t		GetIndexSize(const MeshCacheSubMesh& subMesh) { return (subMesh.Flags & MeshCache16BitIndices) != 0 ? sizeof(uint16_t) : sizeof(UINT); }
+	string						GetTextureName(const MeshCacheMaterial& material) const;
+
+	static BoundingBox			GetBoundingBox(const MeshCacheBounds& bounds);
+
+private:
+	const BYTE *				_data;
+	const MeshCacheHeader *		_header;
+	const MeshCacheSubMesh *	_subMeshes;
+	const MeshCacheMaterial *	_materials;
+};
+
+// A file mapped read-only into memory.  The view is unmapped when this is destroyed.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool						Open(const wstring& fileName);
+	void						Close();
+
+	inline const BYTE *			GetData() const { return _data; }
+	inline size_t				GetSize() const { return _size; }
+
+private:
+	HANDLE						_file;
+	HANDLE						_mapping;
+	const BYTE *				_data;
+	size_t						_size;
+};
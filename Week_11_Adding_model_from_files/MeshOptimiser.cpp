@@ -0,0 +1,461 @@
+#include "MeshOptimiser.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Tuning values from Forsyth's paper.  The cache modelled when scoring is larger than the
+// hardware cache, which gives better results across different hardware.
+const size_t ForsythCacheSize = 32;
+const float ForsythCacheDecayPower = 1.5f;
+const float ForsythLastTriangleScore = 0.75f;
+const float ForsythValenceBoostScale = 2.0f;
+const float ForsythValenceBoostPower = 0.5f;
+// Vertices used by more triangles than this all get the same valence score
+const uint32_t ForsythMaximumValence = 64;
+
+const uint32_t NoIndex = 0xFFFFFFFF;
+
+struct Position
+{
+	float					X;
+	float					Y;
+	float					Z;
+};
+
+static inline Position GetPosition(const void * vertices, size_t vertexStride, uint32_t index)
+{
+	Position position;
+	memcpy(&position, static_cast<const uint8_t *>(vertices) + vertexStride * index, sizeof(Position));
+	return position;
+}
+
+MeshOptimiserOptions DefaultMeshOptimiserOptions()
+{
+	MeshOptimiserOptions options;
+	options.WeldVertices = true;
+	options.OptimiseOverdraw = false;
+	options.OverdrawThreshold = 1.05f;
+	return options;
+}
+
+VertexCacheStatistics AnalyseVertexCache(const vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize)
+{
+	// Simulate a FIFO cache.  Each vertex records the value the transform counter had when it
+	// was added to the cache, so it is still in the cache if fewer than cacheSize transforms
+	// have happened since.
+	vector<size_t> addedAt(vertexCount, 0);
+	vector<bool> used(vertexCount, false);
+	size_t transforms = 0;
+	size_t usedCount = 0;
+	for (uint32_t index : indices)
+	{
+		if (!used[index])
+		{
+			used[index] = true;
+			usedCount++;
+		}
+		else if (transforms - addedAt[index] < cacheSize)
+		{
+			continue;
+		}
+		transforms++;
+		addedAt[index] = transforms;
+	}
+	VertexCacheStatistics statistics;
+	statistics.Transforms = transforms;
+	statistics.ACMR = indices.empty() ? 0.0f : static_cast<float>(transforms) / (indices.size() / 3);
+	statistics.ATVR = usedCount == 0 ? 0.0f : static_cast<float>(transforms) / usedCount;
+	return statistics;
+}
+
+size_t WeldVertices(void * vertices, size_t vertexCount, size_t vertexStride, vector<uint32_t>& indices)
+{
+	uint8_t * vertexBytes = static_cast<uint8_t *>(vertices);
+
+	// Open addressing hash table of vertex indices, at most half full
+	size_t tableSize = 1;
+	while (tableSize < vertexCount * 2)
+	{
+		tableSize *= 2;
+	}
+	vector<uint32_t> table(tableSize, NoIndex);
+	vector<uint32_t> remap(vertexCount);
+	size_t weldedCount = 0;
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const uint8_t * vertex = vertexBytes + vertexStride * i;
+		// 64-bit FNV-1a over the bytes of the vertex
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t b = 0; b < vertexStride; b++)
+		{
+			hash ^= vertex[b];
+			hash *= 1099511628211ull;
+		}
+		size_t slot = static_cast<size_t>(hash) & (tableSize - 1);
+		while (table[slot] != NoIndex && memcmp(vertexBytes + vertexStride * table[slot], vertex, vertexStride) != 0)
+		{
+			slot = (slot + 1) & (tableSize - 1);
+		}
+		if (table[slot] == NoIndex)
+		{
+			// A vertex not seen before.  Move it down to the end of the welded vertices.
+			uint32_t weldedIndex = static_cast<uint32_t>(weldedCount++);
+			if (weldedIndex != i)
+			{
+				memcpy(vertexBytes + vertexStride * weldedIndex, vertex, vertexStride);
+			}
+			table[slot] = weldedIndex;
+		}
+		remap[i] = table[slot];
+	}
+	for (uint32_t& index : indices)
+	{
+		index = remap[index];
+	}
+	return weldedCount;
+}
+
+void OptimiseVertexCache(vector<uint32_t>& indices, size_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// Scores depend only on the position in the cache and the number of triangles left, so
+	// work them out once
+	float cacheScores[ForsythCacheSize];
+	for (size_t i = 0; i < ForsythCacheSize; i++)
+	{
+		cacheScores[i] = i < 3 ? ForsythLastTriangleScore :
+					     powf(1.0f - static_cast<float>(i - 3) / (ForsythCacheSize - 3), ForsythCacheDecayPower);
+	}
+	float valenceScores[ForsythMaximumValence + 1];
+	valenceScores[0] = 0.0f;
+	for (uint32_t i = 1; i <= ForsythMaximumValence; i++)
+	{
+		valenceScores[i] = ForsythValenceBoostScale * powf(static_cast<float>(i), -ForsythValenceBoostPower);
+	}
+
+	// The triangles that use each vertex and have not been emitted yet are kept at the start
+	// of the vertex's section of the adjacency list
+	vector<uint32_t> remaining(vertexCount, 0);
+	for (uint32_t index : indices)
+	{
+		remaining[index]++;
+	}
+	vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remaining[i];
+	}
+	vector<uint32_t> adjacency(indices.size());
+	{
+		vector<uint32_t> filled(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			adjacency[filled[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	vector<int> cachePositions(vertexCount, -1);
+	vector<float> vertexScores(vertexCount);
+	auto scoreVertex = [&](uint32_t vertex)
+	{
+		if (remaining[vertex] == 0)
+		{
+			return -1.0f;
+		}
+		float score = cachePositions[vertex] >= 0 ? cacheScores[cachePositions[vertex]] : 0.0f;
+		return score + valenceScores[min(remaining[vertex], ForsythMaximumValence)];
+	};
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		vertexScores[i] = scoreVertex(i);
+	}
+	vector<float> triangleScores(triangleCount);
+	vector<bool> emitted(triangleCount, false);
+	uint32_t bestTriangle = 0;
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		triangleScores[i] = vertexScores[indices[i * 3]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+		if (triangleScores[i] > triangleScores[bestTriangle])
+		{
+			bestTriangle = static_cast<uint32_t>(i);
+		}
+	}
+
+	vector<uint32_t> output;
+	output.reserve(indices.size());
+	vector<uint32_t> cache;
+	vector<uint32_t> newCache;
+	cache.reserve(ForsythCacheSize + 3);
+	newCache.reserve(ForsythCacheSize + 3);
+	size_t nextUnemitted = 0;
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+	{
+		if (bestTriangle == NoIndex)
+		{
+			// Nothing in the cache has any triangles left, so start again somewhere else
+			while (emitted[nextUnemitted])
+			{
+				nextUnemitted++;
+			}
+			bestTriangle = static_cast<uint32_t>(nextUnemitted);
+		}
+		const uint32_t * triangle = &indices[bestTriangle * 3];
+		output.insert(output.end(), triangle, triangle + 3);
+		emitted[bestTriangle] = true;
+
+		// Take the triangle out of the adjacency of its vertices and put them at the front of
+		// the cache
+		newCache.clear();
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t vertex = triangle[corner];
+			uint32_t * first = &adjacency[adjacencyOffsets[vertex]];
+			uint32_t * last = first + remaining[vertex];
+			uint32_t * found = find(first, last, bestTriangle);
+			if (found != last)
+			{
+				*found = *(last - 1);
+				remaining[vertex]--;
+			}
+			if (find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+			{
+				newCache.push_back(vertex);
+			}
+		}
+		for (uint32_t vertex : cache)
+		{
+			if (find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+			{
+				newCache.push_back(vertex);
+			}
+		}
+		// Vertices that fall out of the cache lose their cache score
+		for (size_t i = ForsythCacheSize; i < newCache.size(); i++)
+		{
+			cachePositions[newCache[i]] = -1;
+			vertexScores[newCache[i]] = scoreVertex(newCache[i]);
+		}
+		if (newCache.size() > ForsythCacheSize)
+		{
+			newCache.resize(ForsythCacheSize);
+		}
+		cache.swap(newCache);
+
+		// Rescore everything in the cache and the triangles that use it, and pick the best
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			cachePositions[cache[i]] = static_cast<int>(i);
+			vertexScores[cache[i]] = scoreVertex(cache[i]);
+		}
+		bestTriangle = NoIndex;
+		float bestScore = -1.0f;
+		for (uint32_t vertex : cache)
+		{
+			for (uint32_t i = 0; i < remaining[vertex]; i++)
+			{
+				uint32_t candidate = adjacency[adjacencyOffsets[vertex] + i];
+				const uint32_t * corners = &indices[candidate * 3];
+				float score = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+				triangleScores[candidate] = score;
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = candidate;
+				}
+			}
+		}
+	}
+	indices.swap(output);
+}
+
+void OptimiseOverdraw(vector<uint32_t>& indices, const void * vertices, size_t vertexCount, size_t vertexStride, float threshold)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2)
+	{
+		return;
+	}
+	VertexCacheStatistics before = AnalyseVertexCache(indices, vertexCount);
+
+	// Split the triangles into clusters wherever the cache would have to start again (a
+	// triangle none of whose vertices is in the cache).  Moving whole clusters around keeps most
+	// of the cache reuse within them.
+	vector<size_t> clusterStarts;
+	{
+		vector<size_t> addedAt(vertexCount, 0);
+		vector<bool> used(vertexCount, false);
+		size_t transforms = 0;
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			int misses = 0;
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t index = indices[t * 3 + corner];
+				if (!used[index] || transforms - addedAt[index] >= DefaultVertexCacheSize)
+				{
+					used[index] = true;
+					transforms++;
+					addedAt[index] = transforms;
+					misses++;
+				}
+			}
+			if (t == 0 || misses == 3)
+			{
+				clusterStarts.push_back(t);
+			}
+		}
+	}
+	size_t clusterCount = clusterStarts.size();
+	if (clusterCount < 2)
+	{
+		return;
+	}
+	clusterStarts.push_back(triangleCount);
+
+	// Each cluster is sorted on how far its centre lies out from the centre of the mesh in the
+	// direction it faces.  Clusters on the outside facing outwards are drawn first, so that
+	// they hide what is behind them.  Everything is weighted by triangle area.
+	struct Cluster
+	{
+		size_t				First;
+		size_t				End;
+		float				Centre[3];
+		float				Normal[3];
+		float				Area;
+		float				SortKey;
+	};
+	vector<Cluster> clusters(clusterCount);
+	float meshCentre[3] = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		Cluster& cluster = clusters[c];
+		cluster.First = clusterStarts[c];
+		cluster.End = clusterStarts[c + 1];
+		cluster.Area = 0.0f;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			cluster.Centre[axis] = 0.0f;
+			cluster.Normal[axis] = 0.0f;
+		}
+		for (size_t t = cluster.First; t < cluster.End; t++)
+		{
+			Position a = GetPosition(vertices, vertexStride, indices[t * 3]);
+			Position b = GetPosition(vertices, vertexStride, indices[t * 3 + 1]);
+			Position c = GetPosition(vertices, vertexStride, indices[t * 3 + 2]);
+			float ab[3] = { b.X - a.X, b.Y - a.Y, b.Z - a.Z };
+			float ac[3] = { c.X - a.X, c.Y - a.Y, c.Z - a.Z };
+			float normal[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+			float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			cluster.Centre[0] += (a.X + b.X + c.X) / 3.0f * area;
+			cluster.Centre[1] += (a.Y + b.Y + c.Y) / 3.0f * area;
+			cluster.Centre[2] += (a.Z + b.Z + c.Z) / 3.0f * area;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				cluster.Normal[axis] += normal[axis];
+			}
+			cluster.Area += area;
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			meshCentre[axis] += cluster.Centre[axis];
+		}
+		meshArea += cluster.Area;
+		if (cluster.Area > 0.0f)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				cluster.Centre[axis] /= cluster.Area;
+			}
+		}
+	}
+	if (meshArea > 0.0f)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			meshCentre[axis] /= meshArea;
+		}
+	}
+	for (Cluster& cluster : clusters)
+	{
+		float normalLength = sqrtf(cluster.Normal[0] * cluster.Normal[0] + cluster.Normal[1] * cluster.Normal[1] + cluster.Normal[2] * cluster.Normal[2]);
+		cluster.SortKey = 0.0f;
+		if (normalLength > 0.0f)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				cluster.SortKey += (cluster.Centre[axis] - meshCentre[axis]) * cluster.Normal[axis] / normalLength;
+			}
+		}
+	}
+	stable_sort(clusters.begin(), clusters.end(), [](const Cluster& first, const Cluster& second) { return first.SortKey > second.SortKey; });
+
+	vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (const Cluster& cluster : clusters)
+	{
+		output.insert(output.end(), indices.begin() + cluster.First * 3, indices.begin() + cluster.End * 3);
+	}
+	// Only keep the new order if it has not cost too much cache efficiency
+	VertexCacheStatistics after = AnalyseVertexCache(output, vertexCount);
+	if (after.ACMR <= before.ACMR * threshold)
+	{
+		indices.swap(output);
+	}
+}
+
+size_t OptimiseVertexFetch(void * vertices, size_t vertexCount, size_t vertexStride, vector<uint32_t>& indices)
+{
+	// Number the vertices in the order they are first used
+	vector<uint32_t> remap(vertexCount, NoIndex);
+	uint32_t usedCount = 0;
+	for (uint32_t& index : indices)
+	{
+		if (remap[index] == NoIndex)
+		{
+			remap[index] = usedCount++;
+		}
+		index = remap[index];
+	}
+	uint8_t * vertexBytes = static_cast<uint8_t *>(vertices);
+	vector<uint8_t> reordered(vertexStride * usedCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		if (remap[i] != NoIndex)
+		{
+			memcpy(&reordered[vertexStride * remap[i]], vertexBytes + vertexStride * i, vertexStride);
+		}
+	}
+	memcpy(vertexBytes, reordered.data(), reordered.size());
+	return usedCount;
+}
+
+size_t OptimiseMesh(void * vertices, size_t vertexCount, size_t vertexStride, vector<uint32_t>& indices, const MeshOptimiserOptions& options, MeshOptimiserReport * report)
+{
+	if (report != nullptr)
+	{
+		report->VertexCountBefore = vertexCount;
+		report->Before = AnalyseVertexCache(indices, vertexCount);
+	}
+	if (options.WeldVertices)
+	{
+		vertexCount = WeldVertices(vertices, vertexCount, vertexStride, indices);
+	}
+	OptimiseVertexCache(indices, vertexCount);
+	if (options.OptimiseOverdraw)
+	{
+		OptimiseOverdraw(indices, vertices, vertexCount, vertexStride, options.OverdrawThreshold);
+	}
+	vertexCount = OptimiseVertexFetch(vertices, vertexCount, vertexStride, indices);
+	if (report != nullptr)
+	{
+		report->VertexCountAfter = vertexCount;
+		report->After = AnalyseVertexCache(indices, vertexCount);
+	}
+	return vertexCount;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Reorders indexed triangle lists so that the GPU does less work drawing them.  The functions
+// only look at the indices and, where they need them, the vertex positions, so they work with
+// any vertex structure (the Vertex structure used by meshes and the ObjectVertexStruct produced
+// by GeometricObject).  Positions are read as three floats at the start of each vertex.
+//
+// The stages are normally run in this order (OptimiseMesh does this):
+//
+//	1. WeldVertices merges vertices that are identical, so that they can share cache entries.
+//	2. OptimiseVertexCache reorders the triangles so that vertices are reused while they are
+//	   still in the post-transform cache (Tom Forsyth's "Linear-Speed Vertex Cache
+//	   Optimisation").
+//	3. OptimiseOverdraw reorders clusters of triangles so that those facing out from the centre
+//	   of the mesh are drawn first (after Sander, Nehab and Barczak's "Fast Triangle Reordering
+//	   for Vertex Locality and Reduced Overdraw").  This gives up a little cache efficiency,
+//	   limited by a threshold.
+//	4. OptimiseVertexFetch reorders the vertices into the order they are first used, which
+//	   improves the locality of vertex fetches and drops any vertices that are not used.
+//
+// This module has no dependencies on Windows or Direct3D.
+
+// The number of entries in the FIFO cache used by AnalyseVertexCache.  Most current hardware
+// behaves at least as well as this.
+const size_t DefaultVertexCacheSize = 16;
+
+struct VertexCacheStatistics
+{
+	// Vertices transformed, assuming a FIFO cache
+	size_t					Transforms;
+	// Average cache miss ratio: transforms per triangle.  0.5 is ideal for large regular
+	// meshes and 3 is the worst possible.
+	float					ACMR;
+	// Average transform to vertex ratio: transforms per vertex used.  1 is ideal.
+	float					ATVR;
+};
+
+struct MeshOptimiserOptions
+{
+	bool					WeldVertices;
+	bool					OptimiseOverdraw;
+	// How much worse the ACMR is allowed to get in return for less overdraw (1.05 allows 5%)
+	float					OverdrawThreshold;
+};
+
+struct MeshOptimiserReport
+{
+	size_t					VertexCountBefore;
+	size_t					VertexCountAfter;
+	VertexCacheStatistics	Before;
+	VertexCacheStatistics	After;
+};
+
+// Welds, vertex cache optimisation and fetch optimisation, without overdraw optimisation
+MeshOptimiserOptions DefaultMeshOptimiserOptions();
+
+VertexCacheStatistics AnalyseVertexCache(const vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize = DefaultVertexCacheSize);
+
+// Merges vertices whose bytes are identical.  The vertices are compacted in place, the indices
+// are updated and the new number of vertices is returned.
+size_t WeldVertices(void * vertices, size_t vertexCount, size_t vertexStride, vector<uint32_t>& indices);
+
+void OptimiseVertexCache(vector<uint32_t>& indices, size_t vertexCount);
+
+// Should be given the output of OptimiseVertexCache
+void OptimiseOverdraw(vector<uint32_t>& indices, const void * vertices, size_t vertexCount, size_t vertexStride, float threshold);
+
+// Reorders the vertices in place, updates the indices and returns the number of vertices used
+size_t OptimiseVertexFetch(void * vertices, size_t vertexCount, size_t vertexStride, vector<uint32_t>& indices);
+
+// Runs the stages chosen in the options and returns the new number of vertices.  The report is
+// optional.
+size_t OptimiseMesh(void * vertices, size_t vertexCount, size_t vertexStride, vector<uint32_t>& indices, const MeshOptimiserOptions& options, MeshOptimiserReport * report = nullptr);
+
+// Convenience version for a vector of vertices, which is resized to the vertices that are left
+template<typename VertexType>
+void OptimiseMesh(vector<VertexType>& vertices, vector<uint32_t>& indices, const MeshOptimiserOptions& options, MeshOptimiserReport * report = nullptr)
+{
+	if (vertices.empty() || indices.empty())
+	{
+		return;
+	}
+	size_t vertexCount = OptimiseMesh(vertices.data(), vertices.size(), sizeof(VertexType), indices, options, report);
+	vertices.resize(vertexCount);
+}
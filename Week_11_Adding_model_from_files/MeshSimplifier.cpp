@@ -0,0 +1,517 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+// Boundary edges are held in place by planes through the edge at right angles to the
+// triangle, weighted by this much more than the planes of the triangles themselves
+const double BoundaryWeight = 10.0;
+// A collapse is rejected if the normal of any triangle it moves turns by more than about 75
+// degrees (this is the cosine), which stops triangles folding over
+const double MinimumNormalCosine = 0.25;
+
+MeshSimplifierOptions DefaultMeshSimplifierOptions()
+{
+	MeshSimplifierOptions options;
+	options.MaximumLodCount = 4;
+	options.TriangleRatio = 0.5f;
+	options.MinimumTriangleCount = 32;
+	options.MinimumReduction = 0.8f;
+	return options;
+}
+
+struct Point
+{
+	double					X;
+	double					Y;
+	double					Z;
+};
+
+static inline Point Subtract(const Point& a, const Point& b)
+{
+	return { a.X - b.X, a.Y - b.Y, a.Z - b.Z };
+}
+
+static inline Point Cross(const Point& a, const Point& b)
+{
+	return { a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X };
+}
+
+static inline double Dot(const Point& a, const Point& b)
+{
+	return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+}
+
+// The sum of the squared distances to a set of planes, each weighted, as a symmetric 4x4 matrix
+struct Quadric
+{
+	double					A2, B2, C2, AB, AC, BC, AD, BD, CD, D2;
+	// Total area of the triangles whose planes were added, used to turn the sum into a distance
+	double					Weight;
+};
+
+static void AddPlane(Quadric& quadric, const Point& normal, double d, double weight)
+{
+	double a = normal.X;
+	double b = normal.Y;
+	double c = normal.Z;
+	quadric.A2 += weight * a * a;
+	quadric.B2 += weight * b * b;
+	quadric.C2 += weight * c * c;
+	quadric.AB += weight * a * b;
+	quadric.AC += weight * a * c;
+	quadric.BC += weight * b * c;
+	quadric.AD += weight * a * d;
+	quadric.BD += weight * b * d;
+	quadric.CD += weight * c * d;
+	quadric.D2 += weight * d * d;
+}
+
+static void AddQuadric(Quadric& quadric, const Quadric& other)
+{
+	quadric.A2 += other.A2;
+	quadric.B2 += other.B2;
+	quadric.C2 += other.C2;
+	quadric.AB += other.AB;
+	quadric.AC += other.AC;
+	quadric.BC += other.BC;
+	quadric.AD += other.AD;
+	quadric.BD += other.BD;
+	quadric.CD += other.CD;
+	quadric.D2 += other.D2;
+	quadric.Weight += other.Weight;
+}
+
+static double EvaluateQuadric(const Quadric& quadric, const Point& p)
+{
+	return quadric.A2 * p.X * p.X + quadric.B2 * p.Y * p.Y + quadric.C2 * p.Z * p.Z +
+		   2.0 * (quadric.AB * p.X * p.Y + quadric.AC * p.X * p.Z + quadric.BC * p.Y * p.Z +
+				  quadric.AD * p.X + quadric.BD * p.Y + quadric.CD * p.Z) +
+		   quadric.D2;
+}
+
+struct PositionKey
+{
+	uint32_t				Bits[3];
+
+	bool operator==(const PositionKey& other) const
+	{
+		return Bits[0] == other.Bits[0] && Bits[1] == other.Bits[1] && Bits[2] == other.Bits[2];
+	}
+};
+
+struct PositionKeyHash
+{
+	size_t operator()(const PositionKey& key) const
+	{
+		return (key.Bits[0] * 73856093u) ^ (key.Bits[1] * 19349663u) ^ (key.Bits[2] * 83492791u);
+	}
+};
+
+static inline uint64_t EdgeKey(uint32_t a, uint32_t b)
+{
+	return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+}
+
+// Holds the state between calls, so that a chain of levels carries on collapsing from where the
+// last level stopped and keeps the quadrics it has built up
+class Simplifier
+{
+public:
+	Simplifier(const void * vertices, size_t vertexCount, size_t vertexStride, const vector<uint32_t>& indices);
+
+	float						Simplify(size_t targetIndexCount, float errorLimit);
+	inline const vector<uint32_t>&	GetIndices() const { return _indices; }
+
+private:
+	struct Collapse
+	{
+		uint32_t				From;
+		uint32_t				To;
+		float					Error;
+	};
+
+	size_t						_vertexCount;
+	vector<Point>				_positions;
+	// The first vertex with the same position as each vertex.  Points are identified by this.
+	vector<uint32_t>			_point;
+	// The vertex each vertex has been moved to, or itself if it has not been collapsed
+	vector<uint32_t>			_remap;
+	// Indexed by point
+	vector<Quadric>				_quadrics;
+	vector<uint32_t>			_indices;
+	float						_error;
+
+	// Triangles around each point, rebuilt for each pass
+	vector<uint32_t>			_triangleStart;
+	vector<uint32_t>			_triangles;
+
+	uint32_t					Resolve(uint32_t vertex);
+	void						Compact();
+	bool						TryCollapse(uint32_t from, uint32_t to, size_t& removedTriangles);
+};
+
+Simplifier::Simplifier(const void * vertices, size_t vertexCount, size_t vertexStride, const vector<uint32_t>& indices)
+{
+	_vertexCount = vertexCount;
+	_error = 0.0f;
+	_positions.resize(vertexCount);
+	_point.resize(vertexCount);
+	_remap.resize(vertexCount);
+	unordered_map<PositionKey, uint32_t, PositionKeyHash> points;
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		float position[3];
+		memcpy(position, static_cast<const uint8_t *>(vertices) + vertexStride * i, sizeof(position));
+		_positions[i] = { position[0], position[1], position[2] };
+		// Adding zero turns -0 into 0, so that the two are the same point
+		const float keyPosition[3] = { position[0] + 0.0f, position[1] + 0.0f, position[2] + 0.0f };
+		PositionKey key;
+		memcpy(key.Bits, keyPosition, sizeof(key.Bits));
+		_point[i] = points.insert(make_pair(key, i)).first->second;
+		_remap[i] = i;
+	}
+	_indices = indices;
+	Compact();
+
+	// Each point starts with the planes of the triangles around it, weighted by area
+	_quadrics.assign(vertexCount, Quadric());
+	unordered_map<uint64_t, uint32_t> edgeCounts;
+	for (size_t t = 0; t < _indices.size(); t += 3)
+	{
+		uint32_t point[3] = { _point[_indices[t]], _point[_indices[t + 1]], _point[_indices[t + 2]] };
+		Point normal = Cross(Subtract(_positions[point[1]], _positions[point[0]]), Subtract(_positions[point[2]], _positions[point[0]]));
+		double length = sqrt(Dot(normal, normal));
+		if (length > 0.0)
+		{
+			normal = { normal.X / length, normal.Y / length, normal.Z / length };
+			double area = 0.5 * length;
+			double d = -Dot(normal, _positions[point[0]]);
+			for (int k = 0; k < 3; k++)
+			{
+				AddPlane(_quadrics[point[k]], normal, d, area);
+				_quadrics[point[k]].Weight += area;
+			}
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			edgeCounts[EdgeKey(point[k], point[(k + 1) % 3])]++;
+		}
+	}
+
+	// Hold boundary edges in place with a plane through the edge, at right angles to the triangle
+	for (size_t t = 0; t < _indices.size(); t += 3)
+	{
+		uint32_t point[3] = { _point[_indices[t]], _point[_indices[t + 1]], _point[_indices[t + 2]] };
+		Point normal = Cross(Subtract(_positions[point[1]], _positions[point[0]]), Subtract(_positions[point[2]], _positions[point[0]]));
+		double length = sqrt(Dot(normal, normal));
+		if (length == 0.0)
+		{
+			continue;
+		}
+		normal = { normal.X / length, normal.Y / length, normal.Z / length };
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t a = point[k];
+			uint32_t b = point[(k + 1) % 3];
+			if (edgeCounts[EdgeKey(a, b)] != 1)
+			{
+				continue;
+			}
+			Point edge = Subtract(_positions[b], _positions[a]);
+			Point boundaryNormal = Cross(edge, normal);
+			double boundaryLength = sqrt(Dot(boundaryNormal, boundaryNormal));
+			if (boundaryLength == 0.0)
+			{
+				continue;
+			}
+			boundaryNormal = { boundaryNormal.X / boundaryLength, boundaryNormal.Y / boundaryLength, boundaryNormal.Z / boundaryLength };
+			double d = -Dot(boundaryNormal, _positions[a]);
+			double weight = BoundaryWeight * Dot(edge, edge);
+			AddPlane(_quadrics[a], boundaryNormal, d, weight);
+			AddPlane(_quadrics[b], boundaryNormal, d, weight);
+		}
+	}
+}
+
+uint32_t Simplifier::Resolve(uint32_t vertex)
+{
+	uint32_t resolved = vertex;
+	while (_remap[resolved] != resolved)
+	{
+		resolved = _remap[resolved];
+	}
+	// Shorten the path for next time
+	while (_remap[vertex] != resolved)
+	{
+		uint32_t next = _remap[vertex];
+		_remap[vertex] = resolved;
+		vertex = next;
+	}
+	return resolved;
+}
+
+void Simplifier::Compact()
+{
+	// Apply the collapses to the indices and drop the triangles that have become degenerate
+	size_t write = 0;
+	for (size_t t = 0; t + 2 < _indices.size(); t += 3)
+	{
+		uint32_t a = Resolve(_indices[t]);
+		uint32_t b = Resolve(_indices[t + 1]);
+		uint32_t c = Resolve(_indices[t + 2]);
+		if (_point[a] != _point[b] && _point[b] != _point[c] && _point[a] != _point[c])
+		{
+			_indices[write++] = a;
+			_indices[write++] = b;
+			_indices[write++] = c;
+		}
+	}
+	_indices.resize(write);
+}
+
+bool Simplifier::TryCollapse(uint32_t from, uint32_t to, size_t& removedTriangles)
+{
+	// Every vertex at the point being removed needs a vertex at the other point to move to,
+	// which is the one it shares an edge with.  If a vertex has none, or more than one, the
+	// collapse would tear a seam.
+	struct Target
+	{
+		uint32_t				Vertex;
+		uint32_t				To;
+	};
+	Target targets[16];
+	size_t targetCount = 0;
+	removedTriangles = 0;
+	for (uint32_t i = _triangleStart[from]; i < _triangleStart[from + 1]; i++)
+	{
+		size_t t = _triangles[i] * 3;
+		uint32_t corner[3] = { Resolve(_indices[t]), Resolve(_indices[t + 1]), Resolve(_indices[t + 2]) };
+		int fromCorner = -1;
+		int toCorner = -1;
+		for (int k = 0; k < 3; k++)
+		{
+			if (_point[corner[k]] == from)
+			{
+				fromCorner = k;
+			}
+			else if (_point[corner[k]] == to)
+			{
+				toCorner = k;
+			}
+		}
+		if (fromCorner < 0)
+		{
+			continue;
+		}
+		size_t j = 0;
+		while (j < targetCount && targets[j].Vertex != corner[fromCorner])
+		{
+			j++;
+		}
+		if (j == targetCount)
+		{
+			if (targetCount == sizeof(targets) / sizeof(targets[0]))
+			{
+				return false;
+			}
+			targets[targetCount++] = { corner[fromCorner], toCorner >= 0 ? corner[toCorner] : UINT32_MAX };
+		}
+		if (toCorner >= 0)
+		{
+			if (targets[j].To != UINT32_MAX && targets[j].To != corner[toCorner])
+			{
+				return false;
+			}
+			targets[j].To = corner[toCorner];
+			removedTriangles++;
+			continue;
+		}
+
+		// The triangle survives the collapse, so check that it does not fold over
+		Point p0 = _positions[corner[0]];
+		Point p1 = _positions[corner[1]];
+		Point p2 = _positions[corner[2]];
+		Point oldNormal = Cross(Subtract(p1, p0), Subtract(p2, p0));
+		(fromCorner == 0 ? p0 : fromCorner == 1 ? p1 : p2) = _positions[to];
+		Point newNormal = Cross(Subtract(p1, p0), Subtract(p2, p0));
+		double oldLength = sqrt(Dot(oldNormal, oldNormal));
+		double newLength = sqrt(Dot(newNormal, newNormal));
+		if (oldLength > 0.0 && Dot(oldNormal, newNormal) < MinimumNormalCosine * oldLength * newLength)
+		{
+			return false;
+		}
+	}
+	for (size_t j = 0; j < targetCount; j++)
+	{
+		if (targets[j].To == UINT32_MAX)
+		{
+			return false;
+		}
+	}
+	for (size_t j = 0; j < targetCount; j++)
+	{
+		_remap[targets[j].Vertex] = targets[j].To;
+	}
+	AddQuadric(_quadrics[to], _quadrics[from]);
+	return true;
+}
+
+float Simplifier::Simplify(size_t targetIndexCount, float errorLimit)
+{
+	bool reachedLimit = false;
+	while (_indices.size() > targetIndexCount && !reachedLimit)
+	{
+		size_t triangleCount = _indices.size() / 3;
+
+		// Find the points on boundaries (edges used by one triangle) and on non-manifold edges
+		// (used by more than two)
+		unordered_map<uint64_t, uint32_t> edgeCounts;
+		edgeCounts.reserve(_indices.size());
+		for (size_t t = 0; t < _indices.size(); t += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				edgeCounts[EdgeKey(_point[_indices[t + k]], _point[_indices[t + (k + 1) % 3]])]++;
+			}
+		}
+		vector<uint8_t> boundary(_vertexCount, 0);
+		vector<uint8_t> locked(_vertexCount, 0);
+		for (const pair<const uint64_t, uint32_t>& edge : edgeCounts)
+		{
+			uint32_t a = static_cast<uint32_t>(edge.first >> 32);
+			uint32_t b = static_cast<uint32_t>(edge.first);
+			if (edge.second == 1)
+			{
+				boundary[a] = boundary[b] = 1;
+			}
+			else if (edge.second > 2)
+			{
+				locked[a] = locked[b] = 1;
+			}
+		}
+
+		// The triangles around each point
+		_triangleStart.assign(_vertexCount + 1, 0);
+		for (size_t i = 0; i < _indices.size(); i++)
+		{
+			_triangleStart[_point[_indices[i]] + 1]++;
+		}
+		for (size_t i = 0; i < _vertexCount; i++)
+		{
+			_triangleStart[i + 1] += _triangleStart[i];
+		}
+		_triangles.resize(_indices.size());
+		vector<uint32_t> fill(_triangleStart.begin(), _triangleStart.end() - 1);
+		for (size_t i = 0; i < _indices.size(); i++)
+		{
+			_triangles[fill[_point[_indices[i]]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		// Every edge can collapse either way, unless the point being removed is locked or is
+		// on a boundary that the edge does not follow
+		vector<Collapse> collapses;
+		collapses.reserve(_indices.size() * 2);
+		for (size_t t = 0; t < _indices.size(); t += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t a = _point[_indices[t + k]];
+				uint32_t b = _point[_indices[t + (k + 1) % 3]];
+				bool boundaryEdge = edgeCounts[EdgeKey(a, b)] == 1;
+				for (int direction = 0; direction < 2; direction++)
+				{
+					uint32_t from = direction == 0 ? a : b;
+					uint32_t to = direction == 0 ? b : a;
+					if (locked[from] || (boundary[from] && !boundaryEdge))
+					{
+						continue;
+					}
+					Quadric quadric = _quadrics[from];
+					AddQuadric(quadric, _quadrics[to]);
+					double cost = EvaluateQuadric(quadric, _positions[to]) / max(quadric.Weight, DBL_MIN);
+					collapses.push_back({ from, to, static_cast<float>(sqrt(max(cost, 0.0))) });
+				}
+			}
+		}
+		sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; });
+
+		// Take the cheapest collapses first.  Each point is only involved in one collapse per
+		// pass, because the costs of the others around it are out of date once it moves.
+		vector<uint8_t> touched(_vertexCount, 0);
+		size_t targetTriangleCount = targetIndexCount / 3;
+		bool collapsed = false;
+		for (const Collapse& collapse : collapses)
+		{
+			if (triangleCount <= targetTriangleCount)
+			{
+				break;
+			}
+			if (collapse.Error > errorLimit)
+			{
+				reachedLimit = true;
+				break;
+			}
+			if (touched[collapse.From] || touched[collapse.To])
+			{
+				continue;
+			}
+			size_t removedTriangles;
+			if (!TryCollapse(collapse.From, collapse.To, removedTriangles))
+			{
+				continue;
+			}
+			touched[collapse.From] = 1;
+			touched[collapse.To] = 1;
+			triangleCount -= min(removedTriangles, triangleCount);
+			_error = max(_error, collapse.Error);
+			collapsed = true;
+		}
+		Compact();
+		if (!collapsed)
+		{
+			break;
+		}
+	}
+	return _error;
+}
+
+float SimplifyMesh(const void * vertices, size_t vertexCount, size_t vertexStride, const vector<uint32_t>& indices, size_t targetIndexCount, float errorLimit, vector<uint32_t>& result)
+{
+	Simplifier simplifier(vertices, vertexCount, vertexStride, indices);
+	float error = simplifier.Simplify(targetIndexCount, errorLimit);
+	result = simplifier.GetIndices();
+	return error;
+}
+
+void BuildLodChain(const void * vertices, size_t vertexCount, size_t vertexStride, const vector<uint32_t>& indices, const MeshSimplifierOptions& options, vector<MeshLod>& lods)
+{
+	lods.clear();
+	if (indices.empty())
+	{
+		return;
+	}
+	Simplifier simplifier(vertices, vertexCount, vertexStride, indices);
+	size_t previousIndexCount = indices.size();
+	for (size_t level = 0; level < options.MaximumLodCount; level++)
+	{
+		size_t targetTriangleCount = max(static_cast<size_t>(previousIndexCount / 3 * options.TriangleRatio), options.MinimumTriangleCount);
+		if (targetTriangleCount * 3 >= previousIndexCount)
+		{
+			break;
+		}
+		float error = simplifier.Simplify(targetTriangleCount * 3, FLT_MAX);
+		const vector<uint32_t>& simplified = simplifier.GetIndices();
+		if (simplified.empty() || simplified.size() > previousIndexCount * options.MinimumReduction)
+		{
+			break;
+		}
+		MeshLod lod;
+		lod.Indices = simplified;
+		lod.Error = error;
+		lods.push_back(lod);
+		previousIndexCount = simplified.size();
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Builds simplified levels of detail for an indexed triangle list by edge collapse, ordered by
+// the quadric error metric (Garland and Heckbert's "Surface Simplification Using Quadric Error
+// Metrics").  Each collapse moves one vertex onto a neighbouring vertex, so no new vertices are
+// made and every level is just another index list into the same vertices.  The levels can share
+// the vertex buffer of the full mesh and only need their own indices.
+//
+// Vertices with the same position but different normals or texture coordinates (seams) are
+// treated as one point.  Such a point only collapses along the seam, so that every vertex on
+// it has a partner to move to, and the seam never opens.  Points on the boundary of an open
+// mesh only collapse along the boundary, and points on non-manifold edges never collapse.
+//
+// Positions are read as three floats at the start of each vertex, as in MeshOptimiser.h.  This
+// module has no dependencies on Windows or Direct3D.
+
+struct MeshLod
+{
+	vector<uint32_t>		Indices;
+	// Estimated distance between this level and the full mesh, in the units of the positions
+	float					Error;
+};
+
+struct MeshSimplifierOptions
+{
+	// Levels after the full mesh
+	size_t					MaximumLodCount;
+	// Each level aims for this fraction of the triangles of the previous one
+	float					TriangleRatio;
+	// No level is made with fewer triangles than this
+	size_t					MinimumTriangleCount;
+	// A level that keeps more than this fraction of the triangles of the previous one is not
+	// worth drawing, so the chain stops there
+	float					MinimumReduction;
+};
+
+MeshSimplifierOptions DefaultMeshSimplifierOptions();
+
+// Collapses edges until there are no more than targetIndexCount indices or the next collapse
+// would have an error above errorLimit.  Returns the error of the result.
+float SimplifyMesh(const void * vertices, size_t vertexCount, size_t vertexStride, const vector<uint32_t>& indices, size_t targetIndexCount, float errorLimit, vector<uint32_t>& result);
+
+// Builds successive levels from the same simplifier, so each level carries on from the one
+// before and the errors only grow.  The full mesh is not included.
+void BuildLodChain(const void * vertices, size_t vertexCount, size_t vertexStride, const vector<uint32_t>& indices, const MeshSimplifierOptions& options, vector<MeshLod>& lods);
@@ -0,0 +1,312 @@
+#include "RecordingRenderDevice.h"
+#include <cstring>
+#include <stdexcept>
+
+// The names of the commands and their arguments, as written by WriteLog
+struct CommandDescription
+{
+	const char *				Name;
+	bool						HasObject;
+	const char *				ArgumentNames[5];
+};
+
+static const CommandDescription CommandDescriptions[RenderCommandTypeCount] =
+{
+	{ "CreateBuffer", true, { "size", "binding", "usage" } },
+	{ "ReleaseBuffer", true, { } },
+	{ "UpdateBuffer", true, { "bytes" } },
+	{ "MapBuffer", true, { "mode" } },
+	{ "UnmapBuffer", true, { "bytes" } },
+	{ "SignalFence", true, { } },
+	{ "SetVertexShader", true, { } },
+	{ "SetPixelShader", true, { } },
+	{ "SetInputLayout", true, { } },
+	{ "SetPrimitiveTopology", false, { "topology" } },
+	{ "SetRasteriserState", true, { } },
+	{ "SetVertexBuffer", true, { "slot", "stride" } },
+	{ "SetIndexBuffer", true, { "indexsize" } },
+	{ "SetVertexConstantBuffer", true, { "slot" } },
+	{ "SetVertexConstantBufferRange", true, { "slot", "first", "count" } },
+	{ "SetPixelConstantBuffer", true, { "slot" } },
+	{ "SetPixelShaderResource", true, { "slot" } },
+	{ "DrawIndexed", false, { "indices", "start", "base" } },
+	{ "DrawIndexedInstanced", false, { "indices", "instances", "start", "base", "startInstance" } }
+};
+
+RecordingRenderDevice::RecordingRenderDevice(bool constantBufferOffsets)
+{
+	_constantBufferOffsets = constantBufferOffsets;
+	_recording = true;
+	_autoCompleteFences = true;
+	_nextObjectId = 1;
+	_statistics = {};
+}
+
+RenderBuffer RecordingRenderDevice::CreateBuffer(const RenderBufferDesc& desc, const void * initialData)
+{
+	unique_ptr<RecordedBuffer> recordedBuffer = make_unique<RecordedBuffer>();
+	recordedBuffer->Desc = desc;
+	recordedBuffer->Data.resize(desc.Size);
+	recordedBuffer->Mapped = false;
+	if (initialData != nullptr)
+	{
+		memcpy(recordedBuffer->Data.data(), initialData, desc.Size);
+	}
+	RenderBuffer buffer = recordedBuffer.get();
+	_buffers[buffer] = move(recordedBuffer);
+	_statistics.BufferBytes += desc.Size;
+	Record(CreateBufferCommand, buffer, desc.Size, desc.Binding, desc.Usage);
+	return buffer;
+}
+
+void RecordingRenderDevice::ReleaseBuffer(RenderBuffer buffer)
+{
+	RecordedBuffer * recordedBuffer = FindBuffer(buffer);
+	if (recordedBuffer == nullptr)
+	{
+		return;
+	}
+	Record(ReleaseBufferCommand, buffer);
+	_statistics.BufferBytes -= recordedBuffer->Desc.Size;
+	// A buffer created later may be given the same address, so its id is forgotten as well
+	_objectIds.erase(buffer);
+	_buffers.erase(buffer);
+}
+
+void RecordingRenderDevice::UpdateBuffer(RenderBuffer buffer, const void * data, size_t size)
+{
+	RecordedBuffer * recordedBuffer = FindBuffer(buffer);
+	if (recordedBuffer == nullptr || recordedBuffer->Desc.Usage != RenderBufferDefault || size != recordedBuffer->Desc.Size)
+	{
+		// As on Direct3D 11, where UpdateSubresource reads the whole buffer
+		throw logic_error("UpdateBuffer needs a default buffer and replaces all of it");
+	}
+	memcpy(recordedBuffer->Data.data(), data, size);
+	_statistics.BytesUploaded += size;
+	Record(UpdateBufferCommand, buffer, size);
+}
+
+void * RecordingRenderDevice::MapBuffer(RenderBuffer buffer, RenderMapMode mode)
+{
+	RecordedBuffer * recordedBuffer = FindBuffer(buffer);
+	if (recordedBuffer == nullptr || recordedBuffer->Desc.Usage != RenderBufferDynamic || recordedBuffer->Mapped)
+	{
+		throw logic_error("MapBuffer needs a dynamic buffer that is not already mapped");
+	}
+	recordedBuffer->Mapped = true;
+	Record(MapBufferCommand, buffer, mode);
+	return recordedBuffer->Data.data();
+}
+
+void RecordingRenderDevice::UnmapBuffer(RenderBuffer buffer, size_t bytesWritten)
+{
+	RecordedBuffer * recordedBuffer = FindBuffer(buffer);
+	if (recordedBuffer == nullptr || !recordedBuffer->Mapped)
+	{
+		throw logic_error("UnmapBuffer needs a mapped buffer");
+	}
+	recordedBuffer->Mapped = false;
+	_statistics.BytesUploaded += bytesWritten;
+	Record(UnmapBufferCommand, buffer, bytesWritten);
+}
+
+RenderFence RecordingRenderDevice::CreateFence()
+{
+	unique_ptr<uint8_t> fence = make_unique<uint8_t>(FenceUnsignalled);
+	RenderFence handle = fence.get();
+	_fences[handle] = move(fence);
+	return handle;
+}
+
+void RecordingRenderDevice::ReleaseFence(RenderFence fence)
+{
+	_objectIds.erase(fence);
+	_fences.erase(fence);
+}
+
+void RecordingRenderDevice::SignalFence(RenderFence fence)
+{
+	*static_cast<uint8_t *>(fence) = _autoCompleteFences ? FenceComplete : FenceSignalled;
+	Record(SignalFenceCommand, fence);
+}
+
+bool RecordingRenderDevice::IsFenceComplete(RenderFence fence)
+{
+	// Nothing is ever left for a GPU to do, so unless completion has been held back, a fence is
+	// complete once it has been signalled
+	return *static_cast<const uint8_t *>(fence) == FenceComplete;
+}
+
+void RecordingRenderDevice::CompleteFences()
+{
+	for (auto& fence : _fences)
+	{
+		if (*fence.second == FenceSignalled)
+		{
+			*fence.second = FenceComplete;
+		}
+	}
+}
+
+void RecordingRenderDevice::SetVertexShader(RenderVertexShader vertexShader)
+{
+	Record(SetVertexShaderCommand, vertexShader);
+}
+
+void RecordingRenderDevice::SetPixelShader(RenderPixelShader pixelShader)
+{
+	Record(SetPixelShaderCommand, pixelShader);
+}
+
+void RecordingRenderDevice::SetInputLayout(RenderInputLayout inputLayout)
+{
+	Record(SetInputLayoutCommand, inputLayout);
+}
+
+void RecordingRenderDevice::SetPrimitiveTopology(RenderTopology topology)
+{
+	Record(SetPrimitiveTopologyCommand, nullptr, topology);
+}
+
+void RecordingRenderDevice::SetRasteriserState(RenderRasteriserState rasteriserState)
+{
+	Record(SetRasteriserStateCommand, rasteriserState);
+}
+
+void RecordingRenderDevice::SetVertexBuffer(unsigned int slot, RenderBuffer vertexBuffer, unsigned int stride)
+{
+	Record(SetVertexBufferCommand, vertexBuffer, slot, stride);
+}
+
+void RecordingRenderDevice::SetIndexBuffer(RenderBuffer indexBuffer, unsigned int indexSize)
+{
+	Record(SetIndexBufferCommand, indexBuffer, indexSize);
+}
+
+void RecordingRenderDevice::SetVertexConstantBuffer(unsigned int slot, RenderBuffer constantBuffer)
+{
+	Record(SetVertexConstantBufferCommand, constantBuffer, slot);
+}
+
+void RecordingRenderDevice::SetVertexConstantBufferRange(unsigned int slot, RenderBuffer constantBuffer, unsigned int firstConstant, unsigned int constantCount)
+{
+	if (!_constantBufferOffsets)
+	{
+		throw logic_error("Constant buffer offsets are turned off");
+	}
+	Record(SetVertexConstantBufferRangeCommand, constantBuffer, slot, firstConstant, constantCount);
+}
+
+void RecordingRenderDevice::SetPixelConstantBuffer(unsigned int slot, RenderBuffer constantBuffer)
+{
+	Record(SetPixelConstantBufferCommand, constantBuffer, slot);
+}
+
+void RecordingRenderDevice::SetPixelShaderResource(unsigned int slot, RenderShaderResource shaderResource)
+{
+	Record(SetPixelShaderResourceCommand, shaderResource, slot);
+}
+
+void RecordingRenderDevice::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+	_statistics.IndicesDrawn += indexCount;
+	_statistics.InstancesDrawn++;
+	Record(DrawIndexedCommand, nullptr, indexCount, startIndex, baseVertex);
+}
+
+void RecordingRenderDevice::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance)
+{
+	_statistics.IndicesDrawn += static_cast<size_t>(indexCount) * instanceCount;
+	_statistics.InstancesDrawn += instanceCount;
+	Record(DrawIndexedInstancedCommand, nullptr, indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void RecordingRenderDevice::Clear()
+{
+	_commands.clear();
+	size_t bufferBytes = _statistics.BufferBytes;
+	_statistics = {};
+	_statistics.BufferBytes = bufferBytes;
+}
+
+const uint8_t * RecordingRenderDevice::GetBufferData(RenderBuffer buffer) const
+{
+	RecordedBuffer * recordedBuffer = FindBuffer(buffer);
+	return recordedBuffer != nullptr ? recordedBuffer->Data.data() : nullptr;
+}
+
+const void * RecordingRenderDevice::GetObject(unsigned int id) const
+{
+	for (const auto& objectId : _objectIds)
+	{
+		if (objectId.second == id)
+		{
+			return objectId.first;
+		}
+	}
+	return nullptr;
+}
+
+void RecordingRenderDevice::WriteLog(ostream& stream) const
+{
+	for (const RenderCommand& command : _commands)
+	{
+		const CommandDescription& description = CommandDescriptions[command.Type];
+		stream << description.Name;
+		if (description.HasObject)
+		{
+			stream << " #" << command.Object;
+		}
+		for (int i = 0; i < 5 && description.ArgumentNames[i] != nullptr; i++)
+		{
+			stream << " " << description.ArgumentNames[i] << "=" << command.Arguments[i];
+		}
+		stream << "\n";
+	}
+}
+
+const char * RecordingRenderDevice::GetCommandName(RenderCommandType type)
+{
+	return CommandDescriptions[type].Name;
+}
+
+RecordingRenderDevice::RecordedBuffer * RecordingRenderDevice::FindBuffer(RenderBuffer buffer) const
+{
+	auto it = _buffers.find(buffer);
+	return it != _buffers.end() ? it->second.get() : nullptr;
+}
+
+unsigned int RecordingRenderDevice::GetObjectId(const void * object)
+{
+	// Id 0 is kept for no object
+	if (object == nullptr)
+	{
+		return 0;
+	}
+	auto it = _objectIds.find(object);
+	if (it != _objectIds.end())
+	{
+		return it->second;
+	}
+	unsigned int id = _nextObjectId++;
+	_objectIds[object] = id;
+	return id;
+}
+
+void RecordingRenderDevice::Record(RenderCommandType type, const void * object, int64_t argument0, int64_t argument1, int64_t argument2, int64_t argument3, int64_t argument4)
+{
+	_statistics.CommandCounts[type]++;
+	if (!_recording)
+	{
+		return;
+	}
+	RenderCommand command;
+	command.Type = type;
+	command.Object = GetObjectId(object);
+	command.Arguments[0] = argument0;
+	command.Arguments[1] = argument1;
+	command.Arguments[2] = argument2;
+	command.Arguments[3] = argument3;
+	command.Arguments[4] = argument4;
+	_commands.push_back(command);
+}
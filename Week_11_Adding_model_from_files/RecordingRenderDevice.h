@@ -0,0 +1,154 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include "RenderDevice.h"
+
+using namespace std;
+
+// A device that records the calls made on it instead of drawing anything, so that the CPU side
+// of a frame (the scene graph, render queue and state cache) can be run, measured and checked on
+// a machine without a GPU.  Like RenderDevice, this has no dependencies on Windows or Direct3D.
+//
+// Every object is given a small id the first time it is recorded, in order, so two runs that
+// make the same calls produce the same log even though the handles differ.  The
+// shaders, layouts and other objects that are not created by the device can be any unique
+// pointers.  Buffers are backed by memory, so mapped buffers are written as usual and their
+// contents can be checked, and fences complete as soon as they are signalled.
+
+enum RenderCommandType
+{
+	CreateBufferCommand,
+	ReleaseBufferCommand,
+	UpdateBufferCommand,
+	MapBufferCommand,
+	UnmapBufferCommand,
+	SignalFenceCommand,
+	SetVertexShaderCommand,
+	SetPixelShaderCommand,
+	SetInputLayoutCommand,
+	SetPrimitiveTopologyCommand,
+	SetRasteriserStateCommand,
+	SetVertexBufferCommand,
+	SetIndexBufferCommand,
+	SetVertexConstantBufferCommand,
+	SetVertexConstantBufferRangeCommand,
+	SetPixelConstantBufferCommand,
+	SetPixelShaderResourceCommand,
+	DrawIndexedCommand,
+	DrawIndexedInstancedCommand,
+	RenderCommandTypeCount
+};
+
+// Object is the id of the buffer, fence, shader or state that the command is about, or 0 for
+// none.  The arguments are the other values passed to the device, in the same order (see
+// WriteLog for their names).
+struct RenderCommand
+{
+	RenderCommandType			Type;
+	unsigned int				Object;
+	int64_t						Arguments[5];
+};
+
+struct RecordingStatistics
+{
+	size_t						CommandCounts[RenderCommandTypeCount];
+	// Bytes written with UpdateBuffer and through mapped buffers
+	size_t						BytesUploaded;
+	// Size of the buffers that currently exist
+	size_t						BufferBytes;
+	size_t						IndicesDrawn;
+	size_t						InstancesDrawn;
+};
+
+class RecordingRenderDevice : public RenderDevice
+{
+public:
+	// Turning off constant buffer offsets makes the render queue take the path it uses on
+	// Direct3D 11.0 devices
+	RecordingRenderDevice(bool constantBufferOffsets = true);
+
+	RenderBuffer				CreateBuffer(const RenderBufferDesc& desc, const void * initialData);
+	void						ReleaseBuffer(RenderBuffer buffer);
+	void						UpdateBuffer(RenderBuffer buffer, const void * data, size_t size);
+	void *						MapBuffer(RenderBuffer buffer, RenderMapMode mode);
+	void						UnmapBuffer(RenderBuffer buffer, size_t bytesWritten);
+
+	inline bool					SupportsConstantBufferOffsets() const { return _constantBufferOffsets; }
+
+	RenderFence					CreateFence();
+	void						ReleaseFence(RenderFence fence);
+	void						SignalFence(RenderFence fence);
+	bool						IsFenceComplete(RenderFence fence);
+
+	void						SetVertexShader(RenderVertexShader vertexShader);
+	void						SetPixelShader(RenderPixelShader pixelShader);
+	void						SetInputLayout(RenderInputLayout inputLayout);
+	void						SetPrimitiveTopology(RenderTopology topology);
+	void						SetRasteriserState(RenderRasteriserState rasteriserState);
+	void						SetVertexBuffer(unsigned int slot, RenderBuffer vertexBuffer, unsigned int stride);
+	void						SetIndexBuffer(RenderBuffer indexBuffer, unsigned int indexSize);
+	void						SetVertexConstantBuffer(unsigned int slot, RenderBuffer constantBuffer);
+	void						SetVertexConstantBufferRange(unsigned int slot, RenderBuffer constantBuffer, unsigned int firstConstant, unsigned int constantCount);
+	void						SetPixelConstantBuffer(unsigned int slot, RenderBuffer constantBuffer);
+	void						SetPixelShaderResource(unsigned int slot, RenderShaderResource shaderResource);
+
+	void						DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex);
+	void						DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance);
+
+	// With recording off, only the statistics are kept, so that long runs can be measured
+	// without the log growing
+	inline void					SetRecording(bool recording) { _recording = recording; }
+	// Normally a fence is complete as soon as it is signalled.  With automatic completion off,
+	// signalled fences stay incomplete until CompleteFences is called, as if the GPU were
+	// still working on the frames that signalled them.
+	inline void					SetAutoCompleteFences(bool autoComplete) { _autoCompleteFences = autoComplete; }
+	void						CompleteFences();
+	inline const vector<RenderCommand>&	GetCommands() const { return _commands; }
+	inline const RecordingStatistics&	GetStatistics() const { return _statistics; }
+	// Drops the recorded commands and clears the statistics, apart from BufferBytes.  The ids
+	// of the objects are kept.
+	void						Clear();
+
+	// The contents of a buffer created by this device, or null
+	const uint8_t *				GetBufferData(RenderBuffer buffer) const;
+	// The object that was given an id in the recorded commands, or null
+	const void *				GetObject(unsigned int id) const;
+
+	// Writes one line for each recorded command, such as "DrawIndexed indices=36 start=0 base=0"
+	void						WriteLog(ostream& stream) const;
+	static const char *			GetCommandName(RenderCommandType type);
+
+private:
+	enum FenceState : uint8_t
+	{
+		FenceUnsignalled,
+		FenceSignalled,
+		FenceComplete
+	};
+
+	struct RecordedBuffer
+	{
+		RenderBufferDesc		Desc;
+		vector<uint8_t>			Data;
+		bool					Mapped;
+	};
+
+	bool						_constantBufferOffsets;
+	bool						_recording;
+	bool						_autoCompleteFences;
+	vector<RenderCommand>		_commands;
+	RecordingStatistics			_statistics;
+	unordered_map<const void *, unique_ptr<RecordedBuffer>>	_buffers;
+	// Each fence is one byte holding its FenceState
+	unordered_map<const void *, unique_ptr<uint8_t>>		_fences;
+	unordered_map<const void *, unsigned int>				_objectIds;
+	unsigned int				_nextObjectId;
+
+	RecordedBuffer *			FindBuffer(RenderBuffer buffer) const;
+	unsigned int				GetObjectId(const void * object);
+	void						Record(RenderCommandType type, const void * object, int64_t argument0 = 0, int64_t argument1 = 0, int64_t argument2 = 0, int64_t argument3 = 0, int64_t argument4 = 0);
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// The calls that the per-frame rendering code (StateCache, RenderQueue and ConstantBufferRing)
+// makes on the GPU: creating and writing buffers, binding shaders, state and resources, drawing,
+// and fences to find out when the GPU has finished with a frame.  This has no dependencies on
+// Windows or Direct3D.  D3D11RenderDevice passes the calls on to a Direct3D 11 device context,
+// and RecordingRenderDevice keeps a log of them instead, so the CPU side of a frame can be run
+// and measured without a GPU.
+//
+// Objects are passed as opaque handles.  D3D11RenderDevice uses the Direct3D interface pointers
+// themselves as the handles, so the shaders, layouts and views that nodes create through the
+// shader library and resource manager can be handed straight to the device.
+
+typedef void *					RenderBuffer;
+typedef void *					RenderFence;
+typedef void *					RenderVertexShader;
+typedef void *					RenderPixelShader;
+typedef void *					RenderInputLayout;
+typedef void *					RenderRasteriserState;
+typedef void *					RenderShaderResource;
+
+enum RenderBufferBinding
+{
+	RenderVertexBufferBinding,
+	RenderIndexBufferBinding,
+	RenderConstantBufferBinding
+};
+
+enum RenderBufferUsage
+{
+	// Written with UpdateBuffer
+	RenderBufferDefault,
+	// Written by the CPU with MapBuffer
+	RenderBufferDynamic
+};
+
+enum RenderMapMode
+{
+	// The old contents are dropped and the driver hands out fresh memory
+	RenderMapDiscard,
+	// The caller promises not to write to anything the GPU may still be reading
+	RenderMapNoOverwrite
+};
+
+enum RenderTopology
+{
+	RenderTriangleList,
+	RenderTriangleStrip,
+	RenderLineList,
+	RenderPointList
+};
+
+struct RenderBufferDesc
+{
+	size_t						Size;
+	RenderBufferBinding			Binding;
+	RenderBufferUsage			Usage;
+};
+
+class RenderDevice
+{
+public:
+	virtual ~RenderDevice() {}
+
+	// A buffer is held by the device until it is released.  The initial data may be null.
+	virtual RenderBuffer		CreateBuffer(const RenderBufferDesc& desc, const void * initialData) = 0;
+	virtual void				ReleaseBuffer(RenderBuffer buffer) = 0;
+	// Replaces the whole contents of a buffer created with RenderBufferDefault, so size must be
+	// the size of the buffer
+	virtual void				UpdateBuffer(RenderBuffer buffer, const void * data, size_t size) = 0;
+	// Maps a buffer created with RenderBufferDynamic.  The number of bytes written is passed to
+	// UnmapBuffer so that uploads can be counted.
+	virtual void *				MapBuffer(RenderBuffer buffer, RenderMapMode mode) = 0;
+	virtual void				UnmapBuffer(RenderBuffer buffer, size_t bytesWritten) = 0;
+
+	// Whether constant buffers can be bound at an offset (SetVertexConstantBufferRange) and
+	// dynamic constant buffers mapped with RenderMapNoOverwrite
+	virtual bool				SupportsConstantBufferOffsets() const = 0;
+
+	// A fence is signalled after the commands issued so far, and is complete once the GPU has
+	// finished with them
+	virtual RenderFence			CreateFence() = 0;
+	virtual void				ReleaseFence(RenderFence fence) = 0;
+	virtual void				SignalFence(RenderFence fence) = 0;
+	virtual bool				IsFenceComplete(RenderFence fence) = 0;
+
+	virtual void				SetVertexShader(RenderVertexShader vertexShader) = 0;
+	virtual void				SetPixelShader(RenderPixelShader pixelShader) = 0;
+	virtual void				SetInputLayout(RenderInputLayout inputLayout) = 0;
+	virtual void				SetPrimitiveTopology(RenderTopology topology) = 0;
+	virtual void				SetRasteriserState(RenderRasteriserState rasteriserState) = 0;
+	virtual void				SetVertexBuffer(unsigned int slot, RenderBuffer vertexBuffer, unsigned int stride) = 0;
+	// The index size is 2 or 4 bytes
+	virtual void				SetIndexBuffer(RenderBuffer indexBuffer, unsigned int indexSize) = 0;
+	virtual void				SetVertexConstantBuffer(unsigned int slot, RenderBuffer constantBuffer) = 0;
+	// Binds part of a constant buffer, given in constants of 16 bytes
+	virtual void				SetVertexConstantBufferRange(unsigned int slot, RenderBuffer constantBuffer, unsigned int firstConstant, unsigned int constantCount) = 0;
+	virtual void				SetPixelConstantBuffer(unsigned int slot, RenderBuffer constantBuffer) = 0;
+	virtual void				SetPixelShaderResource(unsigned int slot, RenderShaderResource shaderResource) = 0;
+
+	virtual void				DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex) = 0;
+	virtual void				DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance) = 0;
+};
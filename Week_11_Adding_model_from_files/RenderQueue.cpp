@@ -0,0 +1,341 @@
+#include "RenderQueue.h"
+#include <cstring>
+
+// Returns true if the two packets can be drawn in the same instanced draw call
+static bool CanInstance(const DrawPacket& first, const DrawPacket& packet)
+{
+	return packet.InstancedVertexShader == first.InstancedVertexShader &&
+		   packet.InstancedInputLayout == first.InstancedInputLayout &&
+		   packet.Pass == first.Pass &&
+		   packet.PixelShader == first.PixelShader &&
+		   packet.RasteriserState == first.RasteriserState &&
+		   packet.VertexBuffer == first.VertexBuffer &&
+		   packet.VertexStride == first.VertexStride &&
+		   packet.IndexBuffer == first.IndexBuffer &&
+		   packet.IndexSize == first.IndexSize &&
+		   packet.IndexCount == first.IndexCount &&
+		   packet.StartIndex == first.StartIndex &&
+		   packet.BaseVertex == first.BaseVertex &&
+		   packet.Texture == first.Texture &&
+		   packet.MaterialConstantBuffer == first.MaterialConstantBuffer &&
+		   packet.MeshConstantBuffer == first.MeshConstantBuffer;
+}
+
+RenderQueue::RenderQueue(shared_ptr<RenderDevice> device)
+{
+	_device = device;
+	_objectConstantBuffer = nullptr;
+	_instanceBuffer = nullptr;
+	_instanceBufferCapacity = 0;
+	_nearPlane = 1.0f;
+	_farPlane = 10000.0f;
+	_statistics = {};
+
+	RenderBufferDesc bufferDesc = { sizeof(FrameConstants), RenderConstantBufferBinding, RenderBufferDefault };
+	_frameConstantBuffer = _device->CreateBuffer(bufferDesc, nullptr);
+	if (_device->SupportsConstantBufferOffsets())
+	{
+		// Room for 1024 draws to start with.  The ring grows if a frame needs more.
+		_objectConstantRing = make_unique<ConstantBufferRing>(_device, 1024 * ConstantBufferRing::SliceSize);
+	}
+	else
+	{
+		bufferDesc.Size = sizeof(ObjectConstants);
+		_objectConstantBuffer = _device->CreateBuffer(bufferDesc, nullptr);
+	}
+}
+
+RenderQueue::~RenderQueue()
+{
+	_device->ReleaseBuffer(_frameConstantBuffer);
+	if (_objectConstantBuffer != nullptr)
+	{
+		_device->ReleaseBuffer(_objectConstantBuffer);
+	}
+	if (_instanceBuffer != nullptr)
+	{
+		_device->ReleaseBuffer(_instanceBuffer);
+	}
+}
+
+void RenderQueue::Begin(const FrameConstants& frameConstants, const Matrix& viewTransformation, float nearPlane, float farPlane)
+{
+	_frameConstants = frameConstants;
+	_viewTransformation = viewTransformation;
+	_nearPlane = nearPlane;
+	_farPlane = farPlane;
+	_packets.clear();
+	_entries.clear();
+	_objectConstants.clear();
+	_shaderIds.clear();
+	_resourceIds.clear();
+	_geometryIds.clear();
+	_statistics.SortKeyIdOverflows = 0;
+}
+
+void RenderQueue::Submit(RenderPass pass, const DrawPacket& packet, const ObjectConstants& objectConstants)
+{
+	RenderQueueEntry entry;
+	entry.PacketIndex = static_cast<uint32_t>(_packets.size());
+	_packets.push_back(packet);
+	_packets.back().Pass = pass;
+	_objectConstants.push_back(objectConstants);
+
+	// Depth is taken from the origin of the object in view space
+	float viewDepth = Vector3::Transform(objectConstants.World.Translation(), _viewTransformation).z;
+	entry.SortKey = BuildSortKey(pass,
+								 GetShaderId(packet),
+								 GetResourceId(packet.MaterialConstantBuffer),
+								 GetResourceId(packet.Texture),
+								 GetGeometryId(packet),
+								 QuantiseDepth(viewDepth, _nearPlane, _farPlane));
+	_entries.push_back(entry);
+}
+
+void RenderQueue::Sort()
+{
+	RadixSort(_entries, _sortScratch);
+}
+
+void RenderQueue::Execute(StateCache * stateCache)
+{
+	BuildBatches();
+	UploadInstanceData();
+	UploadObjectConstants();
+
+	// The statistics are for this frame only, but the bound state carries over between frames
+	StateFilter& filter = stateCache->GetFilter();
+	filter.ResetStatistics();
+	_statistics.InstancedPackets = 0;
+
+	// The frame constants are the same for every packet
+	stateCache->UpdateBuffer(_frameConstantBuffer, &_frameConstants, sizeof(FrameConstants));
+	stateCache->SetVertexConstantBuffer(FrameConstantsRegister, _frameConstantBuffer);
+	stateCache->SetPixelConstantBuffer(FrameConstantsRegister, _frameConstantBuffer);
+	if (!_objectConstantRing)
+	{
+		stateCache->SetVertexConstantBuffer(ObjectConstantsRegister, _objectConstantBuffer);
+	}
+	_statistics.ConstantDataUploaded = sizeof(FrameConstants);
+
+	for (const Batch& batch : _batches)
+	{
+		// Every batch asks for all of its state.  The state cache drops any calls for state
+		// that is already bound, which after sorting is most of them.
+		uint32_t packetIndex = _entries[batch.FirstEntry].PacketIndex;
+		const DrawPacket& packet = _packets[packetIndex];
+		bool instanced = batch.EntryCount > 1;
+		if (instanced)
+		{
+			stateCache->SetVertexShader(packet.InstancedVertexShader);
+			stateCache->SetInputLayout(packet.InstancedInputLayout);
+			stateCache->SetInstanceBuffer(_instanceBuffer, sizeof(ObjectConstants));
+		}
+		else
+		{
+			stateCache->SetVertexShader(packet.VertexShader);
+			stateCache->SetInputLayout(packet.InputLayout);
+		}
+		stateCache->SetPixelShader(packet.PixelShader);
+		stateCache->SetPrimitiveTopology(RenderTriangleList);
+		stateCache->SetRasteriserState(packet.RasteriserState);
+		stateCache->SetVertexBuffer(packet.VertexBuffer, packet.VertexStride);
+		stateCache->SetIndexBuffer(packet.IndexBuffer, packet.IndexSize);
+		stateCache->SetPixelShaderResource(packet.Texture);
+		stateCache->SetPixelConstantBuffer(MaterialConstantsRegister, packet.MaterialConstantBuffer);
+		if (packet.MeshConstantBuffer != nullptr)
+		{
+			// Shaders for the full vertex format ignore this register, so it can be left bound
+			stateCache->SetVertexConstantBuffer(MeshConstantsRegister, packet.MeshConstantBuffer);
+		}
+		if (instanced)
+		{
+			stateCache->DrawIndexedInstanced(packet.IndexCount, static_cast<unsigned int>(batch.EntryCount), packet.StartIndex, packet.BaseVertex, static_cast<unsigned int>(batch.FirstInstance));
+			_statistics.InstancedPackets += batch.EntryCount;
+		}
+		else
+		{
+			// Only the object constants are different for every packet
+			if (_objectConstantRing)
+			{
+				stateCache->SetVertexConstantBuffer(ObjectConstantsRegister, _objectConstantRing->GetBuffer(), batch.FirstConstant, ConstantBufferRing::SliceConstantCount);
+			}
+			else
+			{
+				stateCache->UpdateBuffer(_objectConstantBuffer, &_objectConstants[packetIndex], sizeof(ObjectConstants));
+			}
+			_statistics.ConstantDataUploaded += sizeof(ObjectConstants);
+			stateCache->DrawIndexed(packet.IndexCount, packet.StartIndex, packet.BaseVertex);
+		}
+	}
+
+	if (_objectConstantRing)
+	{
+		_objectConstantRing->EndFrame();
+	}
+
+	_statistics.PacketCount = _entries.size();
+	_statistics.DrawCalls = _batches.size();
+	_statistics.StateChanges = filter.GetIssuedCount();
+	_statistics.StateChangesSaved = filter.GetElidedCount();
+}
+
+void RenderQueue::BuildBatches()
+{
+	// Since packets that share geometry, shaders, material and texture have the same key apart
+	// from the depth (see SortKey.h), sorting leaves them next to each other.  Gather each run of packets that
+	// can be instanced into a batch.
+	_batches.clear();
+	_instanceData.clear();
+	size_t entryCount = _entries.size();
+	size_t first = 0;
+	while (first < entryCount)
+	{
+		const DrawPacket& firstPacket = _packets[_entries[first].PacketIndex];
+		size_t end = first + 1;
+		if (firstPacket.InstancedVertexShader != nullptr && firstPacket.Pass == OpaquePass)
+		{
+			while (end < entryCount && CanInstance(firstPacket, _packets[_entries[end].PacketIndex]))
+			{
+				end++;
+			}
+		}
+		Batch batch;
+		batch.FirstEntry = first;
+		batch.EntryCount = end - first;
+		batch.FirstInstance = _instanceData.size();
+		batch.FirstConstant = 0;
+		if (batch.EntryCount > 1)
+		{
+			for (size_t i = first; i < end; i++)
+			{
+				_instanceData.push_back(_objectConstants[_entries[i].PacketIndex]);
+			}
+		}
+		_batches.push_back(batch);
+		first = end;
+	}
+}
+
+void RenderQueue::UploadInstanceData()
+{
+	if (_instanceData.empty())
+	{
+		return;
+	}
+	if (_instanceData.size() > _instanceBufferCapacity)
+	{
+		// Grow to the next power of two so that the buffer is not recreated every time
+		// another instance is added
+		size_t capacity = 64;
+		while (capacity < _instanceData.size())
+		{
+			capacity *= 2;
+		}
+		RenderBufferDesc instanceBufferDesc = { sizeof(ObjectConstants) * capacity, RenderVertexBufferBinding, RenderBufferDynamic };
+		// Create the new buffer before releasing the old one so that the state cache
+		// cannot mistake it for the buffer that is currently bound
+		RenderBuffer instanceBuffer = _device->CreateBuffer(instanceBufferDesc, nullptr);
+		if (_instanceBuffer != nullptr)
+		{
+			_device->ReleaseBuffer(_instanceBuffer);
+		}
+		_instanceBuffer = instanceBuffer;
+		_instanceBufferCapacity = capacity;
+	}
+	size_t size = sizeof(ObjectConstants) * _instanceData.size();
+	void * mappedBuffer = _device->MapBuffer(_instanceBuffer, RenderMapDiscard);
+	memcpy(mappedBuffer, _instanceData.data(), size);
+	_device->UnmapBuffer(_instanceBuffer, size);
+}
+
+void RenderQueue::UploadObjectConstants()
+{
+	if (!_objectConstantRing)
+	{
+		return;
+	}
+	size_t sliceCount = 0;
+	for (const Batch& batch : _batches)
+	{
+		if (batch.EntryCount == 1)
+		{
+			sliceCount++;
+		}
+	}
+	if (sliceCount == 0)
+	{
+		return;
+	}
+	// Write the object constants of every draw that is not instanced with a single map, each
+	// in its own slice
+	unsigned int firstConstant;
+	uint8_t * slice = _objectConstantRing->Map(sliceCount, firstConstant);
+	for (Batch& batch : _batches)
+	{
+		if (batch.EntryCount == 1)
+		{
+			memcpy(slice, &_objectConstants[_entries[batch.FirstEntry].PacketIndex], sizeof(ObjectConstants));
+			batch.FirstConstant = firstConstant;
+			slice += ConstantBufferRing::SliceSize;
+			firstConstant += ConstantBufferRing::SliceConstantCount;
+		}
+	}
+	_objectConstantRing->Unmap();
+}
+
+unsigned int RenderQueue::GetShaderId(const DrawPacket& packet)
+{
+	pair<const void *, const void *> shaders(packet.VertexShader, packet.PixelShader);
+	auto it = _shaderIds.find(shaders);
+	if (it != _shaderIds.end())
+	{
+		return it->second;
+	}
+	unsigned int id = IssueSortKeyId(_shaderIds.size());
+	_shaderIds[shaders] = id;
+	return id;
+}
+
+unsigned int RenderQueue::GetResourceId(const void * resource)
+{
+	if (resource == nullptr)
+	{
+		return 0;
+	}
+	auto it = _resourceIds.find(resource);
+	if (it != _resourceIds.end())
+	{
+		return it->second;
+	}
+	// Id 0 is kept for no resource
+	unsigned int id = IssueSortKeyId(_resourceIds.size() + 1);
+	_resourceIds[resource] = id;
+	return id;
+}
+
+unsigned int RenderQueue::GetGeometryId(const DrawPacket& packet)
+{
+	// Draws only share geometry if they draw the same range of the same buffers
+	GeometryKey geometry(packet.VertexBuffer, packet.IndexBuffer, packet.StartIndex, packet.BaseVertex, packet.IndexCount);
+	auto it = _geometryIds.find(geometry);
+	if (it != _geometryIds.end())
+	{
+		return it->second;
+	}
+	unsigned int id = IssueSortKeyId(_geometryIds.size());
+	_geometryIds[geometry] = id;
+	return id;
+}
+
+unsigned int RenderQueue::IssueSortKeyId(size_t issuedCount)
+{
+	// Once the field in the key is full, everything else shares the last id rather than
+	// wrapping round on to ids that are already in use
+	if (issuedCount >= SortKeyIdMask)
+	{
+		_statistics.SortKeyIdOverflows++;
+		return SortKeyIdMask;
+	}
+	return static_cast<unsigned int>(issuedCount);
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <memory>
+#include "RenderDevice.h"
+#include "SortKey.h"
+#include "StateCache.h"
+#include "ShaderConstants.h"
+#include "ConstantBufferRing.h"
+
+// Everything that is needed to issue one indexed draw call.  The queue only holds handles to
+// the resources, so they must stay alive until the queue has been executed (the nodes that
+// submit packets own them, so this is the case during a frame).  Only the render device is
+// used to draw them, so the queue runs the same on RecordingRenderDevice as on Direct3D.
+
+struct DrawPacket
+{
+	RenderVertexShader				VertexShader;
+	RenderPixelShader				PixelShader;
+	RenderInputLayout				InputLayout;
+	RenderRasteriserState			RasteriserState;
+	RenderBuffer					VertexBuffer;
+	unsigned int					VertexStride;
+	RenderBuffer					IndexBuffer;
+	// 2 or 4 bytes
+	unsigned int					IndexSize;
+	unsigned int					IndexCount;
+	// Where the sub-mesh is in buffers that are shared with other sub-meshes (see GeometryArena)
+	unsigned int					StartIndex;
+	int								BaseVertex;
+	RenderShaderResource			Texture;
+	// The material's constant buffer.  Packets are also grouped on this when sorting.
+	RenderBuffer					MaterialConstantBuffer;
+	// The sub-mesh's MeshConstants, for vertices in the quantised format.  Null otherwise.
+	RenderBuffer					MeshConstantBuffer;
+
+	// If these are set, consecutive packets that share everything above are drawn with a single
+	// instanced draw, with the object constants of each packet in the instance stream
+	RenderVertexShader				InstancedVertexShader;
+	RenderInputLayout				InstancedInputLayout;
+
+	// Filled in by the queue when the packet is submitted
+	RenderPass						Pass;
+};
+
+struct RenderQueueStatistics
+{
+	size_t							PacketCount;
+	size_t							DrawCalls;
+	// Packets that were drawn as part of an instanced draw
+	size_t							InstancedPackets;
+	size_t							StateChanges;
+	// Calls for state that was already bound, which the state cache dropped
+	size_t							StateChangesSaved;
+	// Bytes of constant data uploaded, including the frame constants
+	size_t							ConstantDataUploaded;
+	// Shaders, resources and geometry that had to share the last sort key id because the frame
+	// used more than the key has room for.  Packets that share an id may not be grouped.
+	size_t							SortKeyIdOverflows;
+};
+
+// Draw packets are collected from the scene graph during the frame instead of being drawn
+// straight away.  At the end of the frame they are sorted on their keys and drawn in a single
+// loop that goes through the state cache, so the pipeline state is only changed when it differs
+// from what is already bound.  Runs of packets that differ only in their object constants are
+// drawn with one instanced draw call.
+
+class RenderQueue
+{
+public:
+	RenderQueue(shared_ptr<RenderDevice> device);
+	~RenderQueue();
+
+	// The buffers belong to the device, so the queue cannot be copied
+	RenderQueue(const RenderQueue&) = delete;
+	RenderQueue& operator=(const RenderQueue&) = delete;
+
+	// The frame constants are uploaded once when the queue is executed and stay bound for
+	// every packet
+	void							Begin(const FrameConstants& frameConstants, const Matrix& viewTransformation, float nearPlane, float farPlane);
+
+	// The object constants are copied into the queue and uploaded when it is executed.  The world transformation in them is used to find the depth of the packet.
+	void							Submit(RenderPass pass, const DrawPacket& packet, const ObjectConstants& objectConstants);
+
+	void							Sort();
+	void							Execute(StateCache * stateCache);
+
+	inline const RenderQueueStatistics&	GetStatistics() const { return _statistics; }
+
+private:
+	struct Batch
+	{
+		size_t						FirstEntry;
+		size_t						EntryCount;
+		size_t						FirstInstance;
+		// Where the object constants of a batch that is not instanced are in the constant ring
+		unsigned int				FirstConstant;
+	};
+
+	shared_ptr<RenderDevice>		_device;
+
+	FrameConstants					_frameConstants;
+	Matrix							_viewTransformation;
+	float							_nearPlane;
+	float							_farPlane;
+
+	vector<DrawPacket>				_packets;
+	vector<RenderQueueEntry>		_entries;
+	vector<RenderQueueEntry>		_sortScratch;
+	// The object constants of each packet, in the same order as the packets
+	vector<ObjectConstants>			_objectConstants;
+	vector<Batch>					_batches;
+	vector<ObjectConstants>			_instanceData;
+
+	RenderBuffer					_frameConstantBuffer;
+	// The object constants of every draw that is not instanced are written to slices of this
+	// ring in one go.  If the device cannot bind constant buffers at an offset, it is null and
+	// _objectConstantBuffer is updated before each draw instead.
+	unique_ptr<ConstantBufferRing>	_objectConstantRing;
+	RenderBuffer					_objectConstantBuffer;
+
+	// Dynamic vertex buffer holding the instance data for all of the instanced draws in a frame
+	RenderBuffer					_instanceBuffer;
+	size_t							_instanceBufferCapacity;
+
+	// Resources are given small ids the first time they are seen in a frame so that they fit in
+	// the sort key.  The ids only have to agree within a frame, so they are issued afresh by
+	// Begin.  That keeps the maps to the size of one frame, and an object released and created
+	// again at the same address cannot inherit the old id.
+	map<pair<const void *, const void *>, unsigned int>	_shaderIds;
+	unordered_map<const void *, unsigned int>			_resourceIds;
+	// Vertex buffer, index buffer, start index, base vertex and index count
+	typedef tuple<const void *, const void *, unsigned int, int, unsigned int> GeometryKey;
+	map<GeometryKey, unsigned int>						_geometryIds;
+
+	RenderQueueStatistics			_statistics;
+
+	void							BuildBatches();
+	void							UploadInstanceData();
+	void							UploadObjectConstants();
+	unsigned int					GetShaderId(const DrawPacket& packet);
+	unsigned int					GetResourceId(const void * resource);
+	unsigned int					GetGeometryId(const DrawPacket& packet);
+	unsigned int					IssueSortKeyId(size_t issuedCount);
+};
@@ -1,406 +1,903 @@
-#include "ResourceManager.h"
-#include "DirectXFramework.h"
-#include <sstream>
-#include "WICTextureLoader.h"
-#include <locale>
-#include <codecvt>
-
-#pragma comment(lib, "Assimp/lib/release/assimp-vc143-mt.lib")
-
-using namespace Assimp;
-
-//-------------------------------------------------------------------------------------------
-// Utility functions to convert from wstring to string and back
-// Copied from https://stackoverflow.com/questions/4804298/how-to-convert-wstring-into-string
-
-wstring s2ws(const std::string& str)
-{
-	using convert_typeX = std::codecvt_utf8<wchar_t>;
-	std::wstring_convert<convert_typeX, wchar_t> converterX;
-
-	return converterX.from_bytes(str);
-}
-
-string ws2s(const std::wstring& wstr)
-{
-	using convert_typeX = std::codecvt_utf8<wchar_t>;
-	std::wstring_convert<convert_typeX, wchar_t> converterX;
-
-	return converterX.to_bytes(wstr);
-}
-
-//-------------------------------------------------------------------------------------------
-
-ResourceManager::ResourceManager()
-{
-	_device = DirectXFramework::GetDXFramework()->GetDevice();
-	_deviceContext = DirectXFramework::GetDXFramework()->GetDeviceContext();
-}
-
-ResourceManager::~ResourceManager(void)
-{
-}
-
-shared_ptr<Mesh> ResourceManager::GetMesh(wstring modelName)
-{
-	// CHeck to see if the mesh has already been loaded
-	MeshResourceMap::iterator it = _meshResources.find(modelName);
-	if (it != _meshResources.end())
-	{
-		// Update reference count and return pointer to existing mesh
-		it->second.ReferenceCount++;
-		return it->second.MeshPointer;
-	}
-	else
-	{
-		// This is the first request for this model.  Load the mesh and
-		// save a reference to it.
-		shared_ptr<Mesh> mesh = LoadModelFromFile(modelName);
-		if (mesh != nullptr)
-		{
-			MeshResourceStruct resourceStruct;
-			resourceStruct.ReferenceCount = 1;
-			resourceStruct.MeshPointer = mesh;
-			_meshResources[modelName] = resourceStruct;
-			return mesh;
-		}
-		else
-		{
-			return nullptr;
-		}
-	}
-}
-
-void ResourceManager::ReleaseMesh(wstring modelName)
-{
-	MeshResourceMap::iterator it = _meshResources.find(modelName);
-	if (it != _meshResources.end())
-	{
-		it->second.ReferenceCount--;
-		if (it->second.ReferenceCount == 0)
-		{
-			// Release any materials used by this mesh
-			shared_ptr<Mesh> mesh = it->second.MeshPointer;
-			unsigned int subMeshCount = static_cast<unsigned int>(mesh->GetSubMeshCount());
-			// Loop through all submeshes in the mesh
-			for (unsigned int i = 0; i < subMeshCount; i++)
-			{
-				shared_ptr<SubMesh> subMesh = mesh->GetSubMesh(i);
-				wstring materialName = subMesh->GetMaterial()->GetMaterialName();
-				ReleaseMaterial(materialName);
-			}
-			// If no other nodes are using this mesh, remove it frmo the map
-			// (which will also release the resources).
-			it->second.MeshPointer = nullptr;
-			_meshResources.erase(modelName);
-		}
-	}
-}
-
-void ResourceManager::CreateMaterialFromTexture(wstring textureName)
-{
-    // We have no diffuse or specular colours here since we are just building a default material structure
-    // based on a provided texture. Just use the texture name as the material name in this case
-    InitialiseMaterial(textureName, 
-                       Vector4(1.0f, 1.0f, 1.0f, 1.0f), 
-                       Vector4(0.0f, 0.0f, 0.0f, 1.0f),
-                       0,
-	   			       1.0f,
-                       textureName);
-}
-
-void ResourceManager::CreateMaterialWithNoTexture(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity)
-{
-    InitialiseMaterial(materialName, diffuseColour, specularColour, shininess, opacity, L"");
-}
-
-void ResourceManager::CreateMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, wstring textureName)
-{
-    InitialiseMaterial(materialName, diffuseColour, specularColour, shininess, opacity, textureName);
-}
-
-shared_ptr<Material> ResourceManager::GetMaterial(wstring materialName)
-{
-	// This works a bit different to the GetMesh method.  We can only find
-	// materials we have previously created (usually when the mesh was loaded
-	// from the file).
-	MaterialResourceMap::iterator it = _materialResources.find(materialName);
-	if (it != _materialResources.end())
-	{
-		it->second.ReferenceCount++;
-		return it->second.MaterialPointer;
-	}
-	else
-	{
-		// Material not previously created.
-		return nullptr;
-	}
-}
-
-void ResourceManager::ReleaseMaterial(wstring materialName)
-{
-	MaterialResourceMap::iterator it = _materialResources.find(materialName);
-	if (it != _materialResources.end())
-	{
-		it->second.ReferenceCount--;
-		if (it->second.ReferenceCount == 0)
-		{
-			it->second.MaterialPointer = nullptr;
-			_meshResources.erase(materialName);
-		}
-	}
-}
-
-void ResourceManager::InitialiseMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, wstring textureName)
-{
-	MaterialResourceMap::iterator it = _materialResources.find(materialName);
-	if (it == _materialResources.end())
-	{
-		// We are creating the material for the first time
-		ComPtr<ID3D11ShaderResourceView> texture;
-		if (textureName.size() > 0)
-		{
-			// A texture was specified.  Try to load it.
-			if (FAILED(CreateWICTextureFromFile(_device.Get(),
-											    _deviceContext.Get(),
-												textureName.c_str(),
-												nullptr,
-												texture.GetAddressOf()
-												)))
-			{
-				texture = nullptr;
-			}
-		}
-		else
-		{
-			texture = nullptr;;
-		}
-		shared_ptr<Material> material = make_shared<Material>(materialName, diffuseColour, specularColour, shininess, opacity, texture);
-		MaterialResourceStruct resourceStruct;
-		resourceStruct.ReferenceCount = 0;
-		resourceStruct.MaterialPointer = material;
-		_materialResources[materialName] = resourceStruct;
-	}
-}
-
-shared_ptr<Mesh> ResourceManager::LoadModelFromFile(wstring modelName)
-{
-	ComPtr<ID3D11Buffer> vertexBuffer;
-	ComPtr<ID3D11Buffer> indexBuffer;
-	wstring* materials = nullptr;
-
-	Importer importer;
-
-	unsigned int postProcessSteps = aiProcess_Triangulate |
-		aiProcess_ConvertToLeftHanded;
-	string modelNameUTF8 = ws2s(modelName);
-	const aiScene* scene = importer.ReadFile(modelNameUTF8.c_str(), postProcessSteps);
-	if (!scene)
-	{
-		// If failed to load, there is nothing to do
-		return nullptr;
-	}
-	if (!scene->HasMeshes())
-	{
-		//If there are no meshes, then there is nothing to do.
-		return nullptr;
-	}
-	if (scene->HasMaterials())
-	{
-		// We need to find the directory part of the model name since we will need to add it to any texture names. 
-		// There is definately a more elegant and accurate way to do this using Windows API calls, but this is a quick
-		// and dirty approach
-		string::size_type slashIndex = modelNameUTF8.find_last_of("\\");
-		string directory;
-		if (slashIndex == string::npos)
-		{
-			directory = ".";
-		}
-		else if (slashIndex == 0)
-		{
-			directory = "/";
-		}
-		else
-		{
-			directory = modelNameUTF8.substr(0, slashIndex);
-		}
-		// Let's deal with the materials/textures first
-		materials = new wstring[scene->mNumMaterials];
-		for (unsigned int i = 0; i < scene->mNumMaterials; i++)
-		{
-			// Get the core material properties.  Ideally, we would be looking for more information
-			// e.g. emissive colour, etc.  This is a task for later.
-			aiMaterial* material = scene->mMaterials[i];
-
-			aiColor3D diffuseColour(0.0f, 0.0f, 0.0f);
-			material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuseColour);
-			aiColor3D specularColour(0.0f, 0.0f, 0.0f);
-			material->Get(AI_MATKEY_COLOR_SPECULAR, specularColour);
-			float defaultShininess = 0.0f;
-			float& shininess = defaultShininess;
-			material->Get(AI_MATKEY_SHININESS, shininess);
-			float defaultOpacity = 1.0f;
-			float& opacity = defaultOpacity;
-			material->Get(AI_MATKEY_OPACITY, opacity);
-			string fullTextureNamePath = "";
-			if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0)
-			{
-				aiString textureName;
-				float blendFactor;
-				aiTextureOp blendOp;
-				if (material->GetTexture(aiTextureType_DIFFUSE, 0, &textureName, NULL, NULL, &blendFactor, &blendOp, NULL) == AI_SUCCESS)
-				{
-					// Get full path to texture by prepending the same folder as included in the model name. This
-					// does assume that textures are in the same folder as the model files
-					fullTextureNamePath = directory + "\\" + textureName.data;
-				}
-			}
-			// Now create a unique name for the material based on the model name and loop count
-			stringstream materialNameStream;
-			materialNameStream << modelNameUTF8 << i;
-			string materialName = materialNameStream.str();
-			wstring materialNameWS = s2ws(materialName);
-			CreateMaterial(materialNameWS,
-				Vector4(diffuseColour.r, diffuseColour.g, diffuseColour.b, 1.0f),
-				Vector4(specularColour.r, specularColour.g, specularColour.b, 1.0f),
-				shininess,
-				opacity,
-				s2ws(fullTextureNamePath));
-			materials[i] = materialNameWS;
-		}
-	}
-	// Now we have created all of the materials, build up the mesh
-	shared_ptr<Mesh> resourceMesh = make_shared<Mesh>();
-	for (unsigned int sm = 0; sm < scene->mNumMeshes; sm++)
-	{
-		aiMesh* subMesh = scene->mMeshes[sm];
-		unsigned int numVertices = subMesh->mNumVertices;
-		bool hasNormals = subMesh->HasNormals();
-		bool hasTexCoords = subMesh->HasTextureCoords(0);
-		if (numVertices == 0)
-		{
-			return nullptr;
-		}
-		// Build up our vertex structure
-		aiVector3D* subMeshVertices = subMesh->mVertices;
-		aiVector3D* subMeshNormals = subMesh->mNormals;
-		// We only handle one set of UV coordinates at the moment.  Again, handling multiple sets of UV
-		// coordinates is a future enhancement.
-		aiVector3D* subMeshTexCoords = subMesh->mTextureCoords[0];
-		Vertex* modelVertices = new Vertex[numVertices];
-		Vertex* currentVertex = modelVertices;
-		for (unsigned int i = 0; i < numVertices; i++)
-		{
-			currentVertex->Position = Vector3(subMeshVertices->x, subMeshVertices->y, subMeshVertices->z);
-			if (hasNormals)
-			{
-				currentVertex->Normal = Vector3(subMeshNormals->x, subMeshNormals->y, subMeshNormals->z);
-			}
-			else
-			{
-				currentVertex->Normal = Vector3(0, 0, 0);
-			}
-			subMeshVertices++;
-			subMeshNormals++;
-			if (!hasTexCoords)
-			{
-				// If the model does not have texture coordinates, set them to 0
-				currentVertex->TexCoord = Vector2(0.0f, 0.0f);
-			}
-			else
-			{
-				// Handle negative texture coordinates by wrapping them to positive.  This should
-				// ideally be handled in the shader.  Note we are assuming that negative coordinates
-				// here are no smaller than -1.0 - this may not be a valid assumption.
-				if (subMeshTexCoords->x < 0)
-				{
-					currentVertex->TexCoord.x = subMeshTexCoords->x + 1.0f;
-				}
-				else
-				{
-					currentVertex->TexCoord.x = subMeshTexCoords->x;
-				}
-				if (subMeshTexCoords->y < 0)
-				{
-					currentVertex->TexCoord.y = subMeshTexCoords->y + 1.0f;
-				}
-				else
-				{
-					currentVertex->TexCoord.y = subMeshTexCoords->y;
-				}
-				subMeshTexCoords++;
-			}
-			currentVertex++;
-		}
-
-		D3D11_BUFFER_DESC vertexBufferDescriptor;
-		vertexBufferDescriptor.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDescriptor.ByteWidth = sizeof(Vertex) * numVertices;
-		vertexBufferDescriptor.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDescriptor.CPUAccessFlags = 0;
-		vertexBufferDescriptor.MiscFlags = 0;
-		vertexBufferDescriptor.StructureByteStride = 0;
-
-		// Now set up a structure that tells DirectX where to get the
-		// data for the vertices from
-		D3D11_SUBRESOURCE_DATA vertexInitialisationData;
-		vertexInitialisationData.pSysMem = modelVertices;
-
-		// and create the vertex buffer
-		if (FAILED(_device->CreateBuffer(&vertexBufferDescriptor, &vertexInitialisationData, vertexBuffer.GetAddressOf())))
-		{
-			return nullptr;
-		}
-
-		// Now extract the indices from the file
-		unsigned int numberOfFaces = subMesh->mNumFaces;
-		unsigned int numberOfIndices = numberOfFaces * 3;
-		aiFace* subMeshFaces = subMesh->mFaces;
-		if (subMeshFaces->mNumIndices != 3)
-		{
-			// We are not dealing with triangles, so we cannot handle it
-			return nullptr;
-		}
-		unsigned int* modelIndices = new unsigned int[numberOfIndices * 3];
-		unsigned int* currentIndex = modelIndices;
-		for (unsigned int i = 0; i < numberOfFaces; i++)
-		{
-			*currentIndex++ = subMeshFaces->mIndices[0];
-			*currentIndex++ = subMeshFaces->mIndices[1];
-			*currentIndex++ = subMeshFaces->mIndices[2];
-			subMeshFaces++;
-		}
-		// Setup the structure that specifies how big the index 
-		// buffer should be
-		D3D11_BUFFER_DESC indexBufferDescriptor;
-		indexBufferDescriptor.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDescriptor.ByteWidth = sizeof(UINT) * numberOfIndices * 3;
-		indexBufferDescriptor.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDescriptor.CPUAccessFlags = 0;
-		indexBufferDescriptor.MiscFlags = 0;
-		indexBufferDescriptor.StructureByteStride = 0;
-
-		// Now set up a structure that tells DirectX where to get the
-		// data for the indices from
-		D3D11_SUBRESOURCE_DATA indexInitialisationData;
-		indexInitialisationData.pSysMem = modelIndices;
-
-		// and create the index buffer
-		if (FAILED(_device->CreateBuffer(&indexBufferDescriptor, &indexInitialisationData, indexBuffer.GetAddressOf())))
-		{
-			return nullptr;
-		}
-
-		// Do we have a material associated with this mesh?
-		shared_ptr<Material> material = nullptr;
-		if (scene->HasMaterials())
-		{
-			material = GetMaterial(materials[subMesh->mMaterialIndex]);
-		}
-		shared_ptr<SubMesh> resourceSubMesh = make_shared<SubMesh>(vertexBuffer, indexBuffer, numVertices, numberOfIndices, material, hasNormals, hasTexCoords);
-		resourceMesh->AddSubMesh(resourceSubMesh);
-		delete[] modelVertices;
-		delete[] modelIndices;
-	}
-	return resourceMesh;
-}
+#include "ResourceManager.h"
+#include "DirectXFramework.h"
+#include "ShaderConstants.h"
+#include "MeshCache.h"
+#include "MeshOptimiser.h"
+#include <sstream>
+#include "TextureLoader.h"
+#include <chrono>
+#include <locale>
+#include <codecvt>
+
+#pragma comment(lib, "Assimp/lib/release/assimp-vc143-mt.lib")
+
+#define MeshCacheDirectory	L"MeshCache"
+
+using namespace Assimp;
+
+//-------------------------------------------------------------------------------------------
+// Utility functions to convert from wstring to string and back
+// Copied from https://stackoverflow.com/questions/4804298/how-to-convert-wstring-into-string
+
+wstring s2ws(const std::string& str)
+{
+	using convert_typeX = std::codecvt_utf8<wchar_t>;
+	std::wstring_convert<convert_typeX, wchar_t> converterX;
+
+	return converterX.from_bytes(str);
+}
+
+string ws2s(const std::wstring& wstr)
+{
+	using convert_typeX = std::codecvt_utf8<wchar_t>;
+	std::wstring_convert<convert_typeX, wchar_t> converterX;
+
+	return converterX.to_bytes(wstr);
+}
+
+//-------------------------------------------------------------------------------------------
+
+ResourceManager::ResourceManager()
+{
+	_device = DirectXFramework::GetDXFramework()->GetDevice();
+	_deviceContext = DirectXFramework::GetDXFramework()->GetDeviceContext();
+	_shaderLibrary = make_shared<ShaderLibrary>(_device);
+	_workerPool = DirectXFramework::GetDXFramework()->GetWorkerPool();
+}
+
+ResourceManager::~ResourceManager(void)
+{
+}
+
+shared_ptr<Mesh> ResourceManager::GetMesh(wstring modelName)
+{
+	// CHeck to see if the mesh has already been loaded
+	MeshResourceMap::iterator it = _meshResources.find(modelName);
+	if (it != _meshResources.end())
+	{
+		// Update reference count and return pointer to existing mesh
+		it->second.ReferenceCount++;
+		return it->second.MeshPointer;
+	}
+	PendingMeshMap::iterator pending = _pendingMeshes.find(modelName);
+	if (pending != _pendingMeshes.end())
+	{
+		// The model is already being loaded by GetMeshAsync.  Wait for it rather than loading
+		// it twice.
+		pending->second.ReferenceCount++;
+		pending->second.Prepared.wait();
+		CompletePendingMesh(modelName, pending->second);
+		_pendingMeshes.erase(pending);
+		it = _meshResources.find(modelName);
+		return it != _meshResources.end() ? it->second.MeshPointer : nullptr;
+	}
+	else
+	{
+		// This is the first request for this model.  Load the mesh and
+		// save a reference to it.
+		shared_ptr<Mesh> mesh = LoadModelFromFile(modelName);
+		if (mesh != nullptr)
+		{
+			MeshResourceStruct resourceStruct;
+			resourceStruct.ReferenceCount = 1;
+			resourceStruct.MeshPointer = mesh;
+			_meshResources[modelName] = resourceStruct;
+			return mesh;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+}
+
+void ResourceManager::ReleaseMesh(wstring modelName)
+{
+	MeshResourceMap::iterator it = _meshResources.find(modelName);
+	if (it != _meshResources.end())
+	{
+		it->second.ReferenceCount--;
+		if (it->second.ReferenceCount == 0)
+		{
+			// Release any materials used by this mesh
+			shared_ptr<Mesh> mesh = it->second.MeshPointer;
+			unsigned int subMeshCount = static_cast<unsigned int>(mesh->GetSubMeshCount());
+			// Loop through all submeshes in the mesh
+			for (unsigned int i = 0; i < subMeshCount; i++)
+			{
+				// Procedural meshes do not have materials
+				shared_ptr<Material> material = mesh->GetSubMesh(i)->GetMaterial();
+				if (material != nullptr)
+				{
+					ReleaseMaterial(material->GetMaterialName());
+				}
+			}
+			// If no other nodes are using this mesh, remove it frmo the map
+			// (which will also release the resources).
+			it->second.MeshPointer = nullptr;
+			_meshResources.erase(modelName);
+		}
+		return;
+	}
+	// If the mesh is still loading, it is thrown away when it finishes if nothing else has
+	// asked for it by then
+	PendingMeshMap::iterator pending = _pendingMeshes.find(modelName);
+	if (pending != _pendingMeshes.end() && pending->second.ReferenceCount > 0)
+	{
+		pending->second.ReferenceCount--;
+	}
+}
+
+MeshHandle ResourceManager::GetMeshAsync(wstring modelName)
+{
+	MeshHandle handle = make_shared<AsyncMesh>();
+	MeshResourceMap::iterator it = _meshResources.find(modelName);
+	if (it != _meshResources.end())
+	{
+		it->second.ReferenceCount++;
+		handle->State = MeshLoaded;
+		handle->MeshPointer = it->second.MeshPointer;
+		return handle;
+	}
+	PendingMeshMap::iterator pending = _pendingMeshes.find(modelName);
+	if (pending != _pendingMeshes.end())
+	{
+		pending->second.ReferenceCount++;
+		return pending->second.Handle;
+	}
+
+	// Everything up to creating the Direct3D resources is done on a worker.  The task only
+	// uses the prepared model and the promise, both of which it shares ownership of, so it
+	// does not matter if the resource manager has gone by the time it runs.
+	handle->State = MeshLoading;
+	shared_ptr<PreparedModel> model = make_shared<PreparedModel>();
+	shared_ptr<promise<bool>> prepared = make_shared<promise<bool>>();
+	PendingMeshStruct pendingStruct;
+	pendingStruct.ReferenceCount = 1;
+	pendingStruct.Handle = handle;
+	pendingStruct.Model = model;
+	pendingStruct.Prepared = prepared->get_future().share();
+	_pendingMeshes[modelName] = pendingStruct;
+	WorkerPool * workerPool = _workerPool.get();
+	_workerPool->Submit([modelName, model, prepared, workerPool]()
+		{
+			bool succeeded = false;
+			try
+			{
+				// The textures are decoded with ParallelFor, which this worker joins in with,
+				// so it still finishes if every other worker is busy
+				succeeded = PrepareModel(modelName, *model, workerPool);
+			}
+			catch (...)
+			{
+			}
+			prepared->set_value(succeeded);
+		});
+	return handle;
+}
+
+// The fraction of the free space in an arena that can be in gaps before it is compacted
+const float GeometryArenaCompactThreshold = 0.5f;
+
+void ResourceManager::Update()
+{
+	PendingMeshMap::iterator it = _pendingMeshes.begin();
+	while (it != _pendingMeshes.end())
+	{
+		if (it->second.Prepared.wait_for(chrono::seconds(0)) == future_status::ready)
+		{
+			CompletePendingMesh(it->first, it->second);
+			it = _pendingMeshes.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	// Meshes that have been released leave gaps in the arenas.  Once the gaps make up enough
+	// of the free space, the arena is packed together again.
+	for (pair<const UINT, shared_ptr<GeometryArena>>& arena : _geometryArenas)
+	{
+		arena.second->Compact(GeometryArenaCompactThreshold);
+	}
+}
+
+void ResourceManager::CompletePendingMesh(const wstring& modelName, PendingMeshStruct& pending)
+{
+	if (pending.ReferenceCount == 0)
+	{
+		// Everything that asked for the mesh has released it
+		pending.Handle->State = MeshLoadFailed;
+		return;
+	}
+	shared_ptr<Mesh> mesh = nullptr;
+	if (pending.Prepared.get())
+	{
+		KeepOptimiserReports(modelName, *pending.Model);
+		mesh = CreateMeshFromCache(modelName, *pending.Model);
+	}
+	if (mesh == nullptr)
+	{
+		pending.Handle->State = MeshLoadFailed;
+		return;
+	}
+	MeshResourceStruct resourceStruct;
+	resourceStruct.ReferenceCount = pending.ReferenceCount;
+	resourceStruct.MeshPointer = mesh;
+	_meshResources[modelName] = resourceStruct;
+	pending.Handle->MeshPointer = mesh;
+	pending.Handle->State = MeshLoaded;
+}
+
+shared_ptr<Mesh> ResourceManager::GetProceduralMesh(wstring meshKey, const MeshGenerator& generator)
+{
+	// This works the same way as GetMesh, but the mesh is generated rather than loaded
+	MeshResourceMap::iterator it = _meshResources.find(meshKey);
+	if (it != _meshResources.end())
+	{
+		it->second.ReferenceCount++;
+		return it->second.MeshPointer;
+	}
+	shared_ptr<Mesh> mesh = CreateProceduralMesh(generator);
+	if (mesh == nullptr)
+	{
+		return nullptr;
+	}
+	MeshResourceStruct resourceStruct;
+	resourceStruct.ReferenceCount = 1;
+	resourceStruct.MeshPointer = mesh;
+	_meshResources[meshKey] = resourceStruct;
+	return mesh;
+}
+
+// Converts the vertices generated by the functions in GeometricObject to the format used by meshes
+
+static void CopyObjectVertices(const vector<ObjectVertexStruct>& objectVertices, vector<Vertex>& vertices)
+{
+	vertices.resize(objectVertices.size());
+	for (size_t i = 0; i < objectVertices.size(); i++)
+	{
+		vertices[i].Position = objectVertices[i].Position;
+		vertices[i].Normal = objectVertices[i].Normal;
+		vertices[i].TexCoord = Vector2(0.0f, 0.0f);
+	}
+}
+
+// Most of the functions in GeometricObject generate positions only, so the normals are calculated
+// before the vertices are converted
+
+static void GenerateObjectMesh(vector<ObjectVertexStruct>& objectVertices, const vector<UINT>& indices, vector<Vertex>& vertices)
+{
+	ComputeVertexNormals(objectVertices, indices);
+	CopyObjectVertices(objectVertices, vertices);
+}
+
+shared_ptr<Mesh> ResourceManager::GetBoxMesh(const Vector3& size)
+{
+	return GetProceduralMesh(GetBoxMeshKey(size), [size](vector<Vertex>& vertices, vector<UINT>& indices)
+		{
+			vector<ObjectVertexStruct> objectVertices;
+			ComputeBox(objectVertices, indices, size);
+			GenerateObjectMesh(objectVertices, indices, vertices);
+		});
+}
+
+shared_ptr<Mesh> ResourceManager::GetSphereMesh(float diameter, size_t tessellation)
+{
+	return GetProceduralMesh(GetSphereMeshKey(diameter, tessellation), [diameter, tessellation](vector<Vertex>& vertices, vector<UINT>& indices)
+		{
+			vector<ObjectVertexStruct> objectVertices;
+			ComputeSphere(objectVertices, indices, diameter, tessellation);
+			GenerateObjectMesh(objectVertices, indices, vertices);
+		});
+}
+
+shared_ptr<Mesh> ResourceManager::GetCylinderMesh(float height, float diameter, size_t tessellation)
+{
+	return GetProceduralMesh(GetCylinderMeshKey(height, diameter, tessellation), [height, diameter, tessellation](vector<Vertex>& vertices, vector<UINT>& indices)
+		{
+			vector<ObjectVertexStruct> objectVertices;
+			ComputeCylinder(objectVertices, indices, height, diameter, tessellation);
+			GenerateObjectMesh(objectVertices, indices, vertices);
+		});
+}
+
+shared_ptr<Mesh> ResourceManager::GetConeMesh(float diameter, float height, size_t tessellation)
+{
+	return GetProceduralMesh(GetConeMeshKey(diameter, height, tessellation), [diameter, height, tessellation](vector<Vertex>& vertices, vector<UINT>& indices)
+		{
+			vector<ObjectVertexStruct> objectVertices;
+			ComputeCone(objectVertices, indices, diameter, height, tessellation);
+			GenerateObjectMesh(objectVertices, indices, vertices);
+		});
+}
+
+shared_ptr<Mesh> ResourceManager::GetTeapotMesh(float size, size_t tessellation)
+{
+	WorkerPool * workerPool = _workerPool.get();
+	return GetProceduralMesh(GetTeapotMeshKey(size, tessellation), [size, tessellation, workerPool](vector<Vertex>& vertices, vector<UINT>& indices)
+		{
+			// Each patch writes to its own part of the arrays, so the patches are tessellated
+			// across the worker pool.  The normals come from the patches.
+			GeometryCounts counts = GetTeapotCounts(tessellation);
+			vector<ObjectVertexStruct> objectVertices(counts.VertexCount);
+			indices.resize(counts.IndexCount);
+			workerPool->ParallelFor(GetTeapotPatchCount(), [&](size_t patch)
+				{
+					ComputeTeapotPatch(objectVertices.data(), indices.data(), size, tessellation, patch);
+				});
+			CopyObjectVertices(objectVertices, vertices);
+		});
+}
+
+// The keys start with '*', which is not allowed in file names, so they cannot clash
+// with the names of models loaded from files
+
+wstring ResourceManager::GetBoxMeshKey(const Vector3& size)
+{
+	wstringstream key;
+	key << L"*box(" << size.x << L"," << size.y << L"," << size.z << L")";
+	return key.str();
+}
+
+wstring ResourceManager::GetSphereMeshKey(float diameter, size_t tessellation)
+{
+	wstringstream key;
+	key << L"*sphere(" << diameter << L"," << tessellation << L")";
+	return key.str();
+}
+
+wstring ResourceManager::GetCylinderMeshKey(float height, float diameter, size_t tessellation)
+{
+	wstringstream key;
+	key << L"*cylinder(" << height << L"," << diameter << L"," << tessellation << L")";
+	return key.str();
+}
+
+wstring ResourceManager::GetConeMeshKey(float diameter, float height, size_t tessellation)
+{
+	wstringstream key;
+	key << L"*cone(" << diameter << L"," << height << L"," << tessellation << L")";
+	return key.str();
+}
+
+wstring ResourceManager::GetTeapotMeshKey(float size, size_t tessellation)
+{
+	wstringstream key;
+	key << L"*teapot(" << size << L"," << tessellation << L")";
+	return key.str();
+}
+
+void ResourceManager::CreateMaterialFromTexture(wstring textureName)
+{
+    // We have no diffuse or specular colours here since we are just building a default material structure
+    // based on a provided texture. Just use the texture name as the material name in this case
+    InitialiseMaterial(textureName, 
+                       Vector4(1.0f, 1.0f, 1.0f, 1.0f), 
+                       Vector4(0.0f, 0.0f, 0.0f, 1.0f),
+                       0,
+	   			       1.0f,
+                       textureName);
+}
+
+void ResourceManager::CreateMaterialWithNoTexture(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity)
+{
+    InitialiseMaterial(materialName, diffuseColour, specularColour, shininess, opacity, L"");
+}
+
+void ResourceManager::CreateMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, wstring textureName)
+{
+    InitialiseMaterial(materialName, diffuseColour, specularColour, shininess, opacity, textureName);
+}
+
+shared_ptr<Material> ResourceManager::GetMaterial(wstring materialName)
+{
+	// This works a bit different to the GetMesh method.  We can only find
+	// materials we have previously created (usually when the mesh was loaded
+	// from the file).
+	MaterialResourceMap::iterator it = _materialResources.find(materialName);
+	if (it != _materialResources.end())
+	{
+		it->second.ReferenceCount++;
+		return it->second.MaterialPointer;
+	}
+	else
+	{
+		// Material not previously created.
+		return nullptr;
+	}
+}
+
+void ResourceManager::ReleaseMaterial(wstring materialName)
+{
+	MaterialResourceMap::iterator it = _materialResources.find(materialName);
+	if (it != _materialResources.end())
+	{
+		it->second.ReferenceCount--;
+		if (it->second.ReferenceCount == 0)
+		{
+			it->second.MaterialPointer = nullptr;
+			_materialResources.erase(it);
+		}
+	}
+}
+
+void ResourceManager::InitialiseMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, wstring textureName)
+{
+	MaterialResourceMap::iterator it = _materialResources.find(materialName);
+	if (it == _materialResources.end())
+	{
+		// We are creating the material for the first time
+		ComPtr<ID3D11ShaderResourceView> texture;
+		DecodedTexture decodedTexture;
+		if (textureName.size() > 0 && DecodeTexture(textureName, decodedTexture))
+		{
+			// A texture was specified and could be read.  If the texture cannot be created, the
+			// material is created without it.
+			texture = CreateTexture(decodedTexture);
+		}
+		AddMaterial(materialName, diffuseColour, specularColour, shininess, opacity, texture);
+	}
+}
+
+vector<ComPtr<ID3D11ShaderResourceView>> ResourceManager::LoadTextures(const vector<wstring>& textureNames)
+{
+	vector<DecodedTexture> decodedTextures;
+	DecodeTextures(textureNames, decodedTextures, _workerPool.get());
+	vector<ComPtr<ID3D11ShaderResourceView>> textures(textureNames.size());
+	for (size_t i = 0; i < textureNames.size(); i++)
+	{
+		textures[i] = CreateTexture(decodedTextures[i]);
+	}
+	return textures;
+}
+
+ComPtr<ID3D11ShaderResourceView> ResourceManager::CreateTexture(const DecodedTexture& decodedTexture)
+{
+	ComPtr<ID3D11ShaderResourceView> texture;
+	if (decodedTexture.Pixels.empty() ||
+		FAILED(CreateTextureFromDecoded(_device.Get(), _deviceContext.Get(), decodedTexture, texture.GetAddressOf())))
+	{
+		return nullptr;
+	}
+	return texture;
+}
+
+void ResourceManager::AddMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, ComPtr<ID3D11ShaderResourceView> texture)
+{
+	MaterialResourceMap::iterator it = _materialResources.find(materialName);
+	if (it == _materialResources.end())
+	{
+		// The material properties never change, so they go in an immutable constant buffer
+		// that is created once here rather than being uploaded every time the material is used
+		MaterialConstants materialConstants = {};
+		materialConstants.DiffuseColour = diffuseColour;
+		materialConstants.SpecularColour = specularColour;
+		materialConstants.Shininess = shininess;
+		materialConstants.Opacity = opacity;
+		D3D11_BUFFER_DESC bufferDesc = { 0 };
+		bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		bufferDesc.ByteWidth = sizeof(MaterialConstants);
+		bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		D3D11_SUBRESOURCE_DATA initialisationData = { 0 };
+		initialisationData.pSysMem = &materialConstants;
+		ComPtr<ID3D11Buffer> constantBuffer;
+		ThrowIfFailed(_device->CreateBuffer(&bufferDesc, &initialisationData, constantBuffer.GetAddressOf()));
+
+		shared_ptr<Material> material = make_shared<Material>(materialName, diffuseColour, specularColour, shininess, opacity, texture, constantBuffer);
+		MaterialResourceStruct resourceStruct;
+		resourceStruct.ReferenceCount = 0;
+		resourceStruct.MaterialPointer = material;
+		_materialResources[materialName] = resourceStruct;
+	}
+}
+
+shared_ptr<Mesh> ResourceManager::LoadModelFromFile(wstring modelName)
+{
+	PreparedModel model;
+	if (!PrepareModel(modelName, model, _workerPool.get()))
+	{
+		return nullptr;
+	}
+	KeepOptimiserReports(modelName, model);
+	return CreateMeshFromCache(modelName, model);
+}
+
+bool ResourceManager::PrepareModel(const wstring& modelName, PreparedModel& model, WorkerPool * workerPool)
+{
+	MeshSourceStamp source;
+	if (!GetMeshSourceStamp(modelName, source))
+	{
+		return false;
+	}
+	// If the model has been imported before and has not changed since, use the cache
+	wstring cacheFileName = GetMeshCacheFileName(modelName);
+	if (!model.CacheFile.Open(cacheFileName) || !model.Cache.Open(model.CacheFile.GetData(), model.CacheFile.GetSize(), source))
+	{
+		model.CacheFile.Close();
+
+		// Otherwise import it and write the cache for next time.  Failing to write the cache is
+		// not an error.  The model will just be imported again next time.
+		if (!ImportModel(modelName, source, model.CacheData, model.OptimiserReports) || !model.Cache.Open(model.CacheData.data(), model.CacheData.size(), source))
+		{
+			return false;
+		}
+		CreateDirectoryW(MeshCacheDirectory, nullptr);
+		WriteMeshCache(cacheFileName, model.CacheData);
+	}
+
+	// Decode the textures of all the materials together, so that only the textures themselves
+	// are left to create on the main thread.  A texture that cannot be read is left empty and
+	// the material is created without it.
+	uint32_t materialCount = model.Cache.GetHeader().MaterialCount;
+	vector<wstring> textureNames(materialCount);
+	for (uint32_t i = 0; i < materialCount; i++)
+	{
+		textureNames[i] = s2ws(model.Cache.GetTextureName(model.Cache.GetMaterial(i)));
+	}
+	DecodeTextures(textureNames, model.Textures, workerPool);
+	return true;
+}
+
+void ResourceManager::KeepOptimiserReports(const wstring& modelName, PreparedModel& model)
+{
+	if (!model.OptimiserReports.empty())
+	{
+		_optimiserReports[modelName] = move(model.OptimiserReports);
+	}
+}
+
+const vector<MeshOptimiserReport> * ResourceManager::GetOptimiserReports(const wstring& modelName) const
+{
+	auto it = _optimiserReports.find(modelName);
+	if (it == _optimiserReports.end())
+	{
+		return nullptr;
+	}
+	return &it->second;
+}
+
+wstring ResourceManager::GetMeshCacheFileName(const wstring& modelName)
+{
+	// Flatten the path of the model into a single file name in the cache directory
+	wstring fileName = modelName;
+	for (wchar_t& character : fileName)
+	{
+		if (character == L'\\' || character == L'/' || character == L':')
+		{
+			character = L'_';
+		}
+	}
+	return wstring(MeshCacheDirectory) + L"\\" + fileName + L".mesh";
+}
+
+bool ResourceManager::ImportModel(const wstring& modelName, const MeshSourceStamp& source, vector<BYTE>& cacheData, vector<MeshOptimiserReport>& optimiserReports)
+{
+	Importer importer;
+
+	unsigned int postProcessSteps = aiProcess_Triangulate |
+		aiProcess_ConvertToLeftHanded;
+	string modelNameUTF8 = ws2s(modelName);
+	const aiScene* scene = importer.ReadFile(modelNameUTF8.c_str(), postProcessSteps);
+	if (!scene)
+	{
+		// If failed to load, there is nothing to do
+		return false;
+	}
+	if (!scene->HasMeshes())
+	{
+		//If there are no meshes, then there is nothing to do.
+		return false;
+	}
+	vector<ImportedMaterial> materials;
+	if (scene->HasMaterials())
+	{
+		// We need to find the directory part of the model name since we will need to add it to any texture names. 
+		// There is definately a more elegant and accurate way to do this using Windows API calls, but this is a quick
+		// and dirty approach
+		string::size_type slashIndex = modelNameUTF8.find_last_of("\\");
+		string directory;
+		if (slashIndex == string::npos)
+		{
+			directory = ".";
+		}
+		else if (slashIndex == 0)
+		{
+			directory = "/";
+		}
+		else
+		{
+			directory = modelNameUTF8.substr(0, slashIndex);
+		}
+		// Let's deal with the materials/textures first
+		materials.resize(scene->mNumMaterials);
+		for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+		{
+			// Get the core material properties.  Ideally, we would be looking for more information
+			// e.g. emissive colour, etc.  This is a task for later.
+			aiMaterial* material = scene->mMaterials[i];
+
+			aiColor3D diffuseColour(0.0f, 0.0f, 0.0f);
+			material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuseColour);
+			aiColor3D specularColour(0.0f, 0.0f, 0.0f);
+			material->Get(AI_MATKEY_COLOR_SPECULAR, specularColour);
+			float shininess = 0.0f;
+			material->Get(AI_MATKEY_SHININESS, shininess);
+			float opacity = 1.0f;
+			material->Get(AI_MATKEY_OPACITY, opacity);
+			string fullTextureNamePath = "";
+			if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0)
+			{
+				aiString textureName;
+				float blendFactor;
+				aiTextureOp blendOp;
+				if (material->GetTexture(aiTextureType_DIFFUSE, 0, &textureName, NULL, NULL, &blendFactor, &blendOp, NULL) == AI_SUCCESS)
+				{
+					// Get full path to texture by prepending the same folder as included in the model name. This
+					// does assume that textures are in the same folder as the model files
+					fullTextureNamePath = directory + "\\" + textureName.data;
+				}
+			}
+			materials[i].DiffuseColour = Vector4(diffuseColour.r, diffuseColour.g, diffuseColour.b, 1.0f);
+			materials[i].SpecularColour = Vector4(specularColour.r, specularColour.g, specularColour.b, 1.0f);
+			materials[i].Shininess = shininess;
+			materials[i].Opacity = opacity;
+			materials[i].TextureName = fullTextureNamePath;
+		}
+	}
+	vector<ImportedSubMesh> subMeshes(scene->mNumMeshes);
+	for (unsigned int sm = 0; sm < scene->mNumMeshes; sm++)
+	{
+		aiMesh* subMesh = scene->mMeshes[sm];
+		ImportedSubMesh& importedSubMesh = subMeshes[sm];
+		unsigned int numVertices = subMesh->mNumVertices;
+		bool hasNormals = subMesh->HasNormals();
+		bool hasTexCoords = subMesh->HasTextureCoords(0);
+		if (numVertices == 0)
+		{
+			return false;
+		}
+		importedSubMesh.HasNormals = hasNormals;
+		importedSubMesh.HasTexCoords = hasTexCoords;
+		importedSubMesh.MaterialIndex = scene->HasMaterials() ? subMesh->mMaterialIndex : MeshCacheNoMaterial;
+
+		// Build up our vertex structure
+		aiVector3D* subMeshVertices = subMesh->mVertices;
+		aiVector3D* subMeshNormals = subMesh->mNormals;
+		// We only handle one set of UV coordinates at the moment.  Again, handling multiple sets of UV
+		// coordinates is a future enhancement.
+		aiVector3D* subMeshTexCoords = subMesh->mTextureCoords[0];
+		importedSubMesh.Vertices.resize(numVertices);
+		for (unsigned int i = 0; i < numVertices; i++)
+		{
+			Vertex& vertex = importedSubMesh.Vertices[i];
+			vertex.Position = Vector3(subMeshVertices[i].x, subMeshVertices[i].y, subMeshVertices[i].z);
+			if (hasNormals)
+			{
+				vertex.Normal = Vector3(subMeshNormals[i].x, subMeshNormals[i].y, subMeshNormals[i].z);
+			}
+			else
+			{
+				vertex.Normal = Vector3(0, 0, 0);
+			}
+			if (!hasTexCoords)
+			{
+				// If the model does not have texture coordinates, set them to 0
+				vertex.TexCoord = Vector2(0.0f, 0.0f);
+			}
+			else
+			{
+				// Handle negative texture coordinates by wrapping them to positive.  This should
+				// ideally be handled in the shader.  Note we are assuming that negative coordinates
+				// here are no smaller than -1.0 - this may not be a valid assumption.
+				vertex.TexCoord.x = subMeshTexCoords[i].x < 0 ? subMeshTexCoords[i].x + 1.0f : subMeshTexCoords[i].x;
+				vertex.TexCoord.y = subMeshTexCoords[i].y < 0 ? subMeshTexCoords[i].y + 1.0f : subMeshTexCoords[i].y;
+			}
+		}
+
+		// Now extract the indices from the file
+		unsigned int numberOfFaces = subMesh->mNumFaces;
+		importedSubMesh.Indices.resize(numberOfFaces * 3);
+		for (unsigned int i = 0; i < numberOfFaces; i++)
+		{
+			const aiFace& face = subMesh->mFaces[i];
+			if (face.mNumIndices != 3)
+			{
+				// We are not dealing with triangles, so we cannot handle it
+				return false;
+			}
+			importedSubMesh.Indices[i * 3] = face.mIndices[0];
+			importedSubMesh.Indices[i * 3 + 1] = face.mIndices[1];
+			importedSubMesh.Indices[i * 3 + 2] = face.mIndices[2];
+		}
+		if (numberOfFaces == 0)
+		{
+			return false;
+		}
+	}
+	// Optimise the sub-meshes for the vertex cache, overdraw and vertex fetch.  This is only
+	// done on import, so the cost is not paid again when the model is loaded from the cache.
+	MeshOptimiserOptions options = DefaultMeshOptimiserOptions();
+	options.OptimiseOverdraw = true;
+	optimiserReports.assign(subMeshes.size(), MeshOptimiserReport());
+	for (size_t sm = 0; sm < subMeshes.size(); sm++)
+	{
+		OptimiseMesh(subMeshes[sm].Vertices, subMeshes[sm].Indices, options, &optimiserReports[sm]);
+	}
+	// Build the levels of detail from the optimised vertices, which they share with the full
+	// sub-mesh.  Each level only needs its triangles reordered for the vertex cache.
+	MeshSimplifierOptions lodOptions = DefaultMeshSimplifierOptions();
+	for (ImportedSubMesh& subMesh : subMeshes)
+	{
+		BuildLodChain(subMesh.Vertices.data(), subMesh.Vertices.size(), sizeof(Vertex), subMesh.Indices, lodOptions, subMesh.Lods);
+		for (MeshLod& lod : subMesh.Lods)
+		{
+			OptimiseVertexCache(lod.Indices, subMesh.Vertices.size());
+		}
+	}
+	// Each sub-mesh uses the 16 byte quantised vertex format if it loses little enough
+	// precision, and the 32 byte Vertex format otherwise
+	QuantisationError tolerance = DefaultQuantisationTolerance();
+	for (ImportedSubMesh& subMesh : subMeshes)
+	{
+		QuantiseImportedSubMesh(subMesh, tolerance);
+	}
+	BuildMeshCache(materials, subMeshes, source, cacheData);
+	return true;
+}
+
+shared_ptr<Mesh> ResourceManager::CreateMeshFromCache(const wstring& modelName, const PreparedModel& model)
+{
+	const MeshCacheView& cache = model.Cache;
+	const MeshCacheHeader& header = cache.GetHeader();
+
+	// Create the materials, with a unique name for each based on the model name and index
+	string modelNameUTF8 = ws2s(modelName);
+	vector<wstring> materials(header.MaterialCount);
+	for (uint32_t i = 0; i < header.MaterialCount; i++)
+	{
+		const MeshCacheMaterial& material = cache.GetMaterial(i);
+		stringstream materialNameStream;
+		materialNameStream << modelNameUTF8 << i;
+		materials[i] = s2ws(materialNameStream.str());
+		if (_materialResources.find(materials[i]) == _materialResources.end())
+		{
+			AddMaterial(materials[i],
+				Vector4(material.DiffuseColour),
+				Vector4(material.SpecularColour),
+				material.Shininess,
+				material.Opacity,
+				CreateTexture(model.Textures[i]));
+		}
+	}
+
+	// The vertex and index blocks are already in the format the buffers need, so they are
+	// copied into the geometry arena as they are
+	shared_ptr<Mesh> resourceMesh = make_shared<Mesh>();
+	for (uint32_t sm = 0; sm < header.SubMeshCount; sm++)
+	{
+		const MeshCacheSubMesh& subMesh = cache.GetSubMesh(sm);
+
+		DXGI_FORMAT indexFormat = (subMesh.Flags & MeshCache16BitIndices) != 0 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		SubMeshGeometry geometry;
+		if (!CreateGeometry(cache.GetVertices(subMesh), subMesh.VertexCount, static_cast<UINT>(MeshCacheView::GetVertexStride(subMesh)),
+							cache.GetIndices(subMesh), subMesh.IndexCount, indexFormat, geometry))
+		{
+			return nullptr;
+		}
+
+		// Quantised vertices are decoded in the vertex shader using the bounds of the sub-mesh
+		ComPtr<ID3D11Buffer> meshConstantBuffer;
+		if ((subMesh.Flags & MeshCacheQuantisedVertices) != 0)
+		{
+			QuantisationBounds bounds = MakeQuantisationBounds(subMesh.Bounds.Centre, subMesh.Bounds.Extents);
+			MeshConstants meshConstants;
+			meshConstants.PositionMinimum = Vector4(bounds.Minimum[0], bounds.Minimum[1], bounds.Minimum[2], 0.0f);
+			meshConstants.PositionScale = Vector4(bounds.Scale[0], bounds.Scale[1], bounds.Scale[2], 0.0f);
+			D3D11_BUFFER_DESC constantBufferDescriptor = { 0 };
+			constantBufferDescriptor.Usage = D3D11_USAGE_IMMUTABLE;
+			constantBufferDescriptor.ByteWidth = sizeof(MeshConstants);
+			constantBufferDescriptor.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+			D3D11_SUBRESOURCE_DATA constantInitialisationData = { 0 };
+			constantInitialisationData.pSysMem = &meshConstants;
+			if (FAILED(_device->CreateBuffer(&constantBufferDescriptor, &constantInitialisationData, meshConstantBuffer.GetAddressOf())))
+			{
+				return nullptr;
+			}
+		}
+
+		// Do we have a material associated with this mesh?
+		shared_ptr<Material> material = nullptr;
+		if (subMesh.MaterialIndex != MeshCacheNoMaterial)
+		{
+			material = GetMaterial(materials[subMesh.MaterialIndex]);
+		}
+		shared_ptr<SubMesh> resourceSubMesh = make_shared<SubMesh>(geometry, subMesh.VertexCount, subMesh.IndexCount, indexFormat, material,
+																   (subMesh.Flags & MeshCacheHasNormals) != 0,
+																   (subMesh.Flags & MeshCacheHasTexCoords) != 0,
+																   MeshCacheView::GetBoundingBox(subMesh.Bounds),
+																   meshConstantBuffer);
+		// A sub-mesh that did not fit in an arena is only ever drawn in full
+		for (uint32_t l = 0; l < subMesh.LodCount; l++)
+		{
+			const MeshCacheLod& lod = cache.GetLod(subMesh, l);
+			if (!resourceSubMesh->AddLod(cache.GetIndices(lod), lod.IndexCount, lod.Error))
+			{
+				break;
+			}
+		}
+		resourceMesh->AddSubMesh(resourceSubMesh);
+	}
+	return resourceMesh;
+}
+
+shared_ptr<Mesh> ResourceManager::CreateProceduralMesh(const MeshGenerator& generator)
+{
+	vector<Vertex> vertices;
+	vector<UINT> indices;
+	generator(vertices, indices);
+	if (vertices.empty() || indices.empty())
+	{
+		return nullptr;
+	}
+	OptimiseMesh(vertices, indices, DefaultMeshOptimiserOptions());
+
+	BoundingBox bounds;
+	BoundingBox::CreateFromPoints(bounds, vertices.size(), &vertices[0].Position, sizeof(Vertex));
+
+	// Use 16-bit indices if the vertex count allows it
+	DXGI_FORMAT indexFormat = ChooseIndexFormat(vertices.size());
+	vector<uint16_t> indices16;
+	if (indexFormat == DXGI_FORMAT_R16_UINT)
+	{
+		indices16.resize(indices.size());
+		CopyIndicesTo16Bit(indices.data(), indices.size(), indices16.data());
+	}
+
+	SubMeshGeometry geometry;
+	if (!CreateGeometry(vertices.data(), vertices.size(), sizeof(Vertex),
+						indexFormat == DXGI_FORMAT_R16_UINT ? static_cast<const void *>(indices16.data()) : indices.data(), indices.size(), indexFormat, geometry))
+	{
+		return nullptr;
+	}
+
+	shared_ptr<Mesh> mesh = make_shared<Mesh>();
+	mesh->AddSubMesh(make_shared<SubMesh>(geometry, vertices.size(), indices.size(), indexFormat, nullptr, true, true, bounds));
+	return mesh;
+}
+
+bool ResourceManager::CreateGeometry(const void * vertices, size_t vertexCount, UINT vertexStride, const void * indices, size_t indexCount, DXGI_FORMAT indexFormat, SubMeshGeometry& geometry)
+{
+	shared_ptr<GeometryArena>& arena = _geometryArenas[vertexStride];
+	if (arena == nullptr)
+	{
+		arena = make_shared<GeometryArena>(_device, _deviceContext, vertexStride);
+	}
+	if (arena->Add(vertices, vertexCount, indices, indexCount, GetIndexFormatSize(indexFormat), geometry.VertexBlock, geometry.IndexBlock))
+	{
+		geometry.Arena = arena;
+		return true;
+	}
+
+	// The arena has reached the largest size it can be, so the sub-mesh gets buffers of its own
+	geometry.Arena = nullptr;
+	D3D11_BUFFER_DESC vertexBufferDescriptor = { 0 };
+	vertexBufferDescriptor.Usage = D3D11_USAGE_IMMUTABLE;
+	vertexBufferDescriptor.ByteWidth = static_cast<UINT>(vertexStride * vertexCount);
+	vertexBufferDescriptor.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	D3D11_SUBRESOURCE_DATA vertexInitialisationData = { 0 };
+	vertexInitialisationData.pSysMem = vertices;
+	if (FAILED(_device->CreateBuffer(&vertexBufferDescriptor, &vertexInitialisationData, geometry.VertexBuffer.GetAddressOf())))
+	{
+		return false;
+	}
+
+	D3D11_BUFFER_DESC indexBufferDescriptor = { 0 };
+	indexBufferDescriptor.Usage = D3D11_USAGE_IMMUTABLE;
+	indexBufferDescriptor.ByteWidth = static_cast<UINT>(GetIndexFormatSize(indexFormat) * indexCount);
+	indexBufferDescriptor.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	D3D11_SUBRESOURCE_DATA indexInitialisationData = { 0 };
+	indexInitialisationData.pSysMem = indices;
+	return SUCCEEDED(_device->CreateBuffer(&indexBufferDescriptor, &indexInitialisationData, geometry.IndexBuffer.GetAddressOf()));
+}
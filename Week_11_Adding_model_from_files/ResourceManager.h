@@ -1,51 +1,165 @@
-#pragma once
-#include "Mesh.h"
-#include <map>
-#include <assimp\importer.hpp>
-#include <assimp\scene.h>
-#include <assimp\postprocess.h>
-
-using namespace Assimp;
-
-struct MeshResourceStruct
-{
-	unsigned int			ReferenceCount;
-	shared_ptr<Mesh>		MeshPointer;
-};
-
-typedef map<wstring, MeshResourceStruct>		MeshResourceMap;
-
-struct MaterialResourceStruct
-{
-	unsigned int			ReferenceCount;
-	shared_ptr<Material>	MaterialPointer;
-};
-
-typedef map<wstring, MaterialResourceStruct>	MaterialResourceMap;
-
-class ResourceManager
-{
-public:
-	ResourceManager();
-	~ResourceManager();
-				
-	shared_ptr<Mesh>							GetMesh(wstring modelName);
-	void										ReleaseMesh(wstring modelName);
-
-	void										CreateMaterialFromTexture(wstring textureName);
-    void										CreateMaterialWithNoTexture(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity);
-    void										CreateMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, wstring textureName);
-	shared_ptr<Material>						GetMaterial(wstring materialName);
-	void										ReleaseMaterial(wstring materialName);
-
-private:
-	MeshResourceMap								_meshResources;
-	MaterialResourceMap							_materialResources;
-
-	ComPtr<ID3D11Device>						_device;
-	ComPtr<ID3D11DeviceContext>					_deviceContext;
-
-	shared_ptr<Mesh>							LoadModelFromFile(wstring modelName);
-    void										InitialiseMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, wstring textureName);
-};
-
+#pragma once
+#include "Mesh.h"
+#include "GeometricObject.h"
+#include "ShaderLibrary.h"
+#include "MeshCache.h"
+#include "MeshOptimiser.h"
+#include "TextureLoader.h"
+#include "WorkerPool.h"
+#include <map>
+#include <functional>
+#include <future>
+#include <assimp\importer.hpp>
+#include <assimp\scene.h>
+#include <assimp\postprocess.h>
+
+using namespace Assimp;
+
+struct MeshResourceStruct
+{
+	unsigned int			ReferenceCount;
+	shared_ptr<Mesh>		MeshPointer;
+};
+
+typedef map<wstring, MeshResourceStruct>		MeshResourceMap;
+
+enum MeshLoadState
+{
+	MeshLoading,
+	MeshLoaded,
+	MeshLoadFailed
+};
+
+// Returned by GetMeshAsync.  The state and mesh are only changed by ResourceManager::Update,
+// which runs on the main thread, so nodes can check them while rendering without locking.
+struct AsyncMesh
+{
+	MeshLoadState			State;
+	shared_ptr<Mesh>		MeshPointer;
+};
+
+typedef shared_ptr<AsyncMesh>					MeshHandle;
+
+// Everything needed to create a model's Direct3D resources: the cache data (either mapped
+// from the cache file or just imported) and the decoded textures of its materials, in the
+// same order as the materials in the cache
+struct PreparedModel
+{
+	MappedFile				CacheFile;
+	vector<BYTE>			CacheData;
+	MeshCacheView			Cache;
+	vector<DecodedTexture>	Textures;
+	// What the optimiser did to each sub-mesh, if the model was imported rather than read from
+	// the cache
+	vector<MeshOptimiserReport>	OptimiserReports;
+};
+
+struct PendingMeshStruct
+{
+	// The number of requests for the mesh that have not been released.  If this drops to 0
+	// before the load finishes, the mesh is thrown away.
+	unsigned int			ReferenceCount;
+	MeshHandle				Handle;
+	shared_ptr<PreparedModel>	Model;
+	shared_future<bool>		Prepared;
+};
+
+typedef map<wstring, PendingMeshStruct>			PendingMeshMap;
+
+// Generates the vertices and indices of a procedural mesh.  The normals must be filled in.
+typedef function<void(vector<Vertex>& vertices, vector<UINT>& indices)>	MeshGenerator;
+
+struct MaterialResourceStruct
+{
+	unsigned int			ReferenceCount;
+	shared_ptr<Material>	MaterialPointer;
+};
+
+typedef map<wstring, MaterialResourceStruct>	MaterialResourceMap;
+
+class ResourceManager
+{
+public:
+	ResourceManager();
+	~ResourceManager();
+				
+	shared_ptr<Mesh>							GetMesh(wstring modelName);
+	void										ReleaseMesh(wstring modelName);
+
+	// Returns straight away and loads the model on a worker thread.  The handle is filled in
+	// by Update once the model has loaded.  Release it with ReleaseMesh as for GetMesh, which
+	// can be done before the load has finished.
+	MeshHandle									GetMeshAsync(wstring modelName);
+	// Creates the Direct3D resources for any models that have finished loading and compacts
+	// the geometry arenas.  Called by the framework once a frame, before the scene graph is
+	// updated.
+	void										Update();
+
+	// Procedural meshes are cached alongside the meshes loaded from files, keyed on the name
+	// of the generator and its parameters.  The generator is only called the first time a key
+	// is requested.  Release them with ReleaseMesh, passing the same key.
+	shared_ptr<Mesh>							GetProceduralMesh(wstring meshKey, const MeshGenerator& generator);
+	shared_ptr<Mesh>							GetBoxMesh(const Vector3& size);
+	shared_ptr<Mesh>							GetSphereMesh(float diameter, size_t tessellation);
+	shared_ptr<Mesh>							GetCylinderMesh(float height, float diameter, size_t tessellation);
+	shared_ptr<Mesh>							GetConeMesh(float diameter, float height, size_t tessellation);
+	shared_ptr<Mesh>							GetTeapotMesh(float size, size_t tessellation = DefaultTeapotTessellation);
+
+	static wstring								GetBoxMeshKey(const Vector3& size);
+	static wstring								GetSphereMeshKey(float diameter, size_t tessellation);
+	static wstring								GetCylinderMeshKey(float height, float diameter, size_t tessellation);
+	static wstring								GetConeMeshKey(float diameter, float height, size_t tessellation);
+	static wstring								GetTeapotMeshKey(float size, size_t tessellation = DefaultTeapotTessellation);
+
+	void										CreateMaterialFromTexture(wstring textureName);
+    void										CreateMaterialWithNoTexture(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity);
+    void										CreateMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, wstring textureName);
+	shared_ptr<Material>						GetMaterial(wstring materialName);
+
+	// Decodes the textures at the same time on the worker pool, then creates them all.  A
+	// texture that could not be loaded is returned as null.
+	vector<ComPtr<ID3D11ShaderResourceView>>	LoadTextures(const vector<wstring>& textureNames);
+	void										ReleaseMaterial(wstring materialName);
+
+	inline shared_ptr<ShaderLibrary>			GetShaderLibrary() { return _shaderLibrary; }
+
+	// The optimiser reports for each sub-mesh of a model, including the vertex cache statistics
+	// before and after, if it was imported since the program started.  Models read from the
+	// mesh cache were optimised when they were imported, so there are none for them.  Returns
+	// null if there are no reports.
+	const vector<MeshOptimiserReport> *			GetOptimiserReports(const wstring& modelName) const;
+
+private:
+	MeshResourceMap								_meshResources;
+	MaterialResourceMap							_materialResources;
+	shared_ptr<ShaderLibrary>					_shaderLibrary;
+	PendingMeshMap								_pendingMeshes;
+	map<wstring, vector<MeshOptimiserReport>>	_optimiserReports;
+	shared_ptr<WorkerPool>						_workerPool;
+
+	ComPtr<ID3D11Device>						_device;
+	ComPtr<ID3D11DeviceContext>					_deviceContext;
+
+	// The geometry of every mesh is packed into a shared arena, one for each vertex stride
+	map<UINT, shared_ptr<GeometryArena>>		_geometryArenas;
+
+	// Models are imported with Assimp the first time they are loaded and read from the mesh
+	// cache after that (see MeshCache.h)
+	shared_ptr<Mesh>							LoadModelFromFile(wstring modelName);
+	// Does everything apart from creating the Direct3D resources, so it is safe to call from
+	// a worker thread
+	static bool									PrepareModel(const wstring& modelName, PreparedModel& model, WorkerPool * workerPool);
+	static wstring								GetMeshCacheFileName(const wstring& modelName);
+	static bool									ImportModel(const wstring& modelName, const MeshSourceStamp& source, vector<BYTE>& cacheData, vector<MeshOptimiserReport>& optimiserReports);
+	shared_ptr<Mesh>							CreateMeshFromCache(const wstring& modelName, const PreparedModel& model);
+	void										KeepOptimiserReports(const wstring& modelName, PreparedModel& model);
+	void										CompletePendingMesh(const wstring& modelName, PendingMeshStruct& pending);
+	// Puts the geometry in the arena for its vertex stride, or in buffers of its own if the
+	// arena is full.  Returns false if the buffers could not be created.
+	bool										CreateGeometry(const void * vertices, size_t vertexCount, UINT vertexStride, const void * indices, size_t indexCount, DXGI_FORMAT indexFormat, SubMeshGeometry& geometry);
+	shared_ptr<Mesh>							CreateProceduralMesh(const MeshGenerator& generator);
+    void										InitialiseMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, wstring textureName);
+	void										AddMaterial(wstring materialName, Vector4 diffuseColour, Vector4 specularColour, float shininess, float opacity, ComPtr<ID3D11ShaderResourceView> texture);
+	ComPtr<ID3D11ShaderResourceView>			CreateTexture(const DecodedTexture& decodedTexture);
+};
+
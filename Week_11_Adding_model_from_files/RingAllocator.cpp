@@ -0,0 +1,105 @@
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator(size_t capacity, size_t alignment)
+{
+	_capacity = capacity;
+	_alignment = alignment;
+	_discardCount = 0;
+	Reset();
+}
+
+bool RingAllocator::Allocate(size_t size, RingAllocation& allocation)
+{
+	size_t alignedSize = (size + _alignment - 1) / _alignment * _alignment;
+	if (alignedSize == 0 || alignedSize > _capacity)
+	{
+		return false;
+	}
+	allocation.Size = alignedSize;
+	allocation.MapMode = RingMapNoOverwrite;
+
+	if (_used == 0)
+	{
+		// Nothing is in use, so the allocation can go anywhere.  Carry on from the head so that
+		// the space the GPU was most recently using is the last to be reused.
+		if (_head + alignedSize > _capacity)
+		{
+			_head = 0;
+		}
+		_tail = _head;
+		allocation.Offset = _head;
+	}
+	else if (_head > _tail || (_head == _tail && _used < _capacity))
+	{
+		// The free space is from the head to the end of the ring and from the start of the ring
+		// to the tail
+		if (_head + alignedSize <= _capacity)
+		{
+			allocation.Offset = _head;
+		}
+		else if (alignedSize <= _tail)
+		{
+			// Skip the space at the end of the ring.  It counts as used until this frame is
+			// retired.
+			size_t skipped = _capacity - _head;
+			_used += skipped;
+			_frameSize += skipped;
+			allocation.Offset = 0;
+		}
+		else
+		{
+			allocation.MapMode = RingMapDiscard;
+		}
+	}
+	else if (_head < _tail && _head + alignedSize <= _tail)
+	{
+		// The free space is between the head and the tail
+		allocation.Offset = _head;
+	}
+	else
+	{
+		allocation.MapMode = RingMapDiscard;
+	}
+
+	if (allocation.MapMode == RingMapDiscard)
+	{
+		// Nothing is free.  After a discard the driver gives the buffer new memory, so
+		// everything the GPU is still using stays where it is and the whole ring is free again.
+		Reset();
+		_discardCount++;
+		allocation.Offset = 0;
+	}
+	_head = allocation.Offset + alignedSize;
+	_used += alignedSize;
+	_frameSize += alignedSize;
+	return true;
+}
+
+void RingAllocator::EndFrame(uint64_t fence)
+{
+	Frame frame;
+	frame.Fence = fence;
+	frame.End = _head;
+	frame.Size = _frameSize;
+	_frames.push_back(frame);
+	_frameSize = 0;
+}
+
+void RingAllocator::Retire(uint64_t completedFence)
+{
+	while (!_frames.empty() && _frames.front().Fence <= completedFence)
+	{
+		_tail = _frames.front().End;
+		_used -= _frames.front().Size;
+		_frames.pop_front();
+	}
+}
+
+void RingAllocator::Reset()
+{
+	_head = 0;
+	_tail = 0;
+	_used = 0;
+	_frameSize = 0;
+	_frames.clear();
+}
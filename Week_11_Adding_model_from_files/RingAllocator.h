@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+using namespace std;
+
+// Keeps track of which parts of a ring buffer are free.  Space is handed out from the head of
+// the ring and returned from the tail when the GPU has finished with the frame that used it.
+// Each frame is closed with a fence value, and the space it used is reclaimed once that fence
+// is known to have completed.
+//
+// This only does the bookkeeping and has no dependencies on Direct3D, so it can be driven with
+// a plain block of memory standing in for the buffer.  ConstantBufferRing uses it to manage a
+// dynamic constant buffer.
+
+// How the buffer must be mapped before writing to an allocation
+enum RingMapMode
+{
+	// The allocation does not overlap anything the GPU may still be reading
+	RingMapNoOverwrite,
+	// There was no free space, so the ring has been emptied.  The buffer must be mapped with
+	// discard so that the driver gives it fresh memory, leaving the old contents to the GPU.
+	RingMapDiscard
+};
+
+struct RingAllocation
+{
+	size_t					Offset;
+	size_t					Size;
+	RingMapMode				MapMode;
+};
+
+class RingAllocator
+{
+public:
+	RingAllocator(size_t capacity, size_t alignment);
+
+	// Allocates at least the given number of bytes, rounded up to the alignment.  Returns false
+	// if the request is larger than the whole ring, in which case the ring is left unchanged.
+	bool					Allocate(size_t size, RingAllocation& allocation);
+
+	// Closes the current frame.  Everything allocated since the last call belongs to the frame
+	// and is released by Retire once the fence has completed.
+	void					EndFrame(uint64_t fence);
+
+	// Releases the space used by every closed frame whose fence is less than or equal to the
+	// completed fence.  Frames are retired in order.
+	void					Retire(uint64_t completedFence);
+
+	// Forget everything, as after a discard
+	void					Reset();
+
+	inline size_t			GetCapacity() const { return _capacity; }
+	inline size_t			GetAlignment() const { return _alignment; }
+	// Bytes that are allocated or waiting for a fence, including any padding skipped at the
+	// end of the ring when an allocation wrapped round to the start
+	inline size_t			GetUsed() const { return _used; }
+	inline size_t			GetPendingFrameCount() const { return _frames.size(); }
+	inline size_t			GetDiscardCount() const { return _discardCount; }
+
+private:
+	struct Frame
+	{
+		uint64_t			Fence;
+		// Where the head was when the frame was closed, which becomes the tail when the frame
+		// is retired
+		size_t				End;
+		size_t				Size;
+	};
+
+	size_t					_capacity;
+	size_t					_alignment;
+	size_t					_head;
+	size_t					_tail;
+	size_t					_used;
+	// Bytes used by the frame that is still open
+	size_t					_frameSize;
+	deque<Frame>			_frames;
+	size_t					_discardCount;
+};
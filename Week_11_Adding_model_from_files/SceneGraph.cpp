@@ -1,55 +1,88 @@
-#include "SceneGraph.h"  
-
-
-bool SceneGraph::Initialise() {
-    // Implement the logic for Initialise method
-    for (auto& child : _children) {
-        if (!child->Initialise()) {
-            return false;
-        }
-    }
-    return true;
-}
-
-void SceneGraph::Update(const Matrix& worldTransformation) {
-    SceneNode::Update(worldTransformation);
-    for (SceneNodePointer child : _children) {
-        child->Update(_cumulativeWorldTransformation);
-    }
-}
-
-void SceneGraph::Render() {
-    for (auto child : _children) {
-        child->Render();
-    }
-}
-
-void SceneGraph::Shutdown() {
-    for (auto child : _children) {
-        child->Shutdown();
-    }
-}
-
-void SceneGraph::Add(SceneNodePointer node) {
-    _children.push_back(node);
-}
-
-void SceneGraph::Remove(SceneNodePointer node) {
-    auto it = std::remove(_children.begin(), _children.end(), node);
-    _children.erase(it, _children.end());
-}
-
-SceneNodePointer SceneGraph::Find(const std::wstring name) {
-    if (_name == name) {
-        return shared_from_this();
-    }
-
-    for (auto child : _children) {
-        SceneNodePointer  foundNode = child->Find(name);
-        if (foundNode != nullptr) {
-            return foundNode;
-        }
-    }
-
-    return nullptr;
-}
+#include "SceneGraph.h"  
+#include "DirectXFramework.h"
+
+
+bool SceneGraph::Initialise() {
+    // Implement the logic for Initialise method
+    for (auto& child : _children) {
+        if (!child->Initialise()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SceneGraph::Render() {
+    DirectXFramework * framework = DirectXFramework::GetDXFramework();
+    const ViewFrustum& viewFrustum = framework->GetViewFrustum();
+    CullingStatistics& cullingStatistics = framework->GetCullingStatistics();
+    for (const SceneNodePointer& child : _children) {
+        if (!child->HasBounds()) {
+            child->Render();
+        }
+        else if (viewFrustum.Intersects(child->GetLocalBounds(), child->GetCumulativeWorldTransformation())) {
+            cullingStatistics.VisibleCount++;
+            child->Render();
+        }
+        else {
+            cullingStatistics.CulledCount++;
+        }
+    }
+}
+
+void SceneGraph::Shutdown() {
+    for (auto child : _children) {
+        child->Shutdown();
+    }
+}
+
+void SceneGraph::Add(SceneNodePointer node) {
+    _children.push_back(node);
+    TransformStore::GetTransformStore()->SetParent(node->GetTransformHandle(), _transformHandle);
+    // A node may be added more than once, but it only needs to be registered the first time
+    if (!node->_nodeHandle.IsValid()) {
+        node->_nodeHandle = SceneNodeRegistry::GetSceneNodeRegistry()->Register(node.get());
+    }
+}
+
+void SceneGraph::Remove(SceneNodePointer node) {
+    auto it = std::remove(_children.begin(), _children.end(), node);
+    _children.erase(it, _children.end());
+    TransformStore::GetTransformStore()->SetParent(node->GetTransformHandle(), InvalidTransformHandle);
+    SceneNodeRegistry::GetSceneNodeRegistry()->Unregister(node->_nodeHandle);
+    node->_nodeHandle = SceneNodeHandle();
+}
+
+SceneNodePointer SceneGraph::Find(const std::wstring name) {
+    if (_name == name) {
+        return shared_from_this();
+    }
+    return SceneNodeRegistry::GetSceneNodeRegistry()->Resolve(FindHandle(name));
+}
+
+SceneNodeHandle SceneGraph::FindHandle(const wstring& name) {
+    SceneNodeRegistry * registry = SceneNodeRegistry::GetSceneNodeRegistry();
+    const vector<SceneNodeHandle> * handles = registry->FindAll(name);
+    if (handles != nullptr) {
+        // The registry covers every scene graph, so make sure the node is actually part of this one
+        for (SceneNodeHandle handle : *handles) {
+            if (Contains(registry->Get(handle))) {
+                return handle;
+            }
+        }
+    }
+    return SceneNodeHandle();
+}
+
+bool SceneGraph::Contains(SceneNode * node) {
+    // Walk up through the node's parents in the transform store until we reach this graph
+    TransformStore * transformStore = TransformStore::GetTransformStore();
+    TransformHandle parent = transformStore->GetParent(node->GetTransformHandle());
+    while (parent != InvalidTransformHandle) {
+        if (parent == _transformHandle) {
+            return true;
+        }
+        parent = transformStore->GetParent(parent);
+    }
+    return false;
+}
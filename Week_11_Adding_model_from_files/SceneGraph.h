@@ -1,25 +1,30 @@
-#pragma once
-#include "SceneNode.h"
-#include <list>
-
-class SceneGraph : public SceneNode
-{
-public:
-	SceneGraph() : SceneNode(L"Root") {};
-	SceneGraph(wstring name) : SceneNode(name) {};
-	~SceneGraph(void) {};
-
-	virtual bool Initialise(void);
-	virtual void Update(const Matrix& worldTransformation);
-	virtual void Render(void);
-	virtual void Shutdown(void);
-
-	void Add(SceneNodePointer node);
-	void Remove(SceneNodePointer node);
-	SceneNodePointer Find(wstring name);
-
-private:
-	list<SceneNodePointer> _children;
-};
-
-typedef shared_ptr<SceneGraph>			 SceneGraphPointer;
+#pragma once
+#include "SceneNode.h"
+#include <list>
+
+class SceneGraph : public SceneNode
+{
+public:
+	SceneGraph() : SceneNode(L"Root") {};
+	SceneGraph(wstring name) : SceneNode(name) {};
+	~SceneGraph(void) {};
+
+	virtual bool Initialise(void);
+	virtual void Render(void);
+	virtual void Shutdown(void);
+
+	void Add(SceneNodePointer node);
+	void Remove(SceneNodePointer node);
+	SceneNodePointer Find(wstring name);
+
+	// Looks up a node in this graph using the registry's name index.  The handle can be
+	// kept and resolved through the SceneNodeRegistry each frame.
+	SceneNodeHandle FindHandle(const wstring& name);
+
+private:
+	list<SceneNodePointer> _children;
+
+	bool Contains(SceneNode * node);
+};
+
+typedef shared_ptr<SceneGraph>			 SceneGraphPointer;
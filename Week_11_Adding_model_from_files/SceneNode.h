@@ -1,40 +1,58 @@
-#pragma once
-#include "core.h"
-#include "DirectXCore.h"
-
-using namespace std;
-
-// Abstract base class for all nodes of the scene graph.  
-// This scene graph implements the Composite Design Pattern
-
-class SceneNode;
-
-typedef shared_ptr<SceneNode>	SceneNodePointer;
-
-class SceneNode : public enable_shared_from_this<SceneNode>
-{
-public:
-	SceneNode(wstring name) {_name = name;};
-	~SceneNode(void) {};
-
-	// Core methods
-	virtual bool Initialise() = 0;
-	virtual void Update(const Matrix& worldTransformation) { _cumulativeWorldTransformation = _thisWorldTransformation * worldTransformation; }	
-	virtual void Render() = 0;
-	virtual void Shutdown() {}
-
-	void SetWorldTransform(const Matrix& worldTransformation) { _thisWorldTransformation = worldTransformation; }
-		
-	// Although only required in the composite class, these are provided
-	// in order to simplify the code base for recursive operations
-
-	virtual void Add(SceneNodePointer node) {}
-	virtual void Remove(SceneNodePointer node) {};
-	virtual	SceneNodePointer Find(wstring name) { return (_name == name) ? shared_from_this() : nullptr; }
-
-protected:
-	Matrix				_thisWorldTransformation;
-	Matrix				_cumulativeWorldTransformation;
-	wstring				_name;
-};
-
+#pragma once
+#include "core.h"
+#include "DirectXCore.h"
+#include "TransformStore.h"
+#include "SceneNodeRegistry.h"
+
+using namespace std;
+
+// Abstract base class for all nodes of the scene graph.  
+// This scene graph implements the Composite Design Pattern
+
+class SceneNode;
+
+typedef shared_ptr<SceneNode>	SceneNodePointer;
+
+class SceneNode : public enable_shared_from_this<SceneNode>
+{
+	// The scene graph registers and unregisters its children with the registry
+	friend class SceneGraph;
+
+public:
+	SceneNode(wstring name) {_name = name; _hasBounds = false; _transformHandle = TransformStore::GetTransformStore()->Allocate(); };
+	~SceneNode(void) { SceneNodeRegistry::GetSceneNodeRegistry()->Unregister(_nodeHandle); TransformStore::GetTransformStore()->Release(_transformHandle); };
+
+	// Core methods
+	virtual bool Initialise() = 0;
+	virtual void Render() = 0;
+	virtual void Shutdown() {}
+
+	// The transformations themselves are held in the transform store, which updates the
+	// cumulative world transformations for all nodes in one pass (see DirectXFramework::Update)
+	void SetWorldTransform(const Matrix& worldTransformation) { TransformStore::GetTransformStore()->SetLocalTransform(_transformHandle, worldTransformation); }
+	const Matrix& GetCumulativeWorldTransformation() const { return TransformStore::GetTransformStore()->GetWorldTransform(_transformHandle); }
+	inline TransformHandle GetTransformHandle() const { return _transformHandle; }
+	inline SceneNodeHandle GetNodeHandle() const { return _nodeHandle; }
+	inline const wstring& GetName() const { return _name; }
+
+	// Bounding box in the node's local space, used to cull nodes that are outside the view frustum.
+	// Nodes without bounds (such as scene graphs) are never culled.
+	void SetLocalBounds(const BoundingBox& localBounds) { _localBounds = localBounds; _hasBounds = true; }
+	inline bool HasBounds() const { return _hasBounds; }
+	inline const BoundingBox& GetLocalBounds() const { return _localBounds; }
+		
+	// Although only required in the composite class, these are provided
+	// in order to simplify the code base for recursive operations
+
+	virtual void Add(SceneNodePointer node) {}
+	virtual void Remove(SceneNodePointer node) {};
+	virtual	SceneNodePointer Find(wstring name) { return (_name == name) ? shared_from_this() : nullptr; }
+
+protected:
+	TransformHandle		_transformHandle;
+	SceneNodeHandle		_nodeHandle;
+	BoundingBox			_localBounds;
+	bool				_hasBounds;
+	wstring				_name;
+};
+
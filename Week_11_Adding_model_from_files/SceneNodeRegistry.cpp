@@ -0,0 +1,106 @@
+#include "SceneNodeRegistry.h"
+#include "SceneNode.h"
+
+SceneNodeRegistry * _sceneNodeRegistry = nullptr;
+
+SceneNodeRegistry::SceneNodeRegistry()
+{
+	_sceneNodeRegistry = this;
+}
+
+SceneNodeRegistry::~SceneNodeRegistry()
+{
+	if (_sceneNodeRegistry == this)
+	{
+		_sceneNodeRegistry = nullptr;
+	}
+}
+
+SceneNodeRegistry * SceneNodeRegistry::GetSceneNodeRegistry()
+{
+	return _sceneNodeRegistry;
+}
+
+SceneNodeHandle SceneNodeRegistry::Register(SceneNode * node)
+{
+	unsigned int index;
+	if (!_freeSlots.empty())
+	{
+		index = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+	else
+	{
+		index = static_cast<unsigned int>(_slots.size());
+		RegistrySlot slot;
+		slot.Node = nullptr;
+		slot.Generation = 0;
+		_slots.push_back(slot);
+	}
+	RegistrySlot& slot = _slots[index];
+	slot.Node = node;
+	// Skip generation 0 so that default constructed handles never resolve
+	if (++slot.Generation == 0)
+	{
+		slot.Generation = 1;
+	}
+	SceneNodeHandle handle(index, slot.Generation);
+	_nameIndex[node->GetName()].push_back(handle);
+	return handle;
+}
+
+void SceneNodeRegistry::Unregister(SceneNodeHandle handle)
+{
+	SceneNode * node = Get(handle);
+	if (node == nullptr)
+	{
+		return;
+	}
+	auto it = _nameIndex.find(node->GetName());
+	if (it != _nameIndex.end())
+	{
+		vector<SceneNodeHandle>& handles = it->second;
+		for (size_t i = 0; i < handles.size(); i++)
+		{
+			if (handles[i].Index == handle.Index && handles[i].Generation == handle.Generation)
+			{
+				handles.erase(handles.begin() + i);
+				break;
+			}
+		}
+		if (handles.empty())
+		{
+			_nameIndex.erase(it);
+		}
+	}
+	// Bumping the generation invalidates any handles that are still held for this node
+	RegistrySlot& slot = _slots[handle.Index];
+	slot.Node = nullptr;
+	if (++slot.Generation == 0)
+	{
+		slot.Generation = 1;
+	}
+	_freeSlots.push_back(handle.Index);
+}
+
+shared_ptr<SceneNode> SceneNodeRegistry::Resolve(SceneNodeHandle handle) const
+{
+	SceneNode * node = Get(handle);
+	return node != nullptr ? node->shared_from_this() : nullptr;
+}
+
+SceneNode * SceneNodeRegistry::Get(SceneNodeHandle handle) const
+{
+	if (!handle.IsValid() || handle.Index >= _slots.size())
+	{
+		return nullptr;
+	}
+	const RegistrySlot& slot = _slots[handle.Index];
+	return slot.Generation == handle.Generation ? slot.Node : nullptr;
+}
+
+const vector<SceneNodeHandle> * SceneNodeRegistry::FindAll(const wstring& name) const
+{
+	auto it = _nameIndex.find(name);
+	return it != _nameIndex.end() ? &it->second : nullptr;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+class SceneNode;
+
+// Handle to a node registered with the scene node registry.  The generation is incremented
+// each time a slot is reused, so a handle to a node that has since been removed or destroyed
+// simply resolves to nullptr rather than to whichever node took its place.
+
+struct SceneNodeHandle
+{
+	unsigned int			Index;
+	unsigned int			Generation;
+
+	SceneNodeHandle() : Index(0), Generation(0) {}
+	SceneNodeHandle(unsigned int index, unsigned int generation) : Index(index), Generation(generation) {}
+
+	// Generation 0 is never handed out, so a default constructed handle is never valid
+	inline bool				IsValid() const { return Generation != 0; }
+};
+
+// Hashed index of the nodes in the scene graph.  Nodes are registered when they are added to
+// a scene graph and unregistered when they are removed or destroyed, so looking a node up by
+// name does not need to walk the tree.  Animation code should look up a node once, keep the
+// handle and then resolve the handle each frame, which is a constant time operation.
+
+class SceneNodeRegistry
+{
+public:
+	SceneNodeRegistry();
+	~SceneNodeRegistry();
+
+	static SceneNodeRegistry *		GetSceneNodeRegistry();
+
+	SceneNodeHandle					Register(SceneNode * node);
+	void							Unregister(SceneNodeHandle handle);
+
+	shared_ptr<SceneNode>			Resolve(SceneNodeHandle handle) const;
+	SceneNode *						Get(SceneNodeHandle handle) const;
+
+	// Returns all of the registered nodes with the specified name, or nullptr if there are none
+	const vector<SceneNodeHandle> *	FindAll(const wstring& name) const;
+
+private:
+	struct RegistrySlot
+	{
+		SceneNode *					Node;
+		unsigned int				Generation;
+	};
+
+	vector<RegistrySlot>							_slots;
+	vector<unsigned int>							_freeSlots;
+	unordered_map<wstring, vector<SceneNodeHandle>>	_nameIndex;
+};
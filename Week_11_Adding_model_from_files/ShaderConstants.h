@@ -0,0 +1,55 @@
+#pragma once
+#include "SimpleMath.h"
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+// The constant buffers used by shader.hlsl and TextureShader.hlsl, split by how often they
+// change.  The layouts here must match the cbuffer declarations in the shaders.
+
+enum ConstantBufferRegister
+{
+	// Camera and lighting, uploaded once per frame by the render queue
+	FrameConstantsRegister = 0,
+	// Material properties, held in an immutable buffer on each Material
+	MaterialConstantsRegister = 1,
+	// World transformation of the object, uploaded for every draw
+	ObjectConstantsRegister = 2,
+	// How to decode the vertices of a sub-mesh in the quantised vertex format, held in an
+	// immutable buffer on each SubMesh that uses it
+	MeshConstantsRegister = 3
+};
+
+struct FrameConstants
+{
+	Matrix		ViewProjection;
+	Vector4		DirectionalLightColour;
+	Vector4		DirectionalLightVector;
+	Vector4		CameraPosition;
+};
+
+// Used by VSQuantised.  Position = PositionMinimum + PositionScale * stored position.
+struct MeshConstants
+{
+	Vector4		PositionMinimum;
+	Vector4		PositionScale;
+};
+
+struct MaterialConstants
+{
+	Vector4		DiffuseColour;
+	Vector4		SpecularColour;
+	float		Shininess;
+	float		Opacity;
+	float		Padding[2];
+};
+
+// The world-view-projection transformation is not sent.  The vertex shader combines the world
+// transformation with the view-projection transformation in the frame constants instead, which
+// keeps the data uploaded for each draw down to 80 bytes.  The instanced vertex shaders read the
+// same structure from the instance stream.
+struct ObjectConstants
+{
+	Matrix		World;
+	Vector4		AmbientLightColour;
+};
@@ -0,0 +1,216 @@
+#include "ShaderLibrary.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+#if !defined(ShaderDeveloperMode)
+#include "CompiledShaders.h"
+#endif
+
+#define ShaderCacheDirectory	L"ShaderCache"
+
+// Change this to invalidate every file in the disk cache (for example, after changing the compiler)
+const uint64_t ShaderCacheVersion = 1;
+
+// 64-bit FNV-1a hash, used to name the files in the disk cache
+static void HashBytes(uint64_t& hash, const void * data, size_t size)
+{
+	const unsigned char * bytes = static_cast<const unsigned char *>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+
+static void HashString(uint64_t& hash, const string& value)
+{
+	// Include the terminator so that "ab" + "c" does not hash the same as "a" + "bc"
+	HashBytes(hash, value.c_str(), value.size() + 1);
+}
+
+static string MakeShaderKey(const wstring& fileName, const string& entryPoint, const string& profile, const ShaderDefines& defines)
+{
+	stringstream key;
+	key << ws2s(fileName) << "|" << entryPoint << "|" << profile;
+	for (const pair<string, string>& define : defines)
+	{
+		key << "|" << define.first << "=" << define.second;
+	}
+	return key.str();
+}
+
+ShaderLibrary::ShaderLibrary(ComPtr<ID3D11Device> device)
+{
+	_device = device;
+	_cacheDirectory = ShaderCacheDirectory;
+	_compileCount = 0;
+	_cacheLoadCount = 0;
+}
+
+ComPtr<ID3D11VertexShader> ShaderLibrary::GetVertexShader(const wstring& fileName, const string& entryPoint, const ShaderDefines& defines)
+{
+	string key;
+	ComPtr<ID3DBlob> byteCode = GetByteCode(fileName, entryPoint, "vs_5_0", defines, key);
+	map<string, ComPtr<ID3D11VertexShader>>::iterator it = _vertexShaders.find(key);
+	if (it != _vertexShaders.end())
+	{
+		return it->second;
+	}
+	ComPtr<ID3D11VertexShader> vertexShader;
+	ThrowIfFailed(_device->CreateVertexShader(byteCode->GetBufferPointer(), byteCode->GetBufferSize(), NULL, vertexShader.GetAddressOf()));
+	_vertexShaders[key] = vertexShader;
+	return vertexShader;
+}
+
+ComPtr<ID3D11PixelShader> ShaderLibrary::GetPixelShader(const wstring& fileName, const string& entryPoint, const ShaderDefines& defines)
+{
+	string key;
+	ComPtr<ID3DBlob> byteCode = GetByteCode(fileName, entryPoint, "ps_5_0", defines, key);
+	map<string, ComPtr<ID3D11PixelShader>>::iterator it = _pixelShaders.find(key);
+	if (it != _pixelShaders.end())
+	{
+		return it->second;
+	}
+	ComPtr<ID3D11PixelShader> pixelShader;
+	ThrowIfFailed(_device->CreatePixelShader(byteCode->GetBufferPointer(), byteCode->GetBufferSize(), NULL, pixelShader.GetAddressOf()));
+	_pixelShaders[key] = pixelShader;
+	return pixelShader;
+}
+
+ComPtr<ID3D11InputLayout> ShaderLibrary::GetInputLayout(const wstring& fileName, const string& entryPoint, const D3D11_INPUT_ELEMENT_DESC * elements, UINT elementCount, const ShaderDefines& defines)
+{
+	string shaderKey;
+	ComPtr<ID3DBlob> byteCode = GetByteCode(fileName, entryPoint, "vs_5_0", defines, shaderKey);
+
+	// Describe the elements in the key so that identical layouts are shared
+	stringstream key;
+	key << shaderKey;
+	for (UINT i = 0; i < elementCount; i++)
+	{
+		const D3D11_INPUT_ELEMENT_DESC& element = elements[i];
+		key << "|" << element.SemanticName << element.SemanticIndex << ","
+			<< element.Format << "," << element.InputSlot << "," << element.AlignedByteOffset << ","
+			<< element.InputSlotClass << "," << element.InstanceDataStepRate;
+	}
+	map<string, ComPtr<ID3D11InputLayout>>::iterator it = _inputLayouts.find(key.str());
+	if (it != _inputLayouts.end())
+	{
+		return it->second;
+	}
+	ComPtr<ID3D11InputLayout> inputLayout;
+	ThrowIfFailed(_device->CreateInputLayout(elements, elementCount, byteCode->GetBufferPointer(), byteCode->GetBufferSize(), inputLayout.GetAddressOf()));
+	_inputLayouts[key.str()] = inputLayout;
+	return inputLayout;
+}
+
+ComPtr<ID3DBlob> ShaderLibrary::GetByteCode(const wstring& fileName, const string& entryPoint, const string& profile, const ShaderDefines& defines, string& key)
+{
+	key = MakeShaderKey(fileName, entryPoint, profile, defines);
+	map<string, ComPtr<ID3DBlob>>::iterator it = _byteCode.find(key);
+	if (it != _byteCode.end())
+	{
+		return it->second;
+	}
+#if defined(ShaderDeveloperMode)
+	ComPtr<ID3DBlob> byteCode = CompileShader(fileName, entryPoint, profile, defines);
+#else
+	ComPtr<ID3DBlob> byteCode = GetCompiledShader(fileName, entryPoint, profile, defines);
+#endif
+	_byteCode[key] = byteCode;
+	return byteCode;
+}
+
+#if !defined(ShaderDeveloperMode)
+ComPtr<ID3DBlob> ShaderLibrary::GetCompiledShader(const wstring& fileName, const string& entryPoint, const string& profile, const ShaderDefines& defines)
+{
+	// The build does not compile variants with defines, so only shaders without them are found
+	if (defines.empty())
+	{
+		for (const CompiledShader& compiledShader : CompiledShaders)
+		{
+			if (fileName == compiledShader.FileName && entryPoint == compiledShader.EntryPoint && profile == compiledShader.Profile)
+			{
+				ComPtr<ID3DBlob> byteCode;
+				ThrowIfFailed(D3DCreateBlob(compiledShader.ByteCodeSize, byteCode.GetAddressOf()));
+				memcpy(byteCode->GetBufferPointer(), compiledShader.ByteCode, compiledShader.ByteCodeSize);
+				return byteCode;
+			}
+		}
+	}
+	// The shader was not compiled by the build.  Add it to CompiledShaders.h and the project.
+	string message = "No compiled bytecode for " + ws2s(fileName) + " " + entryPoint + " (" + profile + ")";
+	MessageBoxA(0, message.c_str(), 0, 0);
+	ThrowIfFailed(E_INVALIDARG);
+	return nullptr;
+}
+#endif
+
+ComPtr<ID3DBlob> ShaderLibrary::CompileShader(const wstring& fileName, const string& entryPoint, const string& profile, const ShaderDefines& defines)
+{
+	DWORD shaderCompileFlags = 0;
+#if defined( _DEBUG )
+	shaderCompileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+
+	// Read the source so that it can be hashed and compiled from memory
+	ifstream sourceFile(fileName, ios::binary);
+	if (!sourceFile)
+	{
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+	}
+	string source((istreambuf_iterator<char>(sourceFile)), istreambuf_iterator<char>());
+
+	uint64_t hash = 14695981039346656037ull;
+	HashBytes(hash, &ShaderCacheVersion, sizeof(ShaderCacheVersion));
+	HashString(hash, source);
+	HashString(hash, entryPoint);
+	HashString(hash, profile);
+	for (const pair<string, string>& define : defines)
+	{
+		HashString(hash, define.first);
+		HashString(hash, define.second);
+	}
+	HashBytes(hash, &shaderCompileFlags, sizeof(shaderCompileFlags));
+	wstringstream cacheFileName;
+	cacheFileName << _cacheDirectory << L"\\" << hex << setw(16) << setfill(L'0') << hash << L".cso";
+
+	// If this exact shader has been compiled before, use the bytecode from the cache
+	ComPtr<ID3DBlob> byteCode;
+	if (SUCCEEDED(D3DReadFileToBlob(cacheFileName.str().c_str(), byteCode.GetAddressOf())))
+	{
+		_cacheLoadCount++;
+		return byteCode;
+	}
+
+	vector<D3D_SHADER_MACRO> macros;
+	for (const pair<string, string>& define : defines)
+	{
+		macros.push_back({ define.first.c_str(), define.second.c_str() });
+	}
+	macros.push_back({ nullptr, nullptr });
+
+	ComPtr<ID3DBlob> compilationMessages = nullptr;
+	string sourceName = ws2s(fileName);
+	HRESULT hr = D3DCompile(source.data(), source.size(),
+		sourceName.c_str(),
+		macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		entryPoint.c_str(), profile.c_str(),
+		shaderCompileFlags, 0,
+		byteCode.GetAddressOf(),
+		compilationMessages.GetAddressOf());
+
+	if (compilationMessages.Get() != nullptr)
+	{
+		// If there were any compilation messages, display them
+		MessageBoxA(0, (char*)compilationMessages->GetBufferPointer(), 0, 0);
+	}
+	// Even if there are no compiler messages, check to make sure there were no other errors.
+	ThrowIfFailed(hr);
+	_compileCount++;
+
+	// Failing to write to the cache is not an error.  The shader will just be compiled again next time.
+	CreateDirectoryW(_cacheDirectory.c_str(), nullptr);
+	D3DWriteBlobToFile(byteCode.Get(), cacheFileName.str().c_str(), TRUE);
+	return byteCode;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "core.h"
+#include "DirectXCore.h"
+#include <map>
+#include <vector>
+
+// In developer mode, shaders are compiled from the .hlsl files at runtime, so they can be edited
+// without rebuilding.  Otherwise only the bytecode compiled into the executable by the build is
+// used and nothing is compiled at runtime.  Developer mode is on in debug builds and can be turned
+// on in a release build by defining ShaderDeveloperMode.
+#if defined(_DEBUG) && !defined(ShaderDeveloperMode)
+#define ShaderDeveloperMode
+#endif
+
+// Preprocessor definitions passed to the shader compiler as (name, value) pairs
+typedef vector<pair<string, string>>	ShaderDefines;
+
+// Compiles each combination of shader file, entry point, profile and defines once and shares
+// the resulting shader objects and input layouts between everything that asks for them.
+//
+// In developer mode, compiled bytecode is also written to a cache directory on disk.  The cache files are named
+// after a hash of the shader source, entry point, profile, defines and compile flags, so a
+// changed shader is recompiled automatically and an unchanged one is never compiled again,
+// even between runs.  Files included by a shader are not part of the hash, so delete the
+// cache directory after changing an include file.
+
+class ShaderLibrary
+{
+public:
+	ShaderLibrary(ComPtr<ID3D11Device> device);
+
+	ComPtr<ID3D11VertexShader>			GetVertexShader(const wstring& fileName, const string& entryPoint, const ShaderDefines& defines = ShaderDefines());
+	ComPtr<ID3D11PixelShader>			GetPixelShader(const wstring& fileName, const string& entryPoint, const ShaderDefines& defines = ShaderDefines());
+
+	// The input layout is validated against the bytecode of the given vertex shader.  Layouts
+	// with identical elements created for the same shader are shared.
+	ComPtr<ID3D11InputLayout>			GetInputLayout(const wstring& fileName, const string& entryPoint, const D3D11_INPUT_ELEMENT_DESC * elements, UINT elementCount, const ShaderDefines& defines = ShaderDefines());
+
+	// The number of shaders actually compiled and loaded from the disk cache since startup
+	inline size_t						GetCompileCount() const { return _compileCount; }
+	inline size_t						GetCacheLoadCount() const { return _cacheLoadCount; }
+
+private:
+	ComPtr<ID3D11Device>				_device;
+	wstring								_cacheDirectory;
+
+	map<string, ComPtr<ID3DBlob>>				_byteCode;
+	map<string, ComPtr<ID3D11VertexShader>>		_vertexShaders;
+	map<string, ComPtr<ID3D11PixelShader>>		_pixelShaders;
+	map<string, ComPtr<ID3D11InputLayout>>		_inputLayouts;
+
+	size_t								_compileCount;
+	size_t								_cacheLoadCount;
+
+	ComPtr<ID3DBlob>					GetByteCode(const wstring& fileName, const string& entryPoint, const string& profile, const ShaderDefines& defines, string& key);
+	ComPtr<ID3DBlob>					GetCompiledShader(const wstring& fileName, const string& entryPoint, const string& profile, const ShaderDefines& defines);
+	ComPtr<ID3DBlob>					CompileShader(const wstring& fileName, const string& entryPoint, const string& profile, const ShaderDefines& defines);
+};
@@ -0,0 +1,98 @@
+#include "SortKey.h"
+#include <cassert>
+
+uint64_t BuildSortKey(RenderPass pass, unsigned int shaderId, unsigned int materialId, unsigned int textureId, unsigned int geometryId, unsigned int depth)
+{
+	// Ids that do not fit would be masked on to other ids
+	assert(shaderId <= SortKeyIdMask && materialId <= SortKeyIdMask && textureId <= SortKeyIdMask && geometryId <= SortKeyIdMask);
+	uint64_t key = static_cast<uint64_t>(pass & 0xF) << 60;
+	uint64_t shader = shaderId & SortKeyIdMask;
+	uint64_t material = materialId & SortKeyIdMask;
+	uint64_t texture = textureId & SortKeyIdMask;
+	uint64_t keyDepth = depth & SortKeyDepthMask;
+	if (pass == TransparentPass)
+	{
+		keyDepth = SortKeyDepthMask - keyDepth;
+		key |= keyDepth << 36;
+		key |= shader << 24;
+		key |= material << 12;
+		key |= texture;
+	}
+	else
+	{
+		key |= shader << 48;
+		key |= material << 36;
+		key |= texture << 24;
+		key |= static_cast<uint64_t>(geometryId & SortKeyIdMask) << 12;
+		key |= keyDepth >> (SortKeyDepthBits - SortKeyOpaqueDepthBits);
+	}
+	return key;
+}
+
+unsigned int QuantiseDepth(float viewDepth, float nearPlane, float farPlane)
+{
+	float depth = (viewDepth - nearPlane) / (farPlane - nearPlane);
+	if (depth <= 0.0f)
+	{
+		return 0;
+	}
+	if (depth >= 1.0f)
+	{
+		return SortKeyDepthMask;
+	}
+	return static_cast<unsigned int>(depth * SortKeyDepthMask);
+}
+
+void RadixSort(vector<RenderQueueEntry>& entries, vector<RenderQueueEntry>& scratch)
+{
+	const size_t count = entries.size();
+	if (count < 2)
+	{
+		return;
+	}
+	scratch.resize(count);
+
+	// Build the histograms for all eight byte positions in a single pass over the keys
+	uint32_t histograms[8][256] = { 0 };
+	for (size_t i = 0; i < count; i++)
+	{
+		uint64_t key = entries[i].SortKey;
+		for (int digit = 0; digit < 8; digit++)
+		{
+			histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+		}
+	}
+
+	RenderQueueEntry * source = entries.data();
+	RenderQueueEntry * destination = scratch.data();
+	for (int digit = 0; digit < 8; digit++)
+	{
+		uint32_t * histogram = histograms[digit];
+		// If every key has the same value for this byte, this pass would not change the order
+		if (histogram[(source[0].SortKey >> (digit * 8)) & 0xFF] == count)
+		{
+			continue;
+		}
+		// Turn the counts into starting offsets
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++)
+		{
+			uint32_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			destination[histogram[(source[i].SortKey >> (digit * 8)) & 0xFF]++] = source[i];
+		}
+		RenderQueueEntry * temp = source;
+		source = destination;
+		destination = temp;
+	}
+
+	// After an odd number of passes, the sorted entries are in the scratch buffer
+	if (source != entries.data())
+	{
+		entries.swap(scratch);
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Sort keys for the render queue.
+//
+// Each draw packet is given a 64-bit key so that sorting the keys puts the packets into the
+// order that minimises state changes.  This file has no dependencies on Direct3D, so the keys
+// and the sort can be built and checked without a device.
+//
+// Opaque key layout (most significant bits first):
+//
+//    pass (4) | shader (12) | material (12) | texture (12) | geometry (12) | depth (12)
+//
+// The geometry sits above the depth so that draws of the same mesh with the same state end up
+// next to each other, where the render queue can instance them, however they are spread out
+// in depth.  Only the top 12 bits of the depth are kept, which is enough for front to back
+// ordering to cut down overdraw.
+//
+// Transparent objects have to be drawn back to front, so for the transparent pass the depth
+// is moved up to sit just below the pass and is inverted.  Transparent draws are never
+// instanced, so there is no geometry in their key:
+//
+//    pass (4) | inverted depth (24) | shader (12) | material (12) | texture (12)
+
+enum RenderPass
+{
+	OpaquePass = 0,
+	TransparentPass = 1
+};
+
+const unsigned int SortKeyIdBits = 12;
+const unsigned int SortKeyDepthBits = 24;
+const unsigned int SortKeyOpaqueDepthBits = 12;
+const unsigned int SortKeyIdMask = (1u << SortKeyIdBits) - 1;
+const unsigned int SortKeyDepthMask = (1u << SortKeyDepthBits) - 1;
+
+struct RenderQueueEntry
+{
+	uint64_t				SortKey;
+	uint32_t				PacketIndex;
+};
+
+// The depth is in the range given by QuantiseDepth.  The geometry id is ignored for the
+// transparent pass.
+uint64_t					BuildSortKey(RenderPass pass, unsigned int shaderId, unsigned int materialId, unsigned int textureId, unsigned int geometryId, unsigned int depth);
+
+// Map a view space depth between the near and far planes on to the range used in the key
+unsigned int				QuantiseDepth(float viewDepth, float nearPlane, float farPlane);
+
+// Least significant digit radix sort of the entries on their sort keys.  The scratch vector is
+// used as the second buffer so that it can be reused from frame to frame.  Digits that are the
+// same in every key are skipped.
+void						RadixSort(vector<RenderQueueEntry>& entries, vector<RenderQueueEntry>& scratch);
@@ -0,0 +1,119 @@
+#include "StateCache.h"
+
+StateCache::StateCache(shared_ptr<RenderDevice> device)
+{
+	_device = device;
+}
+
+void StateCache::SetVertexShader(RenderVertexShader vertexShader)
+{
+	if (_filter.Set(VertexShaderSlot, vertexShader))
+	{
+		_device->SetVertexShader(vertexShader);
+	}
+}
+
+void StateCache::SetPixelShader(RenderPixelShader pixelShader)
+{
+	if (_filter.Set(PixelShaderSlot, pixelShader))
+	{
+		_device->SetPixelShader(pixelShader);
+	}
+}
+
+void StateCache::SetInputLayout(RenderInputLayout inputLayout)
+{
+	if (_filter.Set(InputLayoutSlot, inputLayout))
+	{
+		_device->SetInputLayout(inputLayout);
+	}
+}
+
+void StateCache::SetPrimitiveTopology(RenderTopology topology)
+{
+	if (_filter.Set(PrimitiveTopologySlot, nullptr, topology))
+	{
+		_device->SetPrimitiveTopology(topology);
+	}
+}
+
+void StateCache::SetRasteriserState(RenderRasteriserState rasteriserState)
+{
+	if (_filter.Set(RasteriserStateSlot, rasteriserState))
+	{
+		_device->SetRasteriserState(rasteriserState);
+	}
+}
+
+void StateCache::SetVertexBuffer(RenderBuffer vertexBuffer, unsigned int stride)
+{
+	if (_filter.Set(VertexBufferSlot, vertexBuffer, stride))
+	{
+		_device->SetVertexBuffer(0, vertexBuffer, stride);
+	}
+}
+
+void StateCache::SetInstanceBuffer(RenderBuffer instanceBuffer, unsigned int stride)
+{
+	if (_filter.Set(InstanceBufferSlot, instanceBuffer, stride))
+	{
+		_device->SetVertexBuffer(1, instanceBuffer, stride);
+	}
+}
+
+void StateCache::SetIndexBuffer(RenderBuffer indexBuffer, unsigned int indexSize)
+{
+	if (_filter.Set(IndexBufferSlot, indexBuffer, indexSize))
+	{
+		_device->SetIndexBuffer(indexBuffer, indexSize);
+	}
+}
+
+void StateCache::SetVertexConstantBuffer(unsigned int slot, RenderBuffer constantBuffer)
+{
+	// A whole buffer is recorded as a range of no constants, so that it is never mistaken for a
+	// range of the same buffer bound with the other overload
+	if (_filter.Set(static_cast<StateSlot>(VertexConstantBufferSlot + slot), constantBuffer))
+	{
+		_device->SetVertexConstantBuffer(slot, constantBuffer);
+	}
+}
+
+void StateCache::SetVertexConstantBuffer(unsigned int slot, RenderBuffer constantBuffer, unsigned int firstConstant, unsigned int constantCount)
+{
+	if (_filter.Set(static_cast<StateSlot>(VertexConstantBufferSlot + slot), constantBuffer, firstConstant, constantCount))
+	{
+		_device->SetVertexConstantBufferRange(slot, constantBuffer, firstConstant, constantCount);
+	}
+}
+
+void StateCache::SetPixelConstantBuffer(unsigned int slot, RenderBuffer constantBuffer)
+{
+	if (_filter.Set(static_cast<StateSlot>(PixelConstantBufferSlot + slot), constantBuffer))
+	{
+		_device->SetPixelConstantBuffer(slot, constantBuffer);
+	}
+}
+
+void StateCache::SetPixelShaderResource(RenderShaderResource shaderResource)
+{
+	if (_filter.Set(PixelShaderResourceSlot, shaderResource))
+	{
+		_device->SetPixelShaderResource(0, shaderResource);
+	}
+}
+
+void StateCache::UpdateBuffer(RenderBuffer buffer, const void * data, size_t size)
+{
+	_device->UpdateBuffer(buffer, data, size);
+}
+
+void StateCache::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+	_device->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void StateCache::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance)
+{
+	_device->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
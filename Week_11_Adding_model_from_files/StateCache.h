@@ -0,0 +1,46 @@
+#pragma once
+#include <memory>
+#include "RenderDevice.h"
+#include "StateFilter.h"
+
+using namespace std;
+
+// A thin layer over the render device that drops calls which would set state that is already
+// bound.  All drawing should go through this rather than the device so that what is
+// bound is known.  Apart from the instance stream and the constant buffers (see
+// ShaderConstants.h), only slot 0 of each stage is used by the shaders in this project, so only
+// slot 0 is cached.
+
+class StateCache
+{
+public:
+	StateCache(shared_ptr<RenderDevice> device);
+
+	void						SetVertexShader(RenderVertexShader vertexShader);
+	void						SetPixelShader(RenderPixelShader pixelShader);
+	void						SetInputLayout(RenderInputLayout inputLayout);
+	void						SetPrimitiveTopology(RenderTopology topology);
+	void						SetRasteriserState(RenderRasteriserState rasteriserState);
+	void						SetVertexBuffer(RenderBuffer vertexBuffer, unsigned int stride);
+	// Instance data goes in vertex buffer slot 1
+	void						SetInstanceBuffer(RenderBuffer instanceBuffer, unsigned int stride);
+	void						SetIndexBuffer(RenderBuffer indexBuffer, unsigned int indexSize);
+	void						SetVertexConstantBuffer(unsigned int slot, RenderBuffer constantBuffer);
+	// Binds part of a constant buffer, given in constants of 16 bytes.  This needs
+	// RenderDevice::SupportsConstantBufferOffsets.
+	void						SetVertexConstantBuffer(unsigned int slot, RenderBuffer constantBuffer, unsigned int firstConstant, unsigned int constantCount);
+	void						SetPixelConstantBuffer(unsigned int slot, RenderBuffer constantBuffer);
+	void						SetPixelShaderResource(RenderShaderResource shaderResource);
+
+	// Calls that do not change the bound state are passed straight through
+	void						UpdateBuffer(RenderBuffer buffer, const void * data, size_t size);
+	void						DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex);
+	void						DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance);
+
+	inline void					Invalidate() { _filter.Invalidate(); }
+	inline StateFilter&			GetFilter() { return _filter; }
+
+private:
+	shared_ptr<RenderDevice>	_device;
+	StateFilter					_filter;
+};
@@ -0,0 +1,40 @@
+#include "StateFilter.h"
+
+StateFilter::StateFilter()
+{
+	Invalidate();
+	ResetStatistics();
+}
+
+bool StateFilter::Set(StateSlot slot, const void * value, unsigned int parameter, unsigned int secondParameter)
+{
+	BoundState& bound = _bound[slot];
+	if (bound.Known && bound.Value == value && bound.Parameter == parameter && bound.SecondParameter == secondParameter)
+	{
+		_elidedCount++;
+		return false;
+	}
+	bound.Value = value;
+	bound.Parameter = parameter;
+	bound.SecondParameter = secondParameter;
+	bound.Known = true;
+	_issuedCount++;
+	return true;
+}
+
+void StateFilter::Invalidate()
+{
+	for (int i = 0; i < StateSlotCount; i++)
+	{
+		_bound[i].Value = nullptr;
+		_bound[i].Parameter = 0;
+		_bound[i].SecondParameter = 0;
+		_bound[i].Known = false;
+	}
+}
+
+void StateFilter::ResetStatistics()
+{
+	_issuedCount = 0;
+	_elidedCount = 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+
+// Keeps track of the pipeline state that is currently bound and decides whether a call that sets
+// state actually needs to be made.  This has no dependencies on Direct3D, so the filtering can be
+// checked without a device.  StateCache uses it to filter the calls it makes on the render device.
+
+// The number of constant buffer registers that are tracked for each shader stage
+const int ConstantBufferSlotCount = 4;
+
+enum StateSlot
+{
+	VertexShaderSlot,
+	PixelShaderSlot,
+	InputLayoutSlot,
+	PrimitiveTopologySlot,
+	RasteriserStateSlot,
+	VertexBufferSlot,
+	InstanceBufferSlot,
+	IndexBufferSlot,
+	// One slot for each constant buffer register, starting with register 0
+	VertexConstantBufferSlot,
+	PixelConstantBufferSlot = VertexConstantBufferSlot + ConstantBufferSlotCount,
+	PixelShaderResourceSlot = PixelConstantBufferSlot + ConstantBufferSlotCount,
+	StateSlotCount
+};
+
+class StateFilter
+{
+public:
+	StateFilter();
+
+	// Returns true if the value (and parameters, such as a stride or format, or the first
+	// constant and constant count of a constant buffer range) differs from what is bound to the
+	// slot, in which case the caller must make the call.  Otherwise the call is counted as
+	// elided and false is returned.
+	bool					Set(StateSlot slot, const void * value, unsigned int parameter = 0, unsigned int secondParameter = 0);
+
+	// Forget what is bound, so that the next call for every slot is made.  This must be called
+	// if anything sets state on the device without going through the filter.
+	void					Invalidate();
+
+	void					ResetStatistics();
+	inline size_t			GetIssuedCount() const { return _issuedCount; }
+	inline size_t			GetElidedCount() const { return _elidedCount; }
+
+private:
+	struct BoundState
+	{
+		const void *		Value;
+		unsigned int		Parameter;
+		unsigned int		SecondParameter;
+		bool				Known;
+	};
+
+	BoundState				_bound[StateSlotCount];
+	size_t					_issuedCount;
+	size_t					_elidedCount;
+};
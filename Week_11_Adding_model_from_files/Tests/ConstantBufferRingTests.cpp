@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include "ConstantBufferRing.h"
+#include "RecordingRenderDevice.h"
+
+namespace
+{
+	// Copied so that the expectations, which take their arguments by reference, do not need a
+	// definition of the class constant
+	const unsigned int SliceConstants = ConstantBufferRing::SliceConstantCount;
+
+	// The mode of the most recent map of the buffer
+	int64_t GetLastMapMode(const RecordingRenderDevice& device)
+	{
+		const vector<RenderCommand>& commands = device.GetCommands();
+		for (auto it = commands.rbegin(); it != commands.rend(); it++)
+		{
+			if (it->Type == MapBufferCommand)
+			{
+				return it->Arguments[0];
+			}
+		}
+		return -1;
+	}
+
+	unsigned int MapAndUnmap(ConstantBufferRing& ring, size_t sliceCount)
+	{
+		unsigned int firstConstant;
+		uint8_t * slices = ring.Map(sliceCount, firstConstant);
+		slices[sliceCount * ConstantBufferRing::SliceSize - 1] = 1;
+		ring.Unmap();
+		return firstConstant;
+	}
+}
+
+TEST(ConstantBufferRing, AlignsSlicesForBindingAtAnOffset)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	ConstantBufferRing ring(device, 4096);
+	unsigned int firstConstant;
+	uint8_t * slices = ring.Map(1, firstConstant);
+	EXPECT_EQ(device->GetBufferData(ring.GetBuffer()), slices);
+	ring.Unmap();
+	EXPECT_EQ(RenderMapDiscard, GetLastMapMode(*device));
+
+	slices = ring.Map(2, firstConstant);
+	EXPECT_EQ(SliceConstants, firstConstant);
+	EXPECT_EQ(device->GetBufferData(ring.GetBuffer()) + 256, slices);
+	ring.Unmap();
+	EXPECT_EQ(RenderMapNoOverwrite, GetLastMapMode(*device));
+	// Every offset is a multiple of 256 bytes, or 16 constants
+	EXPECT_EQ(3 * SliceConstants, MapAndUnmap(ring, 1));
+}
+
+TEST(ConstantBufferRing, ReusesSlicesOnceTheirFenceCompletes)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	device->SetAutoCompleteFences(false);
+	ConstantBufferRing ring(device, 1024);
+	MapAndUnmap(ring, 2);
+	ring.EndFrame();
+	EXPECT_EQ(2 * SliceConstants, MapAndUnmap(ring, 1));
+	ring.EndFrame();
+	EXPECT_EQ(2u, ring.GetAllocator().GetPendingFrameCount());
+
+	// The GPU finishes both frames, so the next slices wrap round to the start of the buffer
+	// without a discard
+	device->CompleteFences();
+	EXPECT_EQ(0u, MapAndUnmap(ring, 2));
+	EXPECT_EQ(RenderMapNoOverwrite, GetLastMapMode(*device));
+	EXPECT_EQ(0u, ring.GetAllocator().GetPendingFrameCount());
+	EXPECT_EQ(0u, ring.GetAllocator().GetDiscardCount());
+	ring.EndFrame();
+}
+
+TEST(ConstantBufferRing, DiscardsWhenTheGpuIsBehind)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	device->SetAutoCompleteFences(false);
+	ConstantBufferRing ring(device, 1024);
+	MapAndUnmap(ring, 3);
+	ring.EndFrame();
+	MapAndUnmap(ring, 1);
+	ring.EndFrame();
+
+	// No fence has completed and the buffer is full
+	EXPECT_EQ(0u, MapAndUnmap(ring, 2));
+	EXPECT_EQ(RenderMapDiscard, GetLastMapMode(*device));
+	EXPECT_EQ(1u, ring.GetAllocator().GetDiscardCount());
+	ring.EndFrame();
+}
+
+TEST(ConstantBufferRing, GrowsForMoreSlicesThanItHolds)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	ConstantBufferRing ring(device, 1024);
+	MapAndUnmap(ring, 1);
+	RenderBuffer firstBuffer = ring.GetBuffer();
+
+	EXPECT_EQ(0u, MapAndUnmap(ring, 9));
+	EXPECT_NE(firstBuffer, ring.GetBuffer());
+	EXPECT_EQ(RenderMapDiscard, GetLastMapMode(*device));
+	EXPECT_EQ(4096u, ring.GetAllocator().GetCapacity());
+	// The old buffer has been released
+	EXPECT_EQ(4096u, device->GetStatistics().BufferBytes);
+	ring.EndFrame();
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "GeometricObject.h"
+#include "LegacyGeometricObject.h"
+
+// The forms of the Compute functions that write into memory provided by the caller must give
+// exactly the same geometry as the forms that fill vectors, at every tessellation.  Both must give
+// the same geometry as the generators they replaced, with the same indices.  The positions may
+// differ in the last bits, because the sines and cosines are now found four at a time with
+// XMVectorSinCos rather than one at a time with XMScalarSinCos.
+
+namespace
+{
+	typedef function<void(vector<ObjectVertexStruct>&, vector<uint32_t>&)> VectorForm;
+	typedef function<void(ObjectVertexStruct *, uint32_t *)> BufferForm;
+
+	void ExpectSameGeometry(const GeometryCounts& counts, const VectorForm& vectorForm, const BufferForm& bufferForm)
+	{
+		// Vectors that already hold something, to check that they are resized rather than
+		// appended to
+		vector<ObjectVertexStruct> vertices(3);
+		vector<uint32_t> indices(7, 99);
+		vectorForm(vertices, indices);
+		ASSERT_EQ(counts.VertexCount, vertices.size());
+		ASSERT_EQ(counts.IndexCount, indices.size());
+
+		// One element more than the counts, to check that nothing is written past them
+		vector<ObjectVertexStruct> bufferVertices(counts.VertexCount + 1);
+		vector<uint32_t> bufferIndices(counts.IndexCount + 1, 0xDEADBEEF);
+		bufferVertices.back().Position = Vector3(-123.0f, -123.0f, -123.0f);
+		bufferForm(bufferVertices.data(), bufferIndices.data());
+		EXPECT_EQ(0, memcmp(vertices.data(), bufferVertices.data(), sizeof(ObjectVertexStruct) * counts.VertexCount));
+		EXPECT_EQ(0, memcmp(indices.data(), bufferIndices.data(), sizeof(uint32_t) * counts.IndexCount));
+		EXPECT_EQ(0xDEADBEEF, bufferIndices.back());
+		EXPECT_EQ(-123.0f, bufferVertices.back().Position.x);
+		for (uint32_t index : indices)
+		{
+			ASSERT_LT(index, counts.VertexCount);
+		}
+	}
+
+	void ExpectSameAsLegacy(const GeometryCounts& counts, const BufferForm& bufferForm, const VectorForm& legacyForm, float tolerance)
+	{
+		vector<ObjectVertexStruct> legacyVertices;
+		vector<uint32_t> legacyIndices;
+		legacyForm(legacyVertices, legacyIndices);
+		ASSERT_EQ(legacyVertices.size(), counts.VertexCount);
+		ASSERT_EQ(legacyIndices.size(), counts.IndexCount);
+
+		vector<ObjectVertexStruct> vertices(counts.VertexCount);
+		vector<uint32_t> indices(counts.IndexCount);
+		bufferForm(vertices.data(), indices.data());
+		EXPECT_EQ(0, memcmp(legacyIndices.data(), indices.data(), sizeof(uint32_t) * counts.IndexCount));
+		for (size_t i = 0; i < counts.VertexCount; i++)
+		{
+			ASSERT_NEAR(legacyVertices[i].Position.x, vertices[i].Position.x, tolerance) << "vertex " << i;
+			ASSERT_NEAR(legacyVertices[i].Position.y, vertices[i].Position.y, tolerance) << "vertex " << i;
+			ASSERT_NEAR(legacyVertices[i].Position.z, vertices[i].Position.z, tolerance) << "vertex " << i;
+			ASSERT_TRUE(vertices[i].Normal.x == 0.0f && vertices[i].Normal.y == 0.0f && vertices[i].Normal.z == 0.0f) << "vertex " << i;
+		}
+	}
+
+	const size_t Tessellations[] = { 3, 4, 5, 8, 17, 32, 64 };
+
+	// Up to the finest each primitive can be without running out of 16-bit indices
+	const size_t SphereLegacyTessellations[] = { 3, 4, 5, 8, 17, 32, 64, 100, 128, 180 };
+	const size_t RoundLegacyTessellations[] = { 3, 4, 5, 8, 17, 32, 64, 256, 1024, 4096, 16000 };
+
+	// Within a few units in the last place of the largest coordinate
+	const float LegacyTolerance = 4e-6f;
+}
+
+TEST(GeometricObject, BoxFormsMatch)
+{
+	Vector3 size(1.0f, 2.0f, 3.0f);
+	ExpectSameGeometry(GetBoxCounts(),
+					   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { ComputeBox(vertices, indices, size); },
+					   [&](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeBox(vertices, indices, size); });
+}
+
+TEST(GeometricObject, SphereFormsMatch)
+{
+	for (size_t tessellation : Tessellations)
+	{
+		SCOPED_TRACE(tessellation);
+		ExpectSameGeometry(GetSphereCounts(tessellation),
+						   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { ComputeSphere(vertices, indices, 2.0f, tessellation); },
+						   [&](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeSphere(vertices, indices, 2.0f, tessellation); });
+	}
+}
+
+TEST(GeometricObject, CylinderFormsMatch)
+{
+	for (size_t tessellation : Tessellations)
+	{
+		SCOPED_TRACE(tessellation);
+		ExpectSameGeometry(GetCylinderCounts(tessellation),
+						   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { ComputeCylinder(vertices, indices, 3.0f, 1.5f, tessellation); },
+						   [&](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeCylinder(vertices, indices, 3.0f, 1.5f, tessellation); });
+	}
+}
+
+TEST(GeometricObject, ConeFormsMatch)
+{
+	for (size_t tessellation : Tessellations)
+	{
+		SCOPED_TRACE(tessellation);
+		ExpectSameGeometry(GetConeCounts(tessellation),
+						   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { ComputeCone(vertices, indices, 1.5f, 3.0f, tessellation); },
+						   [&](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeCone(vertices, indices, 1.5f, 3.0f, tessellation); });
+	}
+}
+
+TEST(GeometricObject, TeapotFormsMatch)
+{
+	for (size_t tessellation : { 1, 2, 6, 12 })
+	{
+		SCOPED_TRACE(tessellation);
+		ExpectSameGeometry(GetTeapotCounts(tessellation),
+						   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { ComputeTeapot(vertices, indices, 1.0f, tessellation); },
+						   [&](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeTeapot(vertices, indices, 1.0f, tessellation); });
+		// Generating the patches one at a time, as the resource manager does on the workers
+		ExpectSameGeometry(GetTeapotCounts(tessellation),
+						   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { ComputeTeapot(vertices, indices, 1.0f, tessellation); },
+						   [&](ObjectVertexStruct * vertices, uint32_t * indices)
+						   {
+							   for (size_t patch = 0; patch < GetTeapotPatchCount(); patch++)
+							   {
+								   ComputeTeapotPatch(vertices, indices, 1.0f, tessellation, patch);
+							   }
+						   });
+	}
+}
+
+TEST(GeometricObject, BoxMatchesLegacy)
+{
+	Vector3 size(1.0f, 2.0f, 3.0f);
+	ExpectSameAsLegacy(GetBoxCounts(),
+					   [&](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeBox(vertices, indices, size); },
+					   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { LegacyGeometricObject::ComputeBox(vertices, indices, size); },
+					   0.0f);
+}
+
+TEST(GeometricObject, SphereMatchesLegacy)
+{
+	for (size_t tessellation : SphereLegacyTessellations)
+	{
+		SCOPED_TRACE(tessellation);
+		ExpectSameAsLegacy(GetSphereCounts(tessellation),
+						   [&](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeSphere(vertices, indices, 2.0f, tessellation); },
+						   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { LegacyGeometricObject::ComputeSphere(vertices, indices, 2.0f, tessellation); },
+						   LegacyTolerance);
+	}
+}
+
+TEST(GeometricObject, CylinderMatchesLegacy)
+{
+	for (size_t tessellation : RoundLegacyTessellations)
+	{
+		SCOPED_TRACE(tessellation);
+		ExpectSameAsLegacy(GetCylinderCounts(tessellation),
+						   [&](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeCylinder(vertices, indices, 3.0f, 1.5f, tessellation); },
+						   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { LegacyGeometricObject::ComputeCylinder(vertices, indices, 3.0f, 1.5f, tessellation); },
+						   LegacyTolerance);
+	}
+}
+
+TEST(GeometricObject, ConeMatchesLegacy)
+{
+	for (size_t tessellation : RoundLegacyTessellations)
+	{
+		SCOPED_TRACE(tessellation);
+		ExpectSameAsLegacy(GetConeCounts(tessellation),
+						   [&](ObjectVertexStruct * vertices, uint32_t * indices) { ComputeCone(vertices, indices, 1.5f, 3.0f, tessellation); },
+						   [&](vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices) { LegacyGeometricObject::ComputeCone(vertices, indices, 1.5f, 3.0f, tessellation); },
+						   LegacyTolerance);
+	}
+}
+
+TEST(GeometricObject, RejectsTessellationsThatAreTooLow)
+{
+	vector<ObjectVertexStruct> vertices;
+	vector<uint32_t> indices;
+	EXPECT_THROW(ComputeSphere(vertices, indices, 1.0f, 2), invalid_argument);
+	EXPECT_THROW(ComputeCylinder(vertices, indices, 1.0f, 1.0f, 2), invalid_argument);
+	EXPECT_THROW(ComputeTeapot(vertices, indices, 1.0f, 0), invalid_argument);
+}
+
+TEST(GeometricObject, RejectsTessellationsThatAreTooHigh)
+{
+	vector<ObjectVertexStruct> vertices;
+	vector<uint32_t> indices;
+	EXPECT_THROW(ComputeSphere(vertices, indices, 1.0f, 181), out_of_range);
+	EXPECT_THROW(LegacyGeometricObject::ComputeSphere(vertices, indices, 1.0f, 181), out_of_range);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "GeometryAllocator.h"
+
+TEST(GeometryAllocator, AllocatesFromTheBestFittingRange)
+{
+	GeometryAllocator allocator(1024, 16, 1024);
+	GeometryBlockId blocks[6];
+	for (int i = 0; i < 6; i++)
+	{
+		blocks[i] = allocator.Allocate(i == 1 ? 256 : 64);
+	}
+	// Free ranges of 256 at 64, 64 at 384 and 448 at the end
+	allocator.Free(blocks[1]);
+	allocator.Free(blocks[3]);
+	EXPECT_EQ(3u, allocator.GetFreeRangeCount());
+
+	GeometryBlockId block = allocator.Allocate(50);
+	EXPECT_EQ(384u, allocator.GetBlock(block).Offset);
+	EXPECT_EQ(64u, allocator.GetBlock(block).Size);
+	block = allocator.Allocate(200);
+	EXPECT_EQ(64u, allocator.GetBlock(block).Offset);
+	EXPECT_EQ(208u, allocator.GetBlock(block).Size);
+	block = allocator.Allocate(300);
+	EXPECT_EQ(576u, allocator.GetBlock(block).Offset);
+	EXPECT_EQ(64u * 4 + 64u + 208u + 304u, allocator.GetUsed());
+}
+
+TEST(GeometryAllocator, MergesFreedBlocksWithTheirNeighbours)
+{
+	GeometryAllocator allocator(512, 16, 512);
+	GeometryBlockId blocks[4];
+	for (int i = 0; i < 4; i++)
+	{
+		blocks[i] = allocator.Allocate(128);
+	}
+	allocator.Free(blocks[0]);
+	allocator.Free(blocks[2]);
+	EXPECT_EQ(2u, allocator.GetFreeRangeCount());
+	// Merges with the free ranges before and after it
+	allocator.Free(blocks[1]);
+	EXPECT_EQ(1u, allocator.GetFreeRangeCount());
+	EXPECT_EQ(384u, allocator.GetLargestFreeRange());
+	EXPECT_EQ(0.0f, allocator.GetFragmentation());
+
+	// Merges with the free range before it only
+	allocator.Free(blocks[3]);
+	EXPECT_EQ(1u, allocator.GetFreeRangeCount());
+	EXPECT_EQ(512u, allocator.GetLargestFreeRange());
+	EXPECT_EQ(0u, allocator.GetBlockCount());
+
+	// Merges with the free range after it only
+	GeometryAllocator second(512, 16, 512);
+	GeometryBlockId first = second.Allocate(128);
+	second.Allocate(128);
+	second.Free(first);
+	EXPECT_EQ(2u, second.GetFreeRangeCount());
+	EXPECT_EQ(256u, second.GetLargestFreeRange());
+}
+
+TEST(GeometryAllocator, GrowsIntoTheFreeSpaceAtTheEnd)
+{
+	GeometryAllocator allocator(1024, 16, 8192);
+	GeometryBlockId first = allocator.Allocate(768);
+	// 256 bytes are free at the end, so 1024 more are needed, which doubling covers
+	GeometryBlockId second = allocator.Allocate(1280);
+	ASSERT_NE(InvalidGeometryBlock, second);
+	EXPECT_EQ(768u, allocator.GetBlock(second).Offset);
+	EXPECT_EQ(2048u, allocator.GetCapacity());
+	EXPECT_EQ(0u, allocator.GetBlock(first).Offset);
+	EXPECT_EQ(0u, allocator.GetFreeRangeCount());
+
+	// Growing by more than double when the block needs it
+	GeometryBlockId third = allocator.Allocate(4096);
+	EXPECT_EQ(2048u, allocator.GetBlock(third).Offset);
+	EXPECT_EQ(6144u, allocator.GetCapacity());
+}
+
+TEST(GeometryAllocator, LeavesEverythingUnchangedWhenFull)
+{
+	GeometryAllocator allocator(1024, 16, 2048);
+	GeometryBlockId first = allocator.Allocate(512);
+	GeometryBlockId second = allocator.Allocate(256);
+	allocator.Free(first);
+	// 512 free at the start and 256 at the end: 1792 would need the capacity to be 2304
+	EXPECT_EQ(InvalidGeometryBlock, allocator.Allocate(1792));
+	EXPECT_EQ(1024u, allocator.GetCapacity());
+	EXPECT_EQ(256u, allocator.GetUsed());
+	EXPECT_EQ(1u, allocator.GetBlockCount());
+	EXPECT_EQ(2u, allocator.GetFreeRangeCount());
+	EXPECT_EQ(512u, allocator.GetBlock(second).Offset);
+
+	// Growing right up to the maximum capacity is allowed
+	GeometryBlockId last = allocator.Allocate(1280);
+	ASSERT_NE(InvalidGeometryBlock, last);
+	EXPECT_EQ(768u, allocator.GetBlock(last).Offset);
+	EXPECT_EQ(2048u, allocator.GetCapacity());
+	EXPECT_EQ(InvalidGeometryBlock, allocator.Allocate(1024));
+	EXPECT_EQ(InvalidGeometryBlock, allocator.Allocate(0));
+}
+
+TEST(GeometryAllocator, DefragmentsInOffsetOrder)
+{
+	GeometryAllocator allocator(1024, 16, 1024);
+	GeometryBlockId blocks[5];
+	for (int i = 0; i < 5; i++)
+	{
+		blocks[i] = allocator.Allocate(64 + i * 16);
+	}
+	allocator.Free(blocks[0]);
+	allocator.Free(blocks[2]);
+	// Reuses the id of block 2, but goes in the gap left by block 0, so the ids are no longer
+	// in offset order
+	GeometryBlockId reused = allocator.Allocate(32);
+	EXPECT_EQ(blocks[2], reused);
+	EXPECT_EQ(0u, allocator.GetBlock(reused).Offset);
+	EXPECT_GT(allocator.GetFragmentation(), 0.0f);
+
+	vector<GeometryMove> moves;
+	allocator.Defragment(moves);
+	ASSERT_EQ(4u, moves.size());
+	GeometryBlockId expectedOrder[4] = { reused, blocks[1], blocks[3], blocks[4] };
+	size_t to = 0;
+	for (size_t i = 0; i < moves.size(); i++)
+	{
+		EXPECT_EQ(expectedOrder[i], moves[i].Id);
+		if (i > 0)
+		{
+			EXPECT_LT(moves[i - 1].From, moves[i].From);
+		}
+		EXPECT_EQ(to, moves[i].To);
+		EXPECT_EQ(to, allocator.GetBlock(moves[i].Id).Offset);
+		to += moves[i].Size;
+	}
+	EXPECT_EQ(allocator.GetUsed(), to);
+	EXPECT_EQ(1u, allocator.GetFreeRangeCount());
+	EXPECT_EQ(0.0f, allocator.GetFragmentation());
+}
@@ -0,0 +1,19 @@
+#pragma once
+//--------------------------------------------------------------------------------------
+// File: LegacyGeometricObject.h
+//
+// The box, sphere, cylinder and cone generators as they were before they were rewritten to
+// write into caller memory, kept so that the tests can check the new ones against them and
+// the benchmarks can measure the difference.  They are not part of the application.
+//
+//--------------------------------------------------------------------------------------
+
+#include "GeometricObject.h"
+
+namespace LegacyGeometricObject
+{
+    void ComputeBox(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, const Vector3& size);
+    void ComputeSphere(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float diameter, size_t tessellation);
+    void ComputeCylinder(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float height, float diameter, size_t tessellation);
+    void ComputeCone(vector<ObjectVertexStruct>& vertices, vector<uint32_t>& indices, float diameter, float height, size_t tessellation);
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <set>
+#include <string>
+#include <vector>
+#include "MeshOptimiser.h"
+
+// The optimiser only reorders, so every stage must leave the same triangles, with the same
+// vertices and winding, in whatever order and with whatever numbering it likes
+
+namespace
+{
+	struct Vertex
+	{
+		float		Position[3];
+		float		Normal[3];
+		float		TexCoord[2];
+	};
+
+	// A shuffled grid in which every triangle has its own copy of its vertices, as in the
+	// optimiser benchmark
+	void BuildShuffledGrid(size_t quadsPerSide, vector<Vertex>& vertices, vector<uint32_t>& indices)
+	{
+		const size_t verticesPerSide = quadsPerSide + 1;
+		vector<uint32_t> corners;
+		for (size_t y = 0; y < quadsPerSide; y++)
+		{
+			for (size_t x = 0; x < quadsPerSide; x++)
+			{
+				const uint32_t corner = static_cast<uint32_t>(y * verticesPerSide + x);
+				const uint32_t across = static_cast<uint32_t>(verticesPerSide);
+				corners.insert(corners.end(), { corner, corner + across, corner + 1, corner + 1, corner + across, corner + across + 1 });
+			}
+		}
+		uint32_t random = 12345;
+		for (size_t i = corners.size() / 3 - 1; i > 0; i--)
+		{
+			random = random * 1664525 + 1013904223;
+			swap_ranges(corners.begin() + i * 3, corners.begin() + i * 3 + 3, corners.begin() + (random % (i + 1)) * 3);
+		}
+		vertices.resize(corners.size());
+		indices.resize(corners.size());
+		for (size_t i = 0; i < corners.size(); i++)
+		{
+			const float x = static_cast<float>(corners[i] % verticesPerSide);
+			const float y = static_cast<float>(corners[i] / verticesPerSide);
+			vertices[i] = { { x, y, 0.0f }, { 0.0f, 0.0f, -1.0f }, { x / quadsPerSide, y / quadsPerSide } };
+			indices[i] = static_cast<uint32_t>(i);
+		}
+	}
+
+	// A closed sphere with shared vertices, so that OptimiseOverdraw has triangles facing every way
+	void BuildSphere(size_t rings, size_t segments, vector<Vertex>& vertices, vector<uint32_t>& indices)
+	{
+		const float pi = 3.14159265f;
+		vertices.clear();
+		for (size_t i = 0; i <= rings; i++)
+		{
+			const float latitude = pi * static_cast<float>(i) / rings - pi / 2;
+			for (size_t j = 0; j <= segments; j++)
+			{
+				const float longitude = 2 * pi * static_cast<float>(j) / segments;
+				const float x = cosf(latitude) * sinf(longitude), y = sinf(latitude), z = cosf(latitude) * cosf(longitude);
+				vertices.push_back({ { x, y, z }, { x, y, z }, { static_cast<float>(j) / segments, static_cast<float>(i) / rings } });
+			}
+		}
+		indices.clear();
+		const uint32_t stride = static_cast<uint32_t>(segments + 1);
+		for (uint32_t i = 0; i < rings; i++)
+		{
+			for (uint32_t j = 0; j < segments; j++)
+			{
+				const uint32_t corner = i * stride + j;
+				indices.insert(indices.end(), { corner, corner + 1, corner + stride, corner + 1, corner + stride + 1, corner + stride });
+			}
+		}
+	}
+
+	typedef array<string, 3> Triangle;
+
+	// Each triangle as the bytes of its three vertices, starting from the smallest so that the
+	// winding is kept but the starting corner does not matter, sorted so that the order of the
+	// triangles does not matter
+	vector<Triangle> GetTriangles(const vector<Vertex>& vertices, size_t vertexCount, const vector<uint32_t>& indices)
+	{
+		vector<Triangle> triangles;
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			Triangle triangle;
+			for (size_t k = 0; k < 3; k++)
+			{
+				EXPECT_LT(indices[t + k], vertexCount);
+				const Vertex& vertex = vertices[min<size_t>(indices[t + k], vertices.size() - 1)];
+				triangle[k] = string(reinterpret_cast<const char *>(&vertex), sizeof(Vertex));
+			}
+			rotate(triangle.begin(), min_element(triangle.begin(), triangle.end()), triangle.end());
+			triangles.push_back(triangle);
+		}
+		sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+}
+
+TEST(MeshOptimiser, WeldsOnlyIdenticalVertices)
+{
+	vector<Vertex> vertices;
+	vector<uint32_t> indices;
+	BuildShuffledGrid(8, vertices, indices);
+	// Copies that differ only in their normal, only in the last bit of a texture coordinate and
+	// only in the sign of a zero must all be kept
+	const Vertex original = vertices[indices[0]];
+	Vertex differentNormal = original;
+	differentNormal.Normal[2] = 1.0f;
+	Vertex differentTexCoord = original;
+	differentTexCoord.TexCoord[0] = nextafterf(original.TexCoord[0], 2.0f);
+	Vertex negativeZero = original;
+	negativeZero.Position[2] = -0.0f;
+	for (const Vertex& vertex : { differentNormal, differentTexCoord, negativeZero })
+	{
+		vertices.push_back(vertex);
+		indices.insert(indices.end(), { static_cast<uint32_t>(vertices.size() - 1), indices[1], indices[2] });
+	}
+	const vector<Triangle> before = GetTriangles(vertices, vertices.size(), indices);
+	set<string> distinct;
+	for (const Vertex& vertex : vertices)
+	{
+		distinct.insert(string(reinterpret_cast<const char *>(&vertex), sizeof(Vertex)));
+	}
+
+	const size_t vertexCount = WeldVertices(vertices.data(), vertices.size(), sizeof(Vertex), indices);
+	EXPECT_EQ(distinct.size(), vertexCount);
+	EXPECT_EQ(before, GetTriangles(vertices, vertexCount, indices));
+}
+
+TEST(MeshOptimiser, StagesKeepTheTriangles)
+{
+	vector<Vertex> vertices;
+	vector<uint32_t> indices;
+	BuildSphere(16, 32, vertices, indices);
+	const vector<Triangle> before = GetTriangles(vertices, vertices.size(), indices);
+
+	OptimiseVertexCache(indices, vertices.size());
+	EXPECT_EQ(before, GetTriangles(vertices, vertices.size(), indices));
+
+	OptimiseOverdraw(indices, vertices.data(), vertices.size(), sizeof(Vertex), 1.05f);
+	EXPECT_EQ(before, GetTriangles(vertices, vertices.size(), indices));
+
+	// Add a vertex that no triangle uses, which fetch optimisation drops
+	vertices.push_back({ { 2.0f, 2.0f, 2.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } });
+	const size_t vertexCount = OptimiseVertexFetch(vertices.data(), vertices.size(), sizeof(Vertex), indices);
+	EXPECT_EQ(vertices.size() - 1, vertexCount);
+	EXPECT_EQ(before, GetTriangles(vertices, vertexCount, indices));
+	// The vertices are in the order they are first used
+	uint32_t next = 0;
+	for (uint32_t index : indices)
+	{
+		ASSERT_LE(index, next);
+		next = max(next, index + 1);
+	}
+	EXPECT_EQ(vertexCount, next);
+}
+
+TEST(MeshOptimiser, OptimiseMeshKeepsTheTrianglesAndReducesACMR)
+{
+	for (bool optimiseOverdraw : { false, true })
+	{
+		SCOPED_TRACE(optimiseOverdraw);
+		vector<Vertex> vertices;
+		vector<uint32_t> indices;
+		BuildShuffledGrid(32, vertices, indices);
+		const vector<Triangle> before = GetTriangles(vertices, vertices.size(), indices);
+		MeshOptimiserOptions options = DefaultMeshOptimiserOptions();
+		options.OptimiseOverdraw = optimiseOverdraw;
+		MeshOptimiserReport report;
+		OptimiseMesh(vertices, indices, options, &report);
+
+		EXPECT_EQ(before, GetTriangles(vertices, vertices.size(), indices));
+		EXPECT_EQ(33u * 33u, vertices.size());
+		EXPECT_EQ(vertices.size(), report.VertexCountAfter);
+		EXPECT_LT(report.VertexCountAfter, report.VertexCountBefore);
+		EXPECT_LE(report.After.ACMR, report.Before.ACMR);
+		EXPECT_LT(report.After.ACMR, 1.0f);
+	}
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+#include "MeshSimplifier.h"
+
+namespace
+{
+	struct Vertex
+	{
+		float		Position[3];
+		float		TexCoord[2];
+	};
+
+	typedef tuple<float, float, float> PositionKey;
+
+	PositionKey GetPositionKey(const Vertex& vertex)
+	{
+		return PositionKey(vertex.Position[0], vertex.Position[1], vertex.Position[2]);
+	}
+
+	Vertex MakeVertex(float x, float y, float z, float u, float v)
+	{
+		return { { x, y, z }, { u, v } };
+	}
+
+	// A UV sphere.  The first and last vertex of each ring are at the same position with U of 0 and
+	// 1, and every vertex of the first and last rings is at a pole, so the sphere is closed but
+	// has a seam from pole to pole.
+	void BuildSphere(size_t rings, size_t segments, vector<Vertex>& vertices, vector<uint32_t>& indices)
+	{
+		const float pi = 3.14159265f;
+		vertices.clear();
+		for (size_t i = 0; i <= rings; i++)
+		{
+			const float latitude = pi * static_cast<float>(i) / rings - pi / 2;
+			for (size_t j = 0; j <= segments; j++)
+			{
+				const float longitude = 2 * pi * static_cast<float>(j % segments) / segments;
+				float y = sinf(latitude);
+				float xz = cosf(latitude);
+				if (i == 0 || i == rings)
+				{
+					xz = 0.0f;
+					y = i == 0 ? -1.0f : 1.0f;
+				}
+				vertices.push_back(MakeVertex(xz * sinf(longitude), y, xz * cosf(longitude),
+											  static_cast<float>(j) / segments, static_cast<float>(i) / rings));
+			}
+		}
+		indices.clear();
+		const uint32_t stride = static_cast<uint32_t>(segments + 1);
+		for (uint32_t i = 0; i < rings; i++)
+		{
+			for (uint32_t j = 0; j < segments; j++)
+			{
+				const uint32_t corner = i * stride + j;
+				if (i != 0)
+				{
+					indices.insert(indices.end(), { corner, corner + 1, corner + stride });
+				}
+				if (i != rings - 1)
+				{
+					indices.insert(indices.end(), { corner + 1, corner + stride + 1, corner + stride });
+				}
+			}
+		}
+	}
+
+	// A bumpy square grid of quads in x and z.  The vertices down the middle column are
+	// duplicated, with the copy used by the right half in a different texture chart (U + 10), so
+	// the grid is one surface but has a texture seam down the middle.
+	void BuildGrid(size_t quadsAcross, vector<Vertex>& vertices, vector<uint32_t>& indices)
+	{
+		const size_t seam = quadsAcross / 2;
+		uint32_t random = 12345;
+		vector<float> heights((quadsAcross + 1) * (quadsAcross + 1));
+		for (float& height : heights)
+		{
+			random = random * 1664525 + 1013904223;
+			height = static_cast<float>(random % 1000) / 4000.0f;
+		}
+		vertices.clear();
+		vector<uint32_t> left((quadsAcross + 1) * (quadsAcross + 1));
+		vector<uint32_t> right(left.size());
+		for (size_t z = 0; z <= quadsAcross; z++)
+		{
+			for (size_t x = 0; x <= quadsAcross; x++)
+			{
+				const size_t i = z * (quadsAcross + 1) + x;
+				const float u = static_cast<float>(x) / quadsAcross;
+				const float v = static_cast<float>(z) / quadsAcross;
+				if (x <= seam)
+				{
+					left[i] = static_cast<uint32_t>(vertices.size());
+					vertices.push_back(MakeVertex(static_cast<float>(x), heights[i], static_cast<float>(z), u, v));
+				}
+				if (x >= seam)
+				{
+					right[i] = static_cast<uint32_t>(vertices.size());
+					vertices.push_back(MakeVertex(static_cast<float>(x), heights[i], static_cast<float>(z), u + 10.0f, v));
+				}
+			}
+		}
+		indices.clear();
+		for (size_t z = 0; z < quadsAcross; z++)
+		{
+			for (size_t x = 0; x < quadsAcross; x++)
+			{
+				const vector<uint32_t>& side = x < seam ? left : right;
+				const size_t corner = z * (quadsAcross + 1) + x;
+				const size_t across = quadsAcross + 1;
+				indices.insert(indices.end(), { side[corner], side[corner + across], side[corner + 1],
+												side[corner + 1], side[corner + across], side[corner + across + 1] });
+			}
+		}
+	}
+
+	// The edges between positions, with the number of triangles that use each
+	map<pair<PositionKey, PositionKey>, int> CountEdges(const vector<Vertex>& vertices, const vector<uint32_t>& indices)
+	{
+		map<pair<PositionKey, PositionKey>, int> edges;
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			for (size_t k = 0; k < 3; k++)
+			{
+				PositionKey a = GetPositionKey(vertices[indices[t + k]]);
+				PositionKey b = GetPositionKey(vertices[indices[t + (k + 1) % 3]]);
+				edges[a < b ? make_pair(a, b) : make_pair(b, a)]++;
+			}
+		}
+		return edges;
+	}
+
+	// Checks that each level has fewer triangles and no less error than the one before, that every
+	// index is a vertex and that no triangle has two corners at the same position
+	void ExpectValidChain(const vector<Vertex>& vertices, const vector<uint32_t>& indices, const vector<MeshLod>& lods)
+	{
+		size_t previousIndexCount = indices.size();
+		float previousError = 0.0f;
+		for (size_t level = 0; level < lods.size(); level++)
+		{
+			SCOPED_TRACE(level);
+			const vector<uint32_t>& lodIndices = lods[level].Indices;
+			ASSERT_EQ(0u, lodIndices.size() % 3);
+			EXPECT_LT(lodIndices.size(), previousIndexCount);
+			EXPECT_GE(lods[level].Error, previousError);
+			for (size_t t = 0; t < lodIndices.size(); t += 3)
+			{
+				for (size_t k = 0; k < 3; k++)
+				{
+					ASSERT_LT(lodIndices[t + k], vertices.size());
+				}
+				PositionKey a = GetPositionKey(vertices[lodIndices[t]]);
+				PositionKey b = GetPositionKey(vertices[lodIndices[t + 1]]);
+				PositionKey c = GetPositionKey(vertices[lodIndices[t + 2]]);
+				ASSERT_TRUE(a != b && b != c && a != c) << "triangle " << t / 3;
+			}
+			previousIndexCount = lodIndices.size();
+			previousError = lods[level].Error;
+		}
+	}
+
+	// Checks that no triangle takes its corners from both sides of a texture seam, which would
+	// stretch the texture across it.  Points at the poles have every U, so they are not compared.
+	void ExpectSeamKept(const vector<Vertex>& vertices, const vector<uint32_t>& indices, float largestUSpan)
+	{
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			float smallestU = INFINITY;
+			float largestU = -INFINITY;
+			for (size_t k = 0; k < 3; k++)
+			{
+				const Vertex& vertex = vertices[indices[t + k]];
+				if (fabsf(vertex.Position[1]) != 1.0f || vertex.Position[0] != 0.0f)
+				{
+					smallestU = min(smallestU, vertex.TexCoord[0]);
+					largestU = max(largestU, vertex.TexCoord[0]);
+				}
+			}
+			ASSERT_LE(largestU - smallestU, largestUSpan) << "triangle " << t / 3;
+		}
+	}
+}
+
+TEST(MeshSimplifier, SimplifiesAClosedSphereWithoutOpeningTheSeam)
+{
+	vector<Vertex> vertices;
+	vector<uint32_t> indices;
+	BuildSphere(24, 48, vertices, indices);
+	vector<MeshLod> lods;
+	BuildLodChain(vertices.data(), vertices.size(), sizeof(Vertex), indices, DefaultMeshSimplifierOptions(), lods);
+	ASSERT_GE(lods.size(), 3u);
+	ExpectValidChain(vertices, indices, lods);
+	EXPECT_GT(lods.back().Error, 0.0f);
+	for (const MeshLod& lod : lods)
+	{
+		// Closed, so every edge is still shared by exactly two triangles
+		for (const auto& edge : CountEdges(vertices, lod.Indices))
+		{
+			ASSERT_EQ(2, edge.second);
+		}
+		ExpectSeamKept(vertices, lod.Indices, 0.5f);
+	}
+}
+
+TEST(MeshSimplifier, KeepsTheBoundaryAndSeamOfAnOpenGrid)
+{
+	const size_t quadsAcross = 32;
+	const float farSide = static_cast<float>(quadsAcross);
+	vector<Vertex> vertices;
+	vector<uint32_t> indices;
+	BuildGrid(quadsAcross, vertices, indices);
+	vector<MeshLod> lods;
+	BuildLodChain(vertices.data(), vertices.size(), sizeof(Vertex), indices, DefaultMeshSimplifierOptions(), lods);
+	ASSERT_GE(lods.size(), 3u);
+	ExpectValidChain(vertices, indices, lods);
+	for (const MeshLod& lod : lods)
+	{
+		// The boundary edges all still run along a side of the square, so the outline and its
+		// corners are kept, and no holes open inside it
+		for (const auto& edge : CountEdges(vertices, lod.Indices))
+		{
+			ASSERT_LE(edge.second, 2);
+			if (edge.second == 1)
+			{
+				const float ax = get<0>(edge.first.first), az = get<2>(edge.first.first);
+				const float bx = get<0>(edge.first.second), bz = get<2>(edge.first.second);
+				const bool onSide = (ax == 0.0f && bx == 0.0f) || (ax == farSide && bx == farSide) ||
+									(az == 0.0f && bz == 0.0f) || (az == farSide && bz == farSide);
+				ASSERT_TRUE(onSide) << "(" << ax << ", " << az << ") to (" << bx << ", " << bz << ")";
+			}
+		}
+		// The two charts are ten apart in U, so a triangle that mixes them spans more than one
+		ExpectSeamKept(vertices, lod.Indices, 1.0f);
+	}
+}
+
+TEST(MeshSimplifier, NeverMovesPointsOnNonManifoldEdges)
+{
+	vector<Vertex> vertices;
+	vector<uint32_t> indices;
+	BuildGrid(16, vertices, indices);
+	// A fin standing up from an edge in the middle of the left half, so that three triangles
+	// share the edge
+	const uint32_t a = indices[(5 * 16 + 4) * 6];
+	const uint32_t b = indices[(5 * 16 + 4) * 6 + 1];
+	vertices.push_back(MakeVertex(vertices[a].Position[0], 3.0f, vertices[a].Position[2], 0.0f, 0.0f));
+	indices.insert(indices.end(), { a, b, static_cast<uint32_t>(vertices.size() - 1) });
+
+	vector<MeshLod> lods;
+	BuildLodChain(vertices.data(), vertices.size(), sizeof(Vertex), indices, DefaultMeshSimplifierOptions(), lods);
+	ASSERT_GE(lods.size(), 2u);
+	ExpectValidChain(vertices, indices, lods);
+	for (const MeshLod& lod : lods)
+	{
+		set<PositionKey> used;
+		for (uint32_t index : lod.Indices)
+		{
+			used.insert(GetPositionKey(vertices[index]));
+		}
+		EXPECT_EQ(1u, used.count(GetPositionKey(vertices[a])));
+		EXPECT_EQ(1u, used.count(GetPositionKey(vertices[b])));
+	}
+}
+
+TEST(MeshSimplifier, StopsAtTheErrorLimit)
+{
+	vector<Vertex> vertices;
+	vector<uint32_t> indices;
+	BuildSphere(24, 48, vertices, indices);
+	vector<uint32_t> result;
+	const float error = SimplifyMesh(vertices.data(), vertices.size(), sizeof(Vertex), indices, 0, 0.01f, result);
+	EXPECT_LE(error, 0.01f);
+	EXPECT_LT(result.size(), indices.size());
+	EXPECT_GT(result.size(), 0u);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include "RecordingRenderDevice.h"
+
+// Stand-ins for objects that are not created by the device
+static int VertexShader;
+static int InputLayout;
+
+TEST(RecordingRenderDevice, KeepsBufferContents)
+{
+	RecordingRenderDevice device;
+	const uint32_t initialData[2] = { 1, 2 };
+	RenderBuffer defaultBuffer = device.CreateBuffer({ sizeof(initialData), RenderConstantBufferBinding, RenderBufferDefault }, initialData);
+	EXPECT_EQ(0, memcmp(device.GetBufferData(defaultBuffer), initialData, sizeof(initialData)));
+
+	const uint32_t update[2] = { 3, 4 };
+	device.UpdateBuffer(defaultBuffer, update, sizeof(update));
+	EXPECT_EQ(0, memcmp(device.GetBufferData(defaultBuffer), update, sizeof(update)));
+
+	RenderBuffer dynamicBuffer = device.CreateBuffer({ 16, RenderVertexBufferBinding, RenderBufferDynamic }, nullptr);
+	uint8_t * mapped = static_cast<uint8_t *>(device.MapBuffer(dynamicBuffer, RenderMapDiscard));
+	mapped[15] = 42;
+	device.UnmapBuffer(dynamicBuffer, 16);
+	EXPECT_EQ(42, device.GetBufferData(dynamicBuffer)[15]);
+
+	EXPECT_EQ(sizeof(initialData) + 16, device.GetStatistics().BufferBytes);
+	EXPECT_EQ(sizeof(update) + 16, device.GetStatistics().BytesUploaded);
+	device.ReleaseBuffer(defaultBuffer);
+	device.ReleaseBuffer(dynamicBuffer);
+	EXPECT_EQ(0u, device.GetStatistics().BufferBytes);
+	EXPECT_EQ(nullptr, device.GetBufferData(dynamicBuffer));
+}
+
+TEST(RecordingRenderDevice, RejectsMisusedBuffers)
+{
+	RecordingRenderDevice device;
+	RenderBuffer defaultBuffer = device.CreateBuffer({ 16, RenderConstantBufferBinding, RenderBufferDefault }, nullptr);
+	RenderBuffer dynamicBuffer = device.CreateBuffer({ 16, RenderConstantBufferBinding, RenderBufferDynamic }, nullptr);
+	EXPECT_THROW(device.MapBuffer(defaultBuffer, RenderMapDiscard), logic_error);
+	EXPECT_THROW(device.UpdateBuffer(dynamicBuffer, "0123456789abcdef", 16), logic_error);
+	EXPECT_THROW(device.UpdateBuffer(defaultBuffer, "01234567", 8), logic_error);
+	EXPECT_THROW(device.UpdateBuffer(defaultBuffer, "0123456789abcdefg", 17), logic_error);
+	EXPECT_THROW(device.UnmapBuffer(dynamicBuffer, 0), logic_error);
+	device.MapBuffer(dynamicBuffer, RenderMapDiscard);
+	EXPECT_THROW(device.MapBuffer(dynamicBuffer, RenderMapNoOverwrite), logic_error);
+
+	RecordingRenderDevice device11(false);
+	EXPECT_FALSE(device11.SupportsConstantBufferOffsets());
+	EXPECT_THROW(device11.SetVertexConstantBufferRange(2, nullptr, 0, 16), logic_error);
+}
+
+TEST(RecordingRenderDevice, CompletesFencesOnceSignalled)
+{
+	RecordingRenderDevice device;
+	RenderFence fence = device.CreateFence();
+	EXPECT_FALSE(device.IsFenceComplete(fence));
+	device.SignalFence(fence);
+	EXPECT_TRUE(device.IsFenceComplete(fence));
+	device.ReleaseFence(fence);
+}
+
+TEST(RecordingRenderDevice, HoldsFencesBackUntilCompleted)
+{
+	RecordingRenderDevice device;
+	device.SetAutoCompleteFences(false);
+	RenderFence signalled = device.CreateFence();
+	RenderFence unsignalled = device.CreateFence();
+	device.SignalFence(signalled);
+	EXPECT_FALSE(device.IsFenceComplete(signalled));
+	device.CompleteFences();
+	EXPECT_TRUE(device.IsFenceComplete(signalled));
+	EXPECT_FALSE(device.IsFenceComplete(unsignalled));
+
+	// Signalling a fence again makes it wait for the next completion
+	device.SignalFence(signalled);
+	EXPECT_FALSE(device.IsFenceComplete(signalled));
+	device.ReleaseFence(signalled);
+	device.ReleaseFence(unsignalled);
+}
+
+TEST(RecordingRenderDevice, WritesEveryArgumentToTheLog)
+{
+	RecordingRenderDevice device;
+	RenderBuffer instanceBuffer = device.CreateBuffer({ 160, RenderVertexBufferBinding, RenderBufferDynamic }, nullptr);
+	device.SetVertexShader(&VertexShader);
+	device.SetInputLayout(&InputLayout);
+	device.SetVertexBuffer(1, instanceBuffer, 80);
+	device.SetPrimitiveTopology(RenderTriangleList);
+	device.DrawIndexedInstanced(36, 2, 6, -4, 7);
+	device.DrawIndexed(12, 3, 1);
+
+	ostringstream log;
+	device.WriteLog(log);
+	EXPECT_EQ("CreateBuffer #1 size=160 binding=0 usage=1\n"
+			  "SetVertexShader #2\n"
+			  "SetInputLayout #3\n"
+			  "SetVertexBuffer #1 slot=1 stride=80\n"
+			  "SetPrimitiveTopology topology=0\n"
+			  "DrawIndexedInstanced indices=36 instances=2 start=6 base=-4 startInstance=7\n"
+			  "DrawIndexed indices=12 start=3 base=1\n",
+			  log.str());
+
+	const RenderCommand& draw = device.GetCommands()[5];
+	EXPECT_EQ(DrawIndexedInstancedCommand, draw.Type);
+	EXPECT_EQ(7, draw.Arguments[4]);
+	EXPECT_EQ(36u * 2 + 12, device.GetStatistics().IndicesDrawn);
+	EXPECT_EQ(3u, device.GetStatistics().InstancesDrawn);
+	device.ReleaseBuffer(instanceBuffer);
+}
+
+TEST(RecordingRenderDevice, CountsWithoutRecording)
+{
+	RecordingRenderDevice device;
+	device.SetRecording(false);
+	device.SetVertexShader(&VertexShader);
+	device.DrawIndexed(3, 0, 0);
+	EXPECT_TRUE(device.GetCommands().empty());
+	EXPECT_EQ(1u, device.GetStatistics().CommandCounts[SetVertexShaderCommand]);
+	EXPECT_EQ(1u, device.GetStatistics().CommandCounts[DrawIndexedCommand]);
+
+	device.Clear();
+	EXPECT_EQ(0u, device.GetStatistics().CommandCounts[DrawIndexedCommand]);
+	EXPECT_STREQ("DrawIndexed", RecordingRenderDevice::GetCommandName(DrawIndexedCommand));
+}
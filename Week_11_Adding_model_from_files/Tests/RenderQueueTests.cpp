@@ -0,0 +1,302 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "RecordingRenderDevice.h"
+#include "RenderQueue.h"
+
+// Drives frames through the render queue and state cache into a recording device and checks
+// the commands that come out.  The shaders, layouts and geometry are stand-in pointers, since
+// the recording device never looks at them.
+
+namespace
+{
+	int VertexShader;
+	int InstancedVertexShader;
+	int PixelShader;
+	int InputLayout;
+	int InstancedInputLayout;
+	int RasteriserState;
+	int VertexBuffer;
+	int IndexBuffer;
+	int RedMaterial;
+	int GlassMaterial;
+
+	DrawPacket CubePacket(bool instanced)
+	{
+		DrawPacket packet = {};
+		packet.VertexShader = &VertexShader;
+		packet.PixelShader = &PixelShader;
+		packet.InputLayout = &InputLayout;
+		packet.RasteriserState = &RasteriserState;
+		packet.VertexBuffer = &VertexBuffer;
+		packet.VertexStride = 32;
+		packet.IndexBuffer = &IndexBuffer;
+		packet.IndexSize = 2;
+		packet.IndexCount = 36;
+		packet.MaterialConstantBuffer = &RedMaterial;
+		if (instanced)
+		{
+			packet.InstancedVertexShader = &InstancedVertexShader;
+			packet.InstancedInputLayout = &InstancedInputLayout;
+		}
+		return packet;
+	}
+
+	ObjectConstants ObjectAt(float z)
+	{
+		ObjectConstants objectConstants = {};
+		objectConstants.World = Matrix::CreateTranslation(0.0f, 0.0f, z);
+		return objectConstants;
+	}
+
+	// Three instanced cubes, a cube drawn on its own with another material and a transparent one
+	void SubmitScene(RenderQueue& queue)
+	{
+		FrameConstants frameConstants = {};
+		queue.Begin(frameConstants, Matrix(), 1.0f, 100.0f);
+		for (int i = 0; i < 3; i++)
+		{
+			queue.Submit(OpaquePass, CubePacket(true), ObjectAt(10.0f + i));
+		}
+		DrawPacket glass = CubePacket(false);
+		glass.MaterialConstantBuffer = &GlassMaterial;
+		queue.Submit(OpaquePass, glass, ObjectAt(20.0f));
+		queue.Submit(TransparentPass, glass, ObjectAt(30.0f));
+		queue.Sort();
+	}
+
+	string GetLog(const RecordingRenderDevice& device)
+	{
+		ostringstream log;
+		device.WriteLog(log);
+		return log.str();
+	}
+}
+
+TEST(RenderQueue, RecordsTheExpectedFrame)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	StateCache stateCache(device);
+	RenderQueue queue(device);
+
+	// Buffers 1 and 2 are the frame constants and the constant ring, created with the queue
+	device->Clear();
+	SubmitScene(queue);
+	queue.Execute(&stateCache);
+	EXPECT_EQ("CreateBuffer #3 size=5120 binding=0 usage=1\n"
+			  "MapBuffer #3 mode=0\n"
+			  "UnmapBuffer #3 bytes=240\n"
+			  "MapBuffer #2 mode=0\n"
+			  "UnmapBuffer #2 bytes=512\n"
+			  "UpdateBuffer #1 bytes=112\n"
+			  "SetVertexConstantBuffer #1 slot=0\n"
+			  "SetPixelConstantBuffer #1 slot=0\n"
+			  "SetVertexShader #4\n"
+			  "SetInputLayout #5\n"
+			  "SetVertexBuffer #3 slot=1 stride=80\n"
+			  "SetPixelShader #6\n"
+			  "SetPrimitiveTopology topology=0\n"
+			  "SetRasteriserState #7\n"
+			  "SetVertexBuffer #8 slot=0 stride=32\n"
+			  "SetIndexBuffer #9 indexsize=2\n"
+			  "SetPixelShaderResource #0 slot=0\n"
+			  "SetPixelConstantBuffer #10 slot=1\n"
+			  "DrawIndexedInstanced indices=36 instances=3 start=0 base=0 startInstance=0\n"
+			  "SetVertexShader #11\n"
+			  "SetInputLayout #12\n"
+			  "SetPixelConstantBuffer #13 slot=1\n"
+			  "SetVertexConstantBufferRange #2 slot=2 first=0 count=16\n"
+			  "DrawIndexed indices=36 start=0 base=0\n"
+			  "SetVertexConstantBufferRange #2 slot=2 first=16 count=16\n"
+			  "DrawIndexed indices=36 start=0 base=0\n"
+			  "SignalFence #14\n",
+			  GetLog(*device));
+
+	const RenderQueueStatistics& statistics = queue.GetStatistics();
+	EXPECT_EQ(5u, statistics.PacketCount);
+	EXPECT_EQ(3u, statistics.DrawCalls);
+	EXPECT_EQ(3u, statistics.InstancedPackets);
+
+	// The second frame only sets what differs from the end of the first one
+	device->Clear();
+	SubmitScene(queue);
+	queue.Execute(&stateCache);
+	EXPECT_EQ("MapBuffer #3 mode=0\n"
+			  "UnmapBuffer #3 bytes=240\n"
+			  "MapBuffer #2 mode=1\n"
+			  "UnmapBuffer #2 bytes=512\n"
+			  "UpdateBuffer #1 bytes=112\n"
+			  "SetVertexShader #4\n"
+			  "SetInputLayout #5\n"
+			  "SetPixelConstantBuffer #10 slot=1\n"
+			  "DrawIndexedInstanced indices=36 instances=3 start=0 base=0 startInstance=0\n"
+			  "SetVertexShader #11\n"
+			  "SetInputLayout #12\n"
+			  "SetPixelConstantBuffer #13 slot=1\n"
+			  "SetVertexConstantBufferRange #2 slot=2 first=32 count=16\n"
+			  "DrawIndexed indices=36 start=0 base=0\n"
+			  "SetVertexConstantBufferRange #2 slot=2 first=48 count=16\n"
+			  "DrawIndexed indices=36 start=0 base=0\n"
+			  "SignalFence #14\n",
+			  GetLog(*device));
+}
+
+TEST(RenderQueue, UploadsInstancesInDrawOrder)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	StateCache stateCache(device);
+	RenderQueue queue(device);
+	SubmitScene(queue);
+	queue.Execute(&stateCache);
+
+	// The instance buffer is the one bound to slot 1.  Opaque packets are drawn front to back.
+	const void * instanceBuffer = nullptr;
+	for (const RenderCommand& command : device->GetCommands())
+	{
+		if (command.Type == SetVertexBufferCommand && command.Arguments[0] == 1)
+		{
+			instanceBuffer = device->GetObject(command.Object);
+		}
+	}
+	ASSERT_NE(nullptr, instanceBuffer);
+	const ObjectConstants * instances = reinterpret_cast<const ObjectConstants *>(device->GetBufferData(const_cast<void *>(instanceBuffer)));
+	for (int i = 0; i < 3; i++)
+	{
+		EXPECT_EQ(10.0f + i, instances[i].World._43);
+	}
+
+	const RecordingStatistics& statistics = device->GetStatistics();
+	EXPECT_EQ(36u * 5, statistics.IndicesDrawn);
+	EXPECT_EQ(5u, statistics.InstancesDrawn);
+	EXPECT_EQ(1u, statistics.CommandCounts[DrawIndexedInstancedCommand]);
+	EXPECT_EQ(2u, statistics.CommandCounts[DrawIndexedCommand]);
+}
+
+TEST(RenderQueue, UpdatesOneConstantBufferWithoutOffsets)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>(false);
+	StateCache stateCache(device);
+	RenderQueue queue(device);
+	SubmitScene(queue);
+	queue.Execute(&stateCache);
+
+	const RecordingStatistics& statistics = device->GetStatistics();
+	EXPECT_EQ(0u, statistics.CommandCounts[SetVertexConstantBufferRangeCommand]);
+	EXPECT_EQ(0u, statistics.CommandCounts[SignalFenceCommand]);
+	// The frame constants, then the object constants of each draw that is not instanced
+	EXPECT_EQ(3u, statistics.CommandCounts[UpdateBufferCommand]);
+	EXPECT_EQ(sizeof(FrameConstants) + 2 * sizeof(ObjectConstants) + 3 * sizeof(ObjectConstants), statistics.BytesUploaded);
+}
+
+TEST(RenderQueue, ReleasesItsBuffers)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	{
+		StateCache stateCache(device);
+		RenderQueue queue(device);
+		SubmitScene(queue);
+		queue.Execute(&stateCache);
+		EXPECT_GT(device->GetStatistics().BufferBytes, 0u);
+	}
+	EXPECT_EQ(0u, device->GetStatistics().BufferBytes);
+}
+
+TEST(RenderQueue, IssuesSortKeyIdsEachFrame)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	RenderQueue queue(device);
+	FrameConstants frameConstants = {};
+	DrawPacket red = CubePacket(false);
+	DrawPacket glass = CubePacket(false);
+	glass.MaterialConstantBuffer = &GlassMaterial;
+
+	// With everything else equal, the materials are drawn in the order they were first seen in
+	// the frame, so the order follows the submissions if the ids start again every frame
+	for (int frame = 0; frame < 2; frame++)
+	{
+		// A new cache, so that the first material is bound even if it is still bound from before
+		StateCache stateCache(device);
+		device->Clear();
+		queue.Begin(frameConstants, Matrix(), 1.0f, 100.0f);
+		queue.Submit(OpaquePass, frame == 0 ? red : glass, ObjectAt(10.0f));
+		queue.Submit(OpaquePass, frame == 0 ? glass : red, ObjectAt(10.0f));
+		queue.Sort();
+		queue.Execute(&stateCache);
+
+		vector<const void *> materials;
+		for (const RenderCommand& command : device->GetCommands())
+		{
+			if (command.Type == SetPixelConstantBufferCommand && command.Arguments[0] == 1)
+			{
+				materials.push_back(device->GetObject(command.Object));
+			}
+		}
+		ASSERT_EQ(2u, materials.size());
+		EXPECT_EQ(frame == 0 ? &RedMaterial : &GlassMaterial, materials[0]) << "frame " << frame;
+		EXPECT_EQ(0u, queue.GetStatistics().SortKeyIdOverflows);
+	}
+}
+
+TEST(RenderQueue, CountsSortKeyIdOverflows)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	device->SetRecording(false);
+	StateCache stateCache(device);
+	RenderQueue queue(device);
+	FrameConstants frameConstants = {};
+
+	// Materials and textures have ids 1 to SortKeyIdMask - 1 to themselves, and everything after
+	// that shares SortKeyIdMask
+	const size_t materialCount = SortKeyIdMask + 10;
+	vector<int> materials(materialCount);
+	queue.Begin(frameConstants, Matrix(), 1.0f, 100.0f);
+	for (size_t i = 0; i < materialCount; i++)
+	{
+		DrawPacket packet = CubePacket(false);
+		packet.MaterialConstantBuffer = &materials[i];
+		queue.Submit(OpaquePass, packet, ObjectAt(10.0f));
+	}
+	queue.Sort();
+	queue.Execute(&stateCache);
+	EXPECT_EQ(11u, queue.GetStatistics().SortKeyIdOverflows);
+	EXPECT_EQ(materialCount, queue.GetStatistics().DrawCalls);
+
+	// The next frame starts again with fresh ids
+	SubmitScene(queue);
+	queue.Execute(&stateCache);
+	EXPECT_EQ(0u, queue.GetStatistics().SortKeyIdOverflows);
+}
+
+TEST(RenderQueue, InstancesMeshesThatAreInterleavedInDepth)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	StateCache stateCache(device);
+	RenderQueue queue(device);
+	FrameConstants frameConstants = {};
+
+	// Two meshes in the same buffers, alternating from front to back
+	queue.Begin(frameConstants, Matrix(), 1.0f, 100.0f);
+	for (int i = 0; i < 8; i++)
+	{
+		DrawPacket packet = CubePacket(true);
+		packet.StartIndex = (i % 2) * 36;
+		queue.Submit(OpaquePass, packet, ObjectAt(10.0f + i * 5.0f));
+	}
+	queue.Sort();
+	queue.Execute(&stateCache);
+
+	EXPECT_EQ(2u, queue.GetStatistics().DrawCalls);
+	EXPECT_EQ(8u, queue.GetStatistics().InstancedPackets);
+	vector<int64_t> startIndices;
+	for (const RenderCommand& command : device->GetCommands())
+	{
+		if (command.Type == DrawIndexedInstancedCommand)
+		{
+			EXPECT_EQ(4, command.Arguments[1]);
+			startIndices.push_back(command.Arguments[2]);
+		}
+	}
+	// Still front to back within each mesh
+	EXPECT_EQ(vector<int64_t>({ 0, 36 }), startIndices);
+}
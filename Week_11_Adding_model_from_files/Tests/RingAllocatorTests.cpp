@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "RingAllocator.h"
+
+TEST(RingAllocator, RoundsAllocationsUpToTheAlignment)
+{
+	RingAllocator allocator(1024, 256);
+	RingAllocation allocation;
+	ASSERT_TRUE(allocator.Allocate(1, allocation));
+	EXPECT_EQ(0u, allocation.Offset);
+	EXPECT_EQ(256u, allocation.Size);
+	ASSERT_TRUE(allocator.Allocate(300, allocation));
+	EXPECT_EQ(256u, allocation.Offset);
+	EXPECT_EQ(512u, allocation.Size);
+	EXPECT_EQ(RingMapNoOverwrite, allocation.MapMode);
+	EXPECT_EQ(768u, allocator.GetUsed());
+}
+
+TEST(RingAllocator, RejectsAllocationsLargerThanTheRing)
+{
+	RingAllocator allocator(1024, 256);
+	RingAllocation allocation;
+	ASSERT_TRUE(allocator.Allocate(256, allocation));
+	EXPECT_FALSE(allocator.Allocate(1025, allocation));
+	EXPECT_FALSE(allocator.Allocate(0, allocation));
+	EXPECT_EQ(256u, allocator.GetUsed());
+	EXPECT_EQ(0u, allocator.GetDiscardCount());
+}
+
+TEST(RingAllocator, RetiresFramesWhenTheirFencesComplete)
+{
+	RingAllocator allocator(1024, 256);
+	RingAllocation allocation;
+	allocator.Allocate(512, allocation);
+	allocator.EndFrame(1);
+	allocator.Allocate(256, allocation);
+	allocator.EndFrame(2);
+	EXPECT_EQ(2u, allocator.GetPendingFrameCount());
+
+	allocator.Retire(0);
+	EXPECT_EQ(768u, allocator.GetUsed());
+	allocator.Retire(1);
+	EXPECT_EQ(256u, allocator.GetUsed());
+	EXPECT_EQ(1u, allocator.GetPendingFrameCount());
+	// A later fence completing retires every frame before it
+	allocator.Allocate(256, allocation);
+	allocator.EndFrame(3);
+	allocator.Retire(3);
+	EXPECT_EQ(0u, allocator.GetUsed());
+	EXPECT_EQ(0u, allocator.GetPendingFrameCount());
+}
+
+TEST(RingAllocator, WrapsRoundAtTheEndOfTheRing)
+{
+	RingAllocator allocator(1024, 256);
+	RingAllocation allocation;
+	allocator.Allocate(512, allocation);
+	allocator.EndFrame(1);
+	allocator.Allocate(256, allocation);
+	EXPECT_EQ(512u, allocation.Offset);
+	allocator.EndFrame(2);
+	allocator.Retire(1);
+
+	// Only 256 bytes are left at the end, so the allocation goes to the start, which the first
+	// frame has finished with.  The skipped bytes stay in use until this frame is retired.
+	ASSERT_TRUE(allocator.Allocate(512, allocation));
+	EXPECT_EQ(0u, allocation.Offset);
+	EXPECT_EQ(RingMapNoOverwrite, allocation.MapMode);
+	EXPECT_EQ(1024u, allocator.GetUsed());
+	allocator.EndFrame(3);
+
+	allocator.Retire(2);
+	EXPECT_EQ(768u, allocator.GetUsed());
+	// The space between the new head and the tail is free
+	ASSERT_TRUE(allocator.Allocate(256, allocation));
+	EXPECT_EQ(512u, allocation.Offset);
+	EXPECT_EQ(RingMapNoOverwrite, allocation.MapMode);
+	allocator.EndFrame(4);
+	allocator.Retire(4);
+	EXPECT_EQ(0u, allocator.GetUsed());
+}
+
+TEST(RingAllocator, DiscardsWhenTheRingIsFull)
+{
+	RingAllocator allocator(1024, 256);
+	RingAllocation allocation;
+	allocator.Allocate(768, allocation);
+	allocator.EndFrame(1);
+	allocator.Allocate(256, allocation);
+	allocator.EndFrame(2);
+
+	// Nothing has been retired, so the ring is emptied and the frames still in flight are
+	// forgotten, since a discard leaves them in the old memory
+	ASSERT_TRUE(allocator.Allocate(512, allocation));
+	EXPECT_EQ(RingMapDiscard, allocation.MapMode);
+	EXPECT_EQ(0u, allocation.Offset);
+	EXPECT_EQ(1u, allocator.GetDiscardCount());
+	EXPECT_EQ(0u, allocator.GetPendingFrameCount());
+	EXPECT_EQ(512u, allocator.GetUsed());
+
+	// Space that is free but too small also discards
+	allocator.EndFrame(3);
+	allocator.Allocate(256, allocation);
+	ASSERT_TRUE(allocator.Allocate(512, allocation));
+	EXPECT_EQ(RingMapDiscard, allocation.MapMode);
+	EXPECT_EQ(2u, allocator.GetDiscardCount());
+}
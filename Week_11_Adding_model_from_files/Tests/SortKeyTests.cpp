@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "SortKey.h"
+
+TEST(SortKey, OrdersOpaqueDrawsByStateThenGeometryThenDepth)
+{
+	unsigned int nearDepth = QuantiseDepth(2.0f, 1.0f, 100.0f);
+	unsigned int farDepth = QuantiseDepth(90.0f, 1.0f, 100.0f);
+	EXPECT_LT(BuildSortKey(OpaquePass, 0, 1, 0, 0, farDepth), BuildSortKey(OpaquePass, 1, 1, 0, 0, nearDepth));
+	EXPECT_LT(BuildSortKey(OpaquePass, 0, 1, 0, 0, farDepth), BuildSortKey(OpaquePass, 0, 2, 0, 0, nearDepth));
+	EXPECT_LT(BuildSortKey(OpaquePass, 0, 1, 0, 0, farDepth), BuildSortKey(OpaquePass, 0, 1, 1, 0, nearDepth));
+	// Draws of one mesh stay together, however they are spread out in depth
+	EXPECT_LT(BuildSortKey(OpaquePass, 0, 1, 0, 0, farDepth), BuildSortKey(OpaquePass, 0, 1, 0, 1, nearDepth));
+	EXPECT_LT(BuildSortKey(OpaquePass, 0, 1, 0, 0, nearDepth), BuildSortKey(OpaquePass, 0, 1, 0, 0, farDepth));
+	EXPECT_LT(BuildSortKey(OpaquePass, SortKeyIdMask, SortKeyIdMask, SortKeyIdMask, SortKeyIdMask, SortKeyDepthMask), BuildSortKey(TransparentPass, 0, 0, 0, 0, 0));
+}
+
+TEST(SortKey, OrdersTransparentDrawsBackToFront)
+{
+	unsigned int nearDepth = QuantiseDepth(2.0f, 1.0f, 100.0f);
+	unsigned int farDepth = QuantiseDepth(90.0f, 1.0f, 100.0f);
+	EXPECT_LT(BuildSortKey(TransparentPass, 3, 3, 3, 0, farDepth), BuildSortKey(TransparentPass, 0, 0, 0, 0, nearDepth));
+	// The geometry plays no part
+	EXPECT_EQ(BuildSortKey(TransparentPass, 1, 2, 3, 0, nearDepth), BuildSortKey(TransparentPass, 1, 2, 3, 9, nearDepth));
+}
+
+TEST(SortKey, ClampsDepthToThePlanes)
+{
+	EXPECT_EQ(0u, QuantiseDepth(0.5f, 1.0f, 100.0f));
+	EXPECT_EQ(SortKeyDepthMask, QuantiseDepth(200.0f, 1.0f, 100.0f));
+	EXPECT_LT(QuantiseDepth(10.0f, 1.0f, 100.0f), QuantiseDepth(11.0f, 1.0f, 100.0f));
+}
+
+TEST(SortKey, RadixSortMatchesStableSort)
+{
+	uint64_t random = 42;
+	vector<RenderQueueEntry> entries(10000);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		random = random * 6364136223846793005ull + 1442695040888963407ull;
+		// Few distinct values in the upper bits, so that there are many equal keys
+		entries[i].SortKey = (random >> 8) & 0x00FF00000000FFFFull;
+		entries[i].PacketIndex = static_cast<uint32_t>(i);
+	}
+	vector<RenderQueueEntry> expected = entries;
+	stable_sort(expected.begin(), expected.end(), [](const RenderQueueEntry& first, const RenderQueueEntry& second)
+				{
+					return first.SortKey < second.SortKey;
+				});
+	vector<RenderQueueEntry> scratch;
+	RadixSort(entries, scratch);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		ASSERT_EQ(expected[i].SortKey, entries[i].SortKey) << "entry " << i;
+		ASSERT_EQ(expected[i].PacketIndex, entries[i].PacketIndex) << "entry " << i;
+	}
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include "RecordingRenderDevice.h"
+#include "StateCache.h"
+
+// Stand-ins for objects that are not created by the device
+static int VertexShader;
+static int OtherVertexShader;
+static int ConstantBuffer;
+
+TEST(StateCache, SkipsBindsThatMatchTheBoundState)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	StateCache stateCache(device);
+	stateCache.SetVertexShader(&VertexShader);
+	stateCache.SetVertexShader(&VertexShader);
+	stateCache.SetPrimitiveTopology(RenderTriangleList);
+	stateCache.SetPrimitiveTopology(RenderTriangleList);
+	stateCache.SetVertexShader(&OtherVertexShader);
+	stateCache.SetVertexShader(&VertexShader);
+
+	const RecordingStatistics& statistics = device->GetStatistics();
+	EXPECT_EQ(3u, statistics.CommandCounts[SetVertexShaderCommand]);
+	EXPECT_EQ(1u, statistics.CommandCounts[SetPrimitiveTopologyCommand]);
+	EXPECT_EQ(4u, stateCache.GetFilter().GetIssuedCount());
+	EXPECT_EQ(2u, stateCache.GetFilter().GetElidedCount());
+}
+
+TEST(StateCache, KeysOnTheParametersOfEachBind)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	StateCache stateCache(device);
+	RenderBuffer vertexBuffer = device->CreateBuffer({ 64, RenderVertexBufferBinding, RenderBufferDefault }, nullptr);
+	stateCache.SetVertexBuffer(vertexBuffer, 32);
+	stateCache.SetVertexBuffer(vertexBuffer, 16);
+	stateCache.SetVertexBuffer(vertexBuffer, 16);
+	// The instance stream is a separate slot from the vertices
+	stateCache.SetInstanceBuffer(vertexBuffer, 16);
+	stateCache.SetVertexConstantBuffer(1, &ConstantBuffer);
+	stateCache.SetVertexConstantBuffer(2, &ConstantBuffer);
+	stateCache.SetPixelConstantBuffer(1, &ConstantBuffer);
+
+	const RecordingStatistics& statistics = device->GetStatistics();
+	EXPECT_EQ(3u, statistics.CommandCounts[SetVertexBufferCommand]);
+	EXPECT_EQ(2u, statistics.CommandCounts[SetVertexConstantBufferCommand]);
+	EXPECT_EQ(1u, statistics.CommandCounts[SetPixelConstantBufferCommand]);
+	device->ReleaseBuffer(vertexBuffer);
+}
+
+TEST(StateCache, RebindsAfterInvalidating)
+{
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	StateCache stateCache(device);
+	stateCache.SetVertexShader(&VertexShader);
+	stateCache.SetPixelConstantBuffer(0, &ConstantBuffer);
+
+	// As after something else has changed the device state, such as ClearState or a new frame
+	stateCache.Invalidate();
+	stateCache.SetVertexShader(&VertexShader);
+	stateCache.SetPixelConstantBuffer(0, &ConstantBuffer);
+	stateCache.SetPixelConstantBuffer(0, &ConstantBuffer);
+
+	const RecordingStatistics& statistics = device->GetStatistics();
+	EXPECT_EQ(2u, statistics.CommandCounts[SetVertexShaderCommand]);
+	EXPECT_EQ(2u, statistics.CommandCounts[SetPixelConstantBufferCommand]);
+	EXPECT_EQ(1u, stateCache.GetFilter().GetElidedCount());
+}
+
+TEST(StateCache, TellsWholeConstantBuffersFromRanges)
+{
+	// The plain and ranged binds of a constant buffer register share a slot in the filter, so
+	// switching between them, or between ranges, must not be skipped
+	shared_ptr<RecordingRenderDevice> device = make_shared<RecordingRenderDevice>();
+	StateCache stateCache(device);
+	RenderBuffer ring = device->CreateBuffer({ 4096, RenderConstantBufferBinding, RenderBufferDynamic }, nullptr);
+	stateCache.SetVertexConstantBuffer(2, ring);
+	stateCache.SetVertexConstantBuffer(2, ring, 0, 16);
+	stateCache.SetVertexConstantBuffer(2, ring, 0, 16);
+	stateCache.SetVertexConstantBuffer(2, ring, 0, 32);
+	stateCache.SetVertexConstantBuffer(2, ring, 16, 16);
+	stateCache.SetVertexConstantBuffer(2, ring);
+	stateCache.SetVertexConstantBuffer(2, ring);
+
+	const RecordingStatistics& statistics = device->GetStatistics();
+	EXPECT_EQ(2u, statistics.CommandCounts[SetVertexConstantBufferCommand]);
+	EXPECT_EQ(3u, statistics.CommandCounts[SetVertexConstantBufferRangeCommand]);
+	EXPECT_EQ(2u, stateCache.GetFilter().GetElidedCount());
+	device->ReleaseBuffer(ring);
+}
@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "TextureDecoder.h"
+
+namespace
+{
+	void WriteUInt16(vector<uint8_t>& data, size_t offset, uint16_t value)
+	{
+		data[offset] = static_cast<uint8_t>(value);
+		data[offset + 1] = static_cast<uint8_t>(value >> 8);
+	}
+
+	void WriteUInt32(vector<uint8_t>& data, size_t offset, uint32_t value)
+	{
+		for (size_t i = 0; i < 4; i++)
+		{
+			data[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+		}
+	}
+
+	// Builds a bitmap file.  The masks are written straight after the first 40 bytes of the info
+	// header, which is inside a larger header or after a 40 byte one.  The palette entries are
+	// BGRX values after the header and masks.  Each row is the bytes of one row without its padding,
+	// in the order they are stored.
+	struct BitmapDescription
+	{
+		int32_t					Width;
+		int32_t					Height;
+		uint16_t				BitCount;
+		uint32_t				Compression;
+		uint32_t				HeaderSize;
+		uint32_t				ColoursUsed;
+		vector<uint32_t>		Masks;
+		vector<uint32_t>		Palette;
+		vector<vector<uint8_t>>	Rows;
+	};
+
+	vector<uint8_t> BuildBitmap(const BitmapDescription& description)
+	{
+		const size_t headerEnd = 14 + max<size_t>(description.HeaderSize, 40 + description.Masks.size() * 4);
+		const size_t pixelOffset = headerEnd + description.Palette.size() * 4;
+		const size_t rowPitch = ((static_cast<size_t>(description.Width) * description.BitCount + 31) / 32) * 4;
+		vector<uint8_t> data(pixelOffset + rowPitch * description.Rows.size(), 0);
+		data[0] = 'B';
+		data[1] = 'M';
+		WriteUInt32(data, 2, static_cast<uint32_t>(data.size()));
+		WriteUInt32(data, 10, static_cast<uint32_t>(pixelOffset));
+		WriteUInt32(data, 14, description.HeaderSize);
+		WriteUInt32(data, 18, static_cast<uint32_t>(description.Width));
+		WriteUInt32(data, 22, static_cast<uint32_t>(description.Height));
+		WriteUInt16(data, 26, 1);
+		WriteUInt16(data, 28, description.BitCount);
+		WriteUInt32(data, 30, description.Compression);
+		WriteUInt32(data, 46, description.ColoursUsed);
+		for (size_t i = 0; i < description.Masks.size(); i++)
+		{
+			WriteUInt32(data, 14 + 40 + i * 4, description.Masks[i]);
+		}
+		for (size_t i = 0; i < description.Palette.size(); i++)
+		{
+			WriteUInt32(data, headerEnd + i * 4, description.Palette[i]);
+		}
+		for (size_t i = 0; i < description.Rows.size(); i++)
+		{
+			copy(description.Rows[i].begin(), description.Rows[i].end(), data.begin() + pixelOffset + rowPitch * i);
+		}
+		return data;
+	}
+
+	bool Decode(const vector<uint8_t>& data, DecodedTexture& texture)
+	{
+		return DecodeImage(data.data(), data.size(), texture);
+	}
+
+	// The RGBA pixels of a decoded row, as 0xRRGGBBAA values
+	vector<uint32_t> GetRow(const DecodedTexture& texture, uint32_t y)
+	{
+		vector<uint32_t> row(texture.Width);
+		for (uint32_t x = 0; x < texture.Width; x++)
+		{
+			const uint8_t * pixel = &texture.Pixels[(static_cast<size_t>(y) * texture.Width + x) * 4];
+			row[x] = (static_cast<uint32_t>(pixel[0]) << 24) | (pixel[1] << 16) | (pixel[2] << 8) | pixel[3];
+		}
+		return row;
+	}
+
+	const uint32_t BitmapRGB = 0;
+	const uint32_t BitmapRLE8 = 1;
+	const uint32_t BitmapBitFields = 3;
+
+	// A palette of black, red, green and blue, as BGRX
+	const vector<uint32_t> FourColours = { 0x00000000, 0x00FF0000, 0x0000FF00, 0x000000FF };
+
+	vector<uint8_t> ReadFile(const string& fileName)
+	{
+		ifstream file(string(SOURCE_DIRECTORY) + "/" + fileName, ios::binary);
+		return vector<uint8_t>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+	}
+}
+
+TEST(TextureDecoder, Decodes24BitRowsBottomUp)
+{
+	// Three pixels, so each row has three bytes of padding
+	vector<uint8_t> data = BuildBitmap({ 3, 2, 24, BitmapRGB, 40, 0, {}, {},
+										 { { 0, 0, 255, 0, 255, 0, 255, 0, 0 },
+										   { 1, 2, 3, 4, 5, 6, 7, 8, 9 } } });
+	DecodedTexture texture;
+	ASSERT_TRUE(CanDecodeImage(data.data(), data.size()));
+	ASSERT_TRUE(Decode(data, texture));
+	EXPECT_EQ(3u, texture.Width);
+	EXPECT_EQ(2u, texture.Height);
+	EXPECT_EQ(vector<uint32_t>({ 0x030201FF, 0x060504FF, 0x090807FF }), GetRow(texture, 0));
+	EXPECT_EQ(vector<uint32_t>({ 0xFF0000FF, 0x00FF00FF, 0x0000FFFF }), GetRow(texture, 1));
+}
+
+TEST(TextureDecoder, DecodesRowsTopDownWhenTheHeightIsNegative)
+{
+	vector<uint8_t> data = BuildBitmap({ 3, -2, 24, BitmapRGB, 40, 0, {}, {},
+										 { { 0, 0, 255, 0, 255, 0, 255, 0, 0 },
+										   { 1, 2, 3, 4, 5, 6, 7, 8, 9 } } });
+	DecodedTexture texture;
+	ASSERT_TRUE(Decode(data, texture));
+	EXPECT_EQ(2u, texture.Height);
+	EXPECT_EQ(vector<uint32_t>({ 0xFF0000FF, 0x00FF00FF, 0x0000FFFF }), GetRow(texture, 0));
+	EXPECT_EQ(vector<uint32_t>({ 0x030201FF, 0x060504FF, 0x090807FF }), GetRow(texture, 1));
+}
+
+TEST(TextureDecoder, DecodesPalettisedImages)
+{
+	const uint32_t black = 0x000000FF, red = 0xFF0000FF, green = 0x00FF00FF, blue = 0x0000FFFF;
+	DecodedTexture texture;
+
+	// Nine pixels, so the last byte of each row is only partly used
+	vector<uint8_t> oneBit = BuildBitmap({ 9, 1, 1, BitmapRGB, 40, 2, {}, { FourColours[0], FourColours[1] }, { { 0xA5, 0x80 } } });
+	ASSERT_TRUE(Decode(oneBit, texture));
+	EXPECT_EQ(vector<uint32_t>({ red, black, red, black, black, red, black, red, red }), GetRow(texture, 0));
+
+	vector<uint8_t> fourBit = BuildBitmap({ 3, 1, 4, BitmapRGB, 40, 4, {}, FourColours, { { 0x12, 0x30 } } });
+	ASSERT_TRUE(Decode(fourBit, texture));
+	EXPECT_EQ(vector<uint32_t>({ red, green, blue }), GetRow(texture, 0));
+
+	// With no colours used given, the palette is the full 256 entries
+	vector<uint32_t> fullPalette(256, 0x00FFFFFF);
+	copy(FourColours.begin(), FourColours.end(), fullPalette.begin());
+	vector<uint8_t> eightBit = BuildBitmap({ 5, 1, 8, BitmapRGB, 40, 0, {}, fullPalette, { { 3, 2, 1, 0, 200 } } });
+	ASSERT_TRUE(Decode(eightBit, texture));
+	EXPECT_EQ(vector<uint32_t>({ blue, green, red, black, 0xFFFFFFFF }), GetRow(texture, 0));
+}
+
+TEST(TextureDecoder, Decodes16And32BitDefaultFormats)
+{
+	DecodedTexture texture;
+
+	// 5 bits each of red, green and blue, scaled to 8 bits with rounding
+	vector<uint8_t> sixteenBit = BuildBitmap({ 2, 1, 16, BitmapRGB, 40, 0, {}, {}, { { 0x00, 0x7C, 0x10, 0x42 } } });
+	ASSERT_TRUE(Decode(sixteenBit, texture));
+	EXPECT_EQ(vector<uint32_t>({ 0xFF0000FF, 0x848484FF }), GetRow(texture, 0));
+
+	// The fourth byte is not alpha
+	vector<uint8_t> thirtyTwoBit = BuildBitmap({ 1, 1, 32, BitmapRGB, 40, 0, {}, {}, { { 0x30, 0x20, 0x10, 0x00 } } });
+	ASSERT_TRUE(Decode(thirtyTwoBit, texture));
+	EXPECT_EQ(vector<uint32_t>({ 0x102030FF }), GetRow(texture, 0));
+}
+
+TEST(TextureDecoder, DecodesBitFieldMasks)
+{
+	DecodedTexture texture;
+
+	// 5-6-5, with the masks after a 40 byte header
+	vector<uint8_t> rgb565 = BuildBitmap({ 2, 1, 16, BitmapBitFields, 40, 0, { 0xF800, 0x07E0, 0x001F }, {}, { { 0xE0, 0x07, 0x1F, 0xF8 } } });
+	ASSERT_TRUE(Decode(rgb565, texture));
+	EXPECT_EQ(vector<uint32_t>({ 0x00FF00FF, 0xFF00FFFF }), GetRow(texture, 0));
+
+	// Alpha in the top byte, with the masks inside a 56 byte header
+	vector<uint8_t> argb = BuildBitmap({ 1, 1, 32, BitmapBitFields, 56, 0, { 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 }, {}, { { 0x30, 0x20, 0x10, 0x80 } } });
+	ASSERT_TRUE(Decode(argb, texture));
+	EXPECT_EQ(vector<uint32_t>({ 0x10203080 }), GetRow(texture, 0));
+
+	// A mask of all 32 bits must not overflow when it is scaled to 8 bits
+	vector<uint8_t> wide = BuildBitmap({ 2, 1, 32, BitmapBitFields, 40, 0, { 0xFFFFFFFF, 0, 0 }, {},
+										 { { 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x80 } } });
+	ASSERT_TRUE(Decode(wide, texture));
+	EXPECT_EQ(vector<uint32_t>({ 0xFF0000FF, 0x800000FF }), GetRow(texture, 0));
+}
+
+TEST(TextureDecoder, RejectsMalformedImages)
+{
+	DecodedTexture texture;
+	vector<uint8_t> valid = BuildBitmap({ 3, 2, 24, BitmapRGB, 40, 0, {}, {}, { vector<uint8_t>(9, 1), vector<uint8_t>(9, 2) } });
+	ASSERT_TRUE(Decode(valid, texture));
+
+	// Truncated in the pixels and in the header
+	EXPECT_FALSE(DecodeImage(valid.data(), valid.size() - 1, texture));
+	EXPECT_FALSE(DecodeImage(valid.data(), 14 + 39, texture));
+	EXPECT_FALSE(CanDecodeImage(valid.data(), 1));
+
+	// A palette index past the colours used, and more colours than the bit count allows
+	vector<uint8_t> outOfRange = BuildBitmap({ 4, 1, 8, BitmapRGB, 40, 4, {}, FourColours, { { 0, 1, 2, 4 } } });
+	EXPECT_FALSE(Decode(outOfRange, texture));
+	vector<uint8_t> tooManyColours = BuildBitmap({ 4, 1, 1, BitmapRGB, 40, 3, {}, { 0, 0, 0 }, { { 0 } } });
+	EXPECT_FALSE(Decode(tooManyColours, texture));
+	vector<uint8_t> truncatedPalette = BuildBitmap({ 4, 1, 8, BitmapRGB, 40, 4, {}, FourColours, { { 0, 1, 2, 3 } } });
+	truncatedPalette.resize(14 + 40 + 3 * 4);
+	EXPECT_FALSE(Decode(truncatedPalette, texture));
+
+	// Run length encoding is left to WIC, as are sizes that no texture can have
+	vector<uint8_t> runLength = BuildBitmap({ 4, 1, 8, BitmapRLE8, 40, 4, {}, FourColours, { { 0, 1, 2, 3 } } });
+	EXPECT_FALSE(Decode(runLength, texture));
+	EXPECT_FALSE(Decode(BuildBitmap({ 0, 1, 24, BitmapRGB, 40, 0, {}, {}, { {} } }), texture));
+	EXPECT_FALSE(Decode(BuildBitmap({ 16385, 1, 1, BitmapRGB, 40, 2, {}, { 0, 0 }, { {} } }), texture));
+	vector<uint8_t> notBitmap = valid;
+	notBitmap[0] = 'P';
+	EXPECT_FALSE(Decode(notBitmap, texture));
+}
+
+TEST(TextureDecoder, DecodesTheProjectBitmaps)
+{
+	// Each pixel is checked against the bytes of the file, read directly.  The widths are all
+	// multiples of four, so the rows have no padding.
+	for (const char * fileName : { "woodbox.bmp", "bihull.bmp", "wings.bmp" })
+	{
+		SCOPED_TRACE(fileName);
+		vector<uint8_t> data = ReadFile(fileName);
+		ASSERT_GT(data.size(), 54u);
+		DecodedTexture texture;
+		ASSERT_TRUE(Decode(data, texture));
+		const uint32_t pixelOffset = data[10] | (data[11] << 8) | (data[12] << 16);
+		const uint32_t bitCount = data[28];
+		const uint8_t * palette = &data[14 + 40];
+		for (uint32_t y = 0; y < texture.Height; y++)
+		{
+			for (uint32_t x = 0; x < texture.Width; x++)
+			{
+				const size_t source = pixelOffset + (static_cast<size_t>(texture.Height - 1 - y) * texture.Width + x) * (bitCount / 8);
+				const uint8_t * bgr = bitCount == 8 ? palette + data[source] * 4 : &data[source];
+				const uint8_t * rgba = &texture.Pixels[(static_cast<size_t>(y) * texture.Width + x) * 4];
+				ASSERT_TRUE(rgba[0] == bgr[2] && rgba[1] == bgr[1] && rgba[2] == bgr[0] && rgba[3] == 255) << x << ", " << y;
+			}
+		}
+	}
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "TransformStore.h"
+#include "WorkerPool.h"
+
+namespace
+{
+	// A forest of random trees, with a new root every thousand nodes, and a rotation and
+	// translation on every node
+	void BuildGraph(TransformStore& store, size_t nodeCount, vector<TransformHandle>& handles)
+	{
+		uint32_t random = 12345;
+		handles.clear();
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			random = random * 1664525 + 1013904223;
+			TransformHandle handle = store.Allocate();
+			size_t groupStart = i - i % 1000;
+			if (i != groupStart)
+			{
+				store.SetParent(handle, handles[groupStart + random % (i - groupStart)]);
+			}
+			float angle = static_cast<float>(random % 628) / 100.0f;
+			store.SetLocalTransform(handle, Matrix::CreateRotationY(angle) * Matrix::CreateTranslation(static_cast<float>(random % 7), 1.0f, 0.5f));
+			handles.push_back(handle);
+		}
+	}
+
+	bool SameWorldTransforms(const TransformStore& first, const TransformStore& second, const vector<TransformHandle>& handles)
+	{
+		for (TransformHandle handle : handles)
+		{
+			if (memcmp(&first.GetWorldTransform(handle), &second.GetWorldTransform(handle), sizeof(Matrix)) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST(TransformStore, WorldIsLocalTimesParentWorld)
+{
+	TransformStore store;
+	vector<TransformHandle> handles;
+	BuildGraph(store, 3000, handles);
+	store.Update();
+	for (TransformHandle handle : handles)
+	{
+		TransformHandle parent = store.GetParent(handle);
+		Matrix expected = store.GetLocalTransform(handle);
+		if (parent != InvalidTransformHandle)
+		{
+			expected = expected * store.GetWorldTransform(parent);
+		}
+		ASSERT_EQ(0, memcmp(&expected, &store.GetWorldTransform(handle), sizeof(Matrix))) << "handle " << handle;
+	}
+}
+
+TEST(TransformStore, ParallelUpdateMatchesSerialUpdate)
+{
+	WorkerPool workerPool(3);
+	TransformStore serialStore;
+	TransformStore parallelStore;
+	// Small subtrees, so that the trees are split across the workers at several levels
+	parallelStore.SetMinimumParallelSubtreeSize(64);
+	vector<TransformHandle> handles;
+	BuildGraph(serialStore, 100000, handles);
+	BuildGraph(parallelStore, 100000, handles);
+	serialStore.Update();
+	parallelStore.Update(&workerPool);
+	EXPECT_EQ(serialStore.GetUpdatedCount(), parallelStore.GetUpdatedCount());
+	EXPECT_TRUE(SameWorldTransforms(serialStore, parallelStore, handles));
+
+	// Move a node near the top of every tenth tree, so only those subtrees are updated
+	for (size_t i = 0; i < handles.size(); i += 10000)
+	{
+		Matrix moved = Matrix::CreateTranslation(0.0f, 2.0f, 0.0f) * serialStore.GetLocalTransform(handles[i + 1]);
+		serialStore.SetLocalTransform(handles[i + 1], moved);
+		parallelStore.SetLocalTransform(handles[i + 1], moved);
+	}
+	serialStore.Update();
+	parallelStore.Update(&workerPool);
+	EXPECT_LT(serialStore.GetUpdatedCount(), handles.size());
+	EXPECT_EQ(serialStore.GetUpdatedCount(), parallelStore.GetUpdatedCount());
+	EXPECT_TRUE(SameWorldTransforms(serialStore, parallelStore, handles));
+}
+
+TEST(TransformStore, ParallelUpdateHandlesDeepChainsAndWideNodes)
+{
+	WorkerPool workerPool(3);
+	TransformStore serialStore;
+	TransformStore parallelStore;
+	parallelStore.SetMinimumParallelSubtreeSize(64);
+	vector<TransformHandle> handles;
+	for (TransformStore * store : { &serialStore, &parallelStore })
+	{
+		// A chain far deeper than the call stack could follow, with a short branch off every
+		// fiftieth node, followed by a root with thousands of leaf children
+		handles.clear();
+		TransformHandle previous = InvalidTransformHandle;
+		for (size_t i = 0; i < 100000; i++)
+		{
+			TransformHandle handle = store->Allocate();
+			store->SetParent(handle, previous);
+			store->SetLocalTransform(handle, Matrix::CreateRotationY(0.001f) * Matrix::CreateTranslation(0.0f, 0.01f, 0.0f));
+			handles.push_back(handle);
+			if (i % 50 == 0)
+			{
+				TransformHandle branch = store->Allocate();
+				store->SetParent(branch, handle);
+				store->SetLocalTransform(branch, Matrix::CreateTranslation(1.0f, 0.0f, 0.0f));
+				handles.push_back(branch);
+			}
+			previous = handle;
+		}
+		TransformHandle root = store->Allocate();
+		store->SetLocalTransform(root, Matrix::CreateTranslation(0.0f, 0.0f, 5.0f));
+		handles.push_back(root);
+		for (size_t i = 0; i < 5000; i++)
+		{
+			TransformHandle leaf = store->Allocate();
+			store->SetParent(leaf, root);
+			store->SetLocalTransform(leaf, Matrix::CreateTranslation(static_cast<float>(i), 0.0f, 0.0f));
+			handles.push_back(leaf);
+		}
+	}
+	serialStore.Update();
+	parallelStore.Update(&workerPool);
+	EXPECT_EQ(handles.size(), parallelStore.GetUpdatedCount());
+	EXPECT_TRUE(SameWorldTransforms(serialStore, parallelStore, handles));
+}
+
+TEST(TransformStore, ReleasedChildrenBecomeRoots)
+{
+	TransformStore store;
+	TransformHandle root = store.Allocate();
+	TransformHandle child = store.Allocate();
+	TransformHandle grandchild = store.Allocate();
+	store.SetParent(child, root);
+	store.SetParent(grandchild, child);
+	store.SetLocalTransform(root, Matrix::CreateTranslation(1.0f, 0.0f, 0.0f));
+	store.SetLocalTransform(grandchild, Matrix::CreateTranslation(0.0f, 1.0f, 0.0f));
+	store.Update();
+	EXPECT_EQ(1.0f, store.GetWorldTransform(grandchild)._41);
+
+	store.Release(child);
+	store.Update();
+	EXPECT_EQ(InvalidTransformHandle, store.GetParent(grandchild));
+	EXPECT_EQ(0.0f, store.GetWorldTransform(grandchild)._41);
+	EXPECT_EQ(1.0f, store.GetWorldTransform(grandchild)._42);
+	EXPECT_EQ(2u, store.GetCount());
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "GeometricObject.h"
+#include "WorkerPool.h"
+
+namespace
+{
+	struct TexturedVertex
+	{
+		Vector3		Position;
+		Vector3		Normal;
+		float		TexCoord[2];
+	};
+
+	const VertexNormalLayout TexturedLayout = { sizeof(TexturedVertex), offsetof(TexturedVertex, Normal), offsetof(TexturedVertex, TexCoord) };
+
+	// A bumpy grid of quads, so that the triangles have different areas, with its triangles in a
+	// shuffled order so that the corners of each vertex are found in different blocks of work.
+	// The last vertex is not used by any triangle.
+	void BuildTerrain(size_t quadsAcross, vector<TexturedVertex>& vertices, vector<uint32_t>& indices)
+	{
+		uint32_t random = 12345;
+		const size_t verticesAcross = quadsAcross + 1;
+		vertices.resize(verticesAcross * verticesAcross + 1);
+		for (size_t z = 0; z < verticesAcross; z++)
+		{
+			for (size_t x = 0; x < verticesAcross; x++)
+			{
+				random = random * 1664525 + 1013904223;
+				TexturedVertex& vertex = vertices[z * verticesAcross + x];
+				vertex.Position = Vector3(static_cast<float>(x), static_cast<float>(random % 1000) / 250.0f, static_cast<float>(z));
+				vertex.TexCoord[0] = static_cast<float>(x) / quadsAcross;
+				vertex.TexCoord[1] = static_cast<float>(z) / quadsAcross;
+			}
+		}
+		vertices.back().Normal = Vector3(7.0f, 7.0f, 7.0f);
+
+		vector<uint32_t> quads(quadsAcross * quadsAcross);
+		for (size_t i = 0; i < quads.size(); i++)
+		{
+			quads[i] = static_cast<uint32_t>(i);
+		}
+		for (size_t i = quads.size() - 1; i > 0; i--)
+		{
+			random = random * 1664525 + 1013904223;
+			swap(quads[i], quads[random % (i + 1)]);
+		}
+		indices.clear();
+		for (uint32_t quad : quads)
+		{
+			const uint32_t corner = static_cast<uint32_t>(quad / quadsAcross * verticesAcross + quad % quadsAcross);
+			const uint32_t across = static_cast<uint32_t>(verticesAcross);
+			indices.insert(indices.end(), { corner, corner + across, corner + 1, corner + 1, corner + across, corner + across + 1 });
+		}
+	}
+
+	// The averaging that CubeNode used to do: the cross product of each polygon is added to its
+	// corners, and each sum is divided by the number of polygons before being normalised
+	template<typename Vertex> vector<Vector3> AverageNormals(const vector<Vertex>& vertices, const vector<uint32_t>& indices)
+	{
+		vector<Vector3> normals(vertices.size());
+		vector<int> contributingCounts(vertices.size(), 0);
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const Vector3 u = vertices[indices[i + 1]].Position - vertices[indices[i]].Position;
+			const Vector3 v = vertices[indices[i + 2]].Position - vertices[indices[i]].Position;
+			const Vector3 polygonNormal = u.Cross(v);
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				normals[indices[i + corner]] += polygonNormal;
+				contributingCounts[indices[i + corner]]++;
+			}
+		}
+		for (size_t i = 0; i < normals.size(); i++)
+		{
+			if (contributingCounts[i] > 0)
+			{
+				normals[i] /= static_cast<float>(contributingCounts[i]);
+				normals[i].Normalize();
+			}
+		}
+		return normals;
+	}
+
+	template<typename Vertex> void ExpectNormalsNear(const vector<Vector3>& expected, const vector<Vertex>& vertices, size_t usedCount)
+	{
+		for (size_t i = 0; i < usedCount; i++)
+		{
+			ASSERT_NEAR(expected[i].x, vertices[i].Normal.x, 1e-5f) << "vertex " << i;
+			ASSERT_NEAR(expected[i].y, vertices[i].Normal.y, 1e-5f) << "vertex " << i;
+			ASSERT_NEAR(expected[i].z, vertices[i].Normal.z, 1e-5f) << "vertex " << i;
+		}
+	}
+}
+
+TEST(VertexNormals, AreaWeightingMatchesTheAverageOfThePolygons)
+{
+	vector<ObjectVertexStruct> vertices;
+	vector<uint32_t> indices;
+	ComputeSphere(vertices, indices, 2.0f, 32);
+	ComputeVertexNormals(vertices, indices);
+	ExpectNormalsNear(AverageNormals(vertices, indices), vertices, vertices.size());
+
+	ComputeCylinder(vertices, indices, 3.0f, 1.5f, 17);
+	ComputeVertexNormals(vertices, indices);
+	ExpectNormalsNear(AverageNormals(vertices, indices), vertices, vertices.size());
+
+	vector<TexturedVertex> terrain;
+	BuildTerrain(64, terrain, indices);
+	GenerateVertexNormals(terrain.data(), terrain.size(), TexturedLayout, indices.data(), indices.size(), NormalWeightingArea);
+	ExpectNormalsNear(AverageNormals(terrain, indices), terrain, terrain.size() - 1);
+	EXPECT_EQ(7.0f, terrain.back().Normal.x);
+}
+
+TEST(VertexNormals, WorkersGiveExactlyTheSameResult)
+{
+	// Enough triangles for many blocks of work on each pass
+	vector<TexturedVertex> serialVertices;
+	vector<uint32_t> indices;
+	BuildTerrain(400, serialVertices, indices);
+	ASSERT_GT(indices.size() / 3, 16u * 16384u);
+	vector<TexturedVertex> parallelVertices = serialVertices;
+	WorkerPool workerPool(3);
+
+	for (NormalWeighting weighting : { NormalWeightingArea, NormalWeightingAngle })
+	{
+		SCOPED_TRACE(weighting);
+		vector<Vector4> serialTangents(serialVertices.size());
+		vector<Vector4> parallelTangents(serialVertices.size());
+		GenerateVertexNormals(serialVertices.data(), serialVertices.size(), TexturedLayout, indices.data(), indices.size(), weighting, serialTangents.data());
+		GenerateVertexNormals(parallelVertices.data(), parallelVertices.size(), TexturedLayout, indices.data(), indices.size(), weighting, parallelTangents.data(), &workerPool);
+		EXPECT_EQ(0, memcmp(serialVertices.data(), parallelVertices.data(), sizeof(TexturedVertex) * serialVertices.size()));
+		EXPECT_EQ(0, memcmp(serialTangents.data(), parallelTangents.data(), sizeof(Vector4) * serialTangents.size()));
+		EXPECT_EQ(7.0f, parallelVertices.back().Normal.x);
+	}
+}
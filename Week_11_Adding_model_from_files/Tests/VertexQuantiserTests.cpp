@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "VertexQuantiser.h"
+
+using namespace std;
+
+namespace
+{
+	// Laid out as the quantiser reads vertices: position, normal and texture coordinate
+	struct TestVertex
+	{
+		float				Position[3];
+		float				Normal[3];
+		float				TexCoord[2];
+	};
+
+	const float Centre[3] = { 10.0f, -2.0f, 0.5f };
+	const float Extents[3] = { 40.0f, 3.0f, 12.0f };
+
+	float NormalError(const float normal[3])
+	{
+		float length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		QuantisationBounds bounds = MakeQuantisationBounds(Centre, Extents);
+		float position[3] = { Centre[0], Centre[1], Centre[2] };
+		float texCoord[2] = { 0.0f, 0.0f };
+		QuantisedVertex vertex;
+		QuantiseVertex(position, normal, texCoord, bounds, vertex);
+		float decoded[3];
+		DequantiseVertex(vertex, bounds, position, decoded, texCoord);
+		float dx = decoded[0] - normal[0] / length;
+		float dy = decoded[1] - normal[1] / length;
+		float dz = decoded[2] - normal[2] / length;
+		return sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	float TexCoordError(float value)
+	{
+		return fabs(HalfToFloat(FloatToHalf(value)) - value);
+	}
+}
+
+TEST(VertexQuantiser, RandomVerticesAreWithinTheDefaultTolerance)
+{
+	mt19937 random(1234);
+	uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	uniform_real_distribution<float> texCoord(0.0f, 2.0f);
+	normal_distribution<float> gaussian;
+	vector<TestVertex> vertices(100000);
+	for (TestVertex& vertex : vertices)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			vertex.Position[i] = Centre[i] + Extents[i] * unit(random);
+		}
+		// Normally distributed components give directions spread evenly over the sphere
+		float length = 0.0f;
+		while (length < 1e-3f)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				vertex.Normal[i] = gaussian(random);
+			}
+			length = sqrt(vertex.Normal[0] * vertex.Normal[0] + vertex.Normal[1] * vertex.Normal[1] + vertex.Normal[2] * vertex.Normal[2]);
+		}
+		for (int i = 0; i < 3; i++)
+		{
+			vertex.Normal[i] /= length;
+		}
+		vertex.TexCoord[0] = texCoord(random);
+		vertex.TexCoord[1] = texCoord(random);
+	}
+
+	vector<QuantisedVertex> quantisedVertices(vertices.size());
+	QuantisationError error;
+	QuantiseVertices(vertices.data(), vertices.size(), sizeof(TestVertex), MakeQuantisationBounds(Centre, Extents), quantisedVertices.data(), error);
+	QuantisationError tolerance = DefaultQuantisationTolerance();
+	EXPECT_LE(error.Position, tolerance.Position);
+	EXPECT_LE(error.Normal, tolerance.Normal);
+	EXPECT_LE(error.TexCoord, tolerance.TexCoord);
+	EXPECT_TRUE(IsWithinTolerance(error, tolerance));
+}
+
+TEST(VertexQuantiser, EncodesThePolesAndTheFoldSeam)
+{
+	// The poles, the equator on the axes, and the lower hemisphere where x or y is 0, which
+	// lies on the edges of the folded octahedron
+	const float normals[][3] =
+	{
+		{ 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+		{ 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+		{ 0.0f, 0.6f, -0.8f }, { 0.0f, -0.6f, -0.8f }, { 0.6f, 0.0f, -0.8f }, { -0.6f, 0.0f, -0.8f },
+		{ -0.0f, 0.6f, -0.8f }, { 0.6f, -0.0f, -0.8f },
+		{ 1e-6f, 0.6f, -0.8f }, { -1e-6f, 0.6f, -0.8f }, { 0.6f, 1e-6f, -0.8f }, { 0.6f, -1e-6f, -0.8f },
+		{ 0.0f, 1e-6f, -1.0f }, { 1e-6f, 0.0f, -1.0f }, { 0.0f, 0.999f, -0.0447101f }
+	};
+	float tolerance = DefaultQuantisationTolerance().Normal;
+	for (const float * normal : normals)
+	{
+		EXPECT_LE(NormalError(normal), tolerance) << "normal " << normal[0] << ", " << normal[1] << ", " << normal[2];
+	}
+}
+
+TEST(VertexQuantiser, KeepsTexCoordsToTwoWithinTheTolerance)
+{
+	// The tolerance is half the spacing of half floats between 1 and 2, which is the largest
+	// rounding error in the range 0 to 2
+	float tolerance = DefaultQuantisationTolerance().TexCoord;
+	EXPECT_EQ(2.0f * tolerance, HalfToFloat(0x3C01) - 1.0f);
+	float largestError = 0.0f;
+	for (int i = 0; i <= 2 * 65536; i++)
+	{
+		largestError = max(largestError, TexCoordError(i / 65536.0f));
+	}
+	// Values half way between two halves are the worst case
+	for (int i = 0; i < 1024; i++)
+	{
+		largestError = max(largestError, TexCoordError(1.0f + (i + 0.5f) / 1024.0f));
+	}
+	EXPECT_EQ(tolerance, largestError);
+	// Past 2 the spacing doubles, so the tolerance no longer holds
+	EXPECT_GT(TexCoordError(2.0f + 1.5f / 512.0f), tolerance);
+}
+
+TEST(VertexQuantiser, ConvertsHalfFloats)
+{
+	EXPECT_EQ(0x0000, FloatToHalf(0.0f));
+	EXPECT_EQ(0x8000, FloatToHalf(-0.0f));
+	EXPECT_EQ(0x3C00, FloatToHalf(1.0f));
+	EXPECT_EQ(0xC000, FloatToHalf(-2.0f));
+	EXPECT_EQ(0x7BFF, FloatToHalf(65504.0f));
+	EXPECT_EQ(0x7C00, FloatToHalf(65520.0f));
+	EXPECT_EQ(0x0001, FloatToHalf(ldexp(1.0f, -24)));
+	EXPECT_EQ(0x7C00, FloatToHalf(numeric_limits<float>::infinity()));
+	EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(numeric_limits<float>::quiet_NaN()))));
+	for (uint32_t half = 0; half < 0x7C00; half++)
+	{
+		ASSERT_EQ(half, FloatToHalf(HalfToFloat(static_cast<uint16_t>(half)))) << "half " << half;
+	}
+}
+
+TEST(VertexQuantiser, RejectsPositionsThatAreNotFinite)
+{
+	TestVertex vertex = { { Centre[0], numeric_limits<float>::quiet_NaN(), Centre[2] }, { 0.0f, 0.0f, 1.0f }, { 0.5f, 0.5f } };
+	QuantisedVertex quantisedVertex;
+	QuantisationError error;
+	QuantiseVertices(&vertex, 1, sizeof(TestVertex), MakeQuantisationBounds(Centre, Extents), &quantisedVertex, error);
+	EXPECT_FALSE(IsWithinTolerance(error, DefaultQuantisationTolerance()));
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+#include "WorkerPool.h"
+
+TEST(WorkerPool, ParallelForVisitsEveryIndexOnce)
+{
+	WorkerPool workerPool(3);
+	vector<atomic<int>> visits(10000);
+	for (atomic<int>& visit : visits)
+	{
+		visit = 0;
+	}
+	workerPool.ParallelFor(visits.size(), [&visits](size_t i)
+						   {
+							   visits[i]++;
+						   });
+	for (size_t i = 0; i < visits.size(); i++)
+	{
+		ASSERT_EQ(1, visits[i].load()) << "index " << i;
+	}
+}
+
+TEST(WorkerPool, ParallelForRunsInlineWithoutWorkers)
+{
+	WorkerPool workerPool(0);
+	vector<size_t> order;
+	workerPool.ParallelFor(5, [&order](size_t i)
+						   {
+							   order.push_back(i);
+						   });
+	EXPECT_EQ(vector<size_t>({ 0, 1, 2, 3, 4 }), order);
+}
+
+TEST(WorkerPool, RunsSubmittedTasksBeforeStopping)
+{
+	atomic<int> completed(0);
+	{
+		WorkerPool workerPool(2);
+		for (int i = 0; i < 100; i++)
+		{
+			workerPool.Submit([&completed]()
+							  {
+								  completed++;
+							  });
+		}
+	}
+	EXPECT_EQ(100, completed.load());
+}
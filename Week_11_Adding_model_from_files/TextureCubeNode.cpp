@@ -1,328 +1,180 @@
-#include "TextureCubeNode.h"
-#include "WICTextureLoader.h"
-//#include "Geometry.h"
-
-#define TextureShaderFileName		L"TextureShader.hlsl"
-#define VertexShaderName	"VS"
-#define PixelShaderName		"PS"
-#define TextureName			L"woodbox.bmp"
-
-struct textCBuffer
-{
-	Matrix		WorldViewProjection;
-	Matrix		World;
-	Vector4		MaterialColour;
-	Vector4		AmbientLightColour;
-	Vector4		DirectionalLightColour;
-	Vector4		DirectionalLightVector;
-	Vector4		cameraPosition;
-	Vector4		SpecularColour;
-	float		Shininess;
-	float		Opacity;
-	float		Padding[2];
-
-};
-
-struct TextVertex
-{
-	Vector3		Position;
-	Vector3		Normal;
-	Vector2     TextureCoordinate;
-};
-
-D3D11_INPUT_ELEMENT_DESC tvertexDesc[] =
-{
-	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}
-};
-
-
-TextVertex tvertices[] =
-{
-	{ Vector3(-1.0f, -1.0f, 1.0f),  Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 0.0f)},    // side 1
-	{ Vector3(1.0f, -1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),   Vector2(0.0f, 1.0f)},
-	{ Vector3(-1.0f, 1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 0.0f)},
-	{ Vector3(1.0f, 1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),    Vector2(1.0f, 1.0f)},
-
-	{ Vector3(-1.0f, -1.0f, -1.0f), Vector3(0.0f, 0.0f, 0.0f),Vector2(0.0f, 0.0f)},    // side 2
-	{ Vector3(-1.0f, 1.0f, -1.0f) ,Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 1.0f)},
-	{ Vector3(1.0f, -1.0f, -1.0f), Vector3(0.0f, 0.0f, 0.0f), Vector2(1.0f, 0.0f)},
-	{ Vector3(1.0f, 1.0f, -1.0f) , Vector3(0.0f, 0.0f, 0.0f), Vector2(1.0f, 1.0f)},
-
-	{ Vector3(-1.0f, 1.0f, -1.0f) ,Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 0.0f)},    // side 3
-	{ Vector3(-1.0f, 1.0f, 1.0f) , Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 1.0f)},
-	{ Vector3(1.0f, 1.0f, -1.0f) ,Vector3(0.0f, 0.0f, 0.0f),  Vector2(1.0f, 0.0f)},
-	{ Vector3(1.0f, 1.0f, 1.0f),Vector3(0.0f, 0.0f, 0.0f),    Vector2(1.0f, 1.0f)},
-
-	{ Vector3(-1.0f, -1.0f, -1.0f) , Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 0.0f)},    // side 4
-	{ Vector3(1.0f, -1.0f, -1.0f) ,Vector3(0.0f, 0.0f, 0.0f),   Vector2(0.0f, 1.0f)},
-	{ Vector3(-1.0f, -1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 0.0f)},
-	{ Vector3(1.0f, -1.0f, 1.0f) , Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 1.0f)},
-
-	{ Vector3(1.0f, -1.0f, -1.0f) , Vector3(0.0f, 0.0f, 0.0f),  Vector2(0.0f, 0.0f)},    // side 5
-	{ Vector3(1.0f, 1.0f, -1.0f) , Vector3(0.0f, 0.0f, 0.0f),   Vector2(0.0f, 1.0f)},
-	{ Vector3(1.0f, -1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),    Vector2(1.0f, 0.0f)},
-	{ Vector3(1.0f, 1.0f, 1.0f) , Vector3(0.0f, 0.0f, 0.0f),    Vector2(1.0f, 1.0f)},
-
-	{ Vector3(-1.0f, -1.0f, -1.0f), Vector3(0.0f, 0.0f, 0.0f),  Vector2(0.0f, 0.0f)},    // side 6
-	{ Vector3(-1.0f, -1.0f, 1.0f) ,Vector3(0.0f, 0.0f, 0.0f),   Vector2(0.0f, 1.0f)},
-	{ Vector3(-1.0f, 1.0f, -1.0f), Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 0.0f)},
-	{ Vector3(-1.0f, 1.0f, 1.0f) , Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 1.0f)}
-};
-
-UINT tindices[] = {
-			0, 1, 2,       // side 1
-			2, 1, 3,
-			4, 5, 6,       // side 2
-			6, 5, 7,
-			8, 9, 10,      // side 3
-			10, 9, 11,
-			12, 13, 14,    // side 4
-			14, 13, 15,
-			16, 17, 18,    // side 5
-			18, 17, 19,
-			20, 21, 22,    // side 6
-			22, 21, 23,
-};
-
-bool TextureCubeNode::Initialise()
-{
-
-	_device = DirectXFramework::GetDXFramework()->GetDevice();
-	_deviceContext = DirectXFramework::GetDXFramework()->GetDeviceContext();
-	if (_device.Get() == nullptr || _deviceContext.Get() == nullptr)
-	{
-		return false;
-	}
-
-
-	GenerateVertexNormals();
-	BuildGeometryBuffers();
-	BuildShaders();
-	BuildVertexLayout();
-	BuildConstantBuffer();
-	BuildTexture();
-
-	return true;
-}
-
-
-
-void TextureCubeNode::Render()
-{
-	// Calculate the world x view x projection transformation
-	Matrix projectionTransformation = DirectXFramework::GetDXFramework()->GetProjectionTransformation();
-	Matrix viewTransformation = DirectXFramework::GetDXFramework()->GetViewTransformation();
-
-
-
-	//Matrix World = _worldTransformation;
-	textCBuffer constantBuffer;
-	constantBuffer.World = _cumulativeWorldTransformation;
-
-	constantBuffer.WorldViewProjection = _cumulativeWorldTransformation * viewTransformation * projectionTransformation;
-	constantBuffer.MaterialColour = Vector4(0.5f, 0.7f, 0.2f, 1.0f); // Adjusted material color
-	constantBuffer.AmbientLightColour = Vector4(0.2f, 0.2f, 0.2f, 1.0f); // Adjusted ambient color
-
-	constantBuffer.DirectionalLightVector = Vector4(1.0f, 1.0f, -1.0f, 0.0f); // Adjusted direction of the light
-	constantBuffer.DirectionalLightColour = Vector4(Colors::Green); // Adjusted color of the light
-
-	constantBuffer.SpecularColour = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f); // Adjusted specular color
-	constantBuffer.Shininess = 10.0f; // Adjusted shininess
-	constantBuffer.Opacity = 1.0f;
-
-
-	// Update the constant buffer. Note the layout of the constant buffer must match that in the shader
-	_deviceContext->VSSetConstantBuffers(0, 1, _constantBuffer.GetAddressOf());
-	_deviceContext->UpdateSubresource(_constantBuffer.Get(), 0, 0, &constantBuffer, 0, 0);
-	//_deviceContext->PSSetConstantBuffers(0, 1, _constantBuffer.GetAddressOf());
-
-	_deviceContext->PSSetShaderResources(0, 1, _texture.GetAddressOf());
-
-
-	// Now render the cube
-	// Specify the distance between vertices and the starting point in the vertex buffer
-	UINT stride = sizeof(TextVertex);
-	UINT offset = 0;
-	// Set the vertex buffer and index buffer we are going to use
-	_deviceContext->IASetVertexBuffers(0, 1, _vertexBuffer.GetAddressOf(), &stride, &offset);
-	_deviceContext->IASetIndexBuffer(_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-	// Specify the layout of the polygons (it will rarely be different to this)
-	_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-	// Specify the layout of the input vertices.  This must match the layout of the input vertices in the shader
-	_deviceContext->IASetInputLayout(_layout.Get());
-
-	// Specify the vertex and pixel shaders we are going to use
-	_deviceContext->VSSetShader(_vertexShader.Get(), 0, 0);
-	_deviceContext->PSSetShader(_pixelShader.Get(), 0, 0);
-
-
-	// Now draw the first cube
-	_deviceContext->DrawIndexed(ARRAYSIZE(tindices), 0, 0);
-
-}
-
-void TextureCubeNode::BuildGeometryBuffers()
-{
-	// This method uses the arrays defined in Geometry.h
-	// 
-	// Setup the structure that specifies how big the vertex 
-	// buffer should be
-	D3D11_BUFFER_DESC vertexBufferDescriptor = { 0 };
-	vertexBufferDescriptor.Usage = D3D11_USAGE_IMMUTABLE;
-	vertexBufferDescriptor.ByteWidth = sizeof(TextVertex) * ARRAYSIZE(tvertices);
-	vertexBufferDescriptor.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDescriptor.CPUAccessFlags = 0;
-	vertexBufferDescriptor.MiscFlags = 0;
-	vertexBufferDescriptor.StructureByteStride = 0;
-
-	// Now set up a structure that tells DirectX where to get the
-	// data for the vertices from
-	D3D11_SUBRESOURCE_DATA vertexInitialisationData = { 0 };
-	vertexInitialisationData.pSysMem = &tvertices;
-
-	// and create the vertex buffer
-	ThrowIfFailed(_device->CreateBuffer(&vertexBufferDescriptor, &vertexInitialisationData, _vertexBuffer.GetAddressOf()));
-
-	// Setup the structure that specifies how big the index 
-	// buffer should be
-	D3D11_BUFFER_DESC indexBufferDescriptor = { 0 };
-	indexBufferDescriptor.Usage = D3D11_USAGE_IMMUTABLE;
-	indexBufferDescriptor.ByteWidth = sizeof(UINT) * ARRAYSIZE(tindices);
-	indexBufferDescriptor.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDescriptor.CPUAccessFlags = 0;
-	indexBufferDescriptor.MiscFlags = 0;
-	indexBufferDescriptor.StructureByteStride = 0;
-
-	// Now set up a structure that tells DirectX where to get the
-	// data for the indices from
-	D3D11_SUBRESOURCE_DATA indexInitialisationData;
-	indexInitialisationData.pSysMem = &tindices;
-
-	// and create the index buffer
-	ThrowIfFailed(_device->CreateBuffer(&indexBufferDescriptor, &indexInitialisationData, _indexBuffer.GetAddressOf()));
-}
-
-void TextureCubeNode::BuildShaders()
-{
-	DWORD shaderCompileFlags = 0;
-#if defined( _DEBUG )
-	shaderCompileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-
-	ComPtr<ID3DBlob> compilationMessages = nullptr;
-
-	//Compile vertex shader
-	HRESULT hr = D3DCompileFromFile(TextureShaderFileName,
-		nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-		VertexShaderName, "vs_5_0",
-		shaderCompileFlags, 0,
-		_vertexShaderByteCode.GetAddressOf(),
-		compilationMessages.GetAddressOf());
-
-	if (compilationMessages.Get() != nullptr)
-	{
-		// If there were any compilation messages, display them
-		MessageBoxA(0, (char*)compilationMessages->GetBufferPointer(), 0, 0);
-	}
-	// Even if there are no compiler messages, check to make sure there were no other errors.
-	ThrowIfFailed(hr);
-	ThrowIfFailed(_device->CreateVertexShader(_vertexShaderByteCode->GetBufferPointer(), _vertexShaderByteCode->GetBufferSize(), NULL, _vertexShader.GetAddressOf()));
-
-	// Compile pixel shader
-	hr = D3DCompileFromFile(TextureShaderFileName,
-		nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-		PixelShaderName, "ps_5_0",
-		shaderCompileFlags, 0,
-		_pixelShaderByteCode.GetAddressOf(),
-		compilationMessages.GetAddressOf());
-
-	if (compilationMessages.Get() != nullptr)
-	{
-		// If there were any compilation messages, display them
-		MessageBoxA(0, (char*)compilationMessages->GetBufferPointer(), 0, 0);
-	}
-	ThrowIfFailed(hr);
-	ThrowIfFailed(_device->CreatePixelShader(_pixelShaderByteCode->GetBufferPointer(), _pixelShaderByteCode->GetBufferSize(), NULL, _pixelShader.GetAddressOf()));
-}
-
-void TextureCubeNode::BuildVertexLayout()
-{
-	// Create the vertex input layout. This tells DirectX the format
-	// of each of the vertices we are sending to it. The vertexDesc array is
-	// defined in Geometry.h
-
-	ThrowIfFailed(_device->CreateInputLayout(tvertexDesc, ARRAYSIZE(tvertexDesc), _vertexShaderByteCode->GetBufferPointer(), _vertexShaderByteCode->GetBufferSize(), _layout.GetAddressOf()));
-}
-
-void TextureCubeNode::BuildConstantBuffer()
-{
-	D3D11_BUFFER_DESC bufferDesc;
-	ZeroMemory(&bufferDesc, sizeof(bufferDesc));
-	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	bufferDesc.ByteWidth = sizeof(textCBuffer);
-	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-
-	ThrowIfFailed(_device->CreateBuffer(&bufferDesc, NULL, _constantBuffer.GetAddressOf()));
-}
-
-void TextureCubeNode::GenerateVertexNormals()
-{
-
-	// Create an array for contributing counts
-	std::vector<int>contributingCounts(ARRAYSIZE(tvertices), 0);
-
-	for (size_t i = 0; i < (ARRAYSIZE(tindices)); i += 3)
-	{
-		//calc the normal for polygon
-		// Get the 3 indices of the vertices that make up the polygon
-		UINT index0 = tindices[i];
-		UINT index1 = tindices[i + 1];
-		UINT index2 = tindices[i + 2];
-
-		Vector3 vertex0 = tvertices[index0].Position;
-		Vector3 vertex1 = tvertices[index1].Position;
-		Vector3 vertex2 = tvertices[index2].Position;
-
-		Vector3 vectorA = vertex1 - vertex0;
-		Vector3 vectorB = vertex2 - vertex0;
-
-		// Calculate the cross product of vectorA and vectorB to get the normal
-		Vector3 polygonNormal = vectorA.Cross(vectorB);
-
-		// Add the polygon normal to the vertex normal for each of the 3 vertices
-		tvertices[index0].Normal += polygonNormal;
-		tvertices[index1].Normal += polygonNormal;
-		tvertices[index2].Normal += polygonNormal;
-
-		// Add 1 to the contributing count for each of the vertices
-		contributingCounts[index0] += 1;
-		contributingCounts[index1] += 1;
-		contributingCounts[index2] += 1;
-	}
-
-	// Loop through vertices
-	for (size_t i = 0; i < ARRAYSIZE(tvertices); i += 1)
-	{
-		if (contributingCounts[i] > 0)
-		{
-			tvertices[i].Normal /= (contributingCounts[i]);
-			tvertices[i].Normal.Normalize();
-		}
-
-	}
-
-
-}
-void TextureCubeNode::BuildTexture()
-{
-	ThrowIfFailed(CreateWICTextureFromFile(_device.Get(),
-		_deviceContext.Get(),
-		TextureName,
-		nullptr,
-		_texture.GetAddressOf()
-	));
-}
\ No newline at end of file
+#include "TextureCubeNode.h"
+//#include "Geometry.h"
+#include "GeometricObject.h"
+
+#define TextureShaderFileName		L"TextureShader.hlsl"
+#define VertexShaderName	"VS"
+#define PixelShaderName		"PS"
+#define MeshKey				L"*texturedcube"
+#define InstancedVertexShaderName	"VSInstanced"
+#define MaterialName		L"*texturedcube"
+#define TextureName			L"woodbox.bmp"
+
+struct TextVertex
+{
+	Vector3		Position;
+	Vector3		Normal;
+	Vector2     TextureCoordinate;
+};
+
+D3D11_INPUT_ELEMENT_DESC tvertexDesc[] =
+{
+	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}
+};
+
+
+TextVertex tvertices[] =
+{
+	{ Vector3(-1.0f, -1.0f, 1.0f),  Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 0.0f)},    // side 1
+	{ Vector3(1.0f, -1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),   Vector2(0.0f, 1.0f)},
+	{ Vector3(-1.0f, 1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 0.0f)},
+	{ Vector3(1.0f, 1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),    Vector2(1.0f, 1.0f)},
+
+	{ Vector3(-1.0f, -1.0f, -1.0f), Vector3(0.0f, 0.0f, 0.0f),Vector2(0.0f, 0.0f)},    // side 2
+	{ Vector3(-1.0f, 1.0f, -1.0f) ,Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 1.0f)},
+	{ Vector3(1.0f, -1.0f, -1.0f), Vector3(0.0f, 0.0f, 0.0f), Vector2(1.0f, 0.0f)},
+	{ Vector3(1.0f, 1.0f, -1.0f) , Vector3(0.0f, 0.0f, 0.0f), Vector2(1.0f, 1.0f)},
+
+	{ Vector3(-1.0f, 1.0f, -1.0f) ,Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 0.0f)},    // side 3
+	{ Vector3(-1.0f, 1.0f, 1.0f) , Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 1.0f)},
+	{ Vector3(1.0f, 1.0f, -1.0f) ,Vector3(0.0f, 0.0f, 0.0f),  Vector2(1.0f, 0.0f)},
+	{ Vector3(1.0f, 1.0f, 1.0f),Vector3(0.0f, 0.0f, 0.0f),    Vector2(1.0f, 1.0f)},
+
+	{ Vector3(-1.0f, -1.0f, -1.0f) , Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 0.0f)},    // side 4
+	{ Vector3(1.0f, -1.0f, -1.0f) ,Vector3(0.0f, 0.0f, 0.0f),   Vector2(0.0f, 1.0f)},
+	{ Vector3(-1.0f, -1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 0.0f)},
+	{ Vector3(1.0f, -1.0f, 1.0f) , Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 1.0f)},
+
+	{ Vector3(1.0f, -1.0f, -1.0f) , Vector3(0.0f, 0.0f, 0.0f),  Vector2(0.0f, 0.0f)},    // side 5
+	{ Vector3(1.0f, 1.0f, -1.0f) , Vector3(0.0f, 0.0f, 0.0f),   Vector2(0.0f, 1.0f)},
+	{ Vector3(1.0f, -1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f),    Vector2(1.0f, 0.0f)},
+	{ Vector3(1.0f, 1.0f, 1.0f) , Vector3(0.0f, 0.0f, 0.0f),    Vector2(1.0f, 1.0f)},
+
+	{ Vector3(-1.0f, -1.0f, -1.0f), Vector3(0.0f, 0.0f, 0.0f),  Vector2(0.0f, 0.0f)},    // side 6
+	{ Vector3(-1.0f, -1.0f, 1.0f) ,Vector3(0.0f, 0.0f, 0.0f),   Vector2(0.0f, 1.0f)},
+	{ Vector3(-1.0f, 1.0f, -1.0f), Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 0.0f)},
+	{ Vector3(-1.0f, 1.0f, 1.0f) , Vector3(0.0f, 0.0f, 0.0f),   Vector2(1.0f, 1.0f)}
+};
+
+UINT tindices[] = {
+			0, 1, 2,       // side 1
+			2, 1, 3,
+			4, 5, 6,       // side 2
+			6, 5, 7,
+			8, 9, 10,      // side 3
+			10, 9, 11,
+			12, 13, 14,    // side 4
+			14, 13, 15,
+			16, 17, 18,    // side 5
+			18, 17, 19,
+			20, 21, 22,    // side 6
+			22, 21, 23,
+};
+
+
+bool TextureCubeNode::Initialise()
+{
+
+	_device = DirectXFramework::GetDXFramework()->GetDevice();
+	_deviceContext = DirectXFramework::GetDXFramework()->GetDeviceContext();
+	if (_device.Get() == nullptr || _deviceContext.Get() == nullptr)
+	{
+		return false;
+	}
+
+
+	// The mesh is shared by all textured cubes through the resource manager
+	_mesh = DirectXFramework::GetDXFramework()->GetResourceManager()->GetProceduralMesh(MeshKey, [](vector<Vertex>& meshVertices, vector<UINT>& meshIndices)
+		{
+			meshVertices.resize(ARRAYSIZE(tvertices));
+			for (size_t i = 0; i < ARRAYSIZE(tvertices); i++)
+			{
+				meshVertices[i].Position = tvertices[i].Position;
+				meshVertices[i].TexCoord = tvertices[i].TextureCoordinate;
+			}
+			meshIndices.assign(tindices, tindices + ARRAYSIZE(tindices));
+			const VertexNormalLayout layout = { sizeof(Vertex), offsetof(Vertex, Normal), offsetof(Vertex, TexCoord) };
+			GenerateVertexNormals(meshVertices.data(), meshVertices.size(), layout, meshIndices.data(), meshIndices.size(), NormalWeightingArea);
+		});
+	if (_mesh == nullptr)
+	{
+		return false;
+	}
+	SetLocalBounds(_mesh->GetBounds());
+
+	BuildShaders();
+	BuildVertexLayout();
+
+	// The material holds the texture as well as the constant buffer, so both are shared by
+	// every textured cube
+	shared_ptr<ResourceManager> resourceManager = DirectXFramework::GetDXFramework()->GetResourceManager();
+	resourceManager->CreateMaterial(MaterialName, Vector4(0.5f, 0.7f, 0.2f, 1.0f), Vector4(0.5f, 0.5f, 0.5f, 1.0f), 10.0f, 1.0f, TextureName);
+	_material = resourceManager->GetMaterial(MaterialName);
+	if (_material == nullptr)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+
+void TextureCubeNode::Render()
+{
+	// Only the world transformation and ambient colour are uploaded for each cube.  The
+	// camera and lighting are in the frame constants and the rest is in the material.
+	ObjectConstants objectConstants;
+	objectConstants.World = GetCumulativeWorldTransformation();
+	objectConstants.AmbientLightColour = Vector4(0.2f, 0.2f, 0.2f, 1.0f);
+
+	// Add the cube to the render queue
+	DrawPacket packet = { 0 };
+	packet.VertexShader = _vertexShader.Get();
+	packet.PixelShader = _pixelShader.Get();
+	packet.InputLayout = _layout.Get();
+	shared_ptr<SubMesh> subMesh = _mesh->GetSubMesh(0);
+	packet.VertexBuffer = subMesh->GetVertexBuffer().Get();
+	packet.VertexStride = sizeof(Vertex);
+	packet.IndexBuffer = subMesh->GetIndexBuffer().Get();
+	packet.IndexSize = subMesh->GetIndexSize();
+	packet.IndexCount = static_cast<UINT>(subMesh->GetIndexCount());
+	packet.StartIndex = subMesh->GetStartIndex();
+	packet.BaseVertex = subMesh->GetBaseVertex();
+	packet.Texture = _material->GetTexture().Get();
+	packet.MaterialConstantBuffer = _material->GetConstantBuffer().Get();
+	packet.InstancedVertexShader = _instancedVertexShader.Get();
+	packet.InstancedInputLayout = _instancedLayout.Get();
+	DirectXFramework::GetDXFramework()->GetRenderQueue()->Submit(OpaquePass, packet, objectConstants);
+}
+
+void TextureCubeNode::Shutdown()
+{
+	DirectXFramework::GetDXFramework()->GetResourceManager()->ReleaseMaterial(MaterialName);
+	DirectXFramework::GetDXFramework()->GetResourceManager()->ReleaseMesh(MeshKey);
+}
+
+void TextureCubeNode::BuildShaders()
+{
+	// The shader library compiles each shader once, so every textured cube gets the same shader objects
+	shared_ptr<ShaderLibrary> shaderLibrary = DirectXFramework::GetDXFramework()->GetResourceManager()->GetShaderLibrary();
+	_vertexShader = shaderLibrary->GetVertexShader(TextureShaderFileName, VertexShaderName);
+	_pixelShader = shaderLibrary->GetPixelShader(TextureShaderFileName, PixelShaderName);
+	_instancedVertexShader = shaderLibrary->GetVertexShader(TextureShaderFileName, InstancedVertexShaderName);
+}
+
+void TextureCubeNode::BuildVertexLayout()
+{
+	// Create the vertex input layout. This tells DirectX the format
+	// of each of the vertices we are sending to it.  Layouts are shared
+	// through the shader library in the same way as the shaders.
+	shared_ptr<ShaderLibrary> shaderLibrary = DirectXFramework::GetDXFramework()->GetResourceManager()->GetShaderLibrary();
+	_layout = shaderLibrary->GetInputLayout(TextureShaderFileName, VertexShaderName, tvertexDesc, ARRAYSIZE(tvertexDesc));
+
+	// The instanced layout reads the instance data from a second vertex stream
+	vector<D3D11_INPUT_ELEMENT_DESC> instancedDesc(tvertexDesc, tvertexDesc + ARRAYSIZE(tvertexDesc));
+	instancedDesc.insert(instancedDesc.end(), InstanceDataDescription, InstanceDataDescription + ARRAYSIZE(InstanceDataDescription));
+	_instancedLayout = shaderLibrary->GetInputLayout(TextureShaderFileName, InstancedVertexShaderName, instancedDesc.data(), static_cast<UINT>(instancedDesc.size()));
+}
@@ -0,0 +1,207 @@
+#include "TextureDecoder.h"
+#include <cstring>
+
+// Largest width or height accepted, matching the largest texture a feature level 11 device can create
+const uint32_t MaximumImageSize = 16384;
+
+// Compression values in the bitmap header
+const uint32_t BitmapRGB = 0;
+const uint32_t BitmapBitFields = 3;
+
+static uint16_t ReadUInt16(const uint8_t * data)
+{
+	return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+static uint32_t ReadUInt32(const uint8_t * data)
+{
+	return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+		   (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+// Extracts one channel described by a bit mask and scales it to 8 bits
+struct ChannelMask
+{
+	uint32_t				Mask;
+	uint32_t				Shift;
+	uint32_t				Maximum;
+
+	void Initialise(uint32_t mask)
+	{
+		Mask = mask;
+		Shift = 0;
+		Maximum = 0;
+		if (mask != 0)
+		{
+			while (((mask >> Shift) & 1) == 0)
+			{
+				Shift++;
+			}
+			Maximum = mask >> Shift;
+		}
+	}
+
+	uint8_t Extract(uint32_t value, uint8_t defaultValue) const
+	{
+		if (Mask == 0)
+		{
+			return defaultValue;
+		}
+		// In 64 bits, since a mask can be up to 32 bits wide
+		const uint64_t channel = (value & Mask) >> Shift;
+		return static_cast<uint8_t>((channel * 255 + Maximum / 2) / Maximum);
+	}
+};
+
+bool CanDecodeImage(const uint8_t * data, size_t size)
+{
+	return size >= 2 && data[0] == 'B' && data[1] == 'M';
+}
+
+bool DecodeImage(const uint8_t * data, size_t size, DecodedTexture& texture)
+{
+	// The file header is 14 bytes, followed by an info header of at least 40 bytes.  The
+	// older 12 byte core header is not handled.
+	if (!CanDecodeImage(data, size) || size < 14 + 40)
+	{
+		return false;
+	}
+	uint32_t pixelOffset = ReadUInt32(data + 10);
+	const uint8_t * header = data + 14;
+	uint32_t headerSize = ReadUInt32(header);
+	if (headerSize < 40 || 14 + static_cast<size_t>(headerSize) > size)
+	{
+		return false;
+	}
+	int32_t width = static_cast<int32_t>(ReadUInt32(header + 4));
+	int32_t height = static_cast<int32_t>(ReadUInt32(header + 8));
+	uint16_t bitCount = ReadUInt16(header + 14);
+	uint32_t compression = ReadUInt32(header + 16);
+	uint32_t coloursUsed = ReadUInt32(header + 32);
+
+	// Rows are stored bottom to top unless the height is negative
+	bool topDown = height < 0;
+	uint32_t absoluteHeight = topDown ? static_cast<uint32_t>(-static_cast<int64_t>(height)) : static_cast<uint32_t>(height);
+	if (width <= 0 || absoluteHeight == 0 || static_cast<uint32_t>(width) > MaximumImageSize || absoluteHeight > MaximumImageSize)
+	{
+		return false;
+	}
+	uint32_t imageWidth = static_cast<uint32_t>(width);
+
+	// Masks for 16 and 32 bit images.  With BI_BITFIELDS they follow a 40 byte header, or are
+	// part of the larger headers.  Otherwise the formats are fixed.
+	ChannelMask red, green, blue, alpha;
+	if (compression == BitmapBitFields && (bitCount == 16 || bitCount == 32))
+	{
+		if (14 + 40 + 12 > size)
+		{
+			return false;
+		}
+		const uint8_t * masks = header + 40;
+		red.Initialise(ReadUInt32(masks));
+		green.Initialise(ReadUInt32(masks + 4));
+		blue.Initialise(ReadUInt32(masks + 8));
+		alpha.Initialise(headerSize >= 56 ? ReadUInt32(masks + 12) : 0);
+	}
+	else if (compression == BitmapRGB && bitCount == 16)
+	{
+		red.Initialise(0x7C00);
+		green.Initialise(0x03E0);
+		blue.Initialise(0x001F);
+		alpha.Initialise(0);
+	}
+	else if (compression == BitmapRGB && bitCount == 32)
+	{
+		// The fourth byte is usually left as 0 rather than being alpha, so it is ignored
+		red.Initialise(0x00FF0000);
+		green.Initialise(0x0000FF00);
+		blue.Initialise(0x000000FF);
+		alpha.Initialise(0);
+	}
+	else if (compression != BitmapRGB || (bitCount != 1 && bitCount != 4 && bitCount != 8 && bitCount != 24))
+	{
+		// Run length encoded or otherwise unusual bitmaps are left to WIC
+		return false;
+	}
+
+	// Palettised images have a table of BGRX entries straight after the info header
+	const uint8_t * palette = nullptr;
+	uint32_t paletteSize = 0;
+	if (bitCount <= 8)
+	{
+		paletteSize = coloursUsed != 0 ? coloursUsed : (1u << bitCount);
+		if (paletteSize > (1u << bitCount) || 14 + static_cast<size_t>(headerSize) + paletteSize * 4 > size)
+		{
+			return false;
+		}
+		palette = header + headerSize;
+	}
+
+	size_t rowPitch = ((static_cast<size_t>(imageWidth) * bitCount + 31) / 32) * 4;
+	if (pixelOffset > size || rowPitch * absoluteHeight > size - pixelOffset)
+	{
+		return false;
+	}
+
+	texture.Width = imageWidth;
+	texture.Height = absoluteHeight;
+	texture.Pixels.resize(static_cast<size_t>(imageWidth) * absoluteHeight * 4);
+	for (uint32_t y = 0; y < absoluteHeight; y++)
+	{
+		uint32_t sourceRow = topDown ? y : absoluteHeight - 1 - y;
+		const uint8_t * source = data + pixelOffset + rowPitch * sourceRow;
+		uint8_t * destination = &texture.Pixels[static_cast<size_t>(y) * imageWidth * 4];
+		switch (bitCount)
+		{
+			case 24:
+				for (uint32_t x = 0; x < imageWidth; x++)
+				{
+					destination[0] = source[2];
+					destination[1] = source[1];
+					destination[2] = source[0];
+					destination[3] = 255;
+					source += 3;
+					destination += 4;
+				}
+				break;
+
+			case 16:
+			case 32:
+				for (uint32_t x = 0; x < imageWidth; x++)
+				{
+					uint32_t value = bitCount == 16 ? ReadUInt16(source) : ReadUInt32(source);
+					destination[0] = red.Extract(value, 0);
+					destination[1] = green.Extract(value, 0);
+					destination[2] = blue.Extract(value, 0);
+					destination[3] = alpha.Extract(value, 255);
+					source += bitCount / 8;
+					destination += 4;
+				}
+				break;
+
+			default:
+			{
+				// 1, 4 or 8 bits per pixel, with the leftmost pixel in the highest bits
+				uint32_t pixelsPerByte = 8 / bitCount;
+				uint32_t indexMask = (1u << bitCount) - 1;
+				for (uint32_t x = 0; x < imageWidth; x++)
+				{
+					uint32_t shift = (pixelsPerByte - 1 - x % pixelsPerByte) * bitCount;
+					uint32_t index = (source[x / pixelsPerByte] >> shift) & indexMask;
+					if (index >= paletteSize)
+					{
+						return false;
+					}
+					const uint8_t * entry = palette + index * 4;
+					destination[0] = entry[2];
+					destination[1] = entry[1];
+					destination[2] = entry[0];
+					destination[3] = 255;
+					destination += 4;
+				}
+				break;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Image decoding that does not depend on Windows, so that it can be built and timed on other
+// platforms.  Only uncompressed Windows bitmaps are handled here, which covers the textures
+// used by this project (woodbox.bmp and the airplane's bihull.bmp and wings.bmp).  Anything
+// else is rejected, and DecodeTexture in TextureLoader.cpp falls back to WIC for it.
+
+struct DecodedTexture
+{
+	uint32_t				Width;
+	uint32_t				Height;
+	// Rows of Width * 4 bytes, top to bottom, in DXGI_FORMAT_R8G8B8A8_UNORM order
+	vector<uint8_t>			Pixels;
+};
+
+// Returns true if the data starts with the signature of a format that DecodeImage handles
+bool CanDecodeImage(const uint8_t * data, size_t size);
+
+// Decodes the image and converts it to RGBA.  Returns false if the format is not handled or the
+// data is malformed.
+bool DecodeImage(const uint8_t * data, size_t size, DecodedTexture& texture);
@@ -0,0 +1,114 @@
+#include "TextureLoader.h"
+#include <wincodec.h>
+#include <fstream>
+#include <iterator>
+
+#pragma comment(lib, "windowscodecs.lib")
+
+// The largest texture that a feature level 11 device can create
+const UINT MaximumTextureSize = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+
+static bool DecodeTextureWithWIC(const wstring& fileName, DecodedTexture& texture)
+{
+	// WIC needs COM on whichever thread this is called from.  The main thread has already
+	// initialised it (see DirectXFramework::Initialise), in which case this fails harmlessly
+	// with RPC_E_CHANGED_MODE and must not be balanced with CoUninitialize.
+	HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	bool decoded = false;
+	{
+		ComPtr<IWICImagingFactory> factory;
+		ComPtr<IWICBitmapDecoder> decoder;
+		ComPtr<IWICBitmapFrameDecode> frame;
+		ComPtr<IWICFormatConverter> converter;
+		UINT width = 0;
+		UINT height = 0;
+		if (SUCCEEDED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(factory.GetAddressOf()))) &&
+			SUCCEEDED(factory->CreateDecoderFromFilename(fileName.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, decoder.GetAddressOf())) &&
+			SUCCEEDED(decoder->GetFrame(0, frame.GetAddressOf())) &&
+			SUCCEEDED(frame->GetSize(&width, &height)) &&
+			width > 0 && height > 0 && width <= MaximumTextureSize && height <= MaximumTextureSize &&
+			SUCCEEDED(factory->CreateFormatConverter(converter.GetAddressOf())) &&
+			SUCCEEDED(converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeMedianCut)))
+		{
+			UINT rowPitch = width * 4;
+			texture.Width = width;
+			texture.Height = height;
+			texture.Pixels.resize(static_cast<size_t>(rowPitch) * height);
+			decoded = SUCCEEDED(converter->CopyPixels(nullptr, rowPitch, static_cast<UINT>(texture.Pixels.size()), texture.Pixels.data()));
+		}
+	}
+	if (SUCCEEDED(comResult))
+	{
+		CoUninitialize();
+	}
+	return decoded;
+}
+
+bool DecodeTexture(const wstring& fileName, DecodedTexture& texture)
+{
+	// Bitmaps are decoded straight from memory, which avoids setting up COM and WIC on
+	// every call.  Anything the portable decoder does not handle goes through WIC.
+	ifstream file(fileName, ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	vector<uint8_t> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	if (CanDecodeImage(data.data(), data.size()) && DecodeImage(data.data(), data.size(), texture))
+	{
+		return true;
+	}
+	return DecodeTextureWithWIC(fileName, texture);
+}
+
+void DecodeTextures(const vector<wstring>& fileNames, vector<DecodedTexture>& textures, WorkerPool * workerPool)
+{
+	textures.resize(fileNames.size());
+	auto decode = [&fileNames, &textures](size_t i)
+	{
+		if (fileNames[i].empty() || !DecodeTexture(fileNames[i], textures[i]))
+		{
+			textures[i].Pixels.clear();
+		}
+	};
+	if (workerPool != nullptr)
+	{
+		workerPool->ParallelFor(fileNames.size(), decode);
+	}
+	else
+	{
+		for (size_t i = 0; i < fileNames.size(); i++)
+		{
+			decode(i);
+		}
+	}
+}
+
+HRESULT CreateTextureFromDecoded(ID3D11Device * device, ID3D11DeviceContext * deviceContext, const DecodedTexture& texture, ID3D11ShaderResourceView ** textureView)
+{
+	// Create a full mipmap chain and let the GPU fill in everything below the top level
+	D3D11_TEXTURE2D_DESC textureDesc = { 0 };
+	textureDesc.Width = texture.Width;
+	textureDesc.Height = texture.Height;
+	textureDesc.MipLevels = 0;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	textureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+	ComPtr<ID3D11Texture2D> texture2D;
+	HRESULT hr = device->CreateTexture2D(&textureDesc, nullptr, texture2D.GetAddressOf());
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	hr = device->CreateShaderResourceView(texture2D.Get(), nullptr, textureView);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	deviceContext->UpdateSubresource(texture2D.Get(), 0, nullptr, texture.Pixels.data(), texture.Width * 4, 0);
+	deviceContext->GenerateMips(*textureView);
+	return S_OK;
+}
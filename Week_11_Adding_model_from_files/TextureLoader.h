@@ -0,0 +1,23 @@
+#pragma once
+#include "DirectXCore.h"
+#include "TextureDecoder.h"
+#include "WorkerPool.h"
+#include <vector>
+#include <string>
+
+using namespace std;
+
+// Texture loading is split in two so that the slow part can be done away from the main thread.
+// DecodeTexture reads an image file and converts it to 32-bit RGBA pixels (see DecodedTexture).  It does not touch
+// Direct3D, so it can be called on any thread.  CreateTextureFromDecoded then creates the texture
+// and its mipmaps, and must be called on the thread that owns the device context.
+
+// Returns false if the file could not be read or is not an image WIC understands.  Bitmaps are
+// decoded by DecodeImage (see TextureDecoder.h) and everything else by WIC.
+bool DecodeTexture(const wstring& fileName, DecodedTexture& texture);
+
+// Decodes all of the files at once, spread across the worker pool.  A texture that could not be
+// decoded is left with no pixels.  Empty file names are skipped.
+void DecodeTextures(const vector<wstring>& fileNames, vector<DecodedTexture>& textures, WorkerPool * workerPool);
+
+HRESULT CreateTextureFromDecoded(ID3D11Device * device, ID3D11DeviceContext * deviceContext, const DecodedTexture& texture, ID3D11ShaderResourceView ** textureView);
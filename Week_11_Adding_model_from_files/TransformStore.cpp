@@ -0,0 +1,350 @@
+#include "TransformStore.h"
+#include <algorithm>
+#include <cstring>
+
+TransformStore * _sceneTransformStore = nullptr;
+
+TransformStore::TransformStore()
+{
+	_sceneTransformStore = this;
+	_orderChanged = false;
+	_updatedCount = 0;
+	_minimumParallelSubtreeSize = 1024;
+}
+
+TransformStore::~TransformStore()
+{
+	if (_sceneTransformStore == this)
+	{
+		_sceneTransformStore = nullptr;
+	}
+}
+
+TransformStore * TransformStore::GetTransformStore()
+{
+	return _sceneTransformStore;
+}
+
+TransformHandle TransformStore::Allocate()
+{
+	TransformHandle handle;
+	if (!_freeHandles.empty())
+	{
+		handle = _freeHandles.back();
+		_freeHandles.pop_back();
+	}
+	else
+	{
+		handle = static_cast<TransformHandle>(_handleIndices.size());
+		_handleIndices.push_back(-1);
+		_parentHandles.push_back(InvalidTransformHandle);
+		_firstChildHandles.push_back(InvalidTransformHandle);
+		_nextSiblingHandles.push_back(InvalidTransformHandle);
+	}
+	_parentHandles[handle] = InvalidTransformHandle;
+	_firstChildHandles[handle] = InvalidTransformHandle;
+	_nextSiblingHandles[handle] = InvalidTransformHandle;
+
+	// A new node has no parent, so adding it to the end of the arrays
+	// keeps them in a valid order.
+	_handleIndices[handle] = static_cast<int>(_localTransforms.size());
+	_localTransforms.push_back(Matrix());
+	_worldTransforms.push_back(Matrix());
+	_parentIndices.push_back(-1);
+	_subtreeSizes.push_back(1);
+	_handles.push_back(handle);
+	_dirtyFlags.push_back(false);
+	return handle;
+}
+
+void TransformStore::Release(TransformHandle handle)
+{
+	if (handle == InvalidTransformHandle || _handleIndices[handle] < 0)
+	{
+		return;
+	}
+	Detach(handle);
+	// Any children that are still alive become roots of their own hierarchy
+	TransformHandle child = _firstChildHandles[handle];
+	while (child != InvalidTransformHandle)
+	{
+		TransformHandle nextChild = _nextSiblingHandles[child];
+		_parentHandles[child] = InvalidTransformHandle;
+		_nextSiblingHandles[child] = InvalidTransformHandle;
+		child = nextChild;
+	}
+	_firstChildHandles[handle] = InvalidTransformHandle;
+	// The entry in the dense arrays is left where it is until the next
+	// reorder, so existing indices remain valid until then.
+	_handleIndices[handle] = -1;
+	_freeHandles.push_back(handle);
+	_orderChanged = true;
+}
+
+void TransformStore::SetParent(TransformHandle handle, TransformHandle parent)
+{
+	if (_parentHandles[handle] == parent)
+	{
+		return;
+	}
+	Detach(handle);
+	if (parent != InvalidTransformHandle)
+	{
+		_parentHandles[handle] = parent;
+		_nextSiblingHandles[handle] = _firstChildHandles[parent];
+		_firstChildHandles[parent] = handle;
+	}
+	_orderChanged = true;
+}
+
+TransformHandle TransformStore::GetParent(TransformHandle handle) const
+{
+	return _parentHandles[handle];
+}
+
+void TransformStore::SetLocalTransform(TransformHandle handle, const Matrix& localTransformation)
+{
+	int index = _handleIndices[handle];
+	// Nodes that are given the same transformation every frame do not need to be updated
+	if (memcmp(&_localTransforms[index], &localTransformation, sizeof(Matrix)) == 0)
+	{
+		return;
+	}
+	_localTransforms[index] = localTransformation;
+	if (!_dirtyFlags[index])
+	{
+		_dirtyFlags[index] = true;
+		_dirtyIndices.push_back(index);
+	}
+}
+
+const Matrix& TransformStore::GetLocalTransform(TransformHandle handle) const
+{
+	return _localTransforms[_handleIndices[handle]];
+}
+
+const Matrix& TransformStore::GetWorldTransform(TransformHandle handle) const
+{
+	return _worldTransforms[_handleIndices[handle]];
+}
+
+void TransformStore::Update(WorkerPool * workerPool)
+{
+	if (_orderChanged)
+	{
+		// The hierarchy has changed, so everything needs to be recalculated.  The roots
+		// of the hierarchies are found by stepping over each subtree in turn.
+		Reorder();
+		for (size_t i = 0; i < _localTransforms.size(); i += _subtreeSizes[i])
+		{
+			_dirtyIndices.push_back(static_cast<int>(i));
+		}
+	}
+
+	// Find the subtree below each dirty node.  Processing them in array order means
+	// that a dirty node inside a subtree we have already found can be skipped.
+	sort(_dirtyIndices.begin(), _dirtyIndices.end());
+	_updateRanges.clear();
+	_updatedCount = 0;
+	size_t updatedTo = 0;
+	for (int index : _dirtyIndices)
+	{
+		size_t first = static_cast<size_t>(index);
+		if (first < updatedTo)
+		{
+			continue;
+		}
+		updatedTo = first + _subtreeSizes[first];
+		_updateRanges.push_back(make_pair(first, updatedTo));
+		_updatedCount += updatedTo - first;
+	}
+	for (int index : _dirtyIndices)
+	{
+		_dirtyFlags[index] = false;
+	}
+	_dirtyIndices.clear();
+
+	// The parent of each range is not part of any other range, so the ranges are independent
+	if (workerPool == nullptr || workerPool->GetThreadCount() == 0 || _updatedCount < _minimumParallelSubtreeSize * 2)
+	{
+		for (const pair<size_t, size_t>& range : _updateRanges)
+		{
+			UpdateRange(range.first, range.second);
+		}
+	}
+	else
+	{
+		// Split large ranges into smaller subtrees.  The nodes above those subtrees are
+		// updated here as they are split off, before any of the subtrees are started.
+		_parallelRanges.clear();
+		for (const pair<size_t, size_t>& range : _updateRanges)
+		{
+			SplitRange(range.first);
+		}
+		workerPool->ParallelFor(_parallelRanges.size(), [this](size_t i)
+								{
+									UpdateRange(_parallelRanges[i].first, _parallelRanges[i].second);
+								});
+	}
+}
+
+void TransformStore::SplitRange(size_t index)
+{
+	if (static_cast<size_t>(_subtreeSizes[index]) <= _minimumParallelSubtreeSize)
+	{
+		_parallelRanges.push_back(make_pair(index, index + _subtreeSizes[index]));
+		return;
+	}
+	// Walk down the large subtrees with an explicit stack, since a deep chain of nodes would
+	// overflow the call stack.  The root of each large subtree is updated here.  Its small
+	// children are gathered into ranges of about the minimum size, which the workers update,
+	// and its large children are split in turn.
+	size_t serialFirst = index;
+	size_t serialLast = index;
+	_splitStack.push_back(index);
+	while (!_splitStack.empty())
+	{
+		size_t node = _splitStack.back();
+		_splitStack.pop_back();
+		// A parent is always taken off the stack before its children, so the roots can be
+		// updated in runs.  Down a chain this is a single run.
+		if (node != serialLast)
+		{
+			UpdateRange(serialFirst, serialLast);
+			serialFirst = node;
+		}
+		serialLast = node + 1;
+
+		size_t last = node + _subtreeSizes[node];
+		size_t groupFirst = node + 1;
+		for (size_t child = node + 1; child < last; child += _subtreeSizes[child])
+		{
+			size_t childLast = child + _subtreeSizes[child];
+			if (static_cast<size_t>(_subtreeSizes[child]) > _minimumParallelSubtreeSize)
+			{
+				if (groupFirst < child)
+				{
+					_parallelRanges.push_back(make_pair(groupFirst, child));
+				}
+				_splitStack.push_back(child);
+				groupFirst = childLast;
+			}
+			else if (childLast - groupFirst > _minimumParallelSubtreeSize)
+			{
+				if (groupFirst < child)
+				{
+					_parallelRanges.push_back(make_pair(groupFirst, child));
+				}
+				groupFirst = child;
+			}
+		}
+		if (groupFirst < last)
+		{
+			_parallelRanges.push_back(make_pair(groupFirst, last));
+		}
+	}
+	UpdateRange(serialFirst, serialLast);
+}
+
+void TransformStore::UpdateRange(size_t first, size_t last)
+{
+	// Since parents always come before their children, the parent's world transformation
+	// is already up to date by the time we reach any of its children.
+	for (size_t i = first; i < last; i++)
+	{
+		int parentIndex = _parentIndices[i];
+		if (parentIndex < 0)
+		{
+			_worldTransforms[i] = _localTransforms[i];
+		}
+		else
+		{
+			XMStoreFloat4x4(&_worldTransforms[i], XMMatrixMultiply(XMLoadFloat4x4(&_localTransforms[i]), XMLoadFloat4x4(&_worldTransforms[parentIndex])));
+		}
+	}
+}
+
+void TransformStore::Detach(TransformHandle handle)
+{
+	TransformHandle parent = _parentHandles[handle];
+	if (parent == InvalidTransformHandle)
+	{
+		return;
+	}
+	// Unlink the handle from its parent's list of children
+	if (_firstChildHandles[parent] == handle)
+	{
+		_firstChildHandles[parent] = _nextSiblingHandles[handle];
+	}
+	else
+	{
+		TransformHandle sibling = _firstChildHandles[parent];
+		while (_nextSiblingHandles[sibling] != handle)
+		{
+			sibling = _nextSiblingHandles[sibling];
+		}
+		_nextSiblingHandles[sibling] = _nextSiblingHandles[handle];
+	}
+	_parentHandles[handle] = InvalidTransformHandle;
+	_nextSiblingHandles[handle] = InvalidTransformHandle;
+}
+
+void TransformStore::Reorder()
+{
+	// Rebuild the dense arrays in depth-first pre-order, dropping any released entries
+	vector<Matrix> localTransforms;
+	vector<int> parentIndices;
+	vector<TransformHandle> handles;
+	vector<int> handleIndices(_handleIndices.size(), -1);
+	size_t liveCount = _handleIndices.size() - _freeHandles.size();
+	localTransforms.reserve(liveCount);
+	parentIndices.reserve(liveCount);
+	handles.reserve(liveCount);
+
+	vector<TransformHandle> stack;
+	TransformHandle handleCount = static_cast<TransformHandle>(_handleIndices.size());
+	for (TransformHandle root = 0; root < handleCount; root++)
+	{
+		if (_handleIndices[root] < 0 || _parentHandles[root] != InvalidTransformHandle)
+		{
+			continue;
+		}
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			TransformHandle handle = stack.back();
+			stack.pop_back();
+			TransformHandle parent = _parentHandles[handle];
+			handleIndices[handle] = static_cast<int>(handles.size());
+			handles.push_back(handle);
+			localTransforms.push_back(_localTransforms[_handleIndices[handle]]);
+			parentIndices.push_back(parent == InvalidTransformHandle ? -1 : handleIndices[parent]);
+			for (TransformHandle child = _firstChildHandles[handle]; child != InvalidTransformHandle; child = _nextSiblingHandles[child])
+			{
+				stack.push_back(child);
+			}
+		}
+	}
+
+	// Work out the size of each subtree.  Walking backwards means every child has
+	// been totalled before it is added to its parent.
+	size_t count = handles.size();
+	vector<int> subtreeSizes(count, 1);
+	for (size_t i = count; i-- > 1;)
+	{
+		if (parentIndices[i] >= 0)
+		{
+			subtreeSizes[parentIndices[i]] += subtreeSizes[i];
+		}
+	}
+
+	_localTransforms.swap(localTransforms);
+	_parentIndices.swap(parentIndices);
+	_subtreeSizes.swap(subtreeSizes);
+	_handles.swap(handles);
+	_handleIndices.swap(handleIndices);
+	_worldTransforms.assign(count, Matrix());
+	_dirtyFlags.assign(count, false);
+	_dirtyIndices.clear();
+	_orderChanged = false;
+}
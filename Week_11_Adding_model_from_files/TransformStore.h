@@ -0,0 +1,93 @@
+#pragma once
+#include "SimpleMath.h"
+#include "WorkerPool.h"
+#include <vector>
+
+using namespace std;
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+// Handle to a node's entry in the transform store.  The store is free to reorder its arrays,
+// so nodes keep a handle rather than an index and the handle stays valid until it is released.
+
+typedef int TransformHandle;
+
+const TransformHandle InvalidTransformHandle = -1;
+
+// Flat storage for the local and world transformations of every node in the scene graph.
+//
+// The transformations are held in contiguous arrays that are kept sorted in depth-first
+// pre-order, so a parent always appears before its children and every subtree occupies a
+// contiguous range of the arrays.  This means the world transformations for the whole scene
+// can be brought up to date with a single linear pass over the arrays instead of a recursive
+// walk through the nodes.
+//
+// Changing a local transformation marks the node as dirty.  Since a subtree is a contiguous
+// range, Update only needs to walk the ranges below the dirty nodes, so nodes that have not
+// moved are left alone.
+//
+// If a worker pool is passed to Update, large dirty ranges are split into independent
+// subtrees that are updated in parallel.  Subtrees smaller than the minimum parallel subtree
+// size are not split any further.  Each matrix is calculated in exactly the same way as in
+// the serial path, so the results are identical.
+
+class TransformStore
+{
+public:
+	TransformStore();
+	~TransformStore();
+
+	static TransformStore *		GetTransformStore();
+
+	TransformHandle				Allocate();
+	void						Release(TransformHandle handle);
+
+	void						SetParent(TransformHandle handle, TransformHandle parent);
+	TransformHandle				GetParent(TransformHandle handle) const;
+
+	void						SetLocalTransform(TransformHandle handle, const Matrix& localTransformation);
+	const Matrix&				GetLocalTransform(TransformHandle handle) const;
+	const Matrix&				GetWorldTransform(TransformHandle handle) const;
+
+	// Bring the world transformations of all dirty subtrees up to date
+	void						Update(WorkerPool * workerPool = nullptr);
+
+	inline void					SetMinimumParallelSubtreeSize(size_t size) { _minimumParallelSubtreeSize = size > 0 ? size : 1; }
+	inline size_t				GetMinimumParallelSubtreeSize() const { return _minimumParallelSubtreeSize; }
+
+	inline size_t				GetCount() const { return _localTransforms.size(); }
+	inline size_t				GetUpdatedCount() const { return _updatedCount; }
+
+private:
+	// Dense arrays, indexed by position in the pre-order sort
+	vector<Matrix>				_localTransforms;
+	vector<Matrix>				_worldTransforms;
+	vector<int>					_parentIndices;
+	vector<int>					_subtreeSizes;
+	vector<TransformHandle>		_handles;
+	vector<bool>				_dirtyFlags;
+	vector<int>					_dirtyIndices;
+
+	// Sparse arrays, indexed by handle.  These hold the hierarchy links that are used
+	// to rebuild the sort order when the hierarchy changes.
+	vector<int>					_handleIndices;
+	vector<TransformHandle>		_parentHandles;
+	vector<TransformHandle>		_firstChildHandles;
+	vector<TransformHandle>		_nextSiblingHandles;
+	vector<TransformHandle>		_freeHandles;
+
+	bool						_orderChanged;
+	size_t						_updatedCount;
+	size_t						_minimumParallelSubtreeSize;
+
+	// Ranges of the dense arrays that need updating this frame
+	vector<pair<size_t, size_t>>	_updateRanges;
+	vector<pair<size_t, size_t>>	_parallelRanges;
+	vector<size_t>				_splitStack;
+
+	void						Detach(TransformHandle handle);
+	void						Reorder();
+	void						UpdateRange(size_t first, size_t last);
+	void						SplitRange(size_t index);
+};
+
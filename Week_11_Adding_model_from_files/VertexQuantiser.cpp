@@ -0,0 +1,241 @@
+#include "VertexQuantiser.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+const float UnormScale = 65535.0f;
+const float SnormScale = 32767.0f;
+
+QuantisationError DefaultQuantisationTolerance()
+{
+	QuantisationError tolerance;
+	// Several times the quantisation step, which is 1 / 65535 of the bounds on each axis
+	tolerance.Position = 1.0f / 10000.0f;
+	// About 0.06 degrees
+	tolerance.Normal = 1.0f / 1000.0f;
+	// Half a texel of a 1024 x 1024 texture.  Half floats are this accurate up to 2, which
+	// covers the coordinates that ResourceManager wraps into the range 0 to 2.
+	tolerance.TexCoord = 1.0f / 2048.0f;
+	return tolerance;
+}
+
+QuantisationBounds MakeQuantisationBounds(const float centre[3], const float extents[3])
+{
+	QuantisationBounds bounds;
+	for (int i = 0; i < 3; i++)
+	{
+		bounds.Minimum[i] = centre[i] - extents[i];
+		bounds.Scale[i] = 2.0f * extents[i];
+	}
+	return bounds;
+}
+
+uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t absBits = bits & 0x7FFFFFFF;
+	if (absBits >= 0x7F800000)
+	{
+		// Infinity stays infinity and NaN stays NaN
+		return static_cast<uint16_t>(sign | 0x7C00 | (absBits > 0x7F800000 ? 0x200 : 0));
+	}
+	if (absBits >= 0x477FF000)
+	{
+		// Rounds to 65520 or more, which is too large for a half
+		return static_cast<uint16_t>(sign | 0x7C00);
+	}
+	if (absBits < 0x38800000)
+	{
+		// Below the smallest normal half (2^-14), so the result is denormal or zero.  Anything
+		// below 2^-25 rounds to zero.
+		if (absBits < 0x33000000)
+		{
+			return static_cast<uint16_t>(sign);
+		}
+		uint32_t mantissa = (absBits & 0x7FFFFF) | 0x800000;
+		uint32_t shift = 126 - (absBits >> 23);
+		uint32_t half = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+		{
+			half++;
+		}
+		return static_cast<uint16_t>(sign | half);
+	}
+	// Rebias the exponent and round the mantissa.  A carry out of the mantissa correctly
+	// moves on to the next exponent.
+	uint32_t half = ((absBits >> 23) - 112) << 10 | (absBits & 0x7FFFFF) >> 13;
+	uint32_t remainder = absBits & 0x1FFF;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0))
+	{
+		half++;
+	}
+	return static_cast<uint16_t>(sign | half);
+}
+
+float HalfToFloat(uint16_t value)
+{
+	uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x3FF;
+	if (exponent == 0)
+	{
+		float result = ldexp(static_cast<float>(mantissa), -24);
+		return sign != 0 ? -result : result;
+	}
+	uint32_t bits;
+	if (exponent == 31)
+	{
+		bits = sign | 0x7F800000 | mantissa << 13;
+	}
+	else
+	{
+		bits = sign | (exponent + 112) << 23 | mantissa << 13;
+	}
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+// Like max, but a NaN error is kept so that IsWithinTolerance rejects it
+static inline float MaxError(float error, float value)
+{
+	return value > error || value != value ? value : error;
+}
+
+static inline float SignNotZero(float value)
+{
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+static inline float DecodeSnorm(int16_t value)
+{
+	return max(value / SnormScale, -1.0f);
+}
+
+static void DecodeOctahedral(const int16_t encoded[2], float normal[3])
+{
+	float x = DecodeSnorm(encoded[0]);
+	float y = DecodeSnorm(encoded[1]);
+	float z = 1.0f - fabs(x) - fabs(y);
+	// Unfold the lower hemisphere
+	float t = max(-z, 0.0f);
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+	float length = sqrt(x * x + y * y + z * z);
+	normal[0] = x / length;
+	normal[1] = y / length;
+	normal[2] = z / length;
+}
+
+static void EncodeOctahedral(const float normal[3], int16_t encoded[2])
+{
+	float l1 = fabs(normal[0]) + fabs(normal[1]) + fabs(normal[2]);
+	if (l1 == 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+	// Project onto the octahedron and fold the lower hemisphere over the upper one
+	float x = normal[0] / l1;
+	float y = normal[1] / l1;
+	if (normal[2] < 0.0f)
+	{
+		float foldedX = (1.0f - fabs(y)) * SignNotZero(x);
+		y = (1.0f - fabs(x)) * SignNotZero(y);
+		x = foldedX;
+	}
+	// Rounding each component to the nearest value is not always the most accurate choice, so
+	// try rounding both ways and keep whichever decodes closest to the normal
+	float floorX = floor(min(max(x, -1.0f), 1.0f) * SnormScale);
+	float floorY = floor(min(max(y, -1.0f), 1.0f) * SnormScale);
+	float bestDot = -2.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		int16_t candidate[2];
+		candidate[0] = static_cast<int16_t>(min(floorX + (i & 1), SnormScale));
+		candidate[1] = static_cast<int16_t>(min(floorY + (i >> 1), SnormScale));
+		float decoded[3];
+		DecodeOctahedral(candidate, decoded);
+		float dot = (decoded[0] * normal[0] + decoded[1] * normal[1] + decoded[2] * normal[2]) / l1;
+		if (dot > bestDot)
+		{
+			bestDot = dot;
+			encoded[0] = candidate[0];
+			encoded[1] = candidate[1];
+		}
+	}
+}
+
+void QuantiseVertex(const float position[3], const float normal[3], const float texCoord[2], const QuantisationBounds& bounds, QuantisedVertex& vertex)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		float value = bounds.Scale[i] > 0.0f ? (position[i] - bounds.Minimum[i]) / bounds.Scale[i] : 0.0f;
+		// Written so that NaN is clamped as well
+		value = value >= 0.0f ? min(value, 1.0f) : 0.0f;
+		vertex.Position[i] = static_cast<uint16_t>(value * UnormScale + 0.5f);
+	}
+	vertex.Position[3] = 0;
+	EncodeOctahedral(normal, vertex.Normal);
+	vertex.TexCoord[0] = FloatToHalf(texCoord[0]);
+	vertex.TexCoord[1] = FloatToHalf(texCoord[1]);
+}
+
+void DequantiseVertex(const QuantisedVertex& vertex, const QuantisationBounds& bounds, float position[3], float normal[3], float texCoord[2])
+{
+	for (int i = 0; i < 3; i++)
+	{
+		position[i] = bounds.Minimum[i] + bounds.Scale[i] * (vertex.Position[i] / UnormScale);
+	}
+	DecodeOctahedral(vertex.Normal, normal);
+	texCoord[0] = HalfToFloat(vertex.TexCoord[0]);
+	texCoord[1] = HalfToFloat(vertex.TexCoord[1]);
+}
+
+void QuantiseVertices(const void * vertices, size_t vertexCount, size_t vertexStride, const QuantisationBounds& bounds, QuantisedVertex * quantisedVertices, QuantisationError& error)
+{
+	error.Position = 0.0f;
+	error.Normal = 0.0f;
+	error.TexCoord = 0.0f;
+	float largestScale = max(bounds.Scale[0], max(bounds.Scale[1], bounds.Scale[2]));
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		// Position, normal and texture coordinate
+		float vertex[8];
+		memcpy(vertex, static_cast<const uint8_t *>(vertices) + vertexStride * i, sizeof(vertex));
+		QuantiseVertex(&vertex[0], &vertex[3], &vertex[6], bounds, quantisedVertices[i]);
+
+		float decoded[8];
+		DequantiseVertex(quantisedVertices[i], bounds, &decoded[0], &decoded[3], &decoded[6]);
+		float dx = decoded[0] - vertex[0];
+		float dy = decoded[1] - vertex[1];
+		float dz = decoded[2] - vertex[2];
+		if (largestScale > 0.0f)
+		{
+			error.Position = MaxError(error.Position, sqrt(dx * dx + dy * dy + dz * dz) / largestScale);
+		}
+		float normalLength = sqrt(vertex[3] * vertex[3] + vertex[4] * vertex[4] + vertex[5] * vertex[5]);
+		if (normalLength > 0.0f)
+		{
+			float nx = decoded[3] - vertex[3] / normalLength;
+			float ny = decoded[4] - vertex[4] / normalLength;
+			float nz = decoded[5] - vertex[5] / normalLength;
+			error.Normal = MaxError(error.Normal, sqrt(nx * nx + ny * ny + nz * nz));
+		}
+		error.TexCoord = MaxError(error.TexCoord, fabs(decoded[6] - vertex[6]));
+		error.TexCoord = MaxError(error.TexCoord, fabs(decoded[7] - vertex[7]));
+	}
+}
+
+bool IsWithinTolerance(const QuantisationError& error, const QuantisationError& tolerance)
+{
+	// A NaN error (from a position or texture coordinate that is not finite) fails the test
+	return error.Position <= tolerance.Position && error.Normal <= tolerance.Normal && error.TexCoord <= tolerance.TexCoord;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// A compact vertex layout of 16 bytes, half the size of the Vertex structure, for meshes that
+// are drawn with the VSQuantised entry points in shader.hlsl and TextureShader.hlsl.
+//
+//	Position	Three UNORM16 values across the bounds of the sub-mesh (R16G16B16A16_UNORM).  The
+//				shader scales them back using the MeshConstants of the sub-mesh.  W is unused.
+//	Normal		Octahedral encoding of the unit normal as two SNORM16 values (R16G16_SNORM)
+//	TexCoord	Two half floats (R16G16_FLOAT)
+//
+// The encode and decode here must match DecodeVertex in the shaders.  Vertices are read as
+// eight floats at the start of each vertex (position, normal and texture coordinate, as in the
+// Vertex structure).  This module has no dependencies on Windows or Direct3D.
+
+struct QuantisedVertex
+{
+	uint16_t				Position[4];
+	int16_t					Normal[2];
+	uint16_t				TexCoord[2];
+};
+
+// Decoded position = Minimum + Scale * UNORM value
+struct QuantisationBounds
+{
+	float					Minimum[3];
+	float					Scale[3];
+};
+
+// The largest differences between the original and decoded vertices
+struct QuantisationError
+{
+	// Distance between the positions, as a fraction of the largest dimension of the bounds
+	float					Position;
+	// Distance between the unit normals.  Vertices with a zero normal (meshes without normals)
+	// are not counted.
+	float					Normal;
+	// Largest difference in either texture coordinate
+	float					TexCoord;
+};
+
+// The error allowed before a mesh is kept in the full vertex format
+QuantisationError DefaultQuantisationTolerance();
+
+QuantisationBounds MakeQuantisationBounds(const float centre[3], const float extents[3]);
+
+void QuantiseVertex(const float position[3], const float normal[3], const float texCoord[2], const QuantisationBounds& bounds, QuantisedVertex& vertex);
+void DequantiseVertex(const QuantisedVertex& vertex, const QuantisationBounds& bounds, float position[3], float normal[3], float texCoord[2]);
+
+// Quantises the vertices and measures the error by decoding them again
+void QuantiseVertices(const void * vertices, size_t vertexCount, size_t vertexStride, const QuantisationBounds& bounds, QuantisedVertex * quantisedVertices, QuantisationError& error);
+
+bool IsWithinTolerance(const QuantisationError& error, const QuantisationError& tolerance);
+
+// IEEE half float conversion, rounding to nearest even
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
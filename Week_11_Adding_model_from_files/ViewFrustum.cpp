@@ -0,0 +1,57 @@
+#include "ViewFrustum.h"
+
+ViewFrustum::ViewFrustum()
+{
+	// Until the frustum is extracted, every plane accepts everything
+	for (int i = 0; i < 6; i++)
+	{
+		_planes[i] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+}
+
+void ViewFrustum::Extract(const Matrix& viewProjectionTransformation)
+{
+	// Since we transform row vectors (v * M), the planes come from the columns of the
+	// view-projection matrix, which are the rows of its transpose.  Depth runs from 0 to 1
+	// in Direct3D, so the near plane is just the third column.
+	XMMATRIX columns = XMMatrixTranspose(XMLoadFloat4x4(&viewProjectionTransformation));
+	XMVECTOR planes[6];
+	planes[0] = XMVectorAdd(columns.r[3], columns.r[0]);			// Left
+	planes[1] = XMVectorSubtract(columns.r[3], columns.r[0]);		// Right
+	planes[2] = XMVectorAdd(columns.r[3], columns.r[1]);			// Bottom
+	planes[3] = XMVectorSubtract(columns.r[3], columns.r[1]);		// Top
+	planes[4] = columns.r[2];										// Near
+	planes[5] = XMVectorSubtract(columns.r[3], columns.r[2]);		// Far
+	for (int i = 0; i < 6; i++)
+	{
+		XMStoreFloat4(&_planes[i], XMPlaneNormalize(planes[i]));
+	}
+}
+
+bool ViewFrustum::Intersects(const BoundingBox& localBounds, const Matrix& worldTransformation) const
+{
+	XMMATRIX world = XMLoadFloat4x4(&worldTransformation);
+	XMVECTOR localCentre = XMLoadFloat3(&localBounds.Center);
+	XMVECTOR localExtents = XMLoadFloat3(&localBounds.Extents);
+
+	// Transform the box into world space.  The result is the box that encloses the
+	// transformed box, so its extents are the absolute values of the rotated extents.
+	XMVECTOR centre = XMVector3Transform(localCentre, world);
+	XMVECTOR extents = XMVectorMultiply(XMVectorAbs(world.r[0]), XMVectorSplatX(localExtents));
+	extents = XMVectorMultiplyAdd(XMVectorAbs(world.r[1]), XMVectorSplatY(localExtents), extents);
+	extents = XMVectorMultiplyAdd(XMVectorAbs(world.r[2]), XMVectorSplatZ(localExtents), extents);
+
+	// The box is outside if it is entirely on the negative side of any plane.  For each plane,
+	// compare the signed distance of the centre with the projected radius of the box.
+	for (int i = 0; i < 6; i++)
+	{
+		XMVECTOR plane = XMLoadFloat4(&_planes[i]);
+		XMVECTOR distance = XMPlaneDotCoord(plane, centre);
+		XMVECTOR radius = XMVector3Dot(XMVectorAbs(plane), extents);
+		if (XMVector4Less(XMVectorAdd(distance, radius), XMVectorZero()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
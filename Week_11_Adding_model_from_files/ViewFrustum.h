@@ -0,0 +1,30 @@
+#pragma once
+#include "DirectXCore.h"
+
+// The six planes of the view frustum, extracted from the combined view and projection
+// transformations.  Each plane is stored with its normal pointing into the frustum, so a point
+// is inside the frustum if it is on the positive side of all six planes.
+
+class ViewFrustum
+{
+public:
+	ViewFrustum();
+
+	void					Extract(const Matrix& viewProjectionTransformation);
+
+	// Tests a bounding box given in the node's local space against the frustum.  The box is
+	// transformed by the world transformation first.  Returns false only if the box is
+	// definitely outside the frustum.
+	bool					Intersects(const BoundingBox& localBounds, const Matrix& worldTransformation) const;
+
+private:
+	XMFLOAT4				_planes[6];
+};
+
+// Counts of the nodes that were drawn and skipped by the last render of the scene graph
+
+struct CullingStatistics
+{
+	size_t					VisibleCount;
+	size_t					CulledCount;
+};
@@ -0,0 +1,112 @@
+#include "WorkerPool.h"
+#include <atomic>
+#include <memory>
+
+// By default, use one worker for each hardware thread apart from the one we are running on
+WorkerPool::WorkerPool() : WorkerPool(thread::hardware_concurrency() > 1 ? thread::hardware_concurrency() - 1 : 1)
+{
+}
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+{
+	_stopping = false;
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		_threads.emplace_back(&WorkerPool::WorkerThread, this);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		lock_guard<mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_taskAvailable.notify_all();
+	for (thread& worker : _threads)
+	{
+		worker.join();
+	}
+}
+
+void WorkerPool::Submit(function<void()> task)
+{
+	{
+		lock_guard<mutex> lock(_mutex);
+		_tasks.push_back(move(task));
+	}
+	_taskAvailable.notify_one();
+}
+
+void WorkerPool::ParallelFor(size_t count, const function<void(size_t)>& body)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (count == 1 || _threads.empty())
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			body(i);
+		}
+		return;
+	}
+
+	// The loop state is shared with the workers.  A worker may not pick up its task until
+	// after the loop has completed, in which case it will find nothing left to do.
+	struct LoopState
+	{
+		atomic<size_t>		NextIndex;
+		atomic<size_t>		CompletedCount;
+		mutex				Mutex;
+		condition_variable	Finished;
+	};
+	shared_ptr<LoopState> state = make_shared<LoopState>();
+	state->NextIndex = 0;
+	state->CompletedCount = 0;
+	const function<void(size_t)> * loopBody = &body;
+
+	auto runLoop = [state, count, loopBody]()
+	{
+		size_t index;
+		while ((index = state->NextIndex++) < count)
+		{
+			(*loopBody)(index);
+			if (++state->CompletedCount == count)
+			{
+				lock_guard<mutex> lock(state->Mutex);
+				state->Finished.notify_all();
+			}
+		}
+	};
+
+	size_t helperCount = min(static_cast<size_t>(_threads.size()), count - 1);
+	for (size_t i = 0; i < helperCount; i++)
+	{
+		Submit(runLoop);
+	}
+	runLoop();
+
+	unique_lock<mutex> lock(state->Mutex);
+	state->Finished.wait(lock, [&state, count]() { return state->CompletedCount == count; });
+}
+
+void WorkerPool::WorkerThread()
+{
+	while (true)
+	{
+		function<void()> task;
+		{
+			unique_lock<mutex> lock(_mutex);
+			_taskAvailable.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+			if (_stopping && _tasks.empty())
+			{
+				return;
+			}
+			task = move(_tasks.front());
+			_tasks.pop_front();
+		}
+		task();
+	}
+}
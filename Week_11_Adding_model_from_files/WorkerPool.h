@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+// A simple pool of worker threads.
+//
+// Submit queues a task to be run on one of the workers at some point in the future.
+// ParallelFor splits a loop across the workers and waits for it to finish.  The calling
+// thread works through the loop as well, so ParallelFor still makes progress (and cannot
+// deadlock) if all of the workers are busy with long running tasks.
+
+class WorkerPool
+{
+public:
+	WorkerPool();
+	WorkerPool(unsigned int threadCount);
+	~WorkerPool();
+
+	void						Submit(function<void()> task);
+	void						ParallelFor(size_t count, const function<void(size_t)>& body);
+
+	inline unsigned int			GetThreadCount() const { return static_cast<unsigned int>(_threads.size()); }
+
+private:
+	vector<thread>				_threads;
+	deque<function<void()>>		_tasks;
+	mutex						_mutex;
+	condition_variable			_taskAvailable;
+	bool						_stopping;
+
+	void						WorkerThread();
+};
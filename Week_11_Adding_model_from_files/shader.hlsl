@@ -1,75 +1,144 @@
-cbuffer ConstantBuffer 
-{
-	Matrix		WorldViewProjection;
-	Matrix		World;
-	float4		MaterialColour;
-    float4		AmbientLightColour;
-    float4		DirectionalLightColour;
-    float4		DirectionalLightVector;
-    float4      cameraPosition;
-    float4      specularCoefficient; 
-    float       shininess; 
-    float       opacity; 
-    float2      padding;
-};
-
-Texture2D Texture;
-SamplerState ss;
-
-struct VertexIn
-{
-	float3 InputPosition : POSITION;
-	float3 Normal        : NORMAL;
-    float2 TexCoord     : TEXCOORD;
-};
-
-struct VertexOut
-{
-	float4 OutputPosition	: SV_POSITION;
-    float4 PositionWS : TEXCOORD1;
-    float4 NormalWS : TEXCOORD0;
-    float2 TexCoord : TEXCOORD3;
-    
-
-};
-
-
-
-VertexOut VS(VertexIn vin)
-{
-	VertexOut vout;
-  
-    vout.OutputPosition = mul(WorldViewProjection, float4(vin.InputPosition, 1.0f));
-    vout.PositionWS = mul(World, float4(vin.InputPosition, 1.0f));
-    vout.NormalWS = float4(mul((float3x3) World, vin.Normal), 1.0f);
-    vout.TexCoord = vin.TexCoord;
-	return vout;
-}
-
-
-float4 PS(VertexOut pin) : SV_Target
-{
-    float4 viewDirection = normalize(cameraPosition - pin.PositionWS);
-    float4 normal = normalize(pin.NormalWS);
-    float NdotL = max(0, dot(normal, normalize(-DirectionalLightVector)));
-    float4 R = 2 * NdotL * normal - normalize(-DirectionalLightVector);
-    float RdotV = max(0, dot(R, viewDirection));
-    
-    // Calculate diffuse, specular, ambient lighting
-    float4 diffuse = saturate(DirectionalLightColour * NdotL * MaterialColour);
-    float4 specular = saturate(DirectionalLightColour * pow(RdotV, shininess) * specularCoefficient);
-    float4 ambientLight = AmbientLightColour * MaterialColour;
-    float4 diffuseColor = Texture.Sample(ss, pin.TexCoord) * MaterialColour;
-
-
-	// Combine all components
-    float4 color = saturate((ambientLight + diffuse + specular));
-    
-    if (opacity < 1.0f)
-    {
-        color.a = opacity;
-    }
-    return color;
-}
-
-
+// The constant buffers are split by how often they change.  The layouts must match
+// the structures in ShaderConstants.h.
+
+cbuffer FrameConstants : register(b0)
+{
+    matrix      ViewProjection;
+    float4      DirectionalLightColour;
+    float4      DirectionalLightVector;
+    float4      cameraPosition;
+};
+
+cbuffer MaterialConstants : register(b1)
+{
+    float4      MaterialColour;
+    float4      specularCoefficient;
+    float       shininess;
+    float       opacity;
+    float2      padding;
+};
+
+cbuffer ObjectConstants : register(b2)
+{
+    matrix      World;
+    float4      AmbientLightColour;
+};
+
+cbuffer MeshConstants : register(b3)
+{
+    float4      PositionMinimum;
+    float4      PositionScale;
+};
+
+Texture2D Texture;
+SamplerState ss;
+
+struct VertexIn
+{
+	float3 InputPosition : POSITION;
+	float3 Normal        : NORMAL;
+    float2 TexCoord     : TEXCOORD;
+};
+
+// The 16 byte vertex format described in VertexQuantiser.h.  The formats in the input layout
+// turn the position into 0 to 1, the normal into -1 to 1 and the half floats into floats.
+struct QuantisedVertexIn
+{
+    float4 Position     : POSITION;
+    float2 Normal       : NORMAL;
+    float2 TexCoord     : TEXCOORD;
+};
+
+struct InstanceIn
+{
+    matrix World            : WORLD;
+    float4 AmbientColour    : AMBIENT;
+};
+
+struct VertexOut
+{
+	float4 OutputPosition	: SV_POSITION;
+    float4 PositionWS : TEXCOORD1;
+    float4 NormalWS : TEXCOORD0;
+    float2 TexCoord : TEXCOORD3;
+    float4 AmbientColour : TEXCOORD2;
+
+};
+
+
+
+VertexOut VS(VertexIn vin)
+{
+	VertexOut vout;
+  
+    vout.PositionWS = mul(World, float4(vin.InputPosition, 1.0f));
+    vout.OutputPosition = mul(ViewProjection, vout.PositionWS);
+    vout.NormalWS = float4(mul((float3x3) World, vin.Normal), 1.0f);
+    vout.TexCoord = vin.TexCoord;
+    vout.AmbientColour = AmbientLightColour;
+	return vout;
+}
+
+// Vertex shader used when several objects that share geometry and material are drawn with
+// one instanced draw call.  The world transformation and ambient colour come from the
+// instance stream rather than the object constants.  Matrices in the instance stream are
+// read a row at a time, so the vector goes on the left.
+
+VertexOut VSInstanced(VertexIn vin, InstanceIn instance)
+{
+	VertexOut vout;
+
+    vout.PositionWS = mul(float4(vin.InputPosition, 1.0f), instance.World);
+    vout.OutputPosition = mul(ViewProjection, vout.PositionWS);
+    vout.NormalWS = float4(mul(vin.Normal, (float3x3) instance.World), 1.0f);
+    vout.TexCoord = vin.TexCoord;
+    vout.AmbientColour = instance.AmbientColour;
+	return vout;
+}
+
+// Must match DequantiseVertex in VertexQuantiser.cpp
+VertexIn DecodeVertex(QuantisedVertexIn qin)
+{
+    VertexIn vin;
+    vin.InputPosition = PositionMinimum.xyz + PositionScale.xyz * qin.Position.xyz;
+    // Octahedral decoding, unfolding the lower hemisphere
+    float3 normal = float3(qin.Normal, 1.0f - abs(qin.Normal.x) - abs(qin.Normal.y));
+    float t = saturate(-normal.z);
+    normal.xy += normal.xy >= 0.0f ? -t : t;
+    vin.Normal = normalize(normal);
+    vin.TexCoord = qin.TexCoord;
+    return vin;
+}
+
+VertexOut VSQuantised(QuantisedVertexIn qin)
+{
+    return VS(DecodeVertex(qin));
+}
+
+
+float4 PS(VertexOut pin) : SV_Target
+{
+    float4 viewDirection = normalize(cameraPosition - pin.PositionWS);
+    float4 normal = normalize(pin.NormalWS);
+    float NdotL = max(0, dot(normal, normalize(-DirectionalLightVector)));
+    float4 R = 2 * NdotL * normal - normalize(-DirectionalLightVector);
+    float RdotV = max(0, dot(R, viewDirection));
+    
+    // Calculate diffuse, specular, ambient lighting
+    float4 diffuse = saturate(DirectionalLightColour * NdotL * MaterialColour);
+    float4 specular = saturate(DirectionalLightColour * pow(RdotV, shininess) * specularCoefficient);
+    float4 ambientLight = pin.AmbientColour * MaterialColour;
+    float4 diffuseColor = Texture.Sample(ss, pin.TexCoord) * MaterialColour;
+
+
+	// Combine all components
+    float4 color = saturate((ambientLight + diffuse + specular));
+    
+    if (opacity < 1.0f)
+    {
+        color.a = opacity;
+    }
+    return color;
+}
+
+